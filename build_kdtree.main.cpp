@@ -1,17 +1,25 @@
 #include <iostream>
 #include <fstream>
+#include <stdexcept>
 #include <string>
+#include <vector>
 
 #include "kdtree.h"
+#include "kdtree_csv.h"
+#include "kdtree_external.h"
+#include "kdtree_report.h"
 
 using namespace std;
 using namespace datastructures;
 
 const string defaultTreeFile = "kdtree.serialized";
+const string csvCacheFlag    = "--csv-cache";
+const string reportFlag      = "--report";
 
 static void printHelp()
 {
-    cout << "Usage: build_kdtree sample_file tree_file                                  " << endl;
+    cout << "Usage: build_kdtree [--csv-cache] [--report] sample_file tree_file         " << endl;
+    cout << "                    memory_budget                                          " << endl;
     cout << "                                                                           " << endl;
     cout << "    Where :                                                                " << endl;
     cout << "                                                                           " << endl;
@@ -22,11 +30,28 @@ static void printHelp()
     cout << "                           Default value is '" << defaultTreeFile << "'    " << endl;
     cout << "                           Note that all contents of an existing file will " << endl;
     cout << "                           be erased.                                      " << endl;
+    cout << "                                                                           " << endl;
+    cout << "      memory_budget      - optional peak memory in megabytes. When provided, " << endl;
+    cout << "                           the tree is built out of core: the sample file  " << endl;
+    cout << "                           is split on disk into partitions that fit the   " << endl;
+    cout << "                           budget, with scratch files next to tree_file    " << endl;
+    cout << "                                                                           " << endl;
+    cout << "      --csv-cache        - optional, keeps a binary copy of the parsed     " << endl;
+    cout << "                           sample next to sample_file and reuses it while  " << endl;
+    cout << "                           sample_file is unchanged. Not used together     " << endl;
+    cout << "                           with memory_budget.                             " << endl;
+    cout << "                                                                           " << endl;
+    cout << "      --report           - optional, times the phases of the build and     " << endl;
+    cout << "                           describes the shape of the tree: leaf depths,   " << endl;
+    cout << "                           balance, splits per axis and cell aspect ratios." << endl;
+    cout << "                           Printed, and written as JSON to                 " << endl;
+    cout << "                           tree_file" << Constants::KDTREE_REPORT_SUFFIX << "                          " << endl;
+    cout << "                           Not used together with memory_budget.           " << endl;
 }
 
-static bool validateInputs( int argc, char *argv[] )
+static bool validateInputs( const vector< string >& arguments )
 {
-    if ( argc < 2 )
+    if ( arguments.size() < 2 )
     {
         return false;
     }
@@ -39,60 +64,80 @@ static bool validateInputs( int argc, char *argv[] )
 
 int main( int argc, char *argv[] )
 {
-    if ( !validateInputs( argc, argv ) )
+    // Flags may appear anywhere, the rest are positional
+    vector< string > arguments;
+    bool useCsvCache = false;
+    bool writeReport = false;
+    for ( int i = 0; i < argc; ++i )
     {
-        printHelp();
-        return 1;
+        if ( csvCacheFlag == argv[ i ] )
+        {
+            useCsvCache = true;
+            continue;
+        }
+        if ( reportFlag == argv[ i ] )
+        {
+            writeReport = true;
+            continue;
+        }
+        arguments.push_back( argv[ i ] );
     }
 
-    const string sampleFileName = argv[ 1 ];
-
-    ifstream treeData( sampleFileName );
-
-    if ( !treeData.is_open() )
+    if ( !validateInputs( arguments ) )
     {
-        cerr << "Unable to open '" << sampleFileName << "' for reading"
-                  << endl;
+        printHelp();
         return 1;
     }
 
-    Types::Points< double > points;
-    string line;
+    const string sampleFileName = arguments[ 1 ];
+    const string treeFileName   = arguments.size() > 2 ? arguments[ 2 ]
+                                                       : defaultTreeFile;
 
-    while ( getline ( treeData, line ) )
+    if ( arguments.size() > 3 )
     {
-        Types::Point< double > point;
-        size_t pos = 0;
+        size_t memoryBudget = 0u;
+        try
+        {
+            memoryBudget = stoul( arguments[ 3 ] ) * 1024u * 1024u;
+        }
+        catch ( const exception& )
+        {
+            printHelp();
+            return 1;
+        }
 
-        while ( true )
+        if ( writeReport )
         {
-            point.push_back( static_cast< double >( stof( line, &pos ) ) );
-
-            if ( line[ pos ] == ',')
-            {
-                line = line.substr( pos + 1u );
-            }
-            else
-            {
-                break;
-            }
+            cout << "Build report is not available out of core" << endl;
         }
 
-        points.push_back( point );
-    }
-    treeData.close();
+        KDExternalBuilder< double > builder( memoryBudget );
+        if ( !builder.build( sampleFileName, treeFileName ) )
+        {
+            cout << "Unable to build KDTree out of core" << endl;
+            return 1;
+        }
+        cout << builder << endl;
 
-    string treeFileName;
-    if ( 2 == argc )
-    {
-        treeFileName = defaultTreeFile;
+        cout << "Done" << endl;
+        cout << "    KDTree is serialized to  : " << treeFileName << endl;
+
+        return 0;
     }
-    else
+
+    KDCsvPoints< double > sample;
+    if ( !sample.load( sampleFileName, useCsvCache ) )
     {
-        treeFileName = argv[ 2 ];
+        cerr << "Unable to load '" << sampleFileName << "'" << endl;
+        return 1;
     }
+    cout << sample << endl;
 
-    KDTree< double > tree( points );
+    // Built straight over the loaded, possibly mapped, coordinates
+    KDTreeOptions options;
+    options.profileBuild = writeReport;
+    KDTree< double > tree( sample.data(), sample.size(), sample.dimension(),
+                           sample.dimension(), options );
     cout << tree << endl;
 
     if ( !tree.serialize( treeFileName )  )
@@ -101,8 +146,28 @@ int main( int argc, char *argv[] )
         return 1;
     }
 
+    const string reportFileName = treeFileName +
+                                  Constants::KDTREE_REPORT_SUFFIX;
+    if ( writeReport )
+    {
+        const KDTreeReport< double > report( tree );
+        cout << report << endl;
+
+        ofstream reportFile( reportFileName.c_str() );
+        report.printJson( reportFile ) << endl;
+        if ( !reportFile )
+        {
+            cout << "Unable to write '" << reportFileName << "'" << endl;
+            return 1;
+        }
+    }
+
     cout << "Done" << endl;
     cout << "    KDTree is serialized to  : " << treeFileName << endl;
+    if ( writeReport )
+    {
+        cout << "    Build report is written to : " << reportFileName << endl;
+    }
 
     return 0;
 }
\ No newline at end of file
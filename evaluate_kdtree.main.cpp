@@ -0,0 +1,311 @@
+#include <chrono>
+#include <iostream>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "kdtree.h"
+#include "kdtree_csv.h"
+#include "kdtree_histogram.h"
+#include "kdtree_brute_force.h"
+
+using namespace std;
+using namespace datastructures;
+
+const string csvCacheFlag = "--csv-cache";
+const string threadsFlag  = "--threads";
+const string jsonFlag     = "--json";
+
+typedef chrono::steady_clock Clock;
+
+static void printHelp()
+{
+    cout << "Usage: evaluate_kdtree [--csv-cache] [--threads count] [--json json_file] " << endl;
+    cout << "                       tree_file query_file                                " << endl;
+    cout << "                                                                           " << endl;
+    cout << "    Answers every query of query_file with the tree of tree_file and by    " << endl;
+    cout << "    brute force, and reports how often the tree finds the closest point    " << endl;
+    cout << "    (recall at 1), how much farther its answers are when it does not       " << endl;
+    cout << "    (distance error ratio) and how much faster it is (speedup)             " << endl;
+    cout << "                                                                           " << endl;
+    cout << "    Where :                                                                " << endl;
+    cout << "      tree_file          - path to file produced by successful             " << endl;
+    cout << "                           invocation of build_kdtree                      " << endl;
+    cout << "                                                                           " << endl;
+    cout << "      query_file         - path CSV file containing query points data      " << endl;
+    cout << "                           as prescribed by the assignment                 " << endl;
+    cout << "                                                                           " << endl;
+    cout << "      --csv-cache        - optional, same as for query_kdtree              " << endl;
+    cout << "                                                                           " << endl;
+    cout << "      --threads count    - optional, number of threads the batched brute   " << endl;
+    cout << "                           force search runs on. Default value is 0, all   " << endl;
+    cout << "                           hardware threads                                " << endl;
+    cout << "                                                                           " << endl;
+    cout << "      --json json_file   - optional, also writes the report to json_file   " << endl;
+    cout << "                           as a JSON object                                " << endl;
+}
+
+static double secondsSince( const Clock::time_point& start )
+{
+    return chrono::duration< double >( Clock::now() - start ).count();
+}
+
+static bool validateInputs( const vector< string >& arguments )
+{
+    if ( arguments.size() < 3 )
+    {
+        return false;
+    }
+
+    return true;
+}
+
+// locations :
+//     tree data  - "data/sample_data.csv"
+//     query data - "data/query_data.csv"
+
+int main( int argc, char *argv[] )
+{
+    // Flags may appear anywhere, the rest are positional
+    vector< string > arguments;
+    bool   useCsvCache = false;
+    size_t numThreads  = 0u;
+    string jsonFilename;
+    for ( int i = 0; i < argc; ++i )
+    {
+        if ( jsonFlag == argv[ i ] )
+        {
+            if ( i + 1 == argc )
+            {
+                printHelp();
+                return 1;
+            }
+            jsonFilename = argv[ ++i ];
+            continue;
+        }
+        if ( threadsFlag == argv[ i ] )
+        {
+            if ( i + 1 == argc )
+            {
+                printHelp();
+                return 1;
+            }
+
+            try
+            {
+                numThreads = stoul( argv[ ++i ] );
+            }
+            catch ( const exception& )
+            {
+                printHelp();
+                return 1;
+            }
+            continue;
+        }
+        if ( csvCacheFlag == argv[ i ] )
+        {
+            useCsvCache = true;
+            continue;
+        }
+        arguments.push_back( argv[ i ] );
+    }
+
+    if ( !validateInputs( arguments ) )
+    {
+        printHelp();
+        return 1;
+    }
+
+    const string treeFileName  = arguments[ 1 ];
+    const string queryFileName = arguments[ 2 ];
+
+    KDTree< float > tree;
+    if ( !tree.deserialize( treeFileName ) )
+    {
+        printHelp();
+        return 1;
+    }
+    cout << tree << endl;
+
+    KDCsvPoints< float > queries;
+    if ( !queries.load( queryFileName, useCsvCache ) )
+    {
+        cout << "evaluate_kdtree is unable to load '"
+                  << queryFileName << "'"
+                  << endl;
+        return 1;
+    }
+    cout << queries << endl;
+
+    // Straight from where the tree stores its points, so brute force
+    // answers are storage indexes until mapped to input order below
+    const KDBruteForce< float > bruteForce( tree.pointsView(), numThreads );
+    cout << bruteForce << endl;
+
+    const size_t numQueries = queries.size();
+    const size_t dimension  = queries.dimension();
+
+    if ( numQueries && bruteForce.size() &&
+         ( dimension != bruteForce.dimension() ) )
+    {
+        cout << "evaluate_kdtree queries have cardinality = " << dimension
+             << " while points stored in the tree have "
+             << "cardinality = " << bruteForce.dimension()
+             << endl;
+        return 1;
+    }
+
+    vector< size_t > treeAnswers( numQueries );
+    vector< size_t > bruteAnswers( numQueries );
+    vector< size_t > batchAnswers;
+    KDHistogram      treeLatencies;
+    KDHistogram      bruteLatencies;
+
+    Clock::time_point start = Clock::now();
+    for ( size_t i = 0; i < numQueries; ++i )
+    {
+        const Clock::time_point queryStart = Clock::now();
+        treeAnswers[ i ] = tree.nearestPointIndex(
+                                   queries.data() + i * dimension,
+                                   dimension );
+        treeLatencies.record( chrono::duration_cast< chrono::nanoseconds >(
+                                      Clock::now() - queryStart ).count() );
+    }
+    const double treeSeconds = secondsSince( start );
+
+    start = Clock::now();
+    for ( size_t i = 0; i < numQueries; ++i )
+    {
+        const Clock::time_point queryStart = Clock::now();
+        bruteAnswers[ i ] = bruteForce.nearestPointIndex(
+                                    queries.data() + i * dimension,
+                                    dimension );
+        bruteLatencies.record( chrono::duration_cast< chrono::nanoseconds >(
+                                       Clock::now() - queryStart ).count() );
+    }
+    const double bruteSeconds = secondsSince( start );
+
+    start = Clock::now();
+    bruteForce.nearestPointIndexes( queries.data(), numQueries, dimension,
+                                    batchAnswers );
+    const double batchSeconds = secondsSince( start );
+
+    if ( batchAnswers != bruteAnswers )
+    {
+        cout << "evaluate_kdtree batched and single brute force answers "
+             << "differ"
+             << endl;
+        return 1;
+    }
+
+    for ( size_t i = 0; i < numQueries; ++i )
+    {
+        bruteAnswers[ i ] = tree.inputIndex( bruteAnswers[ i ] );
+    }
+
+    // A tree answer at the distance of the closest point is a hit, whether
+    // or not it is the same point. Misses are measured by how much farther
+    // they are than the closest point, unless the query is one of the
+    // points.
+    size_t numHits        = 0u;
+    size_t numSameIndexes = 0u;
+    size_t numMisses      = 0u;
+    size_t numRatios      = 0u;
+    double sumErrorRatio  = 0.0;
+    double maxErrorRatio  = 1.0;
+    for ( size_t i = 0; i < numQueries; ++i )
+    {
+        const KDPointView< float > query( queries.data() + i * dimension,
+                                          dimension );
+        const double treeDistance  = Utils::distance< float >(
+                                             query,
+                                             tree.pointAt( treeAnswers[ i ] ) );
+        const double bruteDistance = Utils::distance< float >(
+                                             query,
+                                             tree.pointAt(
+                                                     bruteAnswers[ i ] ) );
+
+        numSameIndexes += ( treeAnswers[ i ] == bruteAnswers[ i ] );
+        if ( treeDistance <= bruteDistance )
+        {
+            ++numHits;
+            continue;
+        }
+
+        ++numMisses;
+        if ( bruteDistance > 0.0 )
+        {
+            const double ratio = treeDistance / bruteDistance;
+            ++numRatios;
+            sumErrorRatio += ratio;
+            maxErrorRatio  = max( maxErrorRatio, ratio );
+        }
+    }
+
+    const double recall         = numQueries ?
+                                  double( numHits ) / numQueries : 1.0;
+    const double indexAgreement = numQueries ?
+                                  double( numSameIndexes ) / numQueries : 1.0;
+    const double meanErrorRatio = numRatios ?
+                                  sumErrorRatio / numRatios : 1.0;
+    const double speedup        = treeSeconds > 0.0 ?
+                                  bruteSeconds / treeSeconds : 0.0;
+    const double batchSpeedup   = batchSeconds > 0.0 ?
+                                  bruteSeconds / batchSeconds : 0.0;
+
+    cout << "Done" << endl;
+    cout << "    total number of queries    : " << numQueries << endl;
+    cout << "    recall at 1                : " << recall << endl;
+    cout << "    same index as brute force  : " << indexAgreement << endl;
+    cout << "    distance error ratio       : "
+         << "mean = " << meanErrorRatio << ", "
+         << "max = "  << maxErrorRatio  << " over "
+         << numMisses << " misses"
+         << endl;
+    cout << "    search timings (s)         : "
+         << "tree = "        << treeSeconds  << ", "
+         << "brute force = " << bruteSeconds << ", "
+         << "batched brute force = " << batchSeconds
+         << endl;
+    cout << "    tree speedup               : " << speedup << endl;
+    cout << "    batched brute force speedup: " << batchSpeedup << endl;
+    cout << "    tree latencies (ns)        : " << treeLatencies << endl;
+    cout << "    brute latencies (ns)       : " << bruteLatencies << endl;
+
+    if ( !jsonFilename.empty() )
+    {
+        fstream json;
+        json.open( jsonFilename, fstream::out | fstream::trunc );
+        json << "{\n"
+             << "  \"queries\": "         << numQueries     << ",\n"
+             << "  \"recall_at_1\": "     << recall         << ",\n"
+             << "  \"index_agreement\": " << indexAgreement << ",\n"
+             << "  \"distance_error_ratio\": { "
+             << "\"mean\": "   << meanErrorRatio << ", "
+             << "\"max\": "    << maxErrorRatio  << ", "
+             << "\"misses\": " << numMisses      << " },\n"
+             << "  \"search_seconds\": { "
+             << "\"tree\": "                << treeSeconds  << ", "
+             << "\"brute_force\": "         << bruteSeconds << ", "
+             << "\"batched_brute_force\": " << batchSeconds << " },\n"
+             << "  \"speedup\": "               << speedup      << ",\n"
+             << "  \"batched_brute_speedup\": " << batchSpeedup << ",\n"
+             << "  \"tree_latency_ns\": ";
+        treeLatencies.printJson( json ) << ",\n"
+             << "  \"brute_latency_ns\": ";
+        bruteLatencies.printJson( json ) << "\n"
+             << "}\n";
+        json.close();
+
+        if ( !json )
+        {
+            cout << "evaluate_kdtree is unable to write '"
+                      << jsonFilename << "'"
+                      << endl;
+            return 1;
+        }
+    }
+
+    return 0;
+}
@@ -1,17 +1,29 @@
+#include <chrono>
 #include <iostream>
 #include <fstream>
 #include <string>
+#include <vector>
 
 #include "kdtree.h"
+#include "kdtree_csv.h"
+#include "kdtree_histogram.h"
+#include "kdtree_server.h"
 
 using namespace std;
 using namespace datastructures;
 
 const string defaultResultsFilename = "results.csv";
+const string csvCacheFlag           = "--csv-cache";
+const string serveFlag              = "--serve";
+const string jsonFlag               = "--json";
+
+typedef chrono::steady_clock Clock;
 
 static void printHelp()
 {
-    cout << "Usage: query_kdtree tree_file query_file answers_file                      " << endl;
+    cout << "Usage: query_kdtree [--csv-cache] [--json json_file] tree_file query_file  " << endl;
+    cout << "                    answers_file                                           " << endl;
+    cout << "       query_kdtree --serve tree_file [socket_path]                        " << endl;
     cout << "                                                                           " << endl;
     cout << "    Where :                                                                " << endl;
     cout << "      tree_file          - path to file produced by successful             " << endl;
@@ -26,11 +38,31 @@ static void printHelp()
               << defaultResultsFilename << "'" << endl;
     cout << "                           Note that all contents of an existing file will " << endl;
     cout << "                           be erased.                                      " << endl;
+    cout << "                                                                           " << endl;
+    cout << "      --csv-cache        - optional, keeps a binary copy of the parsed     " << endl;
+    cout << "                           queries next to query_file and reuses it while  " << endl;
+    cout << "                           query_file is unchanged                         " << endl;
+    cout << "                                                                           " << endl;
+    cout << "      --json json_file   - optional, also writes query count, queries per  " << endl;
+    cout << "                           second, phase timings and latency percentiles   " << endl;
+    cout << "                           to json_file as a JSON object                   " << endl;
+    cout << "                                                                           " << endl;
+    cout << "      --serve            - loads tree_file once and answers batches of     " << endl;
+    cout << "                           queries, framed as described in                 " << endl;
+    cout << "                           kdtree_server.h, until stopped. Listens on the  " << endl;
+    cout << "                           Unix domain socket socket_path if provided, and " << endl;
+    cout << "                           reads stdin and writes stdout otherwise         " << endl;
+}
+
+static double secondsSince( const Clock::time_point& start )
+{
+    return chrono::duration< double >( Clock::now() - start ).count();
 }
 
-static bool validateInputs( int argc, char *argv[] )
+static bool validateInputs( const vector< string >& arguments,
+                            const bool              serve )
 {
-    if ( argc < 3 )
+    if ( arguments.size() < ( serve ? 2u : 3u ) )
     {
         return false;
     }
@@ -44,77 +76,140 @@ static bool validateInputs( int argc, char *argv[] )
 
 int main( int argc, char *argv[] )
 {
-    if ( !validateInputs( argc, argv ) )
+    // Flags may appear anywhere, the rest are positional
+    vector< string > arguments;
+    bool useCsvCache = false;
+    bool serve       = false;
+    string jsonFilename;
+    for ( int i = 0; i < argc; ++i )
+    {
+        if ( jsonFlag == argv[ i ] )
+        {
+            if ( i + 1 == argc )
+            {
+                printHelp();
+                return 1;
+            }
+            jsonFilename = argv[ ++i ];
+            continue;
+        }
+        if ( csvCacheFlag == argv[ i ] )
+        {
+            useCsvCache = true;
+            continue;
+        }
+        if ( serveFlag == argv[ i ] )
+        {
+            serve = true;
+            continue;
+        }
+        arguments.push_back( argv[ i ] );
+    }
+
+    if ( !validateInputs( arguments, serve ) )
     {
         printHelp();
         return 1;
     }
 
-    const string treeFileName = argv[ 1 ];
+    // Serving on stdout leaves it to the protocol alone
+    const bool serveStdio = serve && ( 2u == arguments.size() );
+    if ( serveStdio )
+    {
+        cout.rdbuf( cerr.rdbuf() );
+    }
+
+    const string treeFileName = arguments[ 1 ];
 
     KDTree< float > tree;
 
+    Clock::time_point start = Clock::now();
     if ( !tree.deserialize( treeFileName  ) )
     {
         printHelp();
         return 1;
     }
+    const double loadSeconds = secondsSince( start );
 
     cout << tree << endl;
 
-    const string queryFileName = argv[ 2 ];
+    if ( serve )
+    {
+        KDQueryServer< float > server( tree );
+        cout << server << endl;
+
+        if ( serveStdio )
+        {
+            return server.serve( 0, 1 ) ? 0 : 1;
+        }
+
+        if ( !server.listen( arguments[ 2 ] ) )
+        {
+            return 1;
+        }
+
+        cout << "Serving on '" << arguments[ 2 ] << "'" << endl;
+        server.run();
+        return 0;
+    }
 
-    ifstream queryData( queryFileName );
+    const string queryFileName = arguments[ 2 ];
 
-    if ( !queryData.is_open() )
+    KDCsvPoints< float > queries;
+    start = Clock::now();
+    if ( !queries.load( queryFileName, useCsvCache ) )
     {
-        cout << "query_kdtree is unable to open '"
-                  << queryFileName << "' for reading"
+        cout << "query_kdtree is unable to load '"
+                  << queryFileName << "'"
                   << endl;
         return 1;
     }
+    const double parseSeconds = secondsSince( start );
+    cout << queries << endl;
 
     string resultsFilename;
 
-    if ( 3 == argc )
+    if ( 3 == arguments.size() )
     {
         resultsFilename = defaultResultsFilename;
     }
     else
     {
-        resultsFilename = argv[ 3 ];
+        resultsFilename = arguments[ 3 ];
     }
 
-    fstream results;
-    results.open( resultsFilename, fstream::out | fstream::trunc );
+    // Answers are kept until the search is over, so that its timing and
+    // that of writing them out are told apart
+    vector< size_t > answers( queries.size() );
+    KDHistogram latencies;
 
+    start = Clock::now();
     int numQueriesProcessed = 0;
-    string line;
-    while ( getline ( queryData, line ) )
+    for ( size_t i = 0; i < queries.size(); ++i )
     {
-        Types::Point< float > queryPoint;
-
-        size_t pos = 0;
-
-        while ( true )
-        {
-            queryPoint.push_back( static_cast< float >( stof( line, &pos ) ) );
-
-            if ( line[ pos ] == ',')
-            {
-                line = line.substr( pos + 1u );
-            }
-            else
-            {
-                break;
-            }
-        }
-
-        results << tree.nearestPointIndex( queryPoint ) << '\n';
+        const Clock::time_point queryStart = Clock::now();
+        answers[ i ] = tree.nearestPointIndex(
+                               queries.data() + i * queries.dimension(),
+                               queries.dimension() );
+        latencies.record( chrono::duration_cast< chrono::nanoseconds >(
+                                  Clock::now() - queryStart ).count() );
         ++numQueriesProcessed;
     }
+    const double searchSeconds = secondsSince( start );
 
+    start = Clock::now();
+    fstream results;
+    results.open( resultsFilename, fstream::out | fstream::trunc );
+    for ( size_t i = 0; i < answers.size(); ++i )
+    {
+        results << answers[ i ] << '\n';
+    }
     results.close();
+    const double writeSeconds = secondsSince( start );
+
+    const double queriesPerSecond = searchSeconds > 0.0 ?
+                                    numQueriesProcessed / searchSeconds :
+                                    0.0;
 
     cout << "Done" << endl;
     cout << "    total number of queries : "
@@ -124,6 +219,44 @@ int main( int argc, char *argv[] )
               << resultsFilename
               << "'"
               << endl;
+    cout << "    queries per second      : "
+              << queriesPerSecond
+              << endl;
+    cout << "    phase timings (s)       : "
+              << "load = "     << loadSeconds   << ", "
+              << "parse = "    << parseSeconds  << ", "
+              << "search = "   << searchSeconds << ", "
+              << "write = "    << writeSeconds
+              << endl;
+    cout << "    latencies (ns)          : "
+              << latencies
+              << endl;
+
+    if ( !jsonFilename.empty() )
+    {
+        fstream json;
+        json.open( jsonFilename, fstream::out | fstream::trunc );
+        json << "{\n"
+             << "  \"queries\": "            << numQueriesProcessed << ",\n"
+             << "  \"queries_per_second\": " << queriesPerSecond    << ",\n"
+             << "  \"phase_seconds\": { "
+             << "\"load\": "   << loadSeconds   << ", "
+             << "\"parse\": "  << parseSeconds  << ", "
+             << "\"search\": " << searchSeconds << ", "
+             << "\"write\": "  << writeSeconds  << " },\n"
+             << "  \"latency_ns\": ";
+        latencies.printJson( json ) << "\n"
+             << "}\n";
+        json.close();
+
+        if ( !json )
+        {
+            cout << "query_kdtree is unable to write '"
+                      << jsonFilename << "'"
+                      << endl;
+            return 1;
+        }
+    }
 
     return 0;
 }
\ No newline at end of file
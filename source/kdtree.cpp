@@ -1,5 +1,5 @@
-#include "kdtree.h"
-
-namespace datastructures {
-
-} // namespace datastructures
+#include "kdtree.h"
+
+namespace datastructures {
+
+} // namespace datastructures
@@ -1,758 +1,3881 @@
-#ifndef KDTREE_H
-#define KDTREE_H
-
-#include <iostream>
-#include <fstream>
-
-#include "kdtree_types.h"
-#include "kdtree_node.h"
-#include "kdtree_hyperplane.h"
-#include "kdtree_utils.h"
-#include "kdtree_constants.h"
-
-// @Purpose
-//
-// This is base class for a simple KDTree datastructure implementation
-//
-// Please note that it is capable of performing both nearest point lookup
-// from the original list as well as looking up the *index* of the nearest
-// point from the original list.
-//
-// Override chooseBestSplit() in order to implement a different heuristic
-// of splitting a set of n-dimensional points with a KDHyperplane object
-//
-// Overriding child classes must also provide a clear textual description
-// of the new type. This is dictated by the rather simplistic implementation
-// of operator<<(). Not providing an override for this value will lead to
-// many hours with a debugger!
-//
-// Note that baseline implementation is defined by
-// Constants::KDTREE_SIMPLE_VARIETY
-//
-
-namespace datastructures {
-
-template< typename T >
-class KDTree {
-public:
-
-    KDTree();
-        // default ctor
-
-    KDTree( const KDTree< T >& other );
-        // Copy constructor, copies the pointer contained in other, not the
-        // bisection
-        // Calls build() helper
-
-    KDTree( const Types::Points< T >& points );
-        // Constructor, throws in case points are of different length
-        // Calls build() helper
-
-    virtual ~KDTree();
-        // default dtor
-
-    // OPERATORS
-    KDTree& operator=( const KDTree< T >& other );
-        // Assignment operator. Calls copy; do this in child classes
-        // when overloaded.
-        // Note that this operator will copy the the points contained within
-        // the provided tree, yet will build its own bisecting structure of the
-        // space using own chooseBestSplit() implementation
-        // Calls build() helper
-
-    bool operator==( const KDTree< T >& other ) const;
-        // Equality. Calls equals, do this in child classes
-        // when overloaded.
-        // Calls build() helper
-
-    bool operator!=( const KDTree< T >& other ) const;
-        // Non-equality.  Calls equals, do this in child classes
-        // when overloaded.
-
-    // PRIMARY INTERFACE
-    bool serialize( const std::string& filename ) const;
-        // Writes the tree to the provided file location.
-        // Returns true on success and false otherwise.
-
-    bool deserialize( const std::string& filename );
-        // Loads the contents of the data via the contents of the file
-        // Returns true on success and false otherwise.
-
-    const Types::Point< T > nearestPoint(
-            const Types::Point< T >& pointOfInterest ) const;
-        // Returns const ref the closes point in a tree to the point of interest.
-        // In case the tree is empty or there is a cardinality mismatch -
-        // empty point is returned
-        // Calls nearestPointIndexHelper()
-
-    size_t nearestPointIndex( const Types::Point< T >& pointOfInterest ) const;
-        // Returns index closes point in a tree to the point of interest.
-        // In case the tree is empty or there is a cardinality mismatch -
-        // KDTREE_ERROR_INDEX is returned
-        // Calls nearestPointIndexHelper()
-
-    const Types::Points< T > points() const;
-        // Returns the set of points represented by this KDTree. Used
-        // primarily for testing.
-
-    const std::string& type() const;
-        // Returns type of this KDTree object
-
-    // MANIPULATORS
-    void copy( const KDTree& other );
-        // Copies the value of other into this
-
-    // ACCESSORS
-    bool equals( const KDTree& other ) const;
-        // Worker for equality - call this in child classes when overloading
-        // == and != operator
-
-    std::ostream& print( std::ostream& out ) const;
-        // Prints the contents of the KDTree object in a easy to read
-        // format
-
-protected:
-    virtual const KDHyperplane< T > chooseBestSplit(
-            const Types::Indexes& indexes ) const;
-        // To be overloaded by children when extending the vanilla KDTree
-        // Serves as a heuristics in determining optimal hyperplane to split the
-        // provided points as defined by the index array into m_points variable.
-
-private:
-    void buildWrapper();
-        // Simple helper function that is invoked once the tree is ready to
-        // be build. Calls build();
-
-    std::shared_ptr< KDNode< T > > build( const Types::Indexes& indexes );
-        // Function that builds the recursive bisection of the tree, as
-        // described by the assignment specification. Calls chooseBestSplit()
-        // at each level of recursion until leaf nodes is reached.
-
-    const size_t nearestPointIndexHelper(
-            std::shared_ptr< KDNode< T > > root,
-            const Types::Point< T >&       pointOfInterest,
-            const size_t                   bestSoFarIndex ) const;
-        // A recursive helper function, finds the closes point in to the
-        // point of interest
-
-    void serializeHelper( std::fstream&                   fileStream,
-                          std::shared_ptr< KDNode< T > >  root ) const;
-        // A recursive helper function, writes the KD tree structure to
-        // provided file stream. This function expects a valid file
-        // stream to function properly.
-
-    std::shared_ptr< KDNode< T > > deserializeHelper(
-                          std::ifstream& fileStream );
-        // A recursive helper function, writes the KD tree structure to
-        // provided file stream. This function expects a valid file
-        // stream to function properly.
-
-    // The following allows creating of derived classes for test purposes
-    // while not exposing the vital components in productions classes
-protected:
-    std::shared_ptr< KDNode< T > >     m_root;
-        // Root node of this KD Tree
-
-    Types::Points< T >                 m_points;
-        // Points that the tree is built on
-
-private:
-
-    std::string                        m_type;
-        // Type of the KDTree. Used primarily for debugging/logs
-};
-
-// INDEPENDENT OPERATORS
-template< typename T >
-std::ostream& operator<<( std::ostream& lhs,
-                          const KDTree< T >& rhs );
-
-//============================================================================
-//                  CREATORS
-//============================================================================
-
-template< typename T >
-KDTree< T >::KDTree()
-: m_type( Constants::KDTREE_SIMPLE_VARIETY )
-{
-    // nothing to do here
-}
-
-template< typename T >
-KDTree< T >::KDTree( const Types::Points< T >& points )
-: m_points( points )
-, m_type( Constants::KDTREE_SIMPLE_VARIETY )
-{
-    buildWrapper();
-}
-
-template< typename T >
-KDTree< T >::KDTree( const KDTree& other )
-: m_type( Constants::KDTREE_SIMPLE_VARIETY )
-{
-    copy( other );
-}
-
-template< typename T >
-KDTree< T >::~KDTree()
-{
-    // nothing to do here
-}
-
-//============================================================================
-//                  OPERATORS
-//============================================================================
-
-template< typename T >
-KDTree< T >&
-KDTree< T >::operator=( const KDTree< T >& other )
-{
-    copy( other );
-    return *this;
-}
-
-template< typename T >
-bool
-KDTree< T >::operator==( const KDTree< T >& other ) const
-{
-    return equals( other );
-}
-
-template< typename T >
-bool KDTree< T >::operator!=(
-        const KDTree< T >& other ) const
-{
-    return !equals( other );
-}
-
-//============================================================================
-//                  PRIMARY INTERFACE
-//============================================================================
-template< typename T >
-bool
-KDTree< T >::serialize( const std::string& filename ) const
-{
-    std::fstream serializedData;
-    serializedData.open( filename, std::fstream::out | std::fstream::trunc );
-
-    if ( !serializedData.is_open() )
-    {
-        std::cerr << "KDTree:serialize() is unable to open "
-                  << "'" << filename << "' for writing"
-                  << std::endl;
-        return false;
-    }
-
-    // First serialize tree type
-    serializedData << m_type << '\n';
-
-    // Second serialize number of lines
-    serializedData << m_points.size() << '\n';
-
-    // Third all the points
-    for ( size_t i = 0; i < m_points.size(); ++i )
-    {
-        const Types::Point< T >& point = m_points[ i ];
-        serializedData << point[ 0 ];
-
-        for ( size_t j = 1; j < point.size(); ++j )
-        {
-            serializedData << ',' << point[ j ];
-        }
-
-        serializedData << '\n';
-    }
-
-    // Fourth serialize tree structure in postorder
-    serializeHelper( serializedData, m_root );
-
-    serializedData.close();
-
-    return true;
-}
-
-template< typename T >
-void
-KDTree< T >::serializeHelper( std::fstream&                  fileStream,
-                              std::shared_ptr< KDNode< T > > root ) const
-{
-    // Handle special case of an empty tree
-    if ( nullptr == root )
-    {
-        fileStream << Constants::KDTREE_EMPTY_MARKER << '\n';
-        return;
-    }
-
-    // Handle hyperplane and leaf nodes differently
-    if ( root->isLeaf() )
-    {
-        fileStream << Constants::KDTREE_LEAF_MARKER << '\n';
-        fileStream << root->leafPointIndex()        << '\n';
-        return;
-    }
-
-    fileStream << Constants::KDTREE_HYPERPLANE_MARKER << '\n';
-    fileStream << root->hyperplane().serialize() << '\n';
-
-    // Then store children
-    if ( nullptr != root->left() )
-    {
-        serializeHelper( fileStream, root->left() );
-    }
-    if ( nullptr != root->right() )
-    {
-        serializeHelper( fileStream, root->right() );
-    }
-}
-
-template< typename T >
-bool
-KDTree< T >::deserialize( const std::string& filename )
-{
-    std::ifstream treeData( filename );
-
-    if ( !treeData.is_open() )
-    {
-        std::cerr << "KDTree< T >::serialize() is unable to open "
-                  << "'" << filename << "' for reading"
-                  << std::endl;
-        return false;
-    }
-
-    size_t pos;
-    std::string line;
-
-    // First check tree type
-    getline ( treeData, line );
-
-    if ( line != m_type )
-    {
-        std::cerr << "Tree type mismatch encountered in"
-                  << "KDTree::deserialize() "
-                  << "expected    : '" << m_type << "', "
-                  << "encountered : '" << line   << "'"
-                  << std::endl;
-                  return false;
-    }
-
-    // First deserialize number of lines
-    getline ( treeData, line );
-    int numOfPoints;
-
-    try
-    {
-        numOfPoints = std::stoi( line );
-    }
-    catch ( std::exception e )
-    {
-        std::cerr << "Exception encountered during num tree points parsing in"
-                 << "KDTree::deserialize() "
-                 << "line : '" << line << "', "
-                 << "what : '" << e.what() << "'"
-                 << std::endl;
-                 return false;
-    }
-    catch ( ... )
-    {
-        std::cerr << "Unknown exception encountered during num tree points "
-                  << "parsing in KDTree::deserialize() "
-                  << "line : '" << line << "'"
-                  << std::endl;
-                  return false;
-    }
-
-    // Second all the points
-    Types::Points< T > points;
-    points.reserve( numOfPoints );
-    for ( int i = 0; i < numOfPoints; ++i )
-    {
-        Types::Point< T > point;
-        getline ( treeData, line );
-
-        while ( true )
-        {
-            try
-            {
-                point.push_back( static_cast< T >( stof( line, &pos ) ) );
-            }
-            catch ( std::exception e )
-            {
-                std::cerr << "Exception encountered during tree point parsing in"
-                          << "KDTree::deserialize() "
-                          << "line : '" << line << "', "
-                          << "what : '" << e.what() << "'"
-                          << std::endl;
-                          return false;
-            }
-            catch ( ... )
-            {
-                std::cerr << "Unknown exception encountered during tree point "
-                          << "parsing in KDTree::deserialize() "
-                          << "line : '" << line << "'"
-                          << std::endl;
-                return false;
-            }
-
-            if ( line[ pos ] == ',')
-            {
-                line = line.substr( pos + 1u );
-            }
-            else
-            {
-                break;
-            }
-        }
-
-        points.push_back( point );
-    }
-    m_points = points;
-
-    std::cout << "deserialization begins" << std::endl;
-
-    // Third tree structure from postorder
-    m_root = deserializeHelper( treeData );
-
-    treeData.close();
-
-    return true;
-}
-
-template< typename T >
-std::shared_ptr< KDNode< T > >
-KDTree< T >::deserializeHelper( std::ifstream& fileStream )
-{
-    // Inspect node type first
-    std::string line;
-    getline ( fileStream, line );
-
-    // Handle empty tree special case
-    if ( Constants::KDTREE_EMPTY_MARKER == line )
-    {
-        return nullptr;
-    }
-
-    // Handle Leaf type
-    if ( Constants::KDTREE_LEAF_MARKER == line )
-    {
-        getline ( fileStream, line );
-        int index;
-        try
-        {
-            index = std::stoi( line );
-        }
-        catch ( std::exception e )
-        {
-            std::cerr << "Exception encountered during leaf index parsing in"
-                      << "KDTree::deserializeHelper()"
-                      << "line : '" << line << "', "
-                      << "what : '" << e.what() << "'"
-                      << std::endl;
-            return nullptr;
-        }
-        catch ( ... )
-        {
-            std::cerr << "Unknown exception encountered during leaf index "
-                      << "parsing in KDTree::deserializeHelper()"
-                      << "line : '" << line << "'"
-                      << std::endl;
-            return nullptr;
-        }
-
-        return std::shared_ptr< KDNode< T > >(
-                new KDNode< T >( static_cast< size_t >( index ) ) );
-    }
-
-    // Handle Hyperplane type
-    if ( Constants::KDTREE_HYPERPLANE_MARKER == line )
-    {
-        // Then load the hyperplane
-        getline( fileStream, line );
-        KDHyperplane< T > hyperplane;
-        hyperplane.deserialize( line );
-
-        // Then load children
-        std::shared_ptr <KDNode< T > > left = deserializeHelper( fileStream );
-        std::shared_ptr <KDNode< T > > right = deserializeHelper( fileStream );
-
-        return std::shared_ptr< KDNode< T > >( new KDNode< T >( hyperplane,
-                                                                left,
-                                                                right ) );
-    }
-
-    std::cerr << "Unxpected line encountered during"
-              << "parsing in KDTree::deserializeHelper()"
-              << "line : '" << line << "'"
-              << std::endl;
-
-    return nullptr;
-}
-
-template< typename T >
-const Types::Point< T >
-KDTree< T >::nearestPoint( const Types::Point< T >& pointOfInterest ) const
-{
-    const size_t index = nearestPointIndex( pointOfInterest );
-    if ( Constants::KDTREE_ERROR_INDEX == index )
-    {
-        return Types::Point< T >();
-    }
-
-    return m_points[ index ];
-}
-
-template< typename T >
-size_t
-KDTree< T >::nearestPointIndex(
-        const Types::Point< T >& pointOfInterest ) const
-{
-    return nearestPointIndexHelper( m_root,
-                                    pointOfInterest,
-                                    Constants::KDTREE_ERROR_INDEX );
-}
-
-template< typename T >
-const Types::Points< T >
-KDTree< T >::points() const
-{
-    return m_points;
-}
-
-template< typename T >
-const std::string&
-KDTree< T >::type() const
-{
-    return m_type;
-}
-
-template< typename T >
-const KDHyperplane< T >
-KDTree< T >::chooseBestSplit( const Types::Indexes& indexes ) const
-{
-    Types::Points< T > tempPoints;
-    tempPoints.reserve( indexes.size() );
-
-    for ( typename Types::Indexes::const_iterator it = indexes.cbegin();
-          it != indexes.cend(); ++it )
-    {
-        tempPoints.push_back( m_points[ ( *it ) ] );
-    }
-
-    const size_t axis  = Utils::axisOfHighestVariance( tempPoints );
-    const T      value = Utils::medianValueInAxis( tempPoints, axis );
-
-    return KDHyperplane< T >( axis, value );
-}
-
-template< typename T >
-void
-KDTree< T >::buildWrapper()
-{
-    Types::Indexes globalIndexes;
-    globalIndexes.reserve( m_points.size() );
-    for ( size_t i = 0; i < m_points.size(); ++i )
-    {
-        globalIndexes.push_back( i );
-    }
-
-    m_root = build( globalIndexes );
-}
-
-template< typename T >
-std::shared_ptr< KDNode< T > >
-KDTree< T >::build( const Types::Indexes& indexes )
-{
-    // Sanity
-    if ( !indexes.size() )
-    {
-        std::cerr << "KDTree< T >::build() points container is empty"
-                  << std::endl;
-        return std::shared_ptr< KDNode< T > >( nullptr );
-    }
-
-    // Base Case
-    if ( indexes.size() == 1u )
-    {
-        // Make a leaf node
-        typename Types::Indexes::const_iterator it = indexes.cbegin();
-        return std::shared_ptr< KDNode< T > >(
-                new KDNode< T >( ( *it ) ) );
-    }
-
-    // Recursive case
-    const KDHyperplane< T > hyperplane = chooseBestSplit( indexes );
-
-    Types::Indexes leftIndexes;
-    Types::Indexes rightIndexes;
-
-    for ( typename Types::Indexes::const_iterator it = indexes.cbegin();
-          it != indexes.cend(); ++it )
-    {
-        Types::Point< T > point = m_points[ (*it) ];
-
-        if ( point[ hyperplane.hyperplaneIndex() ] < hyperplane.value() )
-        {
-            leftIndexes.push_back( *it );
-        }
-        else
-        {
-            rightIndexes.push_back( *it );
-        }
-    }
-
-    std::shared_ptr< KDNode< T > > leftSubtree(  build( leftIndexes  ) );
-    std::shared_ptr< KDNode< T > > rightSubtree( build( rightIndexes ) );
-
-    return std::shared_ptr< KDNode< T > >( new KDNode< T >( hyperplane,
-                                                            leftSubtree,
-                                                            rightSubtree ) );
-}
-
-template< typename T >
-const size_t
-KDTree< T >::nearestPointIndexHelper(
-        std::shared_ptr< KDNode< T > > root,
-        const Types::Point< T >&       pointOfInterest,
-        const size_t                   bestSoFarIndex ) const
-{
-    // Base case
-    if ( nullptr == root )
-    {
-        return Constants::KDTREE_ERROR_INDEX;
-    }
-
-    if ( root->isLeaf() )
-    {
-        // Sanity
-        if ( Constants::KDTREE_ERROR_INDEX == root->leafPointIndex() )
-        {
-            std::cerr << "Internal logic error, root " << root << " must not "
-                      << "have Constants::KDTREE_ERROR_INDEX index"
-                      << std::endl;
-            return root->leafPointIndex();
-        }
-
-        // Initial greedy search
-        if ( Constants::KDTREE_ERROR_INDEX == bestSoFarIndex )
-        {
-            return root->leafPointIndex();
-        }
-
-        const Types::Point< T >& leafPoint =
-                m_points[ root->leafPointIndex() ];
-
-        const double distance = Utils::distance< T >( leafPoint,
-                                                      pointOfInterest );
-
-        if ( Constants::KDTREE_INVALID_DISTANCE == distance )
-        {
-            std::cerr << "Point cardinality mismatch. Point of interest has"
-                      << "cardinality = " << pointOfInterest.size() << " "
-                      << "while points stored in the tree have "
-                      << "cardinality = " << leafPoint << " "
-                      << std::endl;
-            return Constants::KDTREE_ERROR_INDEX;
-        }
-
-        if ( distance < Utils::distance< T >( m_points[ bestSoFarIndex ],
-                                              pointOfInterest ) )
-        {
-            return root->leafPointIndex();
-        }
-        else
-        {
-            return bestSoFarIndex;
-        }
-    }
-
-    // Sanity
-    if ( pointOfInterest.size() <= root->hyperplane().hyperplaneIndex() )
-    {
-        std::cerr << "Point cardinality mismatch. Point of interest has"
-                  << "cardinality = " << pointOfInterest.size() << " "
-                  << "while points stored in the tree have "
-                  << "cardinality of at least = "
-                  << root->hyperplane().hyperplaneIndex() << " "
-                  << std::endl;
-        return Constants::KDTREE_ERROR_INDEX;
-    }
-
-    // Recursive case
-    std::shared_ptr< KDNode< T > > greedy;
-    std::shared_ptr< KDNode< T > > other;
-
-    if ( pointOfInterest[ root->hyperplane().hyperplaneIndex() ] <
-                root->hyperplane().value() )
-    {
-        greedy = root->left();
-        other = root->right();
-    }
-    else
-    {
-        greedy = root->right();
-        other = root->left();
-    }
-
-    // First search greedily
-    const size_t greedyBestIndex = nearestPointIndexHelper( greedy,
-                                                            pointOfInterest,
-                                                            bestSoFarIndex );
-    // If the distance to the greedy best is bigger than distance to the
-    // hyperplane at this node, search the other partition as well
-    if ( Utils::distance< T >( pointOfInterest, root->hyperplane() ) <
-         Utils::distance< T >( pointOfInterest, m_points[ greedyBestIndex ] ) )
-    {
-        return nearestPointIndexHelper( other,
-                                        pointOfInterest,
-                                        greedyBestIndex );
-    }
-
-    return greedyBestIndex;
-}
-
-//============================================================================
-//                  MANIPULATORS
-//============================================================================
-
-template< typename T >
-void
-KDTree< T >::copy( const KDTree< T >& other )
-{
-    m_points = other.points();
-    buildWrapper();
-}
-
-//============================================================================
-//                  ACCESSORS
-//============================================================================
-
-template< typename T >
-bool
-KDTree< T >::equals( const KDTree< T >& other ) const
-{
-    return ( ( other.type()    == m_type   ) &&
-             ( other.points()  == m_points ) );
-}
-
-template< typename T >
-std::ostream&
-KDTree< T >::print( std::ostream& out ) const
-{
-    out << "KDTree:[ "
-        << "implementation type = '" << m_type          << "', "
-        << "num points stored = "    << m_points.size() << " ] ";
-
-    return out;
-}
-
-//============================================================================
-//                  INDEPENDENT OPERATORS
-//============================================================================
-template< typename T >
-std::ostream& operator<<( std::ostream& lhs, const KDTree< T >& rhs )
-{
-    return rhs.print( lhs );
-}
-
-} // namespace datastructures
-
-#endif // KDTREE_H
+#ifndef KDTREE_H
+#define KDTREE_H
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "kdtree_types.h"
+#include "kdtree_point_view.h"
+#include "kdtree_node.h"
+#include "kdtree_hyperplane.h"
+#include "kdtree_utils.h"
+#include "kdtree_constants.h"
+#include "kdtree_options.h"
+#include "kdtree_arena.h"
+#include "kdtree_quantized.h"
+#include "kdtree_morton.h"
+#include "kdtree_codec.h"
+#include "kdtree_file.h"
+#include "kdtree_profile.h"
+
+// @Purpose
+//
+// This is base class for a simple KDTree datastructure implementation
+//
+// Please note that it is capable of performing both nearest point lookup
+// from the original list as well as looking up the *index* of the nearest
+// point from the original list.
+//
+// Override chooseBestSplit() in order to implement a different heuristic
+// of splitting a set of n-dimensional points with a KDHyperplane object
+//
+// Overriding child classes must also provide a clear textual description
+// of the new type via the protected KDTree( type ) constructor. This is
+// dictated by the rather simplistic implementation of operator<<(), and
+// copy()/transfer() rely on it to decide whether the bisecting structure of
+// another tree can be reused. Not providing an override for this value will
+// lead to many hours with a debugger!
+//
+// Note that baseline implementation is defined by
+// Constants::KDTREE_SIMPLE_VARIETY
+//
+// Template parameters:
+//
+//   T - coordinate type of the stored points
+//   I - type of leaf point indexes and split axes, e.g. uint32_t for trees
+//       of fewer than 4 billion points; halves the size of index
+//       containers and takes a third off the size of nodes
+//   A - allocator for coordinates, rebound for points, index containers
+//       and nodes. Must be default constructible.
+//
+
+namespace datastructures {
+
+template< typename T,
+          typename I = size_t,
+          typename A = std::allocator< T > >
+class KDTree {
+public:
+    // TYPES
+    typedef KDNode< T, I, A >                           Node;
+        // Node type of this tree
+
+    typedef std::shared_ptr< Node >                     NodePtr;
+        // Pointer to an immutable (sub)tree
+
+    typedef typename std::allocator_traits< A >::template
+            rebind_alloc< I >                           IndexAllocator;
+        // Allocator for leaf index containers
+
+    typedef typename Node::Allocator                    NodeAllocator;
+        // Allocator for tree nodes
+
+    typedef Types::BasicIndexes< I, IndexAllocator >    IndexContainer;
+        // Container of point indexes of width I
+
+    typedef Types::BasicPoints< T, A >                  StoredPoints;
+        // Container of points owned by this tree
+
+    typedef KDPointsView< T, A >                        PointsView;
+        // View of points represented by this tree
+
+    typedef KDNodeArena< Node, NodeAllocator >          NodeArena;
+        // Node storage used in KDTreeOptions::ARENA_NODES mode
+
+    enum DeserializeStatus {
+        DESERIALIZE_SUCCESS,
+            // The tree was loaded
+        DESERIALIZE_OPEN_FAILED,
+            // The file could not be opened or read
+        DESERIALIZE_TYPE_MISMATCH,
+            // The file holds a tree of another type
+        DESERIALIZE_MALFORMED_COUNT,
+            // The number of points is missing or malformed
+        DESERIALIZE_MALFORMED_POINTS,
+            // A point is missing, malformed or of another cardinality
+        DESERIALIZE_MALFORMED_NODE,
+            // A node marker, split or leaf index is malformed or out of
+            // range
+        DESERIALIZE_MALFORMED_STRUCTURE,
+            // A split lacks one of its two children, or the number of nodes
+            // does not match the number of points
+        DESERIALIZE_MALFORMED_TRAILER,
+            // Unexpected lines follow the tree structure
+        DESERIALIZE_MALFORMED_COMPACT,
+            // A KDTreeOptions::COMPACT_FORMAT file was rejected
+
+        DESERIALIZE_MALFORMED_CHUNKED
+            // A KDTreeOptions::CHUNKED_FORMAT file was rejected
+    };
+
+    // CREATORS
+    KDTree();
+        // default ctor
+
+    explicit KDTree( const KDTreeOptions& options );
+        // Constructor, creates an empty tree which will use the provided
+        // options once deserialized
+
+    KDTree( const KDTree& other );
+        // Copy constructor, calls copy()
+
+    KDTree( KDTree&& other ) noexcept;
+        // Move constructor, calls transfer(). Never throws when other is
+        // of the same type(), as the structure is taken over as-is.
+
+    KDTree( const StoredPoints&  points,
+            const KDTreeOptions& options = KDTreeOptions() );
+        // Constructor, throws in case points are of different length
+        // Calls build() helper
+
+    KDTree( StoredPoints&&       points,
+            const KDTreeOptions& options = KDTreeOptions() );
+        // Constructor, takes ownership of the provided points instead of
+        // copying them.
+        // Calls build() helper
+
+    KDTree( const T*             data,
+            const size_t         count,
+            const size_t         dimension,
+            const size_t         stride,
+            const KDTreeOptions& options = KDTreeOptions() );
+        // Non-owning constructor, indexes count points of the provided
+        // dimension that live in a caller-owned flat buffer, point i
+        // starting at data + i * stride. Note that stride is expressed in
+        // elements of T and must not be smaller than dimension.
+        // The tree stores only its bisecting structure; the caller must
+        // guarantee that the buffer outlives the tree and all its copies.
+        // Calls build() helper
+
+    virtual ~KDTree();
+        // default dtor
+
+    // OPERATORS
+    KDTree& operator=( const KDTree& other );
+        // Assignment operator. Calls copy; do this in child classes
+        // when overloaded.
+
+    KDTree& operator=( KDTree&& other ) noexcept;
+        // Move assignment operator. Calls transfer; do this in child classes
+        // when overloaded. Never throws when other is of the same type().
+
+    bool operator==( const KDTree& other ) const;
+        // Equality. Calls equals, do this in child classes
+        // when overloaded.
+        // Calls build() helper
+
+    bool operator!=( const KDTree& other ) const;
+        // Non-equality.  Calls equals, do this in child classes
+        // when overloaded.
+
+    // PRIMARY INTERFACE
+    bool serialize( const std::string& filename ) const;
+        // Writes the tree to the provided file location, in the format
+        // prescribed by the options.
+        // Returns true on success and false otherwise.
+
+    bool deserialize( const std::string& filename );
+        // Loads the contents of the data via the contents of the file,
+        // written in either format
+        // Returns true on success and false otherwise.
+        // Calls deserializeWithStatus()
+
+    DeserializeStatus deserializeWithStatus( const std::string& filename );
+        // Loads the contents of the data via the contents of the file,
+        // written in either format. Text files are read in one go and their
+        // structure is rebuilt without recursion, so that load time is
+        // proportional to file size whatever the depth of the tree.
+        // Returns DESERIALIZE_SUCCESS on success. On failure the tree is
+        // left as it was and the status tells what was wrong.
+
+    const Types::Point< T > nearestPoint(
+            const Types::Point< T >& pointOfInterest ) const;
+        // Returns a copy of the closes point in a tree to the point of
+        // interest. In case the tree is empty or there is a cardinality
+        // mismatch - empty point is returned
+        // Calls nearestPointView(), use it directly to avoid the copy
+
+    size_t nearestPointIndex( const Types::Point< T >& pointOfInterest ) const;
+        // Returns index closes point in a tree to the point of interest.
+        // In case the tree is empty or there is a cardinality mismatch -
+        // KDTREE_ERROR_INDEX is returned
+        // Calls nearestPointIndexWrapper()
+
+    size_t nearestPointIndex( const T*     pointOfInterest,
+                              const size_t dimension ) const;
+        // Same as above, reads dimension coordinates of the point of
+        // interest straight from the caller's buffer
+
+    KDPointView< T > nearestPointView(
+            const Types::Point< T >& pointOfInterest ) const;
+        // Returns a view of the closest point in a tree to the point of
+        // interest. The view refers to storage owned by this tree and is
+        // valid until the tree is modified or destroyed.
+        // In case the tree is empty or there is a cardinality mismatch -
+        // empty view is returned
+
+    KDPointView< T > nearestPointView( const T*     pointOfInterest,
+                                       const size_t dimension ) const;
+        // Same as above, reads dimension coordinates of the point of
+        // interest straight from the caller's buffer
+
+    KDPointView< T > pointAt( const size_t index ) const;
+        // Returns a view of the point stored under the provided index, as
+        // returned by nearestPointIndex(). Returns empty view in case the
+        // index is out of range.
+
+    PointsView pointsView() const;
+        // Returns a view of the set of points represented by this KDTree,
+        // in storage order. Storage order differs from the input order with
+        // KDTreeOptions::LEAF_ORDER, use pointAt() for input order access.
+        // Valid until the tree is modified or destroyed.
+
+    const Types::Points< T > points() const;
+        // Returns a copy of the set of points represented by this KDTree,
+        // in input order.
+        // Used primarily for testing, prefer pointsView() elsewhere.
+
+    bool ownsPoints() const;
+        // Returns false if the tree was built over a caller-owned buffer,
+        // and true otherwise
+
+    const std::string& type() const;
+        // Returns type of this KDTree object. The plain KDTree records its
+        // split policy in the type, unless it is the default one.
+
+    const KDTreeOptions& options() const;
+        // Returns options this KDTree object was built with
+
+    NodePtr root() const;
+        // Returns root of the bisecting structure, nullptr for an empty
+        // tree. Leaf point indexes are indexes into the point storage, see
+        // pointsView() and inputIndex().
+
+    size_t inputIndex( const size_t storageIndex ) const;
+        // Maps index into the point storage to the input order index
+
+    const KDBuildProfile& buildProfile() const;
+        // Returns time spent in every phase of building the structure, if
+        // KDTreeOptions::profileBuild was set. Empty otherwise, and for a
+        // deserialized structure.
+
+    // MANIPULATORS
+    void copy( const KDTree& other );
+        // Copies the value of other into this.
+        // Note that the bisecting structure of the space is immutable once
+        // built, so it is shared with other rather than rebuilt, unless the
+        // two trees are of different type() - i.e. use different
+        // chooseBestSplit() implementations. In the latter case this tree
+        // builds its own structure on the copied points, keeping its own
+        // builder and split policy so that its chooseBestSplit() is used.
+
+    void transfer( KDTree& other ) noexcept;
+        // Moves the value of other into this, leaving other empty.
+        // Follows the same type() rule as copy(): the bisecting structure
+        // of other is taken over as-is unless the types differ. Note that
+        // running out of memory while rebuilding for a different type
+        // terminates the program.
+
+    // ACCESSORS
+    bool equals( const KDTree& other ) const;
+        // Worker for equality - call this in child classes when overloading
+        // == and != operator
+
+    std::ostream& print( std::ostream& out ) const;
+        // Prints the contents of the KDTree object in a easy to read
+        // format
+
+protected:
+    explicit KDTree( const std::string& type );
+        // Constructor for child classes, sets the textual description
+        // of the new type
+
+    virtual const KDHyperplane< T > chooseBestSplit(
+            const IndexContainer& indexes ) const;
+        // To be overloaded by children when extending the vanilla KDTree
+        // Serves as a heuristics in determining optimal hyperplane to split the
+        // provided points as defined by the index array into the stored
+        // points.
+
+private:
+    void buildWrapper();
+        // Simple helper function that is invoked once the tree is ready to
+        // be build. Calls build();
+
+    NodePtr build( const IndexContainer& indexes );
+        // Function that builds the recursive bisection of the tree, as
+        // described by the assignment specification. Calls chooseSplit()
+        // at each level of recursion until leaf nodes is reached.
+
+    NodePtr build( const IndexContainer&         indexes,
+                   const Types::AxisMinMax< T >& cell,
+                   const size_t                  depth );
+        // Recursive worker of the above. cell is the region of the node,
+        // tracked for KDTreeOptions::SLIDING_MIDPOINT only.
+
+    const KDHyperplane< T > chooseSplit( const IndexContainer&         indexes,
+                                         const Types::AxisMinMax< T >& cell,
+                                         const size_t                  depth )
+                                                                        const;
+        // Chooses the hyperplane for the provided points according to the
+        // split policy, from a sample of them when there are more than
+        // KDTreeOptions::splitSampleThreshold. Calls policySplit().
+
+    const KDHyperplane< T > policySplit( const IndexContainer&         indexes,
+                                         const Types::AxisMinMax< T >& cell,
+                                         const size_t                  depth )
+                                                                        const;
+        // Worker of the above, uses all the provided points. Calls
+        // chooseBestSplit() for KDTreeOptions::WIDEST_RANGE_MEDIAN.
+
+    const KDHyperplane< T > medianSplit( const IndexContainer& indexes,
+                                         const size_t          axis ) const;
+        // Returns the hyperplane at the median of the points on axis
+
+    size_t axisOfLargestVariance( const IndexContainer& indexes ) const;
+        // Returns the axis of largest variance of the points, computed in a
+        // single pass
+
+    const KDHyperplane< T > slidingMidpointSplit(
+            const IndexContainer&         indexes,
+            const Types::AxisMinMax< T >& cell ) const;
+        // Returns the hyperplane for KDTreeOptions::SLIDING_MIDPOINT
+
+    const KDHyperplane< T > costModelSplit(
+            const IndexContainer& indexes ) const;
+        // Returns the hyperplane for KDTreeOptions::COST_MODEL
+
+    Types::AxisMinMax< T > bounds( const IndexContainer& indexes ) const;
+        // Returns bounding box of the points
+
+    static double halfPerimeter( const std::vector< double >& minimums,
+                                 const std::vector< double >& maximums );
+        // Returns sum of the box's extents
+
+    static std::string policyType( const KDTreeOptions::SplitPolicy policy );
+        // Returns type of the plain KDTree using the split policy
+
+    static bool isPolicyType( const std::string&          type,
+                              KDTreeOptions::SplitPolicy& policy );
+        // Returns true if type is one of the plain KDTree types, and sets
+        // policy to its split policy
+
+    NodePtr buildPresorted();
+        // Same as build() on all the points, for
+        // KDTreeOptions::PRESORTED_BUILDER
+
+    NodePtr buildPresortedHelper( std::vector< IndexContainer >& sorted,
+                                  IndexContainer&                scratch,
+                                  std::vector< bool >&           isLeft,
+                                  const size_t                   begin,
+                                  const size_t                   end );
+        // A recursive helper function, builds the subtree of the points in
+        // [begin, end) of the per axis sorted orders
+
+    NodePtr buildMorton();
+        // Same as build() on all the points, for
+        // KDTreeOptions::MORTON_BUILDER
+
+    NodePtr buildMortonHelper( const std::vector< Morton::Code >& codes,
+                               const IndexContainer&              order,
+                               const size_t                       begin,
+                               const size_t                       end,
+                               const size_t                       depth,
+                               std::vector< T >&                  workspace,
+                               T*                                 minimums );
+        // A recursive helper function, builds the subtree of the points in
+        // [begin, end) of the Morton order and stores the smallest
+        // coordinate of its points on every axis in minimums
+
+    const KDHyperplane< T > partition( const IndexContainer&    indexes,
+                                       const KDHyperplane< T >& hyperplane,
+                                       IndexContainer&          leftIndexes,
+                                       IndexContainer&          rightIndexes )
+                                                                        const;
+        // Splits indexes into points strictly below and points at or above
+        // the hyperplane. Returns the hyperplane actually used, which
+        // differs from the provided one only when the latter would leave
+        // one side empty.
+
+    size_t nearestPointIndexWrapper(
+            const KDPointView< T >& pointOfInterest ) const;
+        // Simple helper function that validates cardinality of the point
+        // of interest against the stored points. Calls
+        // nearestPointIndexHelper()
+
+    const size_t nearestPointIndexHelper(
+            const NodePtr&          root,
+            const KDPointView< T >& pointOfInterest,
+            const size_t            bestSoFarIndex ) const;
+        // A recursive helper function, finds the closes point in to the
+        // point of interest
+
+    KDPointView< T > storedPoint( const size_t index ) const;
+        // Returns view of the stored point under index, no bounds checking
+
+    void beginNodes( const size_t numNodes );
+        // Prepares node storage for a fresh structure of about numNodes
+        // nodes and forgets the profile of the previous one. Call before
+        // the first makeLeaf()/makeNode() of a build.
+
+    void endNodes();
+        // Makes the root own node storage, if nodes were carved out of an
+        // arena, and applies the requested node layout. Call once the root
+        // of a fresh structure is in m_root.
+
+    void reorderPoints();
+        // Permutes owned points into leaf order and relabels the leaves,
+        // if requested by the options
+
+    void restoreInputOrder();
+        // Undoes reorderPoints()
+
+    void quantizePoints();
+        // Encodes compact copies of the stored points, if requested by the
+        // options
+
+    uint64_t profileClock() const;
+        // Returns KDBuildProfile::now() if the build is profiled, 0
+        // otherwise
+
+    void profileLap( uint64_t& phase, uint64_t& clock ) const;
+        // Adds the time since clock to phase and restarts clock, if the
+        // build is profiled
+
+    size_t storageIndex( const size_t inputIndex ) const;
+        // Maps input order index to index into the point storage
+
+    static void collectLeaves( const NodePtr&         root,
+                               std::vector< Node* >&  leaves );
+        // Appends leaves of the subtree under root to leaves, left to
+        // right, without recursion
+
+    void relayout();
+        // Moves all the nodes into a fresh single-slab arena in van Emde
+        // Boas order
+
+    static size_t flattenPreorder( const NodePtr&          root,
+                                   std::vector< Node* >&   nodes,
+                                   std::vector< size_t >&  children );
+        // Lists the nodes under root in preorder without recursion, the
+        // preorder positions of the left and right children of nodes[ i ]
+        // go to children[ 2i ] and children[ 2i + 1 ], KDTREE_NO_NODE if
+        // absent, returns number of levels
+
+    static void vanEmdeBoasOrder( const std::vector< size_t >&  children,
+                                  const size_t                  levels,
+                                  std::vector< size_t >&        order );
+        // Lists the preorder positions of the tree described by children in
+        // van Emde Boas order, with an explicit stack of subtrees instead
+        // of recursion
+
+    NodePtr makeLeaf( const size_t leafPointIndex ) const;
+        // Allocates a leaf node using NodeAllocator or the arena
+
+    NodePtr makeNode( const KDHyperplane< T >& hyperplane,
+                      const NodePtr&           left,
+                      const NodePtr&           right ) const;
+        // Allocates a non-leaf node using NodeAllocator or the arena
+
+    void serializeHelper( std::fstream&  fileStream,
+                          const NodePtr& root ) const;
+        // A recursive helper function, writes the KD tree structure to
+        // provided file stream. This function expects a valid file
+        // stream to function properly.
+
+    struct SerializedNode {
+        bool    isLeaf;
+            // Whether the node is a leaf
+        size_t  index;
+            // Leaf point index of a leaf, split axis otherwise
+        T       value;
+            // Split value, unused by leaves
+    };
+        // A node of the text format structure, as read in preorder
+
+    DeserializeStatus deserializeText( const std::string& text );
+        // Loads the contents of a KDTreeOptions::TEXT_FORMAT file held in
+        // text. Validates the whole file before touching the tree.
+
+    NodePtr linkNodes(
+            const std::vector< SerializedNode >& nodes,
+            const std::vector< NodePtr >*        subtrees = nullptr ) const;
+        // Rebuilds the structure of a validated preorder sequence of nodes
+        // with an explicit stack, children before their parents. If
+        // subtrees are provided, leaf indexes refer to them rather than to
+        // points. Returns the root, or nullptr if nodes is empty.
+
+    static bool nextLine( const char*& cursor,
+                          const char*  end,
+                          const char*& line,
+                          const char*& lineEnd );
+        // Points line and lineEnd at the contents of the line at cursor,
+        // without its line break, and moves cursor past it. Returns false
+        // if cursor is at end.
+
+    static bool lineEquals( const char*        line,
+                            const char*        lineEnd,
+                            const std::string& expected );
+        // Returns true if the line is exactly expected
+
+    static bool parseIndex( const char*& cursor,
+                            const char*  lineEnd,
+                            size_t&      index );
+        // Parses the non-negative integer at cursor, within the line, and
+        // moves cursor past it. Returns false on malformed input.
+
+    static bool parseCoordinate( const char*& cursor,
+                                 const char*  lineEnd,
+                                 T&           value );
+        // Parses the number at cursor, within the line, and moves cursor
+        // past it. Returns false on malformed input.
+
+    bool serializeCompact( const std::string& filename ) const;
+        // Writes the tree to the provided file location in
+        // KDTreeOptions::COMPACT_FORMAT
+
+    void serializeCompactHelper( const NodePtr&           root,
+                                 const size_t             axisBits,
+                                 KDCodec::BitWriter&      structure,
+                                 std::vector< T >&        values,
+                                 std::vector< uint64_t >& leaves ) const;
+        // A recursive helper function, appends the subtree under root in
+        // preorder: a leaf bit and the split axis of every node to
+        // structure, split values to values and leaf indexes to leaves
+
+    bool deserializeCompact( std::istream& fileStream );
+        // Loads the contents of a KDTreeOptions::COMPACT_FORMAT file, past
+        // its magic. Validates the whole file before touching the tree.
+
+    static void writeStructure(
+            std::ostream&                         out,
+            const KDCodec::BitWriter&             structure,
+            const std::vector< T >&               values,
+            const std::vector< uint64_t >&        leaves,
+            const KDTreeOptions::PointCompression compression );
+        // Writes a structure gathered by serializeCompactHelper(): number
+        // of nodes, node bits, split values and leaf index deltas
+
+    static bool readStructure(
+            std::istream&                         in,
+            const size_t                          dimension,
+            const size_t                          leafLimit,
+            const KDTreeOptions::PointCompression compression,
+            std::vector< SerializedNode >&        nodes );
+        // Reads a structure written by writeStructure() into nodes, in
+        // preorder. Checks that every split has two children, that split
+        // axes are below dimension and leaf indexes below leafLimit.
+        // Returns false on malformed input.
+
+    static bool leafOrderToInputOrder( const std::vector< size_t >& leaves,
+                                       StoredPoints&                points );
+        // Moves points, read in the order of leaves, to the input indexes
+        // the leaves refer to. Returns false unless the leaves refer to
+        // every point exactly once.
+
+    bool serializeChunked( const std::string& filename ) const;
+        // Writes the tree to the provided file location in
+        // KDTreeOptions::CHUNKED_FORMAT
+
+    void serializeChunkedTop( const NodePtr&           root,
+                              const size_t             depth,
+                              const size_t             axisBits,
+                              KDCodec::BitWriter&      structure,
+                              std::vector< T >&        values,
+                              std::vector< uint64_t >& leaves,
+                              std::vector< NodePtr >&  subtrees ) const;
+        // A recursive helper function, appends the splits of the subtree
+        // under root above chunkDepth like serializeCompactHelper(). Every
+        // leaf or node at chunkDepth is appended to subtrees instead and
+        // written as a leaf referring to it.
+
+    bool deserializeChunked( const std::string& filename );
+        // Loads the contents of a KDTreeOptions::CHUNKED_FORMAT file
+
+    void adoptOptions( const KDTree& other );
+        // Takes over the options of other for copy() and transfer(). Plain
+        // trees follow its split policy; trees of a type other than other's
+        // keep their own builder and split policy.
+
+    bool adoptType( const std::string& type );
+        // Checks the type of a file being deserialized against the type of
+        // this tree. Plain trees adopt the split policy of any plain type.
+        // Returns true on success and false otherwise.
+
+    // The following allows creating of derived classes for test purposes
+    // while not exposing the vital components in productions classes
+protected:
+    NodePtr                            m_root;
+        // Root node of this KD Tree
+
+    StoredPoints                       m_points;
+        // Points that the tree is built on. Empty for a tree built over a
+        // caller-owned buffer.
+
+    PointsView                         m_externalPoints;
+        // Caller-owned points that the tree is built on, if any
+
+private:
+
+    std::string                        m_type;
+        // Type of the KDTree. Used primarily for debugging/logs
+
+    KDTreeOptions                      m_options;
+        // Options this tree is built with
+
+    std::shared_ptr< NodeArena >       m_arena;
+        // Node storage in KDTreeOptions::ARENA_NODES mode, also owned by
+        // m_root
+
+    IndexContainer                     m_permutation;
+        // Input order index of every stored point, empty unless points are
+        // stored in KDTreeOptions::LEAF_ORDER
+
+    IndexContainer                     m_inversePermutation;
+        // Storage index of every input order point, empty unless points are
+        // stored in KDTreeOptions::LEAF_ORDER
+
+    std::shared_ptr< const KDQuantizedPoints< T > > m_quantized;
+        // Compact copies of the stored points in storage order, null with
+        // KDTreeOptions::FULL_PRECISION
+
+    KDBuildProfile                     m_profile;
+        // Time spent building the structure, see buildProfile()
+};
+
+// INDEPENDENT OPERATORS
+template< typename T, typename I, typename A >
+std::ostream& operator<<( std::ostream& lhs,
+                          const KDTree< T, I, A >& rhs );
+
+//============================================================================
+//                  CREATORS
+//============================================================================
+
+template< typename T, typename I, typename A >
+KDTree< T, I, A >::KDTree()
+: m_type( Constants::KDTREE_SIMPLE_VARIETY )
+{
+    // nothing to do here
+}
+
+template< typename T, typename I, typename A >
+KDTree< T, I, A >::KDTree( const KDTreeOptions& options )
+: m_type( policyType( options.splitPolicy ) )
+, m_options( options )
+{
+    // nothing to do here
+}
+
+template< typename T, typename I, typename A >
+KDTree< T, I, A >::KDTree( const StoredPoints&  points,
+                           const KDTreeOptions& options )
+: m_points( points )
+, m_type( policyType( options.splitPolicy ) )
+, m_options( options )
+{
+    buildWrapper();
+}
+
+template< typename T, typename I, typename A >
+KDTree< T, I, A >::KDTree( StoredPoints&&       points,
+                           const KDTreeOptions& options )
+: m_points( std::move( points ) )
+, m_type( policyType( options.splitPolicy ) )
+, m_options( options )
+{
+    buildWrapper();
+}
+
+template< typename T, typename I, typename A >
+KDTree< T, I, A >::KDTree( const T*             data,
+                           const size_t         count,
+                           const size_t         dimension,
+                           const size_t         stride,
+                           const KDTreeOptions& options )
+: m_type( policyType( options.splitPolicy ) )
+, m_options( options )
+{
+    // Sanity
+    if ( count && ( ( nullptr == data ) || ( stride < dimension ) ) )
+    {
+        std::cerr << "KDTree< T >::KDTree() invalid external buffer, "
+                  << "data = "      << data      << ", "
+                  << "count = "     << count     << ", "
+                  << "dimension = " << dimension << ", "
+                  << "stride = "    << stride
+                  << std::endl;
+        return;
+    }
+
+    m_externalPoints = PointsView( data, count, dimension, stride );
+    buildWrapper();
+}
+
+template< typename T, typename I, typename A >
+KDTree< T, I, A >::KDTree( const KDTree& other )
+: m_type( Constants::KDTREE_SIMPLE_VARIETY )
+{
+    copy( other );
+}
+
+template< typename T, typename I, typename A >
+KDTree< T, I, A >::KDTree( KDTree&& other ) noexcept
+: m_type( Constants::KDTREE_SIMPLE_VARIETY )
+{
+    transfer( other );
+}
+
+template< typename T, typename I, typename A >
+KDTree< T, I, A >::KDTree( const std::string& type )
+: m_type( type )
+{
+    // nothing to do here
+}
+
+template< typename T, typename I, typename A >
+KDTree< T, I, A >::~KDTree()
+{
+    // nothing to do here
+}
+
+//============================================================================
+//                  OPERATORS
+//============================================================================
+
+template< typename T, typename I, typename A >
+KDTree< T, I, A >&
+KDTree< T, I, A >::operator=( const KDTree< T, I, A >& other )
+{
+    copy( other );
+    return *this;
+}
+
+template< typename T, typename I, typename A >
+KDTree< T, I, A >&
+KDTree< T, I, A >::operator=( KDTree< T, I, A >&& other ) noexcept
+{
+    transfer( other );
+    return *this;
+}
+
+template< typename T, typename I, typename A >
+bool
+KDTree< T, I, A >::operator==( const KDTree< T, I, A >& other ) const
+{
+    return equals( other );
+}
+
+template< typename T, typename I, typename A >
+bool KDTree< T, I, A >::operator!=(
+        const KDTree< T, I, A >& other ) const
+{
+    return !equals( other );
+}
+
+//============================================================================
+//                  PRIMARY INTERFACE
+//============================================================================
+template< typename T, typename I, typename A >
+bool
+KDTree< T, I, A >::serialize( const std::string& filename ) const
+{
+    if ( KDTreeOptions::COMPACT_FORMAT == m_options.fileFormat )
+    {
+        return serializeCompact( filename );
+    }
+
+    if ( KDTreeOptions::CHUNKED_FORMAT == m_options.fileFormat )
+    {
+        return serializeChunked( filename );
+    }
+
+    std::fstream serializedData;
+    serializedData.open( filename, std::fstream::out | std::fstream::trunc );
+
+    if ( !serializedData.is_open() )
+    {
+        std::cerr << "KDTree:serialize() is unable to open "
+                  << "'" << filename << "' for writing"
+                  << std::endl;
+        return false;
+    }
+
+    // First serialize tree type
+    serializedData << m_type << '\n';
+
+    const PointsView points = pointsView();
+
+    // Second serialize number of lines
+    serializedData << points.size() << '\n';
+
+    // Third all the points, in input order
+    for ( size_t i = 0; i < points.size(); ++i )
+    {
+        const KDPointView< T > point = points[ storageIndex( i ) ];
+        serializedData << point[ 0 ];
+
+        for ( size_t j = 1; j < point.size(); ++j )
+        {
+            serializedData << ',' << point[ j ];
+        }
+
+        serializedData << '\n';
+    }
+
+    // Fourth serialize tree structure in postorder
+    serializeHelper( serializedData, m_root );
+
+    // Fifth node layout, if other than the build order
+    if ( KDTreeOptions::VAN_EMDE_BOAS_LAYOUT == m_options.nodeLayout )
+    {
+        serializedData << Constants::KDTREE_LAYOUT_MARKER        << '\n';
+        serializedData << Constants::KDTREE_VAN_EMDE_BOAS_LAYOUT << '\n';
+    }
+    if ( !m_permutation.empty() )
+    {
+        serializedData << Constants::KDTREE_POINT_ORDER_MARKER << '\n';
+        serializedData << Constants::KDTREE_LEAF_POINT_ORDER   << '\n';
+    }
+
+    serializedData.close();
+
+    return true;
+}
+
+template< typename T, typename I, typename A >
+void
+KDTree< T, I, A >::serializeHelper( std::fstream&  fileStream,
+                                    const NodePtr& root ) const
+{
+    // Handle special case of an empty tree
+    if ( nullptr == root )
+    {
+        fileStream << Constants::KDTREE_EMPTY_MARKER << '\n';
+        return;
+    }
+
+    // Handle hyperplane and leaf nodes differently
+    if ( root->isLeaf() )
+    {
+        fileStream << Constants::KDTREE_LEAF_MARKER << '\n';
+        fileStream << inputIndex( root->leafPointIndex() ) << '\n';
+        return;
+    }
+
+    fileStream << Constants::KDTREE_HYPERPLANE_MARKER << '\n';
+    fileStream << root->hyperplane().serialize() << '\n';
+
+    // Then store children
+    if ( nullptr != root->left() )
+    {
+        serializeHelper( fileStream, root->left() );
+    }
+    if ( nullptr != root->right() )
+    {
+        serializeHelper( fileStream, root->right() );
+    }
+}
+
+template< typename T, typename I, typename A >
+bool
+KDTree< T, I, A >::deserialize( const std::string& filename )
+{
+    return DESERIALIZE_SUCCESS == deserializeWithStatus( filename );
+}
+
+template< typename T, typename I, typename A >
+typename KDTree< T, I, A >::DeserializeStatus
+KDTree< T, I, A >::deserializeWithStatus( const std::string& filename )
+{
+    std::ifstream treeData( filename, std::ios::binary );
+
+    if ( !treeData.is_open() )
+    {
+        std::cerr << "KDTree< T >::deserialize() is unable to open "
+                  << "'" << filename << "' for reading"
+                  << std::endl;
+        return DESERIALIZE_OPEN_FAILED;
+    }
+
+    // Compact files are recognized by their magic
+    std::string magic( Constants::KDTREE_COMPACT_MAGIC.size(), '\0' );
+    treeData.read( &magic[ 0 ], magic.size() );
+    if ( treeData && ( Constants::KDTREE_COMPACT_MAGIC == magic ) )
+    {
+        return deserializeCompact( treeData ) ? DESERIALIZE_SUCCESS
+                                              : DESERIALIZE_MALFORMED_COMPACT;
+    }
+    if ( treeData && ( Constants::KDTREE_CHUNKED_MAGIC == magic ) )
+    {
+        treeData.close();
+        return deserializeChunked( filename ) ? DESERIALIZE_SUCCESS
+                                              : DESERIALIZE_MALFORMED_CHUNKED;
+    }
+
+    // Text files are read in one go
+    treeData.clear();
+    treeData.seekg( 0, std::ios::end );
+    const std::streamoff fileSize = treeData.tellg();
+    treeData.seekg( 0 );
+
+    std::string text( fileSize > 0 ? static_cast< size_t >( fileSize ) : 0u,
+                      '\0' );
+    if ( !text.empty() )
+    {
+        treeData.read( &text[ 0 ], text.size() );
+    }
+
+    if ( !treeData )
+    {
+        std::cerr << "KDTree< T >::deserialize() is unable to read "
+                  << "'" << filename << "'"
+                  << std::endl;
+        return DESERIALIZE_OPEN_FAILED;
+    }
+    treeData.close();
+
+    return deserializeText( text );
+}
+
+template< typename T, typename I, typename A >
+typename KDTree< T, I, A >::DeserializeStatus
+KDTree< T, I, A >::deserializeText( const std::string& text )
+{
+    const char*       cursor  = text.c_str();
+    const char* const end     = cursor + text.size();
+    const char*       line    = cursor;
+    const char*       lineEnd = cursor;
+
+    // First check tree type, the tree is restored on failure
+    const std::string   previousType    = m_type;
+    const KDTreeOptions previousOptions = m_options;
+
+    nextLine( cursor, end, line, lineEnd );
+    if ( !adoptType( std::string( line, lineEnd ) ) )
+    {
+        return DESERIALIZE_TYPE_MISMATCH;
+    }
+
+    DeserializeStatus status = DESERIALIZE_SUCCESS;
+
+    // Second number of points. Every point takes at least two characters,
+    // which bounds the count of a malformed file.
+    size_t numPoints = 0u;
+    if ( !nextLine( cursor, end, line, lineEnd ) ||
+         !parseIndex( line, lineEnd, numPoints ) || ( line != lineEnd ) ||
+         ( numPoints > text.size() / 2u ) )
+    {
+        std::cerr << "Malformed number of points encountered in "
+                  << "KDTree::deserialize()"
+                  << std::endl;
+        status = DESERIALIZE_MALFORMED_COUNT;
+    }
+
+    // Third all the points
+    StoredPoints points;
+    size_t dimension = 0u;
+    if ( DESERIALIZE_SUCCESS == status )
+    {
+        points.reserve( numPoints );
+    }
+    for ( size_t i = 0; ( DESERIALIZE_SUCCESS == status ) &&
+                        ( i < numPoints ); ++i )
+    {
+        Types::BasicPoint< T, A > point;
+        point.reserve( dimension );
+
+        bool valid = nextLine( cursor, end, line, lineEnd );
+        while ( valid )
+        {
+            T value;
+            valid = parseCoordinate( line, lineEnd, value );
+            if ( valid )
+            {
+                point.push_back( value );
+            }
+
+            if ( !valid || ( line == lineEnd ) )
+            {
+                break;
+            }
+            valid = ( ',' == *line );
+            ++line;
+        }
+
+        if ( !valid || ( i && ( point.size() != dimension ) ) )
+        {
+            std::cerr << "Malformed point " << i << " encountered in "
+                      << "KDTree::deserialize()"
+                      << std::endl;
+            status = DESERIALIZE_MALFORMED_POINTS;
+            break;
+        }
+
+        dimension = point.size();
+        points.push_back( std::move( point ) );
+    }
+
+    // Fourth tree structure in preorder. A full binary tree on n leaves has
+    // 2n - 1 nodes, so the node storage is preallocated and every split
+    // must be followed by exactly two subtrees.
+    const size_t numNodes = numPoints ? 2u * numPoints - 1u : 0u;
+    std::vector< SerializedNode > nodes;
+    if ( DESERIALIZE_SUCCESS == status )
+    {
+        nodes.reserve( numNodes );
+    }
+
+    size_t pending = 1u;
+    while ( ( DESERIALIZE_SUCCESS == status ) && pending )
+    {
+        if ( !nextLine( cursor, end, line, lineEnd ) )
+        {
+            status = DESERIALIZE_MALFORMED_STRUCTURE;
+            break;
+        }
+
+        // Only a tree without points is empty
+        if ( lineEquals( line, lineEnd, Constants::KDTREE_EMPTY_MARKER ) )
+        {
+            pending = 0u;
+            if ( numNodes )
+            {
+                status = DESERIALIZE_MALFORMED_STRUCTURE;
+            }
+            break;
+        }
+
+        if ( nodes.size() == numNodes )
+        {
+            status = DESERIALIZE_MALFORMED_STRUCTURE;
+            break;
+        }
+
+        SerializedNode node;
+        node.value = T();
+        if ( lineEquals( line, lineEnd, Constants::KDTREE_LEAF_MARKER ) )
+        {
+            node.isLeaf = true;
+            if ( !nextLine( cursor, end, line, lineEnd ) ||
+                 !parseIndex( line, lineEnd, node.index ) ||
+                 ( line != lineEnd ) || ( node.index >= numPoints ) ||
+                 ( node.index >= static_cast< size_t >(
+                                        Constants::errorIndex< I >() ) ) )
+            {
+                status = DESERIALIZE_MALFORMED_NODE;
+                break;
+            }
+            --pending;
+        }
+        else if ( lineEquals( line, lineEnd,
+                              Constants::KDTREE_HYPERPLANE_MARKER ) )
+        {
+            node.isLeaf = false;
+            if ( !nextLine( cursor, end, line, lineEnd ) ||
+                 !parseIndex( line, lineEnd, node.index ) ||
+                 ( node.index >= dimension ) ||
+                 !parseCoordinate( line, lineEnd, node.value ) ||
+                 ( line != lineEnd ) )
+            {
+                status = DESERIALIZE_MALFORMED_NODE;
+                break;
+            }
+            ++pending;
+        }
+        else
+        {
+            status = DESERIALIZE_MALFORMED_NODE;
+            break;
+        }
+
+        nodes.push_back( node );
+    }
+
+    if ( ( DESERIALIZE_SUCCESS == status ) && ( nodes.size() != numNodes ) )
+    {
+        status = DESERIALIZE_MALFORMED_STRUCTURE;
+    }
+
+    if ( DESERIALIZE_MALFORMED_NODE == status )
+    {
+        std::cerr << "Malformed node " << nodes.size() << " encountered in "
+                  << "KDTree::deserialize() "
+                  << "line : '" << std::string( line, lineEnd ) << "'"
+                  << std::endl;
+    }
+    else if ( DESERIALIZE_MALFORMED_STRUCTURE == status )
+    {
+        std::cerr << "Malformed tree structure encountered in "
+                  << "KDTree::deserialize() "
+                  << "nodes : '" << nodes.size() << "', "
+                  << "expected : '" << numNodes << "'"
+                  << std::endl;
+    }
+
+    // Fifth optional node layout and point order
+    KDTreeOptions::NodeLayout nodeLayout = m_options.nodeLayout;
+    KDTreeOptions::PointOrder pointOrder = m_options.pointOrder;
+    while ( ( DESERIALIZE_SUCCESS == status ) &&
+            nextLine( cursor, end, line, lineEnd ) )
+    {
+        if ( line == lineEnd )
+        {
+            continue;
+        }
+
+        if ( lineEquals( line, lineEnd, Constants::KDTREE_LAYOUT_MARKER ) &&
+             nextLine( cursor, end, line, lineEnd ) &&
+             lineEquals( line, lineEnd,
+                         Constants::KDTREE_VAN_EMDE_BOAS_LAYOUT ) )
+        {
+            nodeLayout = KDTreeOptions::VAN_EMDE_BOAS_LAYOUT;
+            continue;
+        }
+
+        if ( lineEquals( line, lineEnd,
+                         Constants::KDTREE_POINT_ORDER_MARKER ) &&
+             nextLine( cursor, end, line, lineEnd ) &&
+             lineEquals( line, lineEnd, Constants::KDTREE_LEAF_POINT_ORDER ) )
+        {
+            pointOrder = KDTreeOptions::LEAF_ORDER;
+            continue;
+        }
+
+        std::cerr << "Unexpected line encountered in "
+                  << "KDTree::deserialize() "
+                  << "line : '" << std::string( line, lineEnd ) << "'"
+                  << std::endl;
+        status = DESERIALIZE_MALFORMED_TRAILER;
+    }
+
+    if ( DESERIALIZE_SUCCESS != status )
+    {
+        m_type    = previousType;
+        m_options = previousOptions;
+        return status;
+    }
+
+    m_points = std::move( points );
+    m_externalPoints = PointsView();
+    m_permutation.clear();
+    m_inversePermutation.clear();
+    m_options.nodeLayout = nodeLayout;
+    m_options.pointOrder = pointOrder;
+
+    std::cout << "deserialization begins" << std::endl;
+
+    beginNodes( nodes.size() );
+    m_root = linkNodes( nodes );
+    reorderPoints();
+    quantizePoints();
+    endNodes();
+
+    return DESERIALIZE_SUCCESS;
+}
+
+template< typename T, typename I, typename A >
+typename KDTree< T, I, A >::NodePtr
+KDTree< T, I, A >::linkNodes(
+        const std::vector< SerializedNode >& nodes,
+        const std::vector< NodePtr >*        subtrees ) const
+{
+    // In reverse preorder both subtrees of a split are complete by the time
+    // the split is reached, the left one on top of the stack
+    std::vector< NodePtr > stack;
+    stack.reserve( nodes.size() / 2u + 1u );
+
+    for ( size_t i = nodes.size(); i > 0; --i )
+    {
+        const SerializedNode& node = nodes[ i - 1u ];
+        if ( node.isLeaf )
+        {
+            stack.push_back( subtrees ? ( *subtrees )[ node.index ]
+                                      : makeLeaf( node.index ) );
+            continue;
+        }
+
+        NodePtr left = std::move( stack.back() );
+        stack.pop_back();
+        NodePtr right = std::move( stack.back() );
+        stack.pop_back();
+
+        stack.push_back( makeNode( KDHyperplane< T >( node.index,
+                                                      node.value ),
+                                   left, right ) );
+    }
+
+    return stack.empty() ? nullptr : stack.back();
+}
+
+template< typename T, typename I, typename A >
+bool
+KDTree< T, I, A >::nextLine( const char*& cursor,
+                             const char*  end,
+                             const char*& line,
+                             const char*& lineEnd )
+{
+    if ( cursor == end )
+    {
+        line    = end;
+        lineEnd = end;
+        return false;
+    }
+
+    line = cursor;
+    const void* lineBreak = std::memchr( cursor, '\n', end - cursor );
+    lineEnd = lineBreak ? static_cast< const char* >( lineBreak ) : end;
+    cursor  = lineBreak ? lineEnd + 1 : end;
+
+    // Tolerate files that went through a Windows editor
+    if ( ( lineEnd != line ) && ( '\r' == *( lineEnd - 1 ) ) )
+    {
+        --lineEnd;
+    }
+
+    return true;
+}
+
+template< typename T, typename I, typename A >
+bool
+KDTree< T, I, A >::lineEquals( const char*        line,
+                               const char*        lineEnd,
+                               const std::string& expected )
+{
+    return ( static_cast< size_t >( lineEnd - line ) == expected.size() ) &&
+           ( 0 == expected.compare( 0, expected.size(), line,
+                                    expected.size() ) );
+}
+
+template< typename T, typename I, typename A >
+bool
+KDTree< T, I, A >::parseIndex( const char*& cursor,
+                               const char*  lineEnd,
+                               size_t&      index )
+{
+    // strtoull() would accept signs and leading white space
+    if ( ( cursor == lineEnd ) || ( *cursor < '0' ) || ( *cursor > '9' ) )
+    {
+        return false;
+    }
+
+    char* parsed;
+    errno = 0;
+    const unsigned long long value = std::strtoull( cursor, &parsed, 10 );
+    if ( ( ERANGE == errno ) || ( parsed > lineEnd ) ||
+         ( value > std::numeric_limits< size_t >::max() ) )
+    {
+        return false;
+    }
+
+    cursor = parsed;
+    index  = static_cast< size_t >( value );
+    return true;
+}
+
+template< typename T, typename I, typename A >
+bool
+KDTree< T, I, A >::parseCoordinate( const char*& cursor,
+                                    const char*  lineEnd,
+                                    T&           value )
+{
+    // The text is null terminated, and strtod() stops at the line break
+    // unless the line holds nothing but white space past cursor
+    char* parsed;
+    const double parsedValue = std::strtod( cursor, &parsed );
+    if ( ( parsed == cursor ) || ( parsed > lineEnd ) )
+    {
+        return false;
+    }
+
+    cursor = parsed;
+    value  = static_cast< T >( parsedValue );
+    return true;
+}
+
+template< typename T, typename I, typename A >
+bool
+KDTree< T, I, A >::serializeCompact( const std::string& filename ) const
+{
+    std::ofstream serializedData( filename,
+                                  std::ios::binary | std::ios::trunc );
+
+    if ( !serializedData.is_open() )
+    {
+        std::cerr << "KDTree:serialize() is unable to open "
+                  << "'" << filename << "' for writing"
+                  << std::endl;
+        return false;
+    }
+
+    const PointsView points    = pointsView();
+    const size_t     dimension = points.empty() ? 0u : points[ 0u ].size();
+    const KDTreeOptions::PointCompression compression =
+            m_options.pointCompression;
+
+    // The structure is gathered up front: XOR_DELTA_POINTS encodes the
+    // points in the order of the leaves, where neighbours are close
+    const size_t axisBits = KDCodec::bitsFor( dimension ? dimension - 1u
+                                                        : 0u );
+    KDCodec::BitWriter      structure;
+    std::vector< T >        values;
+    std::vector< uint64_t > leaves;
+    serializeCompactHelper( m_root, axisBits, structure, values, leaves );
+    const bool leafOrder = KDTreeOptions::XOR_DELTA_POINTS == compression;
+
+    // First magic and tree type
+    serializedData.write( Constants::KDTREE_COMPACT_MAGIC.data(),
+                          Constants::KDTREE_COMPACT_MAGIC.size() );
+    KDCodec::writeVarint( serializedData, m_type.size() );
+    serializedData.write( m_type.data(), m_type.size() );
+
+    // Second layout, point order and point sequence flags, then the point
+    // encoding
+    KDCodec::writeVarint( serializedData,
+            ( KDTreeOptions::VAN_EMDE_BOAS_LAYOUT == m_options.nodeLayout ?
+                      1u : 0u ) |
+            ( m_permutation.empty() ? 0u : 2u ) |
+            ( leafOrder ? 4u : 0u ) );
+    KDCodec::writeVarint( serializedData, compression );
+    KDCodec::writeVarint( serializedData, sizeof( T ) );
+    KDCodec::writeVarint( serializedData, dimension );
+    KDCodec::writeVarint( serializedData, points.size() );
+
+    // Third all the points, in input or leaf order
+    std::vector< T > coordinates;
+    coordinates.reserve( points.size() * dimension );
+    for ( size_t i = 0; i < points.size(); ++i )
+    {
+        const KDPointView< T > point =
+                points[ storageIndex( leafOrder ? leaves[ i ] : i ) ];
+        coordinates.insert( coordinates.end(), point.begin(), point.end() );
+    }
+    KDCodec::encodeValues( serializedData, coordinates, dimension,
+                           compression );
+
+    // Fourth tree structure in preorder: node bits, split values and leaf
+    // index deltas
+    writeStructure( serializedData, structure, values, leaves, compression );
+
+    return serializedData.good();
+}
+
+template< typename T, typename I, typename A >
+void
+KDTree< T, I, A >::serializeCompactHelper(
+        const NodePtr&           root,
+        const size_t             axisBits,
+        KDCodec::BitWriter&      structure,
+        std::vector< T >&        values,
+        std::vector< uint64_t >& leaves ) const
+{
+    // Handle special case of an empty tree
+    if ( nullptr == root )
+    {
+        return;
+    }
+
+    if ( root->isLeaf() )
+    {
+        structure.write( 1u, 1u );
+        leaves.push_back( inputIndex( root->leafPointIndex() ) );
+        return;
+    }
+
+    structure.write( 0u, 1u );
+    structure.write( root->hyperplane().hyperplaneIndex(), axisBits );
+    values.push_back( root->hyperplane().value() );
+
+    serializeCompactHelper( root->left(),  axisBits, structure, values,
+                            leaves );
+    serializeCompactHelper( root->right(), axisBits, structure, values,
+                            leaves );
+}
+
+template< typename T, typename I, typename A >
+bool
+KDTree< T, I, A >::deserializeCompact( std::istream& fileStream )
+{
+    // First tree type
+    uint64_t typeSize;
+    if ( !KDCodec::readVarint( fileStream, typeSize ) ||
+         ( typeSize > Constants::KDTREE_COMPACT_MAX_TYPE_SIZE ) )
+    {
+        std::cerr << "Malformed tree type encountered in "
+                  << "KDTree::deserialize()"
+                  << std::endl;
+        return false;
+    }
+
+    std::string type( typeSize, '\0' );
+    if ( typeSize )
+    {
+        fileStream.read( &type[ 0 ], typeSize );
+    }
+
+    const std::string previousType = m_type;
+    const KDTreeOptions::SplitPolicy previousPolicy = m_options.splitPolicy;
+    if ( !fileStream || !adoptType( type ) )
+    {
+        return false;
+    }
+
+    // Second flags and point encoding. Every leaf takes at least a byte,
+    // so neither the leaves nor the encoded coordinates may need more bytes
+    // than are left in the file.
+    uint64_t flags, compression, valueSize, dimension, numPoints;
+    bool valid = KDCodec::readVarint( fileStream, flags )       &&
+                 KDCodec::readVarint( fileStream, compression ) &&
+                 KDCodec::readVarint( fileStream, valueSize )   &&
+                 KDCodec::readVarint( fileStream, dimension )   &&
+                 KDCodec::readVarint( fileStream, numPoints )   &&
+                 ( compression <= KDTreeOptions::BYTE_SHUFFLE_POINTS ) &&
+                 ( valueSize == sizeof( T ) ) &&
+                 ( !numPoints || dimension ) &&
+                 ( numPoints < static_cast< uint64_t >(
+                                       Constants::errorIndex< I >() ) );
+
+    const KDTreeOptions::PointCompression pointCompression =
+            static_cast< KDTreeOptions::PointCompression >( compression );
+    const uint64_t remaining = KDCodec::remaining( fileStream );
+    valid = valid &&
+            ( !numPoints ||
+              ( ( numPoints <= remaining ) &&
+                ( dimension <= std::numeric_limits< uint64_t >::max() /
+                               numPoints ) &&
+                ( KDCodec::minEncodedSize( numPoints * dimension, dimension,
+                                           sizeof( T ), pointCompression ) <=
+                  remaining - numPoints ) ) );
+    if ( !valid )
+    {
+        std::cerr << "Malformed or incompatible header encountered in "
+                  << "KDTree::deserialize()"
+                  << std::endl;
+        m_type                = previousType;
+        m_options.splitPolicy = previousPolicy;
+        return false;
+    }
+
+    // Third all the points
+    const size_t d = static_cast< size_t >( dimension );
+    std::vector< T > coordinates;
+    if ( !KDCodec::decodeValues( fileStream,
+                                 static_cast< size_t >( numPoints ) * d, d,
+                                 pointCompression, coordinates ) )
+    {
+        std::cerr << "Truncated points encountered in "
+                  << "KDTree::deserialize()"
+                  << std::endl;
+        m_type                = previousType;
+        m_options.splitPolicy = previousPolicy;
+        return false;
+    }
+
+    // Fourth tree structure, over every point
+    std::vector< SerializedNode > nodes;
+    if ( !readStructure( fileStream, d, static_cast< size_t >( numPoints ),
+                         pointCompression, nodes ) ||
+         ( nodes.size() != ( numPoints ? 2u * numPoints - 1u : 0u ) ) )
+    {
+        std::cerr << "Malformed tree structure encountered in "
+                  << "KDTree::deserialize()"
+                  << std::endl;
+        m_type                = previousType;
+        m_options.splitPolicy = previousPolicy;
+        return false;
+    }
+
+    StoredPoints points;
+    points.reserve( static_cast< size_t >( numPoints ) );
+    for ( size_t i = 0; i < numPoints; ++i )
+    {
+        points.push_back( Types::BasicPoint< T, A >(
+                coordinates.begin() + i * d,
+                coordinates.begin() + ( i + 1u ) * d ) );
+    }
+
+    std::vector< size_t > leaves;
+    for ( size_t i = 0; ( flags & 4u ) && ( i < nodes.size() ); ++i )
+    {
+        if ( nodes[ i ].isLeaf )
+        {
+            leaves.push_back( nodes[ i ].index );
+        }
+    }
+
+    if ( ( flags & 4u ) && !leafOrderToInputOrder( leaves, points ) )
+    {
+        std::cerr << "Malformed tree structure encountered in "
+                  << "KDTree::deserialize()"
+                  << std::endl;
+        m_type                = previousType;
+        m_options.splitPolicy = previousPolicy;
+        return false;
+    }
+
+    // The whole file is valid, so the tree can be replaced
+    m_points = std::move( points );
+    m_externalPoints = PointsView();
+    m_permutation.clear();
+    m_inversePermutation.clear();
+
+    m_options.fileFormat       = KDTreeOptions::COMPACT_FORMAT;
+    m_options.pointCompression = pointCompression;
+    if ( flags & 1u )
+    {
+        m_options.nodeLayout = KDTreeOptions::VAN_EMDE_BOAS_LAYOUT;
+    }
+    if ( flags & 2u )
+    {
+        m_options.pointOrder = KDTreeOptions::LEAF_ORDER;
+    }
+
+    beginNodes( nodes.size() );
+    m_root = linkNodes( nodes );
+    reorderPoints();
+    quantizePoints();
+    endNodes();
+
+    return true;
+}
+
+template< typename T, typename I, typename A >
+void
+KDTree< T, I, A >::writeStructure(
+        std::ostream&                         out,
+        const KDCodec::BitWriter&             structure,
+        const std::vector< T >&               values,
+        const std::vector< uint64_t >&        leaves,
+        const KDTreeOptions::PointCompression compression )
+{
+    KDCodec::writeVarint( out, values.size() + leaves.size() );
+    KDCodec::writeBytes( out, structure.bytes() );
+    KDCodec::encodeValues( out, values, 1u, compression );
+
+    uint64_t previous = 0u;
+    for ( size_t i = 0; i < leaves.size(); ++i )
+    {
+        KDCodec::writeVarint( out, KDCodec::zigzag(
+                static_cast< int64_t >( leaves[ i ] - previous ) ) );
+        previous = leaves[ i ];
+    }
+}
+
+template< typename T, typename I, typename A >
+bool
+KDTree< T, I, A >::readStructure(
+        std::istream&                         in,
+        const size_t                          dimension,
+        const size_t                          leafLimit,
+        const KDTreeOptions::PointCompression compression,
+        std::vector< SerializedNode >&        nodes )
+{
+    // A full binary tree has one leaf more than splits
+    uint64_t numNodes;
+    std::vector< uint8_t > structureBytes;
+    if ( !KDCodec::readVarint( in, numNodes ) ||
+         ( numNodes && !( numNodes % 2u ) ) ||
+         ( numNodes / 2u >= std::max< size_t >( leafLimit, 1u ) ) ||
+         !KDCodec::readBytes( in, structureBytes ) )
+    {
+        return false;
+    }
+
+    // Every leaf takes at least a byte, and so do the split values
+    const size_t numLeaves = static_cast< size_t >( ( numNodes + 1u ) / 2u );
+    const uint64_t remaining = KDCodec::remaining( in );
+    if ( ( numLeaves > remaining ) ||
+         ( KDCodec::minEncodedSize( numLeaves ? numLeaves - 1u : 0u, 1u,
+                                    sizeof( T ), compression ) >
+           remaining - numLeaves ) )
+    {
+        return false;
+    }
+
+    std::vector< T > values;
+    if ( !KDCodec::decodeValues( in, numLeaves ? numLeaves - 1u : 0u, 1u,
+                                 compression, values ) )
+    {
+        return false;
+    }
+
+    std::vector< uint64_t > leaves;
+    leaves.reserve( numLeaves );
+    uint64_t previous = 0u;
+    for ( size_t i = 0; i < numLeaves; ++i )
+    {
+        uint64_t delta;
+        if ( !KDCodec::readVarint( in, delta ) )
+        {
+            return false;
+        }
+
+        previous = previous + static_cast< uint64_t >(
+                                      KDCodec::unzigzag( delta ) );
+        if ( previous >= leafLimit )
+        {
+            return false;
+        }
+        leaves.push_back( previous );
+    }
+
+    const size_t axisBits = KDCodec::bitsFor( dimension ? dimension - 1u
+                                                        : 0u );
+    KDCodec::BitReader structure( structureBytes );
+    size_t pending    = 1u;
+    size_t valueIndex = 0u;
+    size_t leafIndex  = 0u;
+
+    nodes.clear();
+    nodes.reserve( static_cast< size_t >( numNodes ) );
+    for ( uint64_t i = 0; i < numNodes; ++i )
+    {
+        SerializedNode node;
+        uint64_t isLeaf;
+        uint64_t axis = 0u;
+        if ( !pending || !structure.read( 1u, isLeaf ) ||
+             ( !isLeaf && ( !structure.read( axisBits, axis ) ||
+                            ( axis >= dimension ) ||
+                            ( valueIndex == values.size() ) ) ) ||
+             ( isLeaf && ( leafIndex == leaves.size() ) ) )
+        {
+            return false;
+        }
+
+        node.isLeaf = isLeaf != 0u;
+        if ( node.isLeaf )
+        {
+            node.index = static_cast< size_t >( leaves[ leafIndex++ ] );
+            node.value = T();
+            --pending;
+        }
+        else
+        {
+            node.index = static_cast< size_t >( axis );
+            node.value = values[ valueIndex++ ];
+            ++pending;
+        }
+        nodes.push_back( node );
+    }
+
+    return numNodes ? !pending : true;
+}
+
+template< typename T, typename I, typename A >
+bool
+KDTree< T, I, A >::leafOrderToInputOrder( const std::vector< size_t >& leaves,
+                                          StoredPoints&                points )
+{
+    if ( leaves.size() != points.size() )
+    {
+        return false;
+    }
+
+    StoredPoints inputOrder( points.size() );
+    std::vector< bool > placed( points.size(), false );
+    for ( size_t i = 0; i < leaves.size(); ++i )
+    {
+        if ( ( leaves[ i ] >= points.size() ) || placed[ leaves[ i ] ] )
+        {
+            return false;
+        }
+
+        placed[ leaves[ i ] ] = true;
+        inputOrder[ leaves[ i ] ] = std::move( points[ i ] );
+    }
+
+    points.swap( inputOrder );
+    return true;
+}
+
+template< typename T, typename I, typename A >
+bool
+KDTree< T, I, A >::serializeChunked( const std::string& filename ) const
+{
+    KDFile file;
+    if ( !file.open( filename, KDFile::WRITE ) )
+    {
+        std::cerr << "KDTree:serialize() is unable to open "
+                  << "'" << filename << "' for writing"
+                  << std::endl;
+        return false;
+    }
+
+    const PointsView points    = pointsView();
+    const size_t     dimension = points.empty() ? 0u : points[ 0u ].size();
+    const size_t     axisBits  = KDCodec::bitsFor( dimension ? dimension - 1u
+                                                             : 0u );
+    const KDTreeOptions::PointCompression compression =
+            m_options.pointCompression;
+
+    // First the splits above the chunks, gathering the subtrees below them
+    KDCodec::BitWriter      structure;
+    std::vector< T >        values;
+    std::vector< uint64_t > leaves;
+    std::vector< NodePtr >  subtrees;
+    serializeChunkedTop( m_root, 0u, axisBits, structure, values, leaves,
+                         subtrees );
+
+    // XOR_DELTA_POINTS encodes the points in the order of the leaves,
+    // where neighbours are close
+    const bool leafOrder = KDTreeOptions::XOR_DELTA_POINTS == compression;
+    std::vector< Node* > leafNodes;
+    if ( leafOrder )
+    {
+        leafNodes.reserve( points.size() );
+        collectLeaves( m_root, leafNodes );
+    }
+
+    // Second every chunk is encoded on its own: blocks of points in input
+    // or leaf order, then the subtrees in preorder
+    const size_t chunkPoints    = Constants::KDTREE_CHUNK_POINTS;
+    const size_t numPointChunks = ( points.size() + chunkPoints - 1u ) /
+                                  chunkPoints;
+    std::vector< std::string > chunks( numPointChunks + subtrees.size() );
+    KDFile::forEach( chunks.size(), m_options.ioThreads,
+                     [ & ]( const size_t chunk )
+                     {
+                         std::ostringstream out;
+                         if ( chunk >= numPointChunks )
+                         {
+                             KDCodec::BitWriter      chunkStructure;
+                             std::vector< T >        chunkValues;
+                             std::vector< uint64_t > chunkLeaves;
+                             serializeCompactHelper(
+                                     subtrees[ chunk - numPointChunks ],
+                                     axisBits, chunkStructure, chunkValues,
+                                     chunkLeaves );
+                             writeStructure( out, chunkStructure,
+                                             chunkValues, chunkLeaves,
+                                             compression );
+                             chunks[ chunk ] = out.str();
+                             return true;
+                         }
+
+                         const size_t begin = chunk * chunkPoints;
+                         const size_t end   = std::min( points.size(),
+                                                        begin + chunkPoints );
+                         std::vector< T > coordinates;
+                         coordinates.reserve( ( end - begin ) * dimension );
+                         for ( size_t i = begin; i < end; ++i )
+                         {
+                             const KDPointView< T > point = points[
+                                     leafOrder ?
+                                     leafNodes[ i ]->leafPointIndex() :
+                                     storageIndex( i ) ];
+                             coordinates.insert( coordinates.end(),
+                                                 point.begin(), point.end() );
+                         }
+                         KDCodec::encodeValues( out, coordinates, dimension,
+                                                compression );
+                         chunks[ chunk ] = out.str();
+                         return true;
+                     } );
+
+    // Third the header: tree type, flags, point encoding, the splits above
+    // the chunks and the size of every chunk
+    std::ostringstream header;
+    KDCodec::writeVarint( header, m_type.size() );
+    header.write( m_type.data(), m_type.size() );
+    KDCodec::writeVarint( header,
+            ( KDTreeOptions::VAN_EMDE_BOAS_LAYOUT == m_options.nodeLayout ?
+                      1u : 0u ) |
+            ( m_permutation.empty() ? 0u : 2u ) |
+            ( leafOrder ? 4u : 0u ) );
+    KDCodec::writeVarint( header, compression );
+    KDCodec::writeVarint( header, sizeof( T ) );
+    KDCodec::writeVarint( header, dimension );
+    KDCodec::writeVarint( header, points.size() );
+    KDCodec::writeVarint( header, chunkPoints );
+    KDCodec::writeVarint( header, subtrees.size() );
+    writeStructure( header, structure, values, leaves, compression );
+    for ( size_t i = 0; i < chunks.size(); ++i )
+    {
+        KDCodec::writeVarint( header, chunks[ i ].size() );
+    }
+
+    const std::string headerBytes = header.str();
+    const uint64_t    headerSize  = headerBytes.size();
+    std::string prefix = Constants::KDTREE_CHUNKED_MAGIC;
+    prefix.append( reinterpret_cast< const char* >( &headerSize ),
+                   sizeof( headerSize ) );
+
+    std::vector< uint64_t > offsets( chunks.size() + 1u );
+    offsets[ 0 ] = prefix.size() + headerBytes.size();
+    for ( size_t i = 0; i < chunks.size(); ++i )
+    {
+        offsets[ i + 1u ] = offsets[ i ] + chunks[ i ].size();
+    }
+
+    // Fourth all the chunks at once
+    const bool written =
+            file.resize( offsets.back() ) &&
+            file.writeAt( 0u, prefix.data(), prefix.size() ) &&
+            file.writeAt( prefix.size(), headerBytes.data(),
+                          headerBytes.size() ) &&
+            KDFile::forEach( chunks.size(), m_options.ioThreads,
+                             [ & ]( const size_t chunk )
+                             {
+                                 return file.writeAt( offsets[ chunk ],
+                                                      chunks[ chunk ].data(),
+                                                      chunks[ chunk ].size() );
+                             } );
+
+    if ( !written )
+    {
+        std::cerr << "KDTree:serialize() is unable to write "
+                  << "'" << filename << "'"
+                  << std::endl;
+    }
+
+    return written;
+}
+
+template< typename T, typename I, typename A >
+void
+KDTree< T, I, A >::serializeChunkedTop(
+        const NodePtr&           root,
+        const size_t             depth,
+        const size_t             axisBits,
+        KDCodec::BitWriter&      structure,
+        std::vector< T >&        values,
+        std::vector< uint64_t >& leaves,
+        std::vector< NodePtr >&  subtrees ) const
+{
+    // Handle special case of an empty tree
+    if ( nullptr == root )
+    {
+        return;
+    }
+
+    if ( root->isLeaf() || ( depth >= m_options.chunkDepth ) )
+    {
+        structure.write( 1u, 1u );
+        leaves.push_back( subtrees.size() );
+        subtrees.push_back( root );
+        return;
+    }
+
+    structure.write( 0u, 1u );
+    structure.write( root->hyperplane().hyperplaneIndex(), axisBits );
+    values.push_back( root->hyperplane().value() );
+
+    serializeChunkedTop( root->left(),  depth + 1u, axisBits, structure,
+                         values, leaves, subtrees );
+    serializeChunkedTop( root->right(), depth + 1u, axisBits, structure,
+                         values, leaves, subtrees );
+}
+
+template< typename T, typename I, typename A >
+bool
+KDTree< T, I, A >::deserializeChunked( const std::string& filename )
+{
+    KDFile file;
+    if ( !file.open( filename, KDFile::READ ) )
+    {
+        std::cerr << "KDTree< T >::deserialize() is unable to open "
+                  << "'" << filename << "' for reading"
+                  << std::endl;
+        return false;
+    }
+
+    // First the header, past the magic
+    const uint64_t fileSize = file.size();
+    const size_t   magicSize = Constants::KDTREE_CHUNKED_MAGIC.size();
+    uint64_t headerSize;
+    if ( !file.readAt( magicSize, &headerSize, sizeof( headerSize ) ) ||
+         ( headerSize > fileSize - magicSize - sizeof( headerSize ) ) )
+    {
+        std::cerr << "Malformed header encountered in "
+                  << "KDTree::deserialize()"
+                  << std::endl;
+        return false;
+    }
+
+    std::string headerBytes( static_cast< size_t >( headerSize ), '\0' );
+    if ( headerSize &&
+         !file.readAt( magicSize + sizeof( headerSize ), &headerBytes[ 0 ],
+                       headerBytes.size() ) )
+    {
+        return false;
+    }
+    std::istringstream header( headerBytes );
+
+    uint64_t typeSize;
+    if ( !KDCodec::readVarint( header, typeSize ) ||
+         ( typeSize > Constants::KDTREE_COMPACT_MAX_TYPE_SIZE ) )
+    {
+        std::cerr << "Malformed tree type encountered in "
+                  << "KDTree::deserialize()"
+                  << std::endl;
+        return false;
+    }
+
+    std::string type( typeSize, '\0' );
+    if ( typeSize )
+    {
+        header.read( &type[ 0 ], typeSize );
+    }
+
+    const std::string previousType = m_type;
+    const KDTreeOptions::SplitPolicy previousPolicy = m_options.splitPolicy;
+    if ( !header || !adoptType( type ) )
+    {
+        return false;
+    }
+
+    uint64_t flags, compression, valueSize, dimension, numPoints;
+    uint64_t chunkPoints, numSubtrees;
+    std::vector< SerializedNode > top;
+    bool valid = KDCodec::readVarint( header, flags )       &&
+                 KDCodec::readVarint( header, compression ) &&
+                 KDCodec::readVarint( header, valueSize )   &&
+                 KDCodec::readVarint( header, dimension )   &&
+                 KDCodec::readVarint( header, numPoints )   &&
+                 KDCodec::readVarint( header, chunkPoints ) &&
+                 KDCodec::readVarint( header, numSubtrees ) &&
+                 ( compression <= KDTreeOptions::BYTE_SHUFFLE_POINTS ) &&
+                 ( valueSize == sizeof( T ) ) &&
+                 ( !numPoints || ( dimension && chunkPoints ) ) &&
+                 ( numPoints < static_cast< uint64_t >(
+                                       Constants::errorIndex< I >() ) ) &&
+                 ( numPoints <= fileSize ) &&
+                 ( !numPoints ||
+                   ( dimension <= std::numeric_limits< uint64_t >::max() /
+                                  numPoints ) ) &&
+                 ( numSubtrees <= numPoints ) &&
+                 ( !numPoints == !numSubtrees );
+
+    const KDTreeOptions::PointCompression pointCompression =
+            static_cast< KDTreeOptions::PointCompression >( compression );
+
+    // Second the splits above the subtrees, which must refer to every one
+    // of them in order
+    valid = valid &&
+            readStructure( header, static_cast< size_t >( dimension ),
+                           static_cast< size_t >( numSubtrees ),
+                           pointCompression, top );
+    size_t numTopNodes = 0u;
+    for ( size_t i = 0; valid && ( i < top.size() ); ++i )
+    {
+        if ( top[ i ].isLeaf )
+        {
+            valid = top[ i ].index == numTopNodes;
+            ++numTopNodes;
+        }
+    }
+    valid = valid && ( numTopNodes == numSubtrees );
+
+    // Third the chunk sizes, which must add up to the file size
+    const size_t numPointChunks = valid && numPoints ?
+            static_cast< size_t >( numPoints / chunkPoints +
+                                   ( numPoints % chunkPoints ? 1u : 0u ) ) :
+            0u;
+    const size_t numChunks = numPointChunks +
+                             static_cast< size_t >( numSubtrees );
+    std::vector< uint64_t > offsets( 1u, magicSize + sizeof( headerSize ) +
+                                         headerSize );
+    offsets.reserve( numChunks + 1u );
+    for ( size_t i = 0; valid && ( i < numChunks ); ++i )
+    {
+        uint64_t chunkSize;
+        valid = KDCodec::readVarint( header, chunkSize ) &&
+                ( chunkSize <= fileSize - offsets.back() );
+        offsets.push_back( offsets.back() + chunkSize );
+    }
+
+    // Points are decoded into memory sized by the header, so every chunk
+    // must be large enough to hold them
+    for ( size_t chunk = 0; valid && ( chunk < numPointChunks ); ++chunk )
+    {
+        const uint64_t begin = chunk * chunkPoints;
+        const uint64_t count = std::min( numPoints - begin, chunkPoints );
+        valid = KDCodec::minEncodedSize( count * dimension, dimension,
+                                         sizeof( T ), pointCompression ) <=
+                offsets[ chunk + 1u ] - offsets[ chunk ];
+    }
+
+    if ( !valid || ( fileSize != offsets.back() ) )
+    {
+        std::cerr << "Malformed header encountered in "
+                  << "KDTree::deserialize()"
+                  << std::endl;
+        m_type                = previousType;
+        m_options.splitPolicy = previousPolicy;
+        return false;
+    }
+
+    // Fourth all the chunks at once
+    StoredPoints points( static_cast< size_t >( numPoints ) );
+    std::vector< std::vector< SerializedNode > > subtreeNodes(
+            static_cast< size_t >( numSubtrees ) );
+    valid = KDFile::forEach( numChunks, m_options.ioThreads,
+            [ & ]( const size_t chunk )
+            {
+                std::string bytes( static_cast< size_t >(
+                        offsets[ chunk + 1u ] - offsets[ chunk ] ), '\0' );
+                if ( !bytes.empty() &&
+                     !file.readAt( offsets[ chunk ], &bytes[ 0 ],
+                                   bytes.size() ) )
+                {
+                    return false;
+                }
+                std::istringstream in( bytes );
+
+                if ( chunk >= numPointChunks )
+                {
+                    std::vector< SerializedNode >& nodes =
+                            subtreeNodes[ chunk - numPointChunks ];
+                    return readStructure( in,
+                                          static_cast< size_t >( dimension ),
+                                          static_cast< size_t >( numPoints ),
+                                          pointCompression, nodes ) &&
+                           !nodes.empty();
+                }
+
+                const size_t begin = chunk * chunkPoints;
+                const size_t end   = std::min( points.size(),
+                                               begin + chunkPoints );
+                const size_t d     = static_cast< size_t >( dimension );
+                std::vector< T > coordinates;
+                if ( !KDCodec::decodeValues( in, ( end - begin ) * d, d,
+                                             pointCompression,
+                                             coordinates ) )
+                {
+                    return false;
+                }
+
+                for ( size_t i = begin; i < end; ++i )
+                {
+                    points[ i ].assign(
+                            coordinates.begin() + ( i - begin ) * d,
+                            coordinates.begin() + ( i - begin + 1u ) * d );
+                }
+                return true;
+            } );
+
+    size_t numNodes = top.size() - numTopNodes;
+    for ( size_t i = 0; i < subtreeNodes.size(); ++i )
+    {
+        numNodes += subtreeNodes[ i ].size();
+    }
+
+    // Points in leaf order follow the leaves of the subtrees in turn
+    std::vector< size_t > leaves;
+    for ( size_t i = 0; valid && ( flags & 4u ) &&
+                        ( i < subtreeNodes.size() ); ++i )
+    {
+        for ( size_t j = 0; j < subtreeNodes[ i ].size(); ++j )
+        {
+            if ( subtreeNodes[ i ][ j ].isLeaf )
+            {
+                leaves.push_back( subtreeNodes[ i ][ j ].index );
+            }
+        }
+    }
+
+    if ( !valid || ( numNodes != ( numPoints ? 2u * numPoints - 1u : 0u ) ) ||
+         ( ( flags & 4u ) && !leafOrderToInputOrder( leaves, points ) ) )
+    {
+        std::cerr << "Malformed chunk encountered in "
+                  << "KDTree::deserialize()"
+                  << std::endl;
+        m_type                = previousType;
+        m_options.splitPolicy = previousPolicy;
+        return false;
+    }
+
+    m_points = std::move( points );
+    m_externalPoints = PointsView();
+    m_permutation.clear();
+    m_inversePermutation.clear();
+
+    m_options.fileFormat       = KDTreeOptions::CHUNKED_FORMAT;
+    m_options.pointCompression = pointCompression;
+    if ( flags & 1u )
+    {
+        m_options.nodeLayout = KDTreeOptions::VAN_EMDE_BOAS_LAYOUT;
+    }
+    if ( flags & 2u )
+    {
+        m_options.pointOrder = KDTreeOptions::LEAF_ORDER;
+    }
+
+    // Fifth the structure. Arenas are not thread safe, so only separately
+    // allocated subtrees are linked concurrently.
+    beginNodes( numNodes );
+    std::vector< NodePtr > subtrees( subtreeNodes.size() );
+    KDFile::forEach( subtrees.size(), m_arena ? 1u : m_options.ioThreads,
+                     [ & ]( const size_t subtree )
+                     {
+                         subtrees[ subtree ] =
+                                 linkNodes( subtreeNodes[ subtree ] );
+                         return true;
+                     } );
+    m_root = linkNodes( top, &subtrees );
+
+    reorderPoints();
+    quantizePoints();
+    endNodes();
+
+    return true;
+}
+
+template< typename T, typename I, typename A >
+bool
+KDTree< T, I, A >::adoptType( const std::string& type )
+{
+    // Plain trees accept any split policy
+    KDTreeOptions::SplitPolicy policy;
+    if ( ( type != m_type ) &&
+         isPolicyType( m_type, policy ) && isPolicyType( type, policy ) )
+    {
+        m_type                = type;
+        m_options.splitPolicy = policy;
+    }
+
+    if ( type != m_type )
+    {
+        std::cerr << "Tree type mismatch encountered in"
+                  << "KDTree::deserialize() "
+                  << "expected    : '" << m_type << "', "
+                  << "encountered : '" << type   << "'"
+                  << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+template< typename T, typename I, typename A >
+const Types::Point< T >
+KDTree< T, I, A >::nearestPoint(
+        const Types::Point< T >& pointOfInterest ) const
+{
+    return nearestPointView( pointOfInterest ).toPoint();
+}
+
+template< typename T, typename I, typename A >
+size_t
+KDTree< T, I, A >::nearestPointIndex(
+        const Types::Point< T >& pointOfInterest ) const
+{
+    return nearestPointIndexWrapper( KDPointView< T >( pointOfInterest ) );
+}
+
+template< typename T, typename I, typename A >
+size_t
+KDTree< T, I, A >::nearestPointIndex( const T*     pointOfInterest,
+                                const size_t dimension ) const
+{
+    return nearestPointIndexWrapper( KDPointView< T >( pointOfInterest,
+                                                       dimension ) );
+}
+
+template< typename T, typename I, typename A >
+size_t
+KDTree< T, I, A >::nearestPointIndexWrapper(
+        const KDPointView< T >& pointOfInterest ) const
+{
+    // Sanity
+    if ( pointsView().size() &&
+         storedPoint( 0u ).size() != pointOfInterest.size() )
+    {
+        std::cerr << "Point cardinality mismatch. Point of interest has "
+                  << "cardinality = " << pointOfInterest.size() << " "
+                  << "while points stored in the tree have "
+                  << "cardinality = " << storedPoint( 0u ).size()
+                  << std::endl;
+        return Constants::KDTREE_ERROR_INDEX;
+    }
+
+    return inputIndex( nearestPointIndexHelper(
+                               m_root,
+                               pointOfInterest,
+                               Constants::KDTREE_ERROR_INDEX ) );
+}
+
+template< typename T, typename I, typename A >
+KDPointView< T >
+KDTree< T, I, A >::nearestPointView(
+        const Types::Point< T >& pointOfInterest ) const
+{
+    return pointAt( nearestPointIndex( pointOfInterest ) );
+}
+
+template< typename T, typename I, typename A >
+KDPointView< T >
+KDTree< T, I, A >::nearestPointView( const T*     pointOfInterest,
+                               const size_t dimension ) const
+{
+    return pointAt( nearestPointIndex( pointOfInterest, dimension ) );
+}
+
+template< typename T, typename I, typename A >
+KDPointView< T >
+KDTree< T, I, A >::pointAt( const size_t index ) const
+{
+    if ( index >= pointsView().size() )
+    {
+        return KDPointView< T >();
+    }
+
+    return storedPoint( storageIndex( index ) );
+}
+
+template< typename T, typename I, typename A >
+typename KDTree< T, I, A >::PointsView
+KDTree< T, I, A >::pointsView() const
+{
+    if ( !ownsPoints() )
+    {
+        return m_externalPoints;
+    }
+
+    return PointsView( m_points );
+}
+
+template< typename T, typename I, typename A >
+const Types::Points< T >
+KDTree< T, I, A >::points() const
+{
+    if ( m_permutation.empty() )
+    {
+        return pointsView().toPoints();
+    }
+
+    Types::Points< T > inputOrder;
+    inputOrder.reserve( m_inversePermutation.size() );
+    for ( size_t i = 0; i < m_inversePermutation.size(); ++i )
+    {
+        inputOrder.push_back( pointAt( i ).toPoint() );
+    }
+
+    return inputOrder;
+}
+
+template< typename T, typename I, typename A >
+bool
+KDTree< T, I, A >::ownsPoints() const
+{
+    return !m_externalPoints.isStrided();
+}
+
+template< typename T, typename I, typename A >
+void
+KDTree< T, I, A >::beginNodes( const size_t numNodes )
+{
+    m_profile = KDBuildProfile();
+
+    if ( KDTreeOptions::ARENA_NODES != m_options.nodeAllocation )
+    {
+        m_arena.reset();
+        return;
+    }
+
+    // Structures built earlier keep their own arenas alive through their
+    // roots, so a fresh arena is needed every time
+    m_arena = std::make_shared< NodeArena >();
+    m_arena->reserve( numNodes );
+}
+
+template< typename T, typename I, typename A >
+void
+KDTree< T, I, A >::endNodes()
+{
+    if ( m_arena && m_root )
+    {
+        m_root = NodePtr( m_arena, m_root.get() );
+    }
+
+    if ( ( KDTreeOptions::VAN_EMDE_BOAS_LAYOUT == m_options.nodeLayout ) &&
+         m_root )
+    {
+        relayout();
+    }
+}
+
+template< typename T, typename I, typename A >
+void
+KDTree< T, I, A >::reorderPoints()
+{
+    if ( ( KDTreeOptions::LEAF_ORDER != m_options.pointOrder ) ||
+         !ownsPoints() || !m_root )
+    {
+        return;
+    }
+
+    std::vector< Node* > leaves;
+    leaves.reserve( m_points.size() );
+    collectLeaves( m_root, leaves );
+
+    // Sanity, every point has to be referred to by exactly one leaf
+    IndexContainer permutation;
+    IndexContainer inversePermutation( m_points.size(),
+                                       Constants::errorIndex< I >() );
+    permutation.reserve( leaves.size() );
+    for ( size_t i = 0; i < leaves.size(); ++i )
+    {
+        const size_t index = leaves[ i ]->leafPointIndex();
+        if ( ( index >= inversePermutation.size() ) ||
+             ( Constants::errorIndex< I >() != inversePermutation[ index ] ) )
+        {
+            std::cerr << "KDTree< T >::reorderPoints() leaves do not refer "
+                      << "to every point exactly once, keeping input order"
+                      << std::endl;
+            return;
+        }
+
+        inversePermutation[ index ] = static_cast< I >( i );
+        permutation.push_back( static_cast< I >( index ) );
+    }
+    if ( permutation.size() != m_points.size() )
+    {
+        std::cerr << "KDTree< T >::reorderPoints() leaves do not refer "
+                  << "to every point exactly once, keeping input order"
+                  << std::endl;
+        return;
+    }
+
+    StoredPoints reordered;
+    reordered.reserve( m_points.size() );
+    for ( size_t i = 0; i < permutation.size(); ++i )
+    {
+        reordered.push_back( std::move( m_points[ permutation[ i ] ] ) );
+
+        // The structure is not shared with anyone yet
+        *leaves[ i ] = Node( i );
+    }
+
+    m_points.swap( reordered );
+    m_permutation.swap( permutation );
+    m_inversePermutation.swap( inversePermutation );
+}
+
+template< typename T, typename I, typename A >
+void
+KDTree< T, I, A >::restoreInputOrder()
+{
+    if ( m_permutation.empty() )
+    {
+        return;
+    }
+
+    StoredPoints inputOrder;
+    inputOrder.reserve( m_points.size() );
+    for ( size_t i = 0; i < m_inversePermutation.size(); ++i )
+    {
+        inputOrder.push_back(
+                std::move( m_points[ m_inversePermutation[ i ] ] ) );
+    }
+
+    m_points.swap( inputOrder );
+    m_permutation.clear();
+    m_inversePermutation.clear();
+}
+
+template< typename T, typename I, typename A >
+void
+KDTree< T, I, A >::quantizePoints()
+{
+    if ( KDTreeOptions::FULL_PRECISION == m_options.pointPrecision )
+    {
+        m_quantized.reset();
+        return;
+    }
+
+    m_quantized = std::make_shared< const KDQuantizedPoints< T > >(
+                          pointsView(),
+                          m_options.pointPrecision );
+}
+
+template< typename T, typename I, typename A >
+uint64_t
+KDTree< T, I, A >::profileClock() const
+{
+    return m_options.profileBuild ? KDBuildProfile::now() : 0u;
+}
+
+template< typename T, typename I, typename A >
+void
+KDTree< T, I, A >::profileLap( uint64_t& phase, uint64_t& clock ) const
+{
+    if ( !m_options.profileBuild )
+    {
+        return;
+    }
+
+    const uint64_t now = KDBuildProfile::now();
+    phase += now - clock;
+    clock  = now;
+}
+
+template< typename T, typename I, typename A >
+size_t
+KDTree< T, I, A >::inputIndex( const size_t storageIndex ) const
+{
+    if ( m_permutation.empty() || ( storageIndex >= m_permutation.size() ) )
+    {
+        return storageIndex;
+    }
+
+    return static_cast< size_t >( m_permutation[ storageIndex ] );
+}
+
+template< typename T, typename I, typename A >
+size_t
+KDTree< T, I, A >::storageIndex( const size_t inputIndex ) const
+{
+    if ( m_inversePermutation.empty() ||
+         ( inputIndex >= m_inversePermutation.size() ) )
+    {
+        return inputIndex;
+    }
+
+    return static_cast< size_t >( m_inversePermutation[ inputIndex ] );
+}
+
+template< typename T, typename I, typename A >
+void
+KDTree< T, I, A >::collectLeaves( const NodePtr&         root,
+                                  std::vector< Node* >&  leaves )
+{
+    if ( !root )
+    {
+        return;
+    }
+
+    // Right subtrees wait on the stack while the left ones are walked
+    std::vector< Node* > pending( 1u, root.get() );
+    while ( !pending.empty() )
+    {
+        Node* node = pending.back();
+        pending.pop_back();
+
+        if ( node->isLeaf() )
+        {
+            leaves.push_back( node );
+            continue;
+        }
+
+        if ( node->right() )
+        {
+            pending.push_back( node->right().get() );
+        }
+        if ( node->left() )
+        {
+            pending.push_back( node->left().get() );
+        }
+    }
+}
+
+template< typename T, typename I, typename A >
+void
+KDTree< T, I, A >::relayout()
+{
+    std::vector< Node* >  nodes;
+    std::vector< size_t > children;
+    const size_t levels = flattenPreorder( m_root, nodes, children );
+
+    std::vector< size_t > order;
+    vanEmdeBoasOrder( children, levels, order );
+
+    // Arena slot of every node, by preorder position
+    std::vector< size_t > positions( nodes.size() );
+    for ( size_t i = 0; i < order.size(); ++i )
+    {
+        positions[ order[ i ] ] = i;
+    }
+
+    // Default construct all the nodes first, so that children can be
+    // linked regardless of whether they precede or follow their parents
+    std::shared_ptr< NodeArena > arena = std::make_shared< NodeArena >();
+    arena->reserve( order.size() );
+
+    std::vector< Node* > slots;
+    slots.reserve( order.size() );
+    for ( size_t i = 0; i < order.size(); ++i )
+    {
+        slots.push_back( arena->create() );
+    }
+
+    for ( size_t i = 0; i < order.size(); ++i )
+    {
+        const size_t position = order[ i ];
+        const Node&  node     = *nodes[ position ];
+        if ( node.isLeaf() )
+        {
+            *slots[ i ] = Node( node.leafPointIndex() );
+            continue;
+        }
+
+        const size_t leftChild  = children[ 2u * position ];
+        const size_t rightChild = children[ 2u * position + 1u ];
+
+        NodePtr left;
+        NodePtr right;
+        if ( Constants::KDTREE_NO_NODE != leftChild )
+        {
+            left = NodePtr( NodePtr(), slots[ positions[ leftChild ] ] );
+        }
+        if ( Constants::KDTREE_NO_NODE != rightChild )
+        {
+            right = NodePtr( NodePtr(), slots[ positions[ rightChild ] ] );
+        }
+
+        *slots[ i ] = Node( node.hyperplane(), left, right );
+    }
+
+    // Releases the build order nodes, unless shared with a copy
+    m_arena = arena;
+    m_root  = NodePtr( m_arena, slots[ 0 ] );
+}
+
+template< typename T, typename I, typename A >
+size_t
+KDTree< T, I, A >::flattenPreorder( const NodePtr&          root,
+                                    std::vector< Node* >&   nodes,
+                                    std::vector< size_t >&  children )
+{
+    nodes.clear();
+    children.clear();
+    if ( !root )
+    {
+        return 0u;
+    }
+
+    // Pending node, the entry of children that links it to its parent and
+    // its depth
+    struct Pending
+    {
+        Node*  node;
+        size_t link;
+        size_t depth;
+    };
+
+    size_t levels = 0u;
+    std::vector< Pending > pending;
+    const Pending first = { root.get(), Constants::KDTREE_NO_NODE, 0u };
+    pending.push_back( first );
+    while ( !pending.empty() )
+    {
+        const Pending current = pending.back();
+        pending.pop_back();
+
+        const size_t position = nodes.size();
+        nodes.push_back( current.node );
+        children.push_back( Constants::KDTREE_NO_NODE );
+        children.push_back( Constants::KDTREE_NO_NODE );
+        if ( Constants::KDTREE_NO_NODE != current.link )
+        {
+            children[ current.link ] = position;
+        }
+        levels = std::max( levels, current.depth + 1u );
+
+        // Right first, so that the left subtree is listed before it
+        if ( current.node->right() )
+        {
+            const Pending right = { current.node->right().get(),
+                                    2u * position + 1u,
+                                    current.depth + 1u };
+            pending.push_back( right );
+        }
+        if ( current.node->left() )
+        {
+            const Pending left = { current.node->left().get(),
+                                   2u * position,
+                                   current.depth + 1u };
+            pending.push_back( left );
+        }
+    }
+
+    return levels;
+}
+
+template< typename T, typename I, typename A >
+void
+KDTree< T, I, A >::vanEmdeBoasOrder( const std::vector< size_t >&  children,
+                                     const size_t                  levels,
+                                     std::vector< size_t >&        order )
+{
+    order.clear();
+    if ( children.empty() || !levels )
+    {
+        return;
+    }
+
+    // Subtrees still to be laid out, as preorder position of their root and
+    // number of levels, the next one last
+    std::vector< std::pair< size_t, size_t > > tasks;
+    tasks.push_back( std::make_pair( size_t( 0u ), levels ) );
+
+    std::vector< std::pair< size_t, size_t > > frontier;
+    std::vector< size_t >                      bottomRoots;
+    while ( !tasks.empty() )
+    {
+        const size_t root       = tasks.back().first;
+        const size_t rootLevels = tasks.back().second;
+        tasks.pop_back();
+
+        if ( 1u == rootLevels )
+        {
+            order.push_back( root );
+            continue;
+        }
+
+        // Top half of the levels first, then every bottom subtree
+        const size_t topLevels    = rootLevels / 2u;
+        const size_t bottomLevels = rootLevels - topLevels;
+
+        // Roots of the bottom subtrees, exactly topLevels below root, left
+        // to right
+        bottomRoots.clear();
+        frontier.assign( 1u, std::make_pair( root, size_t( 0u ) ) );
+        while ( !frontier.empty() )
+        {
+            const size_t position = frontier.back().first;
+            const size_t depth    = frontier.back().second;
+            frontier.pop_back();
+
+            if ( topLevels == depth )
+            {
+                bottomRoots.push_back( position );
+                continue;
+            }
+
+            for ( size_t side = 2u; side-- > 0u; )
+            {
+                const size_t child = children[ 2u * position + side ];
+                if ( Constants::KDTREE_NO_NODE != child )
+                {
+                    frontier.push_back( std::make_pair( child, depth + 1u ) );
+                }
+            }
+        }
+
+        for ( typename std::vector< size_t >::const_reverse_iterator it =
+                    bottomRoots.crbegin();
+              it != bottomRoots.crend(); ++it )
+        {
+            tasks.push_back( std::make_pair( *it, bottomLevels ) );
+        }
+        tasks.push_back( std::make_pair( root, topLevels ) );
+    }
+}
+
+template< typename T, typename I, typename A >
+typename KDTree< T, I, A >::NodePtr
+KDTree< T, I, A >::makeLeaf( const size_t leafPointIndex ) const
+{
+    if ( m_arena )
+    {
+        // Non-owning pointer, the arena owns the node
+        return NodePtr( NodePtr(), m_arena->create( leafPointIndex ) );
+    }
+
+    return Node::create( leafPointIndex );
+}
+
+template< typename T, typename I, typename A >
+typename KDTree< T, I, A >::NodePtr
+KDTree< T, I, A >::makeNode( const KDHyperplane< T >& hyperplane,
+                             const NodePtr&           left,
+                             const NodePtr&           right ) const
+{
+    if ( m_arena )
+    {
+        // Children must not own arena nodes either, otherwise the arena
+        // would keep itself alive
+        const NodePtr leftView(  NodePtr(), left.get()  );
+        const NodePtr rightView( NodePtr(), right.get() );
+
+        return NodePtr( NodePtr(), m_arena->create( hyperplane,
+                                                    leftView,
+                                                    rightView ) );
+    }
+
+    return Node::create( hyperplane, left, right );
+}
+
+template< typename T, typename I, typename A >
+KDPointView< T >
+KDTree< T, I, A >::storedPoint( const size_t index ) const
+{
+    if ( !ownsPoints() )
+    {
+        return m_externalPoints[ index ];
+    }
+
+    return KDPointView< T >( m_points[ index ].data(),
+                             m_points[ index ].size() );
+}
+
+template< typename T, typename I, typename A >
+const std::string&
+KDTree< T, I, A >::type() const
+{
+    return m_type;
+}
+
+template< typename T, typename I, typename A >
+const KDTreeOptions&
+KDTree< T, I, A >::options() const
+{
+    return m_options;
+}
+
+template< typename T, typename I, typename A >
+typename KDTree< T, I, A >::NodePtr
+KDTree< T, I, A >::root() const
+{
+    return m_root;
+}
+
+template< typename T, typename I, typename A >
+const KDBuildProfile&
+KDTree< T, I, A >::buildProfile() const
+{
+    return m_profile;
+}
+
+template< typename T, typename I, typename A >
+const KDHyperplane< T >
+KDTree< T, I, A >::chooseBestSplit( const IndexContainer& indexes ) const
+{
+    Types::Points< T > tempPoints;
+    tempPoints.reserve( indexes.size() );
+
+    for ( typename IndexContainer::const_iterator it = indexes.cbegin();
+          it != indexes.cend(); ++it )
+    {
+        tempPoints.push_back( storedPoint( *it ).toPoint() );
+    }
+
+    const size_t axis  = Utils::axisOfHighestVariance( tempPoints );
+    const T      value = Utils::medianValueInAxis( tempPoints, axis );
+
+    return KDHyperplane< T >( axis, value );
+}
+
+template< typename T, typename I, typename A >
+void
+KDTree< T, I, A >::buildWrapper()
+{
+    uint64_t start = profileClock();
+
+    // Indexes of a fresh structure are input order indexes
+    restoreInputOrder();
+
+    IndexContainer globalIndexes;
+    const size_t numPoints = pointsView().size();
+
+    // Sanity
+    if ( numPoints >= static_cast< size_t >( Constants::errorIndex< I >() ) )
+    {
+        std::cerr << "KDTree< T >::buildWrapper() " << numPoints << " "
+                  << "points exceed the capacity of the index type"
+                  << std::endl;
+        m_root.reset();
+        return;
+    }
+
+    globalIndexes.reserve( numPoints );
+    for ( size_t i = 0; i < numPoints; ++i )
+    {
+        globalIndexes.push_back( i );
+    }
+
+    // Every leaf holds a single point, hence 2n-1 nodes
+    uint64_t clock = profileClock();
+    beginNodes( numPoints ? 2u * numPoints - 1u : 0u );
+    profileLap( m_profile.allocationNanoseconds, clock );
+
+    if ( ( KDTreeOptions::PRESORTED_BUILDER   == m_options.builder ) &&
+         ( KDTreeOptions::WIDEST_RANGE_MEDIAN == m_options.splitPolicy ) )
+    {
+        m_root = buildPresorted();
+    }
+    else if ( KDTreeOptions::MORTON_BUILDER == m_options.builder )
+    {
+        m_root = buildMorton();
+    }
+    else
+    {
+        m_root = build( globalIndexes );
+    }
+
+    clock = profileClock();
+    reorderPoints();
+    quantizePoints();
+    endNodes();
+    profileLap( m_profile.finishNanoseconds, clock );
+    profileLap( m_profile.totalNanoseconds, start );
+}
+
+template< typename T, typename I, typename A >
+typename KDTree< T, I, A >::NodePtr
+KDTree< T, I, A >::build( const IndexContainer& indexes )
+{
+    // The root cell is the bounding box of the points
+    Types::AxisMinMax< T > cell;
+    if ( KDTreeOptions::SLIDING_MIDPOINT == m_options.splitPolicy )
+    {
+        cell = bounds( indexes );
+    }
+
+    return build( indexes, cell, 0u );
+}
+
+template< typename T, typename I, typename A >
+typename KDTree< T, I, A >::NodePtr
+KDTree< T, I, A >::build( const IndexContainer&         indexes,
+                          const Types::AxisMinMax< T >& cell,
+                          const size_t                  depth )
+{
+    // Sanity
+    if ( !indexes.size() )
+    {
+        std::cerr << "KDTree< T >::build() points container is empty"
+                  << std::endl;
+        return NodePtr( nullptr );
+    }
+
+    // Base Case
+    uint64_t clock = profileClock();
+    if ( indexes.size() == 1u )
+    {
+        // Make a leaf node
+        typename IndexContainer::const_iterator it = indexes.cbegin();
+        NodePtr leaf( makeLeaf( *it ) );
+        profileLap( m_profile.allocationNanoseconds, clock );
+
+        return leaf;
+    }
+
+    // Recursive case
+    IndexContainer leftIndexes;
+    IndexContainer rightIndexes;
+
+    const KDHyperplane< T > split = chooseSplit( indexes, cell, depth );
+    profileLap( m_profile.splitNanoseconds, clock );
+
+    const KDHyperplane< T > hyperplane = partition( indexes,
+                                                    split,
+                                                    leftIndexes,
+                                                    rightIndexes );
+    profileLap( m_profile.partitionNanoseconds, clock );
+
+    Types::AxisMinMax< T > leftCell( cell );
+    Types::AxisMinMax< T > rightCell( cell );
+    if ( hyperplane.hyperplaneIndex() < cell.size() )
+    {
+        leftCell[  hyperplane.hyperplaneIndex() ].second = hyperplane.value();
+        rightCell[ hyperplane.hyperplaneIndex() ].first  = hyperplane.value();
+    }
+
+    NodePtr leftSubtree(  build( leftIndexes,  leftCell,  depth + 1u ) );
+    NodePtr rightSubtree( build( rightIndexes, rightCell, depth + 1u ) );
+
+    clock = profileClock();
+    NodePtr node( makeNode( hyperplane, leftSubtree, rightSubtree ) );
+    profileLap( m_profile.allocationNanoseconds, clock );
+
+    return node;
+}
+
+template< typename T, typename I, typename A >
+const KDHyperplane< T >
+KDTree< T, I, A >::chooseSplit( const IndexContainer&         indexes,
+                                const Types::AxisMinMax< T >& cell,
+                                const size_t                  depth ) const
+{
+    const size_t sampleSize = m_options.splitSampleSize;
+    if ( !m_options.splitSampleThreshold                  ||
+         ( indexes.size() <= m_options.splitSampleThreshold ) ||
+         !sampleSize || ( sampleSize >= indexes.size() ) )
+    {
+        return policySplit( indexes, cell, depth );
+    }
+
+    // Draw with replacement, seeded per subset so that builds are
+    // reproducible
+    std::seed_seq seeds{ m_options.splitSampleSeed,
+                         static_cast< uint32_t >( depth ),
+                         static_cast< uint32_t >( indexes.size() ) };
+    std::mt19937 generator( seeds );
+    std::uniform_int_distribution< size_t > draw( 0u, indexes.size() - 1u );
+
+    IndexContainer sample;
+    sample.reserve( sampleSize );
+    for ( size_t i = 0; i < sampleSize; ++i )
+    {
+        sample.push_back( indexes[ draw( generator ) ] );
+    }
+
+    return policySplit( sample, cell, depth );
+}
+
+template< typename T, typename I, typename A >
+const KDHyperplane< T >
+KDTree< T, I, A >::policySplit( const IndexContainer&         indexes,
+                                const Types::AxisMinMax< T >& cell,
+                                const size_t                  depth ) const
+{
+    switch ( m_options.splitPolicy )
+    {
+    case KDTreeOptions::VARIANCE_MEDIAN:
+        return medianSplit( indexes, axisOfLargestVariance( indexes ) );
+    case KDTreeOptions::SLIDING_MIDPOINT:
+        return slidingMidpointSplit( indexes, cell );
+    case KDTreeOptions::COST_MODEL:
+        return costModelSplit( indexes );
+    case KDTreeOptions::CYCLIC_MEDIAN:
+        return medianSplit( indexes,
+                            depth % storedPoint( indexes[ 0 ] ).size() );
+    case KDTreeOptions::WIDEST_RANGE_MEDIAN:
+    default:
+        return chooseBestSplit( indexes );
+    }
+}
+
+template< typename T, typename I, typename A >
+const KDHyperplane< T >
+KDTree< T, I, A >::medianSplit( const IndexContainer& indexes,
+                                const size_t          axis ) const
+{
+    // Same median as Utils::medianValueInAxis()
+    std::vector< T > values;
+    values.reserve( indexes.size() );
+    for ( typename IndexContainer::const_iterator it = indexes.cbegin();
+          it != indexes.cend(); ++it )
+    {
+        values.push_back( storedPoint( *it )[ axis ] );
+    }
+
+    const size_t n = values.size() / 2;
+    std::nth_element( values.begin(), values.begin() + n, values.end() );
+
+    return KDHyperplane< T >( axis, values[ n ] );
+}
+
+template< typename T, typename I, typename A >
+size_t
+KDTree< T, I, A >::axisOfLargestVariance( const IndexContainer& indexes ) const
+{
+    const size_t dimension = storedPoint( indexes[ 0 ] ).size();
+
+    // Welford's running mean and sum of squared deviations, all the axes
+    // in one pass over the points
+    std::vector< double > means( dimension, 0.0 );
+    std::vector< double > deviations( dimension, 0.0 );
+    size_t count = 0u;
+    for ( typename IndexContainer::const_iterator it = indexes.cbegin();
+          it != indexes.cend(); ++it )
+    {
+        const KDPointView< T > point = storedPoint( *it );
+        ++count;
+        for ( size_t axis = 0; axis < dimension; ++axis )
+        {
+            const double value = static_cast< double >( point[ axis ] );
+            const double delta = value - means[ axis ];
+            means[ axis ]      += delta / count;
+            deviations[ axis ] += delta * ( value - means[ axis ] );
+        }
+    }
+
+    return std::max_element( deviations.begin(), deviations.end() ) -
+           deviations.begin();
+}
+
+template< typename T, typename I, typename A >
+const KDHyperplane< T >
+KDTree< T, I, A >::slidingMidpointSplit(
+        const IndexContainer&         indexes,
+        const Types::AxisMinMax< T >& cell ) const
+{
+    // Widest side of the cell
+    size_t axis   = 0u;
+    double widest = -1.0;
+    for ( size_t i = 0; i < cell.size(); ++i )
+    {
+        const double side = static_cast< double >( cell[ i ].second ) -
+                            static_cast< double >( cell[ i ].first );
+        if ( side > widest )
+        {
+            widest = side;
+            axis   = i;
+        }
+    }
+
+    const T midpoint = static_cast< T >(
+            ( static_cast< double >( cell[ axis ].first ) +
+              static_cast< double >( cell[ axis ].second ) ) / 2.0 );
+
+    // Slide to the closest point if all of them are on one side. Points at
+    // the split go right, partition() takes care of an empty left side.
+    T lowest  = storedPoint( indexes[ 0 ] )[ axis ];
+    T highest = lowest;
+    for ( typename IndexContainer::const_iterator it = indexes.cbegin();
+          it != indexes.cend(); ++it )
+    {
+        const T value = storedPoint( *it )[ axis ];
+        lowest  = std::min( lowest,  value );
+        highest = std::max( highest, value );
+    }
+
+    if ( highest < midpoint )
+    {
+        return KDHyperplane< T >( axis, highest );
+    }
+    if ( !( lowest < midpoint ) )
+    {
+        return KDHyperplane< T >( axis, lowest );
+    }
+
+    return KDHyperplane< T >( axis, midpoint );
+}
+
+template< typename T, typename I, typename A >
+const KDHyperplane< T >
+KDTree< T, I, A >::costModelSplit( const IndexContainer& indexes ) const
+{
+    const Types::AxisMinMax< T > box = bounds( indexes );
+    const size_t dimension = box.size();
+    const size_t numBins   = Constants::KDTREE_COST_MODEL_BINS;
+
+    bool   found    = false;
+    double bestCost = 0.0;
+    KDHyperplane< T > best;
+
+    std::vector< size_t > counts( numBins );
+    std::vector< double > minimums( numBins * dimension );
+    std::vector< double > maximums( numBins * dimension );
+
+    for ( size_t axis = 0; axis < dimension; ++axis )
+    {
+        const double lower  = static_cast< double >( box[ axis ].first );
+        const double extent = static_cast< double >( box[ axis ].second ) -
+                              lower;
+        if ( !( extent > 0.0 ) )
+        {
+            continue;
+        }
+
+        // Bin the points along axis, keeping the bounding box of every bin.
+        // Binning is monotone, so every point of a bin is below every point
+        // of the following bins.
+        std::fill( counts.begin(), counts.end(), 0u );
+        std::fill( minimums.begin(), minimums.end(),
+                   std::numeric_limits< double >::max() );
+        std::fill( maximums.begin(), maximums.end(),
+                   -std::numeric_limits< double >::max() );
+
+        for ( typename IndexContainer::const_iterator it = indexes.cbegin();
+              it != indexes.cend(); ++it )
+        {
+            const KDPointView< T > point = storedPoint( *it );
+            const size_t bin = std::min( numBins - 1u, static_cast< size_t >(
+                    ( static_cast< double >( point[ axis ] ) - lower ) /
+                    extent * numBins ) );
+
+            ++counts[ bin ];
+            for ( size_t i = 0; i < dimension; ++i )
+            {
+                const double value = static_cast< double >( point[ i ] );
+                minimums[ bin * dimension + i ] =
+                        std::min( minimums[ bin * dimension + i ], value );
+                maximums[ bin * dimension + i ] =
+                        std::max( maximums[ bin * dimension + i ], value );
+            }
+        }
+
+        // Sweep the candidate planes between bins from both ends
+        std::vector< double > rightCosts( numBins, 0.0 );
+        std::vector< double > boxMin( dimension,
+                                      std::numeric_limits< double >::max() );
+        std::vector< double > boxMax( dimension,
+                                      -std::numeric_limits< double >::max() );
+        size_t rightCount = 0u;
+        for ( size_t bin = numBins; bin-- > 1u; )
+        {
+            rightCount += counts[ bin ];
+            for ( size_t i = 0; i < dimension; ++i )
+            {
+                boxMin[ i ] = std::min( boxMin[ i ],
+                                        minimums[ bin * dimension + i ] );
+                boxMax[ i ] = std::max( boxMax[ i ],
+                                        maximums[ bin * dimension + i ] );
+            }
+            rightCosts[ bin ] = rightCount ?
+                    halfPerimeter( boxMin, boxMax ) * rightCount : -1.0;
+        }
+
+        std::fill( boxMin.begin(), boxMin.end(),
+                   std::numeric_limits< double >::max() );
+        std::fill( boxMax.begin(), boxMax.end(),
+                   -std::numeric_limits< double >::max() );
+        size_t leftCount = 0u;
+        for ( size_t bin = 1u; bin < numBins; ++bin )
+        {
+            leftCount += counts[ bin - 1u ];
+            for ( size_t i = 0; i < dimension; ++i )
+            {
+                boxMin[ i ] = std::min( boxMin[ i ],
+                                        minimums[ ( bin - 1u ) * dimension + i ] );
+                boxMax[ i ] = std::max( boxMax[ i ],
+                                        maximums[ ( bin - 1u ) * dimension + i ] );
+            }
+
+            if ( !leftCount || ( rightCosts[ bin ] < 0.0 ) )
+            {
+                continue;
+            }
+
+            const double cost = halfPerimeter( boxMin, boxMax ) * leftCount +
+                                rightCosts[ bin ];
+            if ( !found || ( cost < bestCost ) )
+            {
+                // Smallest coordinate on the right side separates the sides
+                double split = std::numeric_limits< double >::max();
+                for ( size_t right = bin; right < numBins; ++right )
+                {
+                    split = std::min( split,
+                                      minimums[ right * dimension + axis ] );
+                }
+
+                found    = true;
+                bestCost = cost;
+                best     = KDHyperplane< T >( axis, static_cast< T >( split ) );
+            }
+        }
+    }
+
+    // All the points coincide
+    if ( !found )
+    {
+        return medianSplit( indexes, 0u );
+    }
+
+    return best;
+}
+
+template< typename T, typename I, typename A >
+Types::AxisMinMax< T >
+KDTree< T, I, A >::bounds( const IndexContainer& indexes ) const
+{
+    Types::AxisMinMax< T > box;
+    if ( indexes.empty() )
+    {
+        return box;
+    }
+
+    const KDPointView< T > first = storedPoint( indexes[ 0 ] );
+    for ( size_t i = 0; i < first.size(); ++i )
+    {
+        box.push_back( std::pair< T, T >( first[ i ], first[ i ] ) );
+    }
+
+    for ( typename IndexContainer::const_iterator it = indexes.cbegin();
+          it != indexes.cend(); ++it )
+    {
+        const KDPointView< T > point = storedPoint( *it );
+        for ( size_t i = 0; i < box.size(); ++i )
+        {
+            box[ i ].first  = std::min( box[ i ].first,  point[ i ] );
+            box[ i ].second = std::max( box[ i ].second, point[ i ] );
+        }
+    }
+
+    return box;
+}
+
+template< typename T, typename I, typename A >
+double
+KDTree< T, I, A >::halfPerimeter( const std::vector< double >& minimums,
+                                  const std::vector< double >& maximums )
+{
+    double result = 0.0;
+    for ( size_t i = 0; i < minimums.size(); ++i )
+    {
+        result += maximums[ i ] - minimums[ i ];
+    }
+
+    return result;
+}
+
+template< typename T, typename I, typename A >
+std::string
+KDTree< T, I, A >::policyType( const KDTreeOptions::SplitPolicy policy )
+{
+    if ( KDTreeOptions::WIDEST_RANGE_MEDIAN == policy )
+    {
+        return Constants::KDTREE_SIMPLE_VARIETY;
+    }
+
+    return Constants::KDTREE_SIMPLE_VARIETY + " (" +
+           KDTreeOptions::splitPolicyName( policy ) + ")";
+}
+
+template< typename T, typename I, typename A >
+bool
+KDTree< T, I, A >::isPolicyType( const std::string&          type,
+                                 KDTreeOptions::SplitPolicy& policy )
+{
+    if ( Constants::KDTREE_SIMPLE_VARIETY == type )
+    {
+        policy = KDTreeOptions::WIDEST_RANGE_MEDIAN;
+        return true;
+    }
+
+    const std::string prefix = Constants::KDTREE_SIMPLE_VARIETY + " (";
+    if ( ( type.size() <= prefix.size() ) ||
+         ( type.compare( 0u, prefix.size(), prefix ) != 0 ) ||
+         ( type[ type.size() - 1u ] != ')' ) )
+    {
+        return false;
+    }
+
+    return KDTreeOptions::splitPolicyFromName(
+            type.substr( prefix.size(), type.size() - prefix.size() - 1u ),
+            policy );
+}
+
+template< typename T, typename I, typename A >
+typename KDTree< T, I, A >::NodePtr
+KDTree< T, I, A >::buildPresorted()
+{
+    const PointsView points    = pointsView();
+    const size_t     numPoints = points.size();
+
+    // Sanity
+    if ( !numPoints )
+    {
+        std::cerr << "KDTree< T >::buildPresorted() points container is empty"
+                  << std::endl;
+        return NodePtr( nullptr );
+    }
+
+    // Sort once per axis, ties by index so that every order is unique
+    uint64_t clock = profileClock();
+    const size_t dimension = storedPoint( 0u ).size();
+    std::vector< IndexContainer > sorted( dimension );
+    for ( size_t axis = 0; axis < dimension; ++axis )
+    {
+        IndexContainer& order = sorted[ axis ];
+        order.reserve( numPoints );
+        for ( size_t i = 0; i < numPoints; ++i )
+        {
+            order.push_back( static_cast< I >( i ) );
+        }
+
+        std::sort( order.begin(), order.end(),
+                   [ this, axis ]( const I lhs, const I rhs )
+                   {
+                       const T l = storedPoint( lhs )[ axis ];
+                       const T r = storedPoint( rhs )[ axis ];
+                       return ( l < r ) || ( !( r < l ) && ( lhs < rhs ) );
+                   } );
+    }
+
+    IndexContainer      scratch( numPoints );
+    std::vector< bool > isLeft( numPoints, false );
+    profileLap( m_profile.sortNanoseconds, clock );
+
+    return buildPresortedHelper( sorted, scratch, isLeft, 0u, numPoints );
+}
+
+template< typename T, typename I, typename A >
+typename KDTree< T, I, A >::NodePtr
+KDTree< T, I, A >::buildPresortedHelper(
+        std::vector< IndexContainer >& sorted,
+        IndexContainer&                scratch,
+        std::vector< bool >&           isLeft,
+        const size_t                   begin,
+        const size_t                   end )
+{
+    // Base Case
+    uint64_t clock = profileClock();
+    if ( end - begin == 1u )
+    {
+        NodePtr leaf( makeLeaf( sorted[ 0u ][ begin ] ) );
+        profileLap( m_profile.allocationNanoseconds, clock );
+
+        return leaf;
+    }
+
+    // Axis of the largest range, as Utils::axisOfHighestVariance()
+    size_t axis         = 0u;
+    T      largestRange = T();
+    for ( size_t i = 0; i < sorted.size(); ++i )
+    {
+        const T range = std::abs( storedPoint( sorted[ i ][ end - 1u ] )[ i ] -
+                                  storedPoint( sorted[ i ][ begin ] )[ i ] );
+        if ( !i || ( range > largestRange ) )
+        {
+            largestRange = range;
+            axis         = i;
+        }
+    }
+
+    // Median as Utils::medianValueInAxis(), left side is a prefix of the
+    // sorted order. Degenerate cases follow partition().
+    const IndexContainer& order = sorted[ axis ];
+    const T lowest = storedPoint( order[ begin ] )[ axis ];
+    T       value  = storedPoint( order[ begin + ( end - begin ) / 2u ] )[ axis ];
+
+    size_t middle = begin;
+    while ( storedPoint( order[ middle ] )[ axis ] < value )
+    {
+        ++middle;
+    }
+    if ( middle == begin )
+    {
+        while ( ( middle < end ) &&
+                !( lowest < storedPoint( order[ middle ] )[ axis ] ) )
+        {
+            ++middle;
+        }
+
+        if ( middle < end )
+        {
+            value = storedPoint( order[ middle ] )[ axis ];
+        }
+        else
+        {
+            value  = lowest;
+            middle = begin + ( end - begin ) / 2u;
+        }
+    }
+    profileLap( m_profile.splitNanoseconds, clock );
+
+    // Stable-partition the other orders the same way
+    for ( size_t i = begin; i < end; ++i )
+    {
+        isLeft[ order[ i ] ] = ( i < middle );
+    }
+    for ( size_t i = 0; i < sorted.size(); ++i )
+    {
+        if ( i == axis )
+        {
+            continue;
+        }
+
+        IndexContainer& other = sorted[ i ];
+        size_t left  = begin;
+        size_t right = middle;
+        for ( size_t j = begin; j < end; ++j )
+        {
+            if ( isLeft[ other[ j ] ] )
+            {
+                scratch[ left++ ] = other[ j ];
+            }
+            else
+            {
+                scratch[ right++ ] = other[ j ];
+            }
+        }
+        std::copy( scratch.begin() + begin,
+                   scratch.begin() + end,
+                   other.begin() + begin );
+    }
+    profileLap( m_profile.partitionNanoseconds, clock );
+
+    NodePtr leftSubtree(  buildPresortedHelper( sorted, scratch, isLeft,
+                                                begin, middle ) );
+    NodePtr rightSubtree( buildPresortedHelper( sorted, scratch, isLeft,
+                                                middle, end ) );
+
+    clock = profileClock();
+    NodePtr node( makeNode( KDHyperplane< T >( axis, value ),
+                            leftSubtree,
+                            rightSubtree ) );
+    profileLap( m_profile.allocationNanoseconds, clock );
+
+    return node;
+}
+
+template< typename T, typename I, typename A >
+typename KDTree< T, I, A >::NodePtr
+KDTree< T, I, A >::buildMorton()
+{
+    const PointsView points    = pointsView();
+    const size_t     numPoints = points.size();
+
+    // Sanity
+    if ( !numPoints )
+    {
+        std::cerr << "KDTree< T >::buildMorton() points container is empty"
+                  << std::endl;
+        return NodePtr( nullptr );
+    }
+
+    IndexContainer order;
+    order.reserve( numPoints );
+    for ( size_t i = 0; i < numPoints; ++i )
+    {
+        order.push_back( static_cast< I >( i ) );
+    }
+
+    const size_t dimension = storedPoint( 0u ).size();
+    const size_t bits      = Morton::bitsPerAxis( dimension );
+    if ( !bits )
+    {
+        std::cerr << "KDTree< T >::buildMorton() cardinality " << dimension
+                  << " is too high for Morton codes, building by medians"
+                  << std::endl;
+        return build( order );
+    }
+
+    const size_t threads = Morton::numThreads( m_options.buildThreads,
+                                               numPoints );
+
+    uint64_t clock = profileClock();
+    std::vector< Morton::Code > codes;
+    Morton::encode( points, codes, threads );
+    Morton::radixSort( codes, order, bits * dimension, threads );
+    profileLap( m_profile.sortNanoseconds, clock );
+
+    // Every level of the recursion consumes a code bit, children of a call
+    // at depth keep their minimums in the slots of depth + 1
+    std::vector< T > workspace( ( bits * dimension + 2u ) * 2u * dimension );
+    std::vector< T > minimums( dimension );
+
+    return buildMortonHelper( codes,
+                              order,
+                              0u,
+                              numPoints,
+                              0u,
+                              workspace,
+                              minimums.data() );
+}
+
+template< typename T, typename I, typename A >
+typename KDTree< T, I, A >::NodePtr
+KDTree< T, I, A >::buildMortonHelper(
+        const std::vector< Morton::Code >& codes,
+        const IndexContainer&              order,
+        const size_t                       begin,
+        const size_t                       end,
+        const size_t                       depth,
+        std::vector< T >&                  workspace,
+        T*                                 minimums )
+{
+    const size_t dimension = storedPoint( order[ begin ] ).size();
+
+    // Base Case
+    if ( end - begin == 1u )
+    {
+        const KDPointView< T > point = storedPoint( order[ begin ] );
+        std::copy( point.begin(), point.end(), minimums );
+
+        uint64_t clock = profileClock();
+        NodePtr leaf( makeLeaf( order[ begin ] ) );
+        profileLap( m_profile.allocationNanoseconds, clock );
+
+        return leaf;
+    }
+
+    // Points sharing a grid cell are split by medians
+    const Morton::Code difference = codes[ begin ] ^ codes[ end - 1u ];
+    if ( !difference )
+    {
+        const IndexContainer cell( order.begin() + begin,
+                                   order.begin() + end );
+
+        std::copy( storedPoint( cell[ 0 ] ).begin(),
+                   storedPoint( cell[ 0 ] ).end(),
+                   minimums );
+        for ( size_t i = 1; i < cell.size(); ++i )
+        {
+            const KDPointView< T > point = storedPoint( cell[ i ] );
+            for ( size_t axis = 0; axis < dimension; ++axis )
+            {
+                minimums[ axis ] = std::min( minimums[ axis ], point[ axis ] );
+            }
+        }
+
+        return build( cell );
+    }
+
+    // Split at the highest differing bit. Quantization is monotone, so every
+    // point on the left is strictly below every point on the right on the
+    // bit's axis, and the smallest coordinate on the right separates them.
+    uint64_t clock = profileClock();
+    const size_t bit  = Morton::highestBit( difference );
+    const size_t axis = Morton::axisOfBit( bit, dimension );
+    const size_t middle =
+            std::partition_point( codes.begin() + begin,
+                                  codes.begin() + end,
+                                  [ bit ]( const Morton::Code code )
+                                  {
+                                      return !( ( code >> bit ) & 1u );
+                                  } ) - codes.begin();
+    profileLap( m_profile.splitNanoseconds, clock );
+
+    T* leftMinimums  = &workspace[ ( depth + 1u ) * 2u * dimension ];
+    T* rightMinimums = leftMinimums + dimension;
+
+    NodePtr leftSubtree(  buildMortonHelper( codes, order, begin, middle,
+                                             depth + 1u, workspace,
+                                             leftMinimums ) );
+    NodePtr rightSubtree( buildMortonHelper( codes, order, middle, end,
+                                             depth + 1u, workspace,
+                                             rightMinimums ) );
+
+    for ( size_t i = 0; i < dimension; ++i )
+    {
+        minimums[ i ] = std::min( leftMinimums[ i ], rightMinimums[ i ] );
+    }
+
+    clock = profileClock();
+    NodePtr node( makeNode( KDHyperplane< T >( axis, rightMinimums[ axis ] ),
+                            leftSubtree,
+                            rightSubtree ) );
+    profileLap( m_profile.allocationNanoseconds, clock );
+
+    return node;
+}
+
+template< typename T, typename I, typename A >
+const KDHyperplane< T >
+KDTree< T, I, A >::partition( const IndexContainer&    indexes,
+                              const KDHyperplane< T >& hyperplane,
+                              IndexContainer&          leftIndexes,
+                              IndexContainer&          rightIndexes ) const
+{
+    const size_t axis = hyperplane.hyperplaneIndex();
+
+    for ( typename IndexContainer::const_iterator it = indexes.cbegin();
+          it != indexes.cend(); ++it )
+    {
+        if ( storedPoint( *it )[ axis ] < hyperplane.value() )
+        {
+            leftIndexes.push_back( *it );
+        }
+        else
+        {
+            rightIndexes.push_back( *it );
+        }
+    }
+
+    if ( !leftIndexes.empty() && !rightIndexes.empty() )
+    {
+        return hyperplane;
+    }
+
+    // Degenerate case - the split value is the smallest (or beyond the
+    // largest) value on the axis, e.g. median of a set with many ties.
+    // Split at the next distinct value instead, so that both sides are
+    // non-empty and the recursion terminates.
+    const IndexContainer& all = leftIndexes.empty() ? rightIndexes
+                                                    : leftIndexes;
+    bool found = false;
+    T lowest   = T();
+    T next     = T();
+
+    for ( typename IndexContainer::const_iterator it = all.cbegin();
+          it != all.cend(); ++it )
+    {
+        const T value = storedPoint( *it )[ axis ];
+        if ( !found || value < lowest )
+        {
+            next   = found ? lowest : value;
+            lowest = value;
+            found  = true;
+        }
+        else if ( ( value > lowest ) && ( next == lowest || value < next ) )
+        {
+            next = value;
+        }
+    }
+
+    IndexContainer candidates;
+    candidates.swap( leftIndexes.empty() ? rightIndexes : leftIndexes );
+
+    if ( next != lowest )
+    {
+        return partition( candidates,
+                          KDHyperplane< T >( axis, next ),
+                          leftIndexes,
+                          rightIndexes );
+    }
+
+    // All the points share the value on the axis. Any halving keeps points
+    // of both sides at the hyperplane distance or further from every point
+    // of interest, which is all that nearest point search relies on.
+    const size_t half = candidates.size() / 2;
+    leftIndexes.assign(  candidates.cbegin(), candidates.cbegin() + half );
+    rightIndexes.assign( candidates.cbegin() + half, candidates.cend() );
+
+    return KDHyperplane< T >( axis, lowest );
+}
+
+template< typename T, typename I, typename A >
+const size_t
+KDTree< T, I, A >::nearestPointIndexHelper(
+        const NodePtr& root,
+        const KDPointView< T >&               pointOfInterest,
+        const size_t                          bestSoFarIndex ) const
+{
+    // Base case
+    if ( nullptr == root )
+    {
+        return Constants::KDTREE_ERROR_INDEX;
+    }
+
+    if ( root->isLeaf() )
+    {
+        // Sanity
+        if ( Constants::KDTREE_ERROR_INDEX == root->leafPointIndex() )
+        {
+            std::cerr << "Internal logic error, root " << root << " must not "
+                      << "have Constants::KDTREE_ERROR_INDEX index"
+                      << std::endl;
+            return root->leafPointIndex();
+        }
+
+        // Initial greedy search
+        if ( Constants::KDTREE_ERROR_INDEX == bestSoFarIndex )
+        {
+            return root->leafPointIndex();
+        }
+
+        // Skip the stored point if its compact copy proves it to be no
+        // closer than the best so far
+        const double bestSoFarDistance =
+                Utils::distance< T >( storedPoint( bestSoFarIndex ),
+                                      pointOfInterest );
+        if ( m_quantized &&
+             ( m_quantized->lowerBound( root->leafPointIndex(),
+                                        pointOfInterest ) >=
+               bestSoFarDistance ) )
+        {
+            return bestSoFarIndex;
+        }
+
+        const KDPointView< T > leafPoint =
+                storedPoint( root->leafPointIndex() );
+
+        const double distance = Utils::distance< T >( leafPoint,
+                                                      pointOfInterest );
+
+        if ( Constants::KDTREE_INVALID_DISTANCE == distance )
+        {
+            std::cerr << "Point cardinality mismatch. Point of interest has"
+                      << "cardinality = " << pointOfInterest.size() << " "
+                      << "while points stored in the tree have "
+                      << "cardinality = " << leafPoint << " "
+                      << std::endl;
+            return Constants::KDTREE_ERROR_INDEX;
+        }
+
+        if ( distance < bestSoFarDistance )
+        {
+            return root->leafPointIndex();
+        }
+        else
+        {
+            return bestSoFarIndex;
+        }
+    }
+
+    // Sanity
+    const KDHyperplane< T > hyperplane = root->hyperplane();
+    if ( pointOfInterest.size() <= hyperplane.hyperplaneIndex() )
+    {
+        std::cerr << "Point cardinality mismatch. Point of interest has"
+                  << "cardinality = " << pointOfInterest.size() << " "
+                  << "while points stored in the tree have "
+                  << "cardinality of at least = "
+                  << hyperplane.hyperplaneIndex() << " "
+                  << std::endl;
+        return Constants::KDTREE_ERROR_INDEX;
+    }
+
+    // Recursive case
+    NodePtr greedy;
+    NodePtr other;
+
+    if ( pointOfInterest[ hyperplane.hyperplaneIndex() ] < hyperplane.value() )
+    {
+        greedy = root->left();
+        other = root->right();
+    }
+    else
+    {
+        greedy = root->right();
+        other = root->left();
+    }
+
+    // First search greedily
+    const size_t greedyBestIndex = nearestPointIndexHelper( greedy,
+                                                            pointOfInterest,
+                                                            bestSoFarIndex );
+    if ( Constants::KDTREE_ERROR_INDEX == greedyBestIndex )
+    {
+        return greedyBestIndex;
+    }
+
+    // If the distance to the greedy best is bigger than distance to the
+    // hyperplane at this node, search the other partition as well
+    if ( Utils::distance< T >( pointOfInterest, hyperplane ) <
+         Utils::distance< T >( pointOfInterest,
+                               storedPoint( greedyBestIndex ) ) )
+    {
+        return nearestPointIndexHelper( other,
+                                        pointOfInterest,
+                                        greedyBestIndex );
+    }
+
+    return greedyBestIndex;
+}
+
+//============================================================================
+//                  MANIPULATORS
+//============================================================================
+
+template< typename T, typename I, typename A >
+void
+KDTree< T, I, A >::copy( const KDTree< T, I, A >& other )
+{
+    if ( this == &other )
+    {
+        return;
+    }
+
+    m_points         = other.m_points;
+    m_externalPoints = other.m_externalPoints;
+    adoptOptions( other );
+
+    m_permutation        = other.m_permutation;
+    m_inversePermutation = other.m_inversePermutation;
+    m_quantized          = other.m_quantized;
+
+    if ( other.m_type == m_type )
+    {
+        // Arena nodes are kept alive by the root, so sharing is safe
+        m_root    = other.m_root;
+        m_arena   = other.m_arena;
+        m_profile = other.m_profile;
+    }
+    else
+    {
+        buildWrapper();
+    }
+}
+
+template< typename T, typename I, typename A >
+void
+KDTree< T, I, A >::transfer( KDTree< T, I, A >& other ) noexcept
+{
+    if ( this == &other )
+    {
+        return;
+    }
+
+    m_points         = std::move( other.m_points );
+    m_externalPoints = other.m_externalPoints;
+    other.m_points.clear();
+    other.m_externalPoints = PointsView();
+
+    adoptOptions( other );
+
+    m_permutation        = std::move( other.m_permutation );
+    m_inversePermutation = std::move( other.m_inversePermutation );
+    m_quantized          = std::move( other.m_quantized );
+    other.m_permutation.clear();
+    other.m_inversePermutation.clear();
+    other.m_quantized.reset();
+
+    if ( other.m_type == m_type )
+    {
+        m_root    = std::move( other.m_root );
+        m_arena   = std::move( other.m_arena );
+        m_profile = other.m_profile;
+    }
+    else
+    {
+        buildWrapper();
+    }
+    other.m_root.reset();
+    other.m_arena.reset();
+    other.m_profile = KDBuildProfile();
+}
+
+template< typename T, typename I, typename A >
+void
+KDTree< T, I, A >::adoptOptions( const KDTree< T, I, A >& other )
+{
+    // Type of the plain tree follows its split policy
+    KDTreeOptions::SplitPolicy policy;
+    if ( isPolicyType( m_type, policy ) )
+    {
+        m_type = policyType( other.m_options.splitPolicy );
+    }
+
+    // Any other type rebuilds with its own builder and split policy, so
+    // that its chooseBestSplit() is called rather than skipped by other's
+    const KDTreeOptions::TreeBuilder builder     = m_options.builder;
+    const KDTreeOptions::SplitPolicy splitPolicy = m_options.splitPolicy;
+    m_options = other.m_options;
+    if ( other.m_type != m_type )
+    {
+        m_options.builder     = builder;
+        m_options.splitPolicy = splitPolicy;
+    }
+}
+
+//============================================================================
+//                  ACCESSORS
+//============================================================================
+
+template< typename T, typename I, typename A >
+bool
+KDTree< T, I, A >::equals( const KDTree< T, I, A >& other ) const
+{
+    if ( m_permutation.empty() && other.m_permutation.empty() )
+    {
+        return ( ( other.type()       == m_type       ) &&
+                 ( other.pointsView() == pointsView() ) );
+    }
+
+    return ( ( other.type()   == m_type   ) &&
+             ( other.points() == points() ) );
+}
+
+template< typename T, typename I, typename A >
+std::ostream&
+KDTree< T, I, A >::print( std::ostream& out ) const
+{
+    out << "KDTree:[ "
+        << "implementation type = '" << m_type          << "', "
+        << "num points stored = "    << pointsView().size() << ", "
+        << "owns points = '" << ( ownsPoints() ? "yes" : "no" ) << "', "
+        << "options = "              << m_options       << " ] ";
+
+    return out;
+}
+
+//============================================================================
+//                  INDEPENDENT OPERATORS
+//============================================================================
+template< typename T, typename I, typename A >
+std::ostream& operator<<( std::ostream& lhs, const KDTree< T, I, A >& rhs )
+{
+    return rhs.print( lhs );
+}
+
+} // namespace datastructures
+
+#endif // KDTREE_H
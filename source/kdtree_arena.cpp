@@ -0,0 +1,5 @@
+#include "kdtree_arena.h"
+
+namespace datastructures {
+
+} // namespace datastructures
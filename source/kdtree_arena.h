@@ -0,0 +1,219 @@
+#ifndef KDTREE_ARENA_H
+#define KDTREE_ARENA_H
+
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "kdtree_constants.h"
+
+namespace datastructures {
+
+// PURPOSE:
+//
+// A class that carves nodes of type N out of large slabs obtained from
+// allocator A, and destroys all of them in a single pass.
+//
+// Nodes created by the arena are owned by the arena. Pointers between them
+// must therefore be non-owning - in case of KDNode that means std::shared_ptr
+// instances without a control block, as created by
+// std::shared_ptr< N >( std::shared_ptr< N >(), node ). Destroying such a
+// node touches neither its children nor any reference count, so teardown
+// neither recurses nor frees nodes one by one.
+//
+template< typename N, typename A = std::allocator< N > >
+class KDNodeArena {
+public:
+    // CREATORS
+    explicit KDNodeArena(
+            const size_t slabSize = Constants::KDTREE_ARENA_SLAB_SIZE );
+        // Constructor, slabSize is the number of nodes per slab used when
+        // the number of nodes is not known up front
+
+    virtual ~KDNodeArena();
+        // Destructor, calls clear()
+
+    // PRIMARY INTERFACE
+    void reserve( const size_t numNodes );
+        // Makes sure that the next numNodes nodes are carved out of a
+        // single slab
+
+    template< typename... Args >
+    N* create( Args&&... args );
+        // Constructs a node from the provided arguments in the current slab,
+        // allocates a new slab first if necessary
+
+    // MANIPULATORS
+    void clear();
+        // Destroys all the nodes and releases all the slabs
+
+    // ACCESSORS
+    size_t size() const;
+        // Returns number of nodes created so far
+
+    size_t capacity() const;
+        // Returns number of nodes that fit into the slabs allocated so far
+
+    size_t numSlabs() const;
+        // Returns number of slabs allocated so far
+
+private:
+    // NOT IMPLEMENTED
+    KDNodeArena( const KDNodeArena& );
+    KDNodeArena& operator=( const KDNodeArena& );
+
+    struct Slab {
+        N*      nodes;
+            // Storage of the slab
+
+        size_t  capacity;
+            // Number of nodes that fit into the slab
+
+        size_t  used;
+            // Number of nodes constructed in the slab
+    };
+
+    void addSlab( const size_t capacity );
+        // Allocates a new current slab
+
+    std::vector< Slab >     m_slabs;
+        // All the slabs, the last one is current
+
+    size_t                  m_slabSize;
+        // Default number of nodes per slab
+
+    size_t                  m_size;
+        // Number of nodes created so far
+
+    A                       m_allocator;
+        // Allocator of slab storage
+};
+
+//============================================================================
+//                  CREATORS
+//============================================================================
+
+template< typename N, typename A >
+KDNodeArena< N, A >::KDNodeArena( const size_t slabSize )
+: m_slabSize( slabSize ? slabSize : 1u )
+, m_size( 0u )
+{
+    // nothing to do here
+}
+
+template< typename N, typename A >
+KDNodeArena< N, A >::~KDNodeArena()
+{
+    clear();
+}
+
+//============================================================================
+//                  PRIMARY INTERFACE
+//============================================================================
+
+template< typename N, typename A >
+void
+KDNodeArena< N, A >::reserve( const size_t numNodes )
+{
+    if ( !numNodes )
+    {
+        return;
+    }
+
+    if ( m_slabs.empty() ||
+         ( m_slabs.back().capacity - m_slabs.back().used < numNodes ) )
+    {
+        addSlab( numNodes > m_slabSize ? numNodes : m_slabSize );
+    }
+}
+
+template< typename N, typename A >
+template< typename... Args >
+N*
+KDNodeArena< N, A >::create( Args&&... args )
+{
+    if ( m_slabs.empty() ||
+         ( m_slabs.back().capacity == m_slabs.back().used ) )
+    {
+        addSlab( m_slabSize );
+    }
+
+    Slab& slab = m_slabs.back();
+    N* node = new ( slab.nodes + slab.used ) N( std::forward< Args >( args )... );
+    ++slab.used;
+    ++m_size;
+
+    return node;
+}
+
+template< typename N, typename A >
+void
+KDNodeArena< N, A >::addSlab( const size_t capacity )
+{
+    Slab slab;
+    slab.nodes    = m_allocator.allocate( capacity );
+    slab.capacity = capacity;
+    slab.used     = 0u;
+
+    m_slabs.push_back( slab );
+}
+
+//============================================================================
+//                  MANIPULATORS
+//============================================================================
+
+template< typename N, typename A >
+void
+KDNodeArena< N, A >::clear()
+{
+    for ( typename std::vector< Slab >::iterator it = m_slabs.begin();
+          it != m_slabs.end(); ++it )
+    {
+        for ( size_t i = 0; i < it->used; ++i )
+        {
+            it->nodes[ i ].~N();
+        }
+
+        m_allocator.deallocate( it->nodes, it->capacity );
+    }
+
+    m_slabs.clear();
+    m_size = 0u;
+}
+
+//============================================================================
+//                  ACCESSORS
+//============================================================================
+
+template< typename N, typename A >
+size_t
+KDNodeArena< N, A >::size() const
+{
+    return m_size;
+}
+
+template< typename N, typename A >
+size_t
+KDNodeArena< N, A >::capacity() const
+{
+    size_t total = 0u;
+    for ( typename std::vector< Slab >::const_iterator it = m_slabs.cbegin();
+          it != m_slabs.cend(); ++it )
+    {
+        total += it->capacity;
+    }
+
+    return total;
+}
+
+template< typename N, typename A >
+size_t
+KDNodeArena< N, A >::numSlabs() const
+{
+    return m_slabs.size();
+}
+
+} // close namespace datastructures
+
+#endif // KDTREE_ARENA_H
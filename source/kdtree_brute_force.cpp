@@ -0,0 +1,5 @@
+#include "kdtree_brute_force.h"
+
+namespace datastructures {
+
+} // namespace datastructures
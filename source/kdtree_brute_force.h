@@ -0,0 +1,487 @@
+#ifndef KDTREE_BRUTE_FORCE_H
+#define KDTREE_BRUTE_FORCE_H
+
+#include <algorithm>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+#include "kdtree_types.h"
+#include "kdtree_point_view.h"
+#include "kdtree_constants.h"
+#include "kdtree_file.h"
+
+// @Purpose
+//
+// This class answers the same closest point queries as KDTree by measuring
+// the distance to every point. It is the ground truth KDTree and its
+// variations are checked and timed against, and may well be faster than a
+// tree on a few hundred points.
+//
+// Coordinates are copied into blocks of LANES points, axis by axis, so that
+// the distances to the points of a block are computed by the same few
+// instructions lane by lane - loops of a fixed trip count with no branches,
+// which the compiler vectorizes once optimizations are enabled. The blocks
+// are the only copy of the points the engine holds: it is built straight
+// from the points of a tree, and hands points out as copies gathered from
+// the blocks rather than as views. Distances
+// are accumulated in the order and precision of Utils::distance(), so a
+// point is as close to a query here as it is to the same query in KDTree.
+// Of several closest points, the one of the lowest index is returned.
+//
+// nearestPointIndexes() answers a batch of queries on several threads.
+// Every thread takes TASK_SIZE queries at a time and scans every block for
+// TILE queries in a row, while the block is in the cache.
+//
+
+namespace datastructures {
+
+template< typename T >
+class KDBruteForce {
+public:
+    // CREATORS
+    KDBruteForce();
+        // Default constructor, creates an empty engine
+
+    explicit KDBruteForce( const Types::Points< T >& points,
+                           const size_t              numThreads = 0u );
+        // Constructor, copies points. Logs an error and creates an empty
+        // engine in case points are of different cardinality. Batches are
+        // answered on up to numThreads threads, 0 for all hardware threads.
+
+    template< typename A >
+    explicit KDBruteForce( const KDPointsView< T, A >& points,
+                           const size_t                numThreads = 0u );
+        // Same as above, copies the viewed points, e.g. those of
+        // KDTree::pointsView() in the order the tree stores them
+
+    KDBruteForce( const T*     data,
+                  const size_t count,
+                  const size_t dimension,
+                  const size_t stride,
+                  const size_t numThreads = 0u );
+        // Same as above, copies count points of the provided dimension
+        // from a flat buffer, point i starting at data + i * stride
+
+    // PRIMARY INTERFACE
+    const Types::Point< T > nearestPoint(
+            const Types::Point< T >& pointOfInterest ) const;
+        // Returns a copy of the closest point to the point of interest.
+        // In case the engine is empty or there is a cardinality mismatch -
+        // empty point is returned
+
+    size_t nearestPointIndex( const Types::Point< T >& pointOfInterest ) const;
+        // Returns index of the closest point to the point of interest.
+        // In case the engine is empty or there is a cardinality mismatch -
+        // KDTREE_ERROR_INDEX is returned
+
+    size_t nearestPointIndex( const T*     pointOfInterest,
+                              const size_t dimension ) const;
+        // Same as above, reads dimension coordinates of the point of
+        // interest straight from the caller's buffer
+
+    void nearestPointIndexes( const T*               queries,
+                              const size_t           count,
+                              const size_t           dimension,
+                              std::vector< size_t >& indexes ) const;
+        // Sets indexes to the index of the closest point to each of count
+        // queries of the provided dimension, laid out one after another in
+        // a flat buffer. Same answers as nearestPointIndex(), on up to
+        // numThreads() threads.
+
+    const Types::Point< T > pointAt( const size_t index ) const;
+        // Returns a copy of the point under the provided index. Returns
+        // empty point in case the index is out of range.
+
+    // ACCESSORS
+    Types::Points< T > points() const;
+        // Returns a copy of the points
+
+    size_t size() const;
+        // Returns number of points
+
+    size_t dimension() const;
+        // Returns cardinality of the points
+
+    size_t numThreads() const;
+        // Returns number of threads batches are answered on, 0 for all
+        // hardware threads
+
+    std::ostream& print( std::ostream& out ) const;
+        // Prints the engine in a easy to read format
+
+private:
+    // PRIVATE CONSTANTS
+    enum {
+        LANES     = 16u,
+            // Number of points of a block
+
+        TILE      = 4u,
+            // Number of queries a block is scanned for in a row
+
+        TASK_SIZE = 64u
+            // Number of queries of a batch a thread answers at a time
+    };
+
+    template< typename Points >
+    void copyPoints( const Points& points );
+        // Fills the blocks with points, which are either Types::Points or
+        // a KDPointsView. Logs an error and leaves the engine empty in case
+        // points are of different cardinality.
+
+    void scan( const T* const* queries,
+               const size_t    numQueries,
+               size_t*         indexes ) const;
+        // Sets indexes to the index of the closest point to each of up to
+        // TILE queries of the right dimension. The engine is not empty.
+
+    bool checkDimension( const size_t dimension ) const;
+        // Returns true if queries of dimension can be answered, logs an
+        // error otherwise
+
+    std::vector< T >    m_blocks;
+        // Coordinates of the points in blocks of LANES points, every block
+        // holding one axis after another. The last block is padded.
+
+    size_t              m_size;
+        // Number of points
+
+    size_t              m_dimension;
+        // Cardinality of the points
+
+    size_t              m_numThreads;
+        // Number of threads batches are answered on
+};
+
+// INDEPENDENT OPERATORS
+template< typename T >
+std::ostream& operator<<( std::ostream& lhs, const KDBruteForce< T >& rhs );
+
+//============================================================================
+//                  CREATORS
+//============================================================================
+
+template< typename T >
+KDBruteForce< T >::KDBruteForce()
+: m_size( 0u )
+, m_dimension( 0u )
+, m_numThreads( 0u )
+{
+    // nothing to do here
+}
+
+template< typename T >
+KDBruteForce< T >::KDBruteForce( const Types::Points< T >& points,
+                                 const size_t              numThreads )
+: m_size( 0u )
+, m_dimension( 0u )
+, m_numThreads( numThreads )
+{
+    copyPoints( points );
+}
+
+template< typename T >
+template< typename A >
+KDBruteForce< T >::KDBruteForce( const KDPointsView< T, A >& points,
+                                 const size_t                numThreads )
+: m_size( 0u )
+, m_dimension( 0u )
+, m_numThreads( numThreads )
+{
+    copyPoints( points );
+}
+
+template< typename T >
+KDBruteForce< T >::KDBruteForce( const T*     data,
+                                 const size_t count,
+                                 const size_t dimension,
+                                 const size_t stride,
+                                 const size_t numThreads )
+: m_size( 0u )
+, m_dimension( 0u )
+, m_numThreads( numThreads )
+{
+    // Sanity
+    if ( count && ( ( nullptr == data ) || ( stride < dimension ) ) )
+    {
+        std::cerr << "KDBruteForce< T >::KDBruteForce() invalid buffer, "
+                  << "data = "      << data      << ", "
+                  << "count = "     << count     << ", "
+                  << "dimension = " << dimension << ", "
+                  << "stride = "    << stride
+                  << std::endl;
+        return;
+    }
+
+    if ( count )
+    {
+        copyPoints( KDPointsView< T >( data, count, dimension, stride ) );
+    }
+}
+
+//============================================================================
+//                  PRIMARY INTERFACE
+//============================================================================
+
+template< typename T >
+const Types::Point< T >
+KDBruteForce< T >::nearestPoint(
+        const Types::Point< T >& pointOfInterest ) const
+{
+    return pointAt( nearestPointIndex( pointOfInterest ) );
+}
+
+template< typename T >
+size_t
+KDBruteForce< T >::nearestPointIndex(
+        const Types::Point< T >& pointOfInterest ) const
+{
+    return nearestPointIndex( pointOfInterest.data(),
+                              pointOfInterest.size() );
+}
+
+template< typename T >
+size_t
+KDBruteForce< T >::nearestPointIndex( const T*     pointOfInterest,
+                                      const size_t dimension ) const
+{
+    if ( !m_size || !checkDimension( dimension ) )
+    {
+        return Constants::KDTREE_ERROR_INDEX;
+    }
+
+    size_t index = Constants::KDTREE_ERROR_INDEX;
+    scan( &pointOfInterest, 1u, &index );
+
+    return index;
+}
+
+template< typename T >
+void
+KDBruteForce< T >::nearestPointIndexes( const T*               queries,
+                                        const size_t           count,
+                                        const size_t           dimension,
+                                        std::vector< size_t >& indexes ) const
+{
+    indexes.assign( count, Constants::KDTREE_ERROR_INDEX );
+    if ( !count || !m_size || !checkDimension( dimension ) )
+    {
+        return;
+    }
+
+    const size_t numTasks = ( count + TASK_SIZE - 1u ) / TASK_SIZE;
+    KDFile::forEach( numTasks, m_numThreads,
+                     [ & ]( const size_t task )
+                     {
+                         const size_t begin = task * TASK_SIZE;
+                         const size_t end   = std::min< size_t >(
+                                                      count,
+                                                      begin + TASK_SIZE );
+
+                         const T* tile[ TILE ];
+                         for ( size_t i = begin; i < end; i += TILE )
+                         {
+                             const size_t numQueries = std::min< size_t >(
+                                                               TILE,
+                                                               end - i );
+                             for ( size_t q = 0; q < numQueries; ++q )
+                             {
+                                 tile[ q ] = queries + ( i + q ) * dimension;
+                             }
+                             scan( tile, numQueries, &indexes[ i ] );
+                         }
+
+                         return true;
+                     } );
+}
+
+template< typename T >
+const Types::Point< T >
+KDBruteForce< T >::pointAt( const size_t index ) const
+{
+    if ( index >= m_size )
+    {
+        return Types::Point< T >();
+    }
+
+    // One coordinate from every column of the block
+    const T* block = &m_blocks[ ( index / LANES ) * LANES * m_dimension ];
+    Types::Point< T > point( m_dimension );
+    for ( size_t axis = 0; axis < m_dimension; ++axis )
+    {
+        point[ axis ] = block[ axis * LANES + index % LANES ];
+    }
+
+    return point;
+}
+
+//============================================================================
+//                  ACCESSORS
+//============================================================================
+
+template< typename T >
+Types::Points< T >
+KDBruteForce< T >::points() const
+{
+    Types::Points< T > points;
+    points.reserve( m_size );
+    for ( size_t i = 0; i < m_size; ++i )
+    {
+        points.push_back( pointAt( i ) );
+    }
+
+    return points;
+}
+
+template< typename T >
+size_t
+KDBruteForce< T >::size() const
+{
+    return m_size;
+}
+
+template< typename T >
+size_t
+KDBruteForce< T >::dimension() const
+{
+    return m_dimension;
+}
+
+template< typename T >
+size_t
+KDBruteForce< T >::numThreads() const
+{
+    return m_numThreads;
+}
+
+template< typename T >
+std::ostream&
+KDBruteForce< T >::print( std::ostream& out ) const
+{
+    out << "KDBruteForce:[ "
+        << "size = "      << m_size       << ", "
+        << "dimension = " << m_dimension  << ", "
+        << "threads = "   << m_numThreads << " ]";
+
+    return out;
+}
+
+//============================================================================
+//                  PRIVATE
+//============================================================================
+
+template< typename T >
+template< typename Points >
+void
+KDBruteForce< T >::copyPoints( const Points& points )
+{
+    const size_t count     = points.size();
+    const size_t dimension = count ? points[ 0 ].size() : 0u;
+    for ( size_t i = 0; i < count; ++i )
+    {
+        // Sanity
+        if ( points[ i ].size() != dimension )
+        {
+            std::cerr << "KDBruteForce< T >::KDBruteForce() point " << i
+                      << " has cardinality = " << points[ i ].size() << " "
+                      << "while the first point has "
+                      << "cardinality = " << dimension
+                      << std::endl;
+            return;
+        }
+    }
+
+    m_size      = count;
+    m_dimension = dimension;
+
+    const size_t numBlocks = ( count + LANES - 1u ) / LANES;
+    m_blocks.assign( numBlocks * LANES * dimension, T() );
+    for ( size_t i = 0; i < count; ++i )
+    {
+        T* block = &m_blocks[ ( i / LANES ) * LANES * dimension ];
+        for ( size_t axis = 0; axis < dimension; ++axis )
+        {
+            block[ axis * LANES + i % LANES ] = points[ i ][ axis ];
+        }
+    }
+}
+
+template< typename T >
+void
+KDBruteForce< T >::scan( const T* const* queries,
+                         const size_t    numQueries,
+                         size_t*         indexes ) const
+{
+    double best[ TILE ];
+    for ( size_t q = 0; q < numQueries; ++q )
+    {
+        best[ q ]    = std::numeric_limits< double >::infinity();
+        indexes[ q ] = Constants::KDTREE_ERROR_INDEX;
+    }
+
+    // Squared distances, as Utils::distance() before its square root
+    double sums[ LANES ];
+    const size_t numBlocks = ( m_size + LANES - 1u ) / LANES;
+    for ( size_t block = 0; block < numBlocks; ++block )
+    {
+        const T*     columns = &m_blocks[ block * LANES * m_dimension ];
+        const size_t first   = block * LANES;
+        const size_t lanes   = std::min< size_t >( LANES, m_size - first );
+
+        for ( size_t q = 0; q < numQueries; ++q )
+        {
+            std::fill( sums, sums + LANES, 0.0 );
+            for ( size_t axis = 0; axis < m_dimension; ++axis )
+            {
+                const T  value  = queries[ q ][ axis ];
+                const T* column = columns + axis * LANES;
+                for ( size_t lane = 0; lane < LANES; ++lane )
+                {
+                    const double difference = column[ lane ] - value;
+                    sums[ lane ] += difference * difference;
+                }
+            }
+
+            // Padding lanes are left out
+            for ( size_t lane = 0; lane < lanes; ++lane )
+            {
+                if ( sums[ lane ] < best[ q ] )
+                {
+                    best[ q ]    = sums[ lane ];
+                    indexes[ q ] = first + lane;
+                }
+            }
+        }
+    }
+}
+
+template< typename T >
+bool
+KDBruteForce< T >::checkDimension( const size_t dimension ) const
+{
+    if ( dimension != m_dimension )
+    {
+        std::cerr << "Point cardinality mismatch. Point of interest has "
+                  << "cardinality = " << dimension << " "
+                  << "while points stored in the engine have "
+                  << "cardinality = " << m_dimension
+                  << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+//============================================================================
+//                  INDEPENDENT OPERATORS
+//============================================================================
+
+template< typename T >
+std::ostream& operator<<( std::ostream& lhs, const KDBruteForce< T >& rhs )
+{
+    return rhs.print( lhs );
+}
+
+} // namespace datastructures
+
+#endif // KDTREE_BRUTE_FORCE_H
@@ -0,0 +1,315 @@
+#include "kdtree_codec.h"
+
+namespace datastructures {
+
+//============================================================================
+//                  CREATORS
+//============================================================================
+
+KDCodec::BitWriter::BitWriter()
+: m_numBits( 0u )
+{
+    // nothing to do here
+}
+
+KDCodec::BitReader::BitReader( const std::vector< uint8_t >& bytes )
+: m_bytes( bytes )
+, m_position( 0u )
+{
+    // nothing to do here
+}
+
+//============================================================================
+//                  PRIMARY INTERFACE
+//============================================================================
+
+void
+KDCodec::BitWriter::write( const uint64_t value, const size_t numBits )
+{
+    for ( size_t bit = 0; bit < numBits; ++bit, ++m_numBits )
+    {
+        if ( !( m_numBits % 8u ) )
+        {
+            m_bytes.push_back( 0u );
+        }
+
+        if ( ( value >> bit ) & 1u )
+        {
+            m_bytes.back() |= static_cast< uint8_t >( 1u << ( m_numBits % 8u ) );
+        }
+    }
+}
+
+const std::vector< uint8_t >&
+KDCodec::BitWriter::bytes() const
+{
+    return m_bytes;
+}
+
+bool
+KDCodec::BitReader::read( const size_t numBits, uint64_t& value )
+{
+    if ( m_position + numBits > m_bytes.size() * 8u )
+    {
+        return false;
+    }
+
+    value = 0u;
+    for ( size_t bit = 0; bit < numBits; ++bit, ++m_position )
+    {
+        if ( ( m_bytes[ m_position / 8u ] >> ( m_position % 8u ) ) & 1u )
+        {
+            value |= static_cast< uint64_t >( 1u ) << bit;
+        }
+    }
+
+    return true;
+}
+
+void
+KDCodec::writeVarint( std::ostream& out, uint64_t value )
+{
+    while ( value >= 0x80u )
+    {
+        out.put( static_cast< char >( ( value & 0x7Fu ) | 0x80u ) );
+        value >>= 7;
+    }
+    out.put( static_cast< char >( value ) );
+}
+
+bool
+KDCodec::readVarint( std::istream& in, uint64_t& value )
+{
+    value = 0u;
+    for ( size_t shift = 0; shift < 64u; shift += 7u )
+    {
+        const int byte = in.get();
+        if ( EOF == byte )
+        {
+            return false;
+        }
+
+        value |= static_cast< uint64_t >( byte & 0x7F ) << shift;
+        if ( !( byte & 0x80 ) )
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+uint64_t
+KDCodec::zigzag( const int64_t value )
+{
+    return ( static_cast< uint64_t >( value ) << 1 ) ^
+           static_cast< uint64_t >( value >> 63 );
+}
+
+int64_t
+KDCodec::unzigzag( const uint64_t value )
+{
+    return static_cast< int64_t >( value >> 1 ) ^
+           -static_cast< int64_t >( value & 1u );
+}
+
+void
+KDCodec::writeBytes( std::ostream& out, const std::vector< uint8_t >& bytes )
+{
+    writeVarint( out, bytes.size() );
+    if ( !bytes.empty() )
+    {
+        out.write( reinterpret_cast< const char* >( &bytes[ 0 ] ),
+                   bytes.size() );
+    }
+}
+
+bool
+KDCodec::readBytes( std::istream& in, std::vector< uint8_t >& bytes )
+{
+    uint64_t size;
+    if ( !readVarint( in, size ) )
+    {
+        return false;
+    }
+
+    // Grow as the data arrives, so that a corrupt size fails on the read
+    // rather than on the allocation
+    bytes.clear();
+    const size_t chunk = 1u << 16;
+    while ( bytes.size() < size )
+    {
+        const size_t offset = bytes.size();
+        const size_t length = std::min< uint64_t >( chunk, size - offset );
+        bytes.resize( offset + length );
+        in.read( reinterpret_cast< char* >( &bytes[ offset ] ), length );
+        if ( !in )
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void
+KDCodec::writePlane( std::ostream& out, const std::vector< uint8_t >& bytes )
+{
+    // Length shifted left by one, low bit set for a run
+    size_t literal = 0u;
+    size_t i       = 0u;
+    while ( i <= bytes.size() )
+    {
+        size_t run = 0u;
+        while ( ( i + run < bytes.size() ) && ( bytes[ i + run ] == bytes[ i ] ) )
+        {
+            ++run;
+        }
+
+        if ( ( run >= 3u ) || ( i == bytes.size() ) )
+        {
+            if ( i > literal )
+            {
+                writeVarint( out, static_cast< uint64_t >( i - literal ) << 1 );
+                out.write( reinterpret_cast< const char* >( &bytes[ literal ] ),
+                           i - literal );
+            }
+            if ( i == bytes.size() )
+            {
+                break;
+            }
+
+            writeVarint( out, ( static_cast< uint64_t >( run ) << 1 ) | 1u );
+            out.put( static_cast< char >( bytes[ i ] ) );
+            literal = i + run;
+        }
+
+        i += run;
+    }
+}
+
+bool
+KDCodec::readPlane( std::istream&           in,
+                    const size_t            size,
+                    std::vector< uint8_t >& bytes )
+{
+    bytes.resize( size );
+
+    size_t i = 0u;
+    while ( i < size )
+    {
+        uint64_t control;
+        if ( !readVarint( in, control ) )
+        {
+            return false;
+        }
+
+        const uint64_t length = control >> 1;
+        if ( !length || ( length > size - i ) )
+        {
+            return false;
+        }
+
+        if ( control & 1u )
+        {
+            const int byte = in.get();
+            if ( EOF == byte )
+            {
+                return false;
+            }
+            std::fill( bytes.begin() + i, bytes.begin() + i + length,
+                       static_cast< uint8_t >( byte ) );
+        }
+        else
+        {
+            in.read( reinterpret_cast< char* >( &bytes[ i ] ), length );
+            if ( !in )
+            {
+                return false;
+            }
+        }
+
+        i += length;
+    }
+
+    return true;
+}
+
+size_t
+KDCodec::bitsFor( const uint64_t maxValue )
+{
+    size_t bits = 0u;
+    while ( bits < 64u && ( maxValue >> bits ) )
+    {
+        ++bits;
+    }
+
+    return bits;
+}
+
+uint64_t
+KDCodec::remaining( std::istream& in )
+{
+    const std::istream::pos_type position = in.tellg();
+    if ( position < 0 )
+    {
+        return std::numeric_limits< uint64_t >::max();
+    }
+
+    in.seekg( 0, std::ios::end );
+    const std::istream::pos_type end = in.tellg();
+    in.seekg( position );
+    if ( !in || ( end < position ) )
+    {
+        in.clear();
+        in.seekg( position );
+        return std::numeric_limits< uint64_t >::max();
+    }
+
+    return static_cast< uint64_t >( end - position );
+}
+
+uint64_t
+KDCodec::minEncodedSize( const uint64_t                        count,
+                         const uint64_t                        stride,
+                         const size_t                          valueSize,
+                         const KDTreeOptions::PointCompression compression )
+{
+    const uint64_t largest = std::numeric_limits< uint64_t >::max();
+
+    // Two control bits per value, behind the byte count
+    if ( KDTreeOptions::XOR_DELTA_POINTS == compression )
+    {
+        return 1u + count / 4u + ( count % 4u ? 1u : 0u );
+    }
+
+    // A plane per byte of a column, each at least one run of a byte
+    if ( KDTreeOptions::BYTE_SHUFFLE_POINTS == compression )
+    {
+        const uint64_t planes = std::min( count, stride );
+        return planes > largest / ( 2u * valueSize ) ?
+               largest : planes * 2u * valueSize;
+    }
+
+    return count > largest / valueSize ? largest : count * valueSize;
+}
+
+size_t
+KDCodec::leadingZeros( const uint64_t bits, const size_t width )
+{
+    return width - std::min( width, bitsFor( bits ) );
+}
+
+size_t
+KDCodec::trailingZeros( const uint64_t bits, const size_t width )
+{
+    size_t zeros = 0u;
+    while ( ( zeros < width ) && !( ( bits >> zeros ) & 1u ) )
+    {
+        ++zeros;
+    }
+
+    return zeros;
+}
+
+} // namespace datastructures
@@ -0,0 +1,425 @@
+#ifndef KDTREE_CODEC_H
+#define KDTREE_CODEC_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "kdtree_options.h"
+
+// @Purpose
+//
+// This struct provides the building blocks of the compact KDTree file
+// format: variable length integers, bit streams and lossless encodings of
+// coordinate sequences.
+//
+// Integers are written as LEB128 varints, 7 bits per byte, least
+// significant group first. Signed values are zigzag mapped first, so that
+// small deltas of either sign take a single byte.
+//
+// Coordinate sequences are encoded on the bit patterns of their values, so
+// every encoding is lossless for any coordinate type of up to 8 bytes:
+//  - RAW_POINTS copies the values as they are
+//  - XOR_DELTA_POINTS XORs every value with the value stride positions
+//    back, which clears the sign, exponent and leading mantissa bits that
+//    nearby coordinates share, and writes the XOR into a bit stream much as
+//    Chimp does. Two control bits select the shortest of: nothing, for a
+//    zero XOR; the bits below the leading zeros of the column's previous
+//    non-zero XOR; the count of leading zeros followed by the bits below
+//    them; the counts of leading and significant bits followed by the
+//    significant bits, for a XOR with many trailing zeros.
+//  - BYTE_SHUFFLE_POINTS transposes the values into byte planes - for
+//    every one of stride columns, all the first bytes, then all the second
+//    bytes and so on - and run-length encodes each plane, leaving stretches
+//    without runs as literals. Sign and exponent planes collapse into few
+//    runs.
+//
+// Multi-byte values are written in host byte order.
+//
+
+namespace datastructures {
+
+struct KDCodec {
+    // TYPES
+    class BitWriter {
+    public:
+        BitWriter();
+            // Default constructor, holds no bits
+
+        void write( const uint64_t value, const size_t numBits );
+            // Appends the numBits least significant bits of value
+
+        const std::vector< uint8_t >& bytes() const;
+            // Returns the bits written so far, padded to a whole byte
+
+    private:
+        std::vector< uint8_t > m_bytes;
+        size_t                 m_numBits;
+    };
+
+    class BitReader {
+    public:
+        BitReader( const std::vector< uint8_t >& bytes );
+            // Constructor, reads the provided bytes, which must outlive the
+            // reader
+
+        bool read( const size_t numBits, uint64_t& value );
+            // Reads the next numBits bits into value. Returns false if the
+            // bytes are exhausted.
+
+    private:
+        const std::vector< uint8_t >& m_bytes;
+        size_t                        m_position;
+    };
+
+    // PRIMARY INTERFACE
+    static void writeVarint( std::ostream& out, uint64_t value );
+        // Writes value as a varint
+
+    static bool readVarint( std::istream& in, uint64_t& value );
+        // Reads a varint into value. Returns false on a truncated or
+        // malformed varint.
+
+    static uint64_t zigzag( const int64_t value );
+        // Maps signed value onto an unsigned one, small magnitudes first
+
+    static int64_t unzigzag( const uint64_t value );
+        // Inverse of zigzag()
+
+    static void writeBytes( std::ostream&                 out,
+                            const std::vector< uint8_t >& bytes );
+        // Writes the byte count as a varint followed by the bytes
+
+    static bool readBytes( std::istream&           in,
+                           std::vector< uint8_t >& bytes );
+        // Reads bytes written by writeBytes(). Returns false on a truncated
+        // stream.
+
+    static size_t bitsFor( const uint64_t maxValue );
+        // Returns number of bits needed to represent values up to maxValue
+
+    static uint64_t remaining( std::istream& in );
+        // Returns number of bytes between the read position of in and its
+        // end, the largest uint64_t if in cannot seek
+
+    static uint64_t minEncodedSize(
+            const uint64_t                        count,
+            const uint64_t                        stride,
+            const size_t                          valueSize,
+            const KDTreeOptions::PointCompression compression );
+        // Returns the fewest bytes encodeValues() writes for count values
+        // of valueSize bytes, so that a corrupt count can be rejected
+        // before anything is allocated for it. Saturates at the largest
+        // uint64_t.
+
+    template< typename T >
+    static void encodeValues( std::ostream&                        out,
+                              const std::vector< T >&              values,
+                              const size_t                         stride,
+                              const KDTreeOptions::PointCompression compression );
+        // Writes values with the provided encoding. XOR_DELTA_POINTS XORs
+        // every value with the one stride positions back, so the values are
+        // best ordered to keep similar points together.
+
+    template< typename T >
+    static bool decodeValues( std::istream&                        in,
+                              const size_t                         count,
+                              const size_t                         stride,
+                              const KDTreeOptions::PointCompression compression,
+                              std::vector< T >&                    values );
+        // Reads count values written by encodeValues(). Returns false on a
+        // truncated or malformed stream.
+
+private:
+    static void writePlane( std::ostream&                 out,
+                            const std::vector< uint8_t >& bytes );
+        // Writes a byte plane as runs of at least three equal bytes and
+        // literal stretches in between, each led by a varint of its length
+        // and kind
+
+    static bool readPlane( std::istream&           in,
+                           const size_t            size,
+                           std::vector< uint8_t >& bytes );
+        // Reads a byte plane of size bytes written by writePlane(). Returns
+        // false on a truncated or malformed stream.
+
+    template< typename T >
+    static void encodeXor( std::ostream&           out,
+                           const std::vector< T >& values,
+                           const size_t            stride );
+        // Writes values as XOR_DELTA_POINTS prescribes
+
+    template< typename T >
+    static bool decodeXor( std::istream&     in,
+                           const size_t      count,
+                           const size_t      stride,
+                           std::vector< T >& values );
+        // Reads count values written by encodeXor(). Returns false on a
+        // truncated or malformed stream.
+
+    static size_t leadingZeros( const uint64_t bits, const size_t width );
+        // Returns number of leading zero bits of the width lowest bits
+
+    static size_t trailingZeros( const uint64_t bits, const size_t width );
+        // Returns number of trailing zero bits, width for zero bits
+
+    template< typename T >
+    static uint64_t toBits( const T value );
+        // Returns bit pattern of value
+
+    template< typename T >
+    static T fromBits( const uint64_t bits );
+        // Returns value of the bit pattern
+};
+
+//============================================================================
+//                  PRIMARY INTERFACE
+//============================================================================
+
+template< typename T >
+void
+KDCodec::encodeValues( std::ostream&                         out,
+                       const std::vector< T >&               values,
+                       const size_t                          stride,
+                       const KDTreeOptions::PointCompression compression )
+{
+    static_assert( sizeof( T ) <= sizeof( uint64_t ),
+                   "coordinates wider than 64 bits are not supported" );
+
+    if ( KDTreeOptions::XOR_DELTA_POINTS == compression )
+    {
+        encodeXor( out, values, stride );
+        return;
+    }
+
+    if ( KDTreeOptions::BYTE_SHUFFLE_POINTS == compression )
+    {
+        std::vector< uint8_t > bytes;
+        for ( size_t column = 0; column < stride; ++column )
+        {
+            for ( size_t plane = 0; plane < sizeof( T ); ++plane )
+            {
+                bytes.clear();
+                for ( size_t i = column; i < values.size(); i += stride )
+                {
+                    bytes.push_back( reinterpret_cast< const uint8_t* >(
+                                             &values[ i ] )[ plane ] );
+                }
+                writePlane( out, bytes );
+            }
+        }
+        return;
+    }
+
+    if ( !values.empty() )
+    {
+        out.write( reinterpret_cast< const char* >( &values[ 0 ] ),
+                   values.size() * sizeof( T ) );
+    }
+}
+
+template< typename T >
+bool
+KDCodec::decodeValues( std::istream&                         in,
+                       const size_t                          count,
+                       const size_t                          stride,
+                       const KDTreeOptions::PointCompression compression,
+                       std::vector< T >&                     values )
+{
+    static_assert( sizeof( T ) <= sizeof( uint64_t ),
+                   "coordinates wider than 64 bits are not supported" );
+
+    if ( KDTreeOptions::XOR_DELTA_POINTS == compression )
+    {
+        return decodeXor( in, count, stride, values );
+    }
+
+    values.resize( count );
+
+    if ( KDTreeOptions::BYTE_SHUFFLE_POINTS == compression )
+    {
+        std::vector< uint8_t > bytes;
+        for ( size_t column = 0; column < stride; ++column )
+        {
+            const size_t planeSize = column < count ?
+                    ( count - column + stride - 1u ) / stride : 0u;
+            for ( size_t plane = 0; plane < sizeof( T ); ++plane )
+            {
+                if ( !readPlane( in, planeSize, bytes ) )
+                {
+                    return false;
+                }
+
+                for ( size_t j = 0; j < planeSize; ++j )
+                {
+                    reinterpret_cast< uint8_t* >(
+                            &values[ column + j * stride ] )[ plane ] =
+                                    bytes[ j ];
+                }
+            }
+        }
+        return true;
+    }
+
+    if ( count )
+    {
+        in.read( reinterpret_cast< char* >( &values[ 0 ] ),
+                 count * sizeof( T ) );
+    }
+
+    return static_cast< bool >( in );
+}
+
+template< typename T >
+void
+KDCodec::encodeXor( std::ostream&           out,
+                    const std::vector< T >& values,
+                    const size_t            stride )
+{
+    const size_t width     = 8u * sizeof( T );
+    const size_t countBits = bitsFor( width - 1u );
+
+    BitWriter bits;
+    std::vector< uint64_t > previous( stride, 0u );
+    std::vector< size_t >   leading( stride, width );
+    for ( size_t i = 0; i < values.size(); ++i )
+    {
+        const size_t   column = i % stride;
+        const uint64_t value  = toBits( values[ i ] );
+        const uint64_t delta  = value ^ previous[ column ];
+        previous[ column ] = value;
+
+        if ( !delta )
+        {
+            bits.write( 0u, 2u );
+            continue;
+        }
+
+        // Whichever of the three forms takes the fewest bits
+        const size_t lz     = leadingZeros( delta, width );
+        const size_t tz     = trailingZeros( delta, width );
+        const size_t reuse  = lz >= leading[ column ] ?
+                              width - leading[ column ] : 2u * width;
+        const size_t fresh  = countBits + width - lz;
+        const size_t center = 2u * countBits + width - lz - tz;
+        if ( ( center < fresh ) && ( center < reuse ) )
+        {
+            bits.write( 1u, 2u );
+            bits.write( lz, countBits );
+            bits.write( width - lz - tz - 1u, countBits );
+            bits.write( delta >> tz, width - lz - tz );
+            leading[ column ] = lz;
+        }
+        else if ( reuse <= fresh )
+        {
+            bits.write( 2u, 2u );
+            bits.write( delta, reuse );
+        }
+        else
+        {
+            bits.write( 3u, 2u );
+            bits.write( lz, countBits );
+            bits.write( delta, width - lz );
+            leading[ column ] = lz;
+        }
+    }
+
+    writeBytes( out, bits.bytes() );
+}
+
+template< typename T >
+bool
+KDCodec::decodeXor( std::istream&     in,
+                    const size_t      count,
+                    const size_t      stride,
+                    std::vector< T >& values )
+{
+    const size_t width     = 8u * sizeof( T );
+    const size_t countBits = bitsFor( width - 1u );
+
+    // Every value takes at least its control bits
+    std::vector< uint8_t > bytes;
+    if ( !readBytes( in, bytes ) || ( count / 4u > bytes.size() ) )
+    {
+        return false;
+    }
+
+    BitReader bits( bytes );
+    values.resize( count );
+    std::vector< uint64_t > previous( stride, 0u );
+    std::vector< size_t >   leading( stride, width );
+    for ( size_t i = 0; i < count; ++i )
+    {
+        const size_t column = i % stride;
+        uint64_t control;
+        uint64_t delta = 0u;
+        uint64_t lz;
+        uint64_t significant;
+        if ( !bits.read( 2u, control ) )
+        {
+            return false;
+        }
+
+        if ( 1u == control )
+        {
+            if ( !bits.read( countBits, lz ) ||
+                 !bits.read( countBits, significant ) ||
+                 ( lz + significant >= width ) ||
+                 !bits.read( significant + 1u, delta ) )
+            {
+                return false;
+            }
+            delta <<= width - lz - significant - 1u;
+            leading[ column ] = static_cast< size_t >( lz );
+        }
+        else if ( 2u == control )
+        {
+            if ( ( leading[ column ] >= width ) ||
+                 !bits.read( width - leading[ column ], delta ) )
+            {
+                return false;
+            }
+        }
+        else if ( 3u == control )
+        {
+            if ( !bits.read( countBits, lz ) || ( lz >= width ) ||
+                 !bits.read( width - lz, delta ) )
+            {
+                return false;
+            }
+            leading[ column ] = static_cast< size_t >( lz );
+        }
+
+        previous[ column ] ^= delta;
+        values[ i ] = fromBits< T >( previous[ column ] );
+    }
+
+    return true;
+}
+
+template< typename T >
+uint64_t
+KDCodec::toBits( const T value )
+{
+    uint64_t bits = 0u;
+    std::memcpy( &bits, &value, sizeof( T ) );
+    return bits;
+}
+
+template< typename T >
+T
+KDCodec::fromBits( const uint64_t bits )
+{
+    T value;
+    std::memcpy( &value, &bits, sizeof( T ) );
+    return value;
+}
+
+} // namespace datastructures
+
+#endif // KDTREE_CODEC_H
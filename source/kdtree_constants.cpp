@@ -1,40 +1,124 @@
-#include <limits>
-
-#include "kdtree_constants.h"
-
-namespace datastructures {
-
-const std::size_t Constants::KDTREE_UNINITIALIZED_HYPERPLANE_INDEX
-    = std::numeric_limits< size_t >::max() - 1;
-
-const std::size_t Constants::KDTREE_UNINITIALIZED_HYPERPLANE_VALUE
-    = 0;
-
-const std::size_t Constants::KDTREE_EMPTY_SET_VARIANCE
-    = 0u;
-
-const std::size_t Constants::KDTREE_EMPTY_SET_MEDIAN
-    = 0u;
-
-const std::string Constants::KDTREE_SIMPLE_VARIETY
-    = "Simple KDTree Implementation";
-
-const double Constants::KDTREE_INVALID_DISTANCE
-    = -1.0L;
-
-const double Constants::KDTREE_MAX_DISTANCE
-    = std::numeric_limits< double >::max();
-
-const size_t Constants::KDTREE_ERROR_INDEX
-    = std::numeric_limits< size_t >::max() - 2;
-
-const std::string Constants::KDTREE_HYPERPLANE_MARKER
-    = "HYPERPLANE";
-
-const std::string Constants::KDTREE_LEAF_MARKER
-    = "LEAF";
-
-const std::string Constants::KDTREE_EMPTY_MARKER
-    = "EMPTY TREE";
-
-} // namespace datastructures
+#include <limits>
+
+#include "kdtree_constants.h"
+
+namespace datastructures {
+
+const std::size_t Constants::KDTREE_UNINITIALIZED_HYPERPLANE_INDEX
+    = std::numeric_limits< size_t >::max() - 1;
+
+const std::size_t Constants::KDTREE_UNINITIALIZED_HYPERPLANE_VALUE
+    = 0;
+
+const std::size_t Constants::KDTREE_EMPTY_SET_VARIANCE
+    = 0u;
+
+const std::size_t Constants::KDTREE_EMPTY_SET_MEDIAN
+    = 0u;
+
+const std::string Constants::KDTREE_SIMPLE_VARIETY
+    = "Simple KDTree Implementation";
+
+const double Constants::KDTREE_INVALID_DISTANCE
+    = -1.0L;
+
+const double Constants::KDTREE_MAX_DISTANCE
+    = std::numeric_limits< double >::max();
+
+const size_t Constants::KDTREE_ERROR_INDEX
+    = std::numeric_limits< size_t >::max() - 2;
+
+const std::string Constants::KDTREE_HYPERPLANE_MARKER
+    = "HYPERPLANE";
+
+const std::string Constants::KDTREE_LEAF_MARKER
+    = "LEAF";
+
+const std::string Constants::KDTREE_EMPTY_MARKER
+    = "EMPTY TREE";
+
+const std::string Constants::KDTREE_LAYOUT_MARKER
+    = "LAYOUT";
+
+const std::string Constants::KDTREE_VAN_EMDE_BOAS_LAYOUT
+    = "VAN EMDE BOAS";
+
+const std::string Constants::KDTREE_POINT_ORDER_MARKER
+    = "POINT ORDER";
+
+const std::string Constants::KDTREE_LEAF_POINT_ORDER
+    = "LEAF";
+
+const std::size_t Constants::KDTREE_COST_MODEL_BINS
+    = 16u;
+
+const std::size_t Constants::KDTREE_SPLIT_SAMPLE_SIZE
+    = 4096u;
+
+const std::size_t Constants::KDTREE_PARALLEL_BUILD_GRAIN
+    = 16384u;
+
+const std::string Constants::KDTREE_COMPACT_MAGIC
+    = "KDTREEC1";
+
+const std::size_t Constants::KDTREE_COMPACT_MAX_TYPE_SIZE
+    = 1024u;
+
+const std::string Constants::KDTREE_CHUNKED_MAGIC
+    = "KDTREEP1";
+
+const std::size_t Constants::KDTREE_CHUNK_DEPTH
+    = 8u;
+
+const std::size_t Constants::KDTREE_CHUNK_POINTS
+    = 65536u;
+
+const std::string Constants::KDTREE_CSV_CACHE_MAGIC
+    = "KDCSVC01";
+
+const std::string Constants::KDTREE_CSV_CACHE_SUFFIX
+    = ".kdcache";
+
+const std::string Constants::KDTREE_REPORT_SUFFIX
+    = ".report.json";
+
+const uint32_t Constants::KDTREE_QUERY_MAGIC
+    = 0x3151444Bu; // "KDQ1" in little endian byte order
+
+const uint64_t Constants::KDTREE_QUERY_MAX_BATCH
+    = 1u << 24;
+
+const uint64_t Constants::KDTREE_QUERY_MAX_VALUES
+    = 1u << 26;
+
+const std::size_t Constants::KDTREE_QUERY_TASK_SIZE
+    = 256u;
+
+const std::string Constants::KDTREE_PAGED_MAGIC
+    = "KDPAGED1";
+
+const uint64_t Constants::KDTREE_PAGED_LEAF
+    = std::numeric_limits< uint64_t >::max();
+
+const std::size_t Constants::KDTREE_PAGE_SIZE
+    = 4096u;
+
+const std::size_t Constants::KDTREE_PAGE_CACHE_SIZE
+    = 256u;
+
+const std::string Constants::KDTREE_SHARED_MAGIC
+    = "KDSHARE1";
+
+const uint64_t Constants::KDTREE_SHARED_LEAF
+    = std::numeric_limits< uint64_t >::max();
+
+const std::size_t Constants::KDTREE_ARENA_SLAB_SIZE
+    = 4096u;
+
+const std::size_t Constants::KDTREE_NO_NODE
+    = std::numeric_limits< size_t >::max();
+
+const uint64_t Constants::KDTREE_FLAT_LEAF
+    = std::numeric_limits< uint64_t >::max();
+
+} // namespace datastructures
@@ -1,57 +1,170 @@
-#ifndef KDTREE_CONSTANTS_H
-#define KDTREE_CONSTANTS_H
-
-#include <cstddef>
-#include <string>
-
-namespace datastructures {
-
-struct Constants {
-    static const std::size_t KDTREE_UNINITIALIZED_HYPERPLANE_INDEX;
-        // Used in default ctor to signify uninitialized value of
-        // divisor hyperplane index
-
-    static const std::size_t KDTREE_UNINITIALIZED_HYPERPLANE_VALUE;
-        // Used in default ctor to signify uninitialized value of
-        // divisor hyperplane position
-
-    static const std::size_t KDTREE_EMPTY_SET_VARIANCE;
-        // Defines a variance of an empty set
-
-    static const std::size_t KDTREE_EMPTY_SET_MEDIAN;
-        // Defines a median of an empty set
-
-    static const std::string KDTREE_SIMPLE_VARIETY;
-        // Denotes a plain vanilla KDTree implementations
-
-    static const double KDTREE_INVALID_DISTANCE;
-        // Denotes an error output resulting from an attempt to
-        // calculate distance between points of different
-        // cardinality
-
-    static const double KDTREE_MAX_DISTANCE;
-        // Denotes an error output resulting from an attempt to
-        // calculate distance between points of different
-        // cardinality
-
-    static const size_t KDTREE_ERROR_INDEX;
-        // Denotes an error output resulting from an attempt to
-        // search for a point either on an empty tree on in case of
-        // cardinality mismatch
-
-    static const std::string KDTREE_HYPERPLANE_MARKER;
-        // Denotes an upcoming hyperplane node line in a serialized
-        // file stream
-
-    static const std::string KDTREE_LEAF_MARKER;
-        // Denotes an upcoming leaf node line in a serialized
-        // file stream
-
-    static const std::string KDTREE_EMPTY_MARKER;
-        // Denotes a special-case empty node line in a serialized
-        // file stream
-};
-
-} // namespace datastructures
-
-#endif //KDTREE_CONSTANTS_H
+#ifndef KDTREE_CONSTANTS_H
+#define KDTREE_CONSTANTS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+
+namespace datastructures {
+
+struct Constants {
+    static const std::size_t KDTREE_UNINITIALIZED_HYPERPLANE_INDEX;
+        // Used in default ctor to signify uninitialized value of
+        // divisor hyperplane index
+
+    static const std::size_t KDTREE_UNINITIALIZED_HYPERPLANE_VALUE;
+        // Used in default ctor to signify uninitialized value of
+        // divisor hyperplane position
+
+    static const std::size_t KDTREE_EMPTY_SET_VARIANCE;
+        // Defines a variance of an empty set
+
+    static const std::size_t KDTREE_EMPTY_SET_MEDIAN;
+        // Defines a median of an empty set
+
+    static const std::string KDTREE_SIMPLE_VARIETY;
+        // Denotes a plain vanilla KDTree implementations
+
+    static const double KDTREE_INVALID_DISTANCE;
+        // Denotes an error output resulting from an attempt to
+        // calculate distance between points of different
+        // cardinality
+
+    static const double KDTREE_MAX_DISTANCE;
+        // Denotes an error output resulting from an attempt to
+        // calculate distance between points of different
+        // cardinality
+
+    static const size_t KDTREE_ERROR_INDEX;
+        // Denotes an error output resulting from an attempt to
+        // search for a point either on an empty tree on in case of
+        // cardinality mismatch
+
+    static const std::string KDTREE_HYPERPLANE_MARKER;
+        // Denotes an upcoming hyperplane node line in a serialized
+        // file stream
+
+    static const std::string KDTREE_LEAF_MARKER;
+        // Denotes an upcoming leaf node line in a serialized
+        // file stream
+
+    static const std::string KDTREE_EMPTY_MARKER;
+        // Denotes a special-case empty node line in a serialized
+        // file stream
+
+    static const std::string KDTREE_LAYOUT_MARKER;
+        // Denotes an upcoming node layout line in a serialized file stream.
+        // Only written for layouts other than the build order.
+
+    static const std::string KDTREE_VAN_EMDE_BOAS_LAYOUT;
+        // Denotes van Emde Boas node layout in a serialized file stream
+
+    static const std::string KDTREE_POINT_ORDER_MARKER;
+        // Denotes an upcoming point order line in a serialized file stream.
+        // Only written for orders other than the input order.
+
+    static const std::string KDTREE_LEAF_POINT_ORDER;
+        // Denotes points stored in leaf order in a serialized file stream
+
+    static const std::size_t KDTREE_COST_MODEL_BINS;
+        // Number of candidate split positions per axis evaluated by the
+        // cost model split policy, plus one
+
+    static const std::size_t KDTREE_SPLIT_SAMPLE_SIZE;
+        // Default number of points split statistics are estimated from
+        // once a subset exceeds the sampling threshold
+
+    static const std::size_t KDTREE_PARALLEL_BUILD_GRAIN;
+        // Smallest number of points worth handing to a separate thread
+        // during a parallel build
+
+    static const std::string KDTREE_COMPACT_MAGIC;
+        // Leads a serialized KDTree file in the compact format
+
+    static const std::size_t KDTREE_COMPACT_MAX_TYPE_SIZE;
+        // Longest tree type accepted from a compact format file
+
+    static const std::string KDTREE_CHUNKED_MAGIC;
+        // Leads a serialized KDTree file in the chunked format
+
+    static const std::size_t KDTREE_CHUNK_DEPTH;
+        // Default depth of the subtrees written as separate chunks of a
+        // chunked format file
+
+    static const std::size_t KDTREE_CHUNK_POINTS;
+        // Number of points in a chunk of a chunked format file
+
+    static const std::string KDTREE_CSV_CACHE_MAGIC;
+        // Leads a binary sidecar of a CSV file
+
+    static const std::string KDTREE_CSV_CACHE_SUFFIX;
+        // Appended to the name of a CSV file to name its binary sidecar
+
+    static const std::string KDTREE_REPORT_SUFFIX;
+        // Appended to the name of a serialized tree to name its build report
+
+    static const uint32_t KDTREE_QUERY_MAGIC;
+        // Leads every request and response of the query server protocol
+
+    static const uint64_t KDTREE_QUERY_MAX_BATCH;
+        // Most points a single query server request may carry
+
+    static const uint64_t KDTREE_QUERY_MAX_VALUES;
+        // Most coordinates a single query server request may carry
+
+    static const std::size_t KDTREE_QUERY_TASK_SIZE;
+        // Number of queries of a batch a query server worker answers at a
+        // time
+
+    static const std::string KDTREE_PAGED_MAGIC;
+        // Leads the header page of a paged KDTree file
+
+    static const uint64_t KDTREE_PAGED_LEAF;
+        // Denotes a leaf in place of the split axis in a paged KDTree file
+
+    static const std::size_t KDTREE_PAGE_SIZE;
+        // Default number of bytes of a paged KDTree file page
+
+    static const std::size_t KDTREE_PAGE_CACHE_SIZE;
+        // Default number of pages a paged KDTree keeps in memory, besides
+        // its directory
+
+    static const std::string KDTREE_SHARED_MAGIC;
+        // Leads a shared KDTree segment
+
+    static const uint64_t KDTREE_SHARED_LEAF;
+        // Denotes a leaf in place of the split axis in a shared KDTree
+        // segment
+
+    static const std::size_t KDTREE_ARENA_SLAB_SIZE;
+        // Number of nodes in a node arena slab, used when the number of
+        // nodes to be allocated is not known up front
+
+    static const std::size_t KDTREE_NO_NODE;
+        // Denotes a missing child in a tree flattened to an index array
+
+    static const uint64_t KDTREE_FLAT_LEAF;
+        // Denotes a leaf in place of the split axis of a flattened KDTree
+        // node
+
+    template< typename I >
+    static I errorIndex();
+        // Counterpart of KDTREE_ERROR_INDEX for index type I. Note that
+        // errorIndex< size_t >() == KDTREE_ERROR_INDEX
+};
+
+//============================================================================
+//                  PRIMARY INTERFACE
+//============================================================================
+
+template< typename I >
+I
+Constants::errorIndex()
+{
+    return std::numeric_limits< I >::max() - 2;
+}
+
+} // namespace datastructures
+
+#endif //KDTREE_CONSTANTS_H
@@ -0,0 +1,155 @@
+#include "kdtree_csv.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace datastructures {
+
+//============================================================================
+//                  PRIMARY INTERFACE
+//============================================================================
+
+std::string
+KDCsv::cacheName( const std::string& csvFile )
+{
+    return csvFile + Constants::KDTREE_CSV_CACHE_SUFFIX;
+}
+
+uint64_t
+KDCsv::hash( const char* data, const size_t size )
+{
+    // Eight bytes at a time, each word multiplied in and folded
+    const uint64_t multiplier = 0x9E3779B97F4A7C15ull;
+    uint64_t result = size * multiplier;
+
+    size_t i = 0;
+    for ( ; i + sizeof( uint64_t ) <= size; i += sizeof( uint64_t ) )
+    {
+        uint64_t word;
+        std::memcpy( &word, data + i, sizeof( word ) );
+        result = ( result ^ word ) * multiplier;
+        result ^= result >> 32;
+    }
+
+    for ( ; i < size; ++i )
+    {
+        result = ( result ^ static_cast< uint8_t >( data[ i ] ) ) *
+                 multiplier;
+        result ^= result >> 32;
+    }
+
+    return result;
+}
+
+bool
+KDCsv::fingerprint( const std::string&  csvFile,
+                    const KDMappedFile& contents,
+                    Fingerprint&        fingerprint )
+{
+    struct stat status;
+    if ( 0 != ::stat( csvFile.c_str(), &status ) )
+    {
+        return false;
+    }
+
+    fingerprint.size             = contents.size();
+    fingerprint.mtimeSeconds     = status.st_mtim.tv_sec;
+    fingerprint.mtimeNanoseconds = status.st_mtim.tv_nsec;
+    fingerprint.hash             = hash( contents.data(), contents.size() );
+
+    return static_cast< uint64_t >( status.st_size ) == fingerprint.size;
+}
+
+bool
+KDCsv::matches( const KDMappedFile& cache,
+                const Fingerprint&  source,
+                const size_t        valueSize,
+                CacheHeader&        header )
+{
+    if ( cache.size() < sizeof( header ) )
+    {
+        return false;
+    }
+    std::memcpy( &header, cache.data(), sizeof( header ) );
+
+    return ( 0 == std::memcmp( header.magic,
+                               Constants::KDTREE_CSV_CACHE_MAGIC.data(),
+                               sizeof( header.magic ) ) ) &&
+           ( header.source.size             == source.size             ) &&
+           ( header.source.mtimeSeconds     == source.mtimeSeconds     ) &&
+           ( header.source.mtimeNanoseconds == source.mtimeNanoseconds ) &&
+           ( header.source.hash             == source.hash             ) &&
+           ( header.valueSize == valueSize ) &&
+           ( !header.numPoints || header.dimension ) &&
+           ( header.numPoints <= source.size ) &&
+           ( header.dimension <= source.size ) &&
+           ( cache.size() == sizeof( header ) +
+                             header.numPoints * header.dimension *
+                             valueSize );
+}
+
+bool
+KDCsv::writeCache( const std::string& cacheFile,
+                   const CacheHeader& header,
+                   const void*        values,
+                   const size_t       size )
+{
+    // A name of its own, so that concurrent runs never write the same file
+    std::string temporaryFile = cacheFile + ".XXXXXX";
+    const int descriptor = ::mkstemp( &temporaryFile[ 0 ] );
+    if ( descriptor < 0 )
+    {
+        return false;
+    }
+
+    // mkstemp() leaves the file readable by its owner only
+    bool written = 0 == ::fchmod( descriptor, S_IRUSR | S_IWUSR |
+                                              S_IRGRP | S_IROTH );
+    written = written && writeFully( descriptor, &header, sizeof( header ) );
+    written = written && writeFully( descriptor, values, size );
+
+    // On disk before it is visible under its final name
+    written = written && ( 0 == ::fsync( descriptor ) );
+    written = ( 0 == ::close( descriptor ) ) && written;
+
+    if ( !written ||
+         ( 0 != std::rename( temporaryFile.c_str(), cacheFile.c_str() ) ) )
+    {
+        std::remove( temporaryFile.c_str() );
+        return false;
+    }
+
+    return true;
+}
+
+bool
+KDCsv::writeFully( const int    descriptor,
+                   const void*  buffer,
+                   const size_t size )
+{
+    const char* cursor = static_cast< const char* >( buffer );
+    size_t      left   = size;
+    while ( left )
+    {
+        const ssize_t result = ::write( descriptor, cursor, left );
+        if ( result < 0 )
+        {
+            if ( EINTR == errno )
+            {
+                continue;
+            }
+            return false;
+        }
+
+        cursor += result;
+        left   -= static_cast< size_t >( result );
+    }
+
+    return true;
+}
+
+} // namespace datastructures
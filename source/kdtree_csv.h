@@ -0,0 +1,452 @@
+#ifndef KDTREE_CSV_H
+#define KDTREE_CSV_H
+
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "kdtree_types.h"
+#include "kdtree_constants.h"
+#include "kdtree_file.h"
+
+// @Purpose
+//
+// This component loads points from CSV files, one point per line with comma
+// separated coordinates, as both build_kdtree and query_kdtree expect them.
+//
+// Optionally, parsed points are cached in a binary sidecar next to the CSV
+// file, named after it with KDTREE_CSV_CACHE_SUFFIX appended. The sidecar
+// records size, modification time and a hash of the CSV file it was made
+// from, followed by the coordinates exactly as the points hold them. Later
+// loads finding all three unchanged map the sidecar instead of parsing the
+// text. Checking the hash still reads the CSV file, but sequentially and
+// without parsing it.
+//
+// A sidecar holds coordinates of a single type, so loading a file as points
+// of another type parses it again and replaces the sidecar.
+//
+
+namespace datastructures {
+
+struct KDCsv {
+    // TYPES
+    struct Fingerprint {
+        uint64_t    size;
+            // Size of the file in bytes
+
+        int64_t     mtimeSeconds;
+            // Modification time of the file, seconds part
+
+        int64_t     mtimeNanoseconds;
+            // Modification time of the file, nanoseconds part
+
+        uint64_t    hash;
+            // Hash of the contents of the file
+    };
+        // Identity of a CSV file that a sidecar was made from
+
+    struct CacheHeader {
+        char        magic[ 8 ];
+            // KDTREE_CSV_CACHE_MAGIC
+
+        Fingerprint source;
+            // The CSV file the sidecar was made from
+
+        uint64_t    valueSize;
+            // Size of a coordinate in bytes
+
+        uint64_t    numPoints;
+            // Number of points
+
+        uint64_t    dimension;
+            // Number of coordinates of every point
+    };
+        // Leads a sidecar, followed by the coordinates of all the points
+
+    // PRIMARY INTERFACE
+    static std::string cacheName( const std::string& csvFile );
+        // Returns name of the sidecar of the provided CSV file
+
+    static uint64_t hash( const char* data, const size_t size );
+        // Returns a hash of size bytes at data, meant to detect changes
+        // rather than to resist tampering
+
+    static bool fingerprint( const std::string&  csvFile,
+                             const KDMappedFile& contents,
+                             Fingerprint&        fingerprint );
+        // Fills fingerprint of the provided CSV file, mapped into contents.
+        // Returns true on success and false otherwise.
+
+    static bool matches( const KDMappedFile& cache,
+                         const Fingerprint&  source,
+                         const size_t        valueSize,
+                         CacheHeader&        header );
+        // Reads header of the mapped sidecar. Returns true if the sidecar
+        // is complete, was made from source and holds coordinates of
+        // valueSize bytes.
+
+    static bool writeCache( const std::string& cacheFile,
+                            const CacheHeader& header,
+                            const void*        values,
+                            const size_t       size );
+        // Writes header and size bytes of values to the sidecar under a
+        // unique temporary name first, flushes it to disk, then renames it,
+        // so that concurrent runs never map a partial sidecar.
+        // Returns true on success and false otherwise.
+
+    template< typename T >
+    static bool parseLine( const char*       line,
+                           const char*       lineEnd,
+                           std::vector< T >& values,
+                           size_t&           count );
+        // Appends coordinates of the comma separated line to values and
+        // sets count to their number. The line must be followed by a
+        // character that cannot continue a number. Returns false on
+        // malformed input. Every CSV reader goes through it, so that all of
+        // them accept the same files.
+
+private:
+    static bool writeFully( const int    descriptor,
+                            const void*  buffer,
+                            const size_t size );
+        // Writes exactly size bytes of buffer. Returns false on an error.
+};
+
+template< typename T >
+class KDCsvPoints {
+public:
+    // CREATORS
+    KDCsvPoints();
+        // Default constructor, holds no points
+
+    // PRIMARY INTERFACE
+    bool load( const std::string& csvFile, const bool useCache = false );
+        // Loads points of the provided CSV file, replacing any points
+        // loaded before. With useCache, maps the sidecar of the file if it
+        // is up to date, and writes it after parsing otherwise; failing to
+        // write the sidecar is not an error.
+        // Blank lines are skipped. Returns false if the file cannot be
+        // read, a coordinate is malformed or points differ in cardinality.
+
+    // ACCESSORS
+    size_t size() const;
+        // Returns number of loaded points
+
+    size_t dimension() const;
+        // Returns number of coordinates of every point
+
+    const T* data() const;
+        // Returns coordinates of all the points, point i starting at
+        // data() + i * dimension(). Valid until the next load().
+
+    Types::Points< T > points() const;
+        // Returns a copy of the loaded points
+
+    bool fromCache() const;
+        // Returns true if the points were mapped from a sidecar
+
+    std::ostream& print( std::ostream& out ) const;
+        // Prints the loader in a easy to read format
+
+private:
+    // NOT IMPLEMENTED
+    KDCsvPoints( const KDCsvPoints& );
+    KDCsvPoints& operator=( const KDCsvPoints& );
+
+    bool parse( const char* text, const size_t size );
+        // Parses size bytes of CSV text into m_values
+
+    KDMappedFile        m_cache;
+        // Mapped sidecar, if the points come from one
+
+    std::vector< T >    m_values;
+        // Parsed coordinates, if the points were parsed
+
+    const T*            m_data;
+        // Coordinates of the loaded points, in m_cache or m_values
+
+    size_t              m_size;
+        // Number of loaded points
+
+    size_t              m_dimension;
+        // Number of coordinates of every point
+
+    bool                m_fromCache;
+        // Whether the points come from a sidecar
+};
+
+// INDEPENDENT OPERATORS
+template< typename T >
+std::ostream& operator<<( std::ostream& lhs, const KDCsvPoints< T >& rhs );
+
+//============================================================================
+//                  CREATORS
+//============================================================================
+
+template< typename T >
+KDCsvPoints< T >::KDCsvPoints()
+: m_data( nullptr )
+, m_size( 0u )
+, m_dimension( 0u )
+, m_fromCache( false )
+{
+    // nothing to do here
+}
+
+//============================================================================
+//                  PRIMARY INTERFACE
+//============================================================================
+
+template< typename T >
+bool
+KDCsv::parseLine( const char*       line,
+                  const char*       lineEnd,
+                  std::vector< T >& values,
+                  size_t&           count )
+{
+    count = 0u;
+    while ( true )
+    {
+        while ( ( line != lineEnd ) &&
+                ( ( ' ' == *line ) || ( '\t' == *line ) ) )
+        {
+            ++line;
+        }
+
+        // strtod() would skip any white space, line breaks included
+        if ( ( line == lineEnd ) ||
+             std::isspace( static_cast< unsigned char >( *line ) ) )
+        {
+            return false;
+        }
+
+        char* parsed;
+        const double value = std::strtod( line, &parsed );
+        if ( ( parsed == line ) || ( parsed > lineEnd ) )
+        {
+            return false;
+        }
+        values.push_back( static_cast< T >( value ) );
+        ++count;
+
+        line = parsed;
+        while ( ( line != lineEnd ) &&
+                ( ( ' ' == *line ) || ( '\t' == *line ) ) )
+        {
+            ++line;
+        }
+
+        if ( line == lineEnd )
+        {
+            return true;
+        }
+
+        if ( ',' != *line )
+        {
+            return false;
+        }
+        ++line;
+    }
+}
+
+template< typename T >
+bool
+KDCsvPoints< T >::load( const std::string& csvFile, const bool useCache )
+{
+    m_cache.close();
+    m_values.clear();
+    m_data      = nullptr;
+    m_size      = 0u;
+    m_dimension = 0u;
+    m_fromCache = false;
+
+    KDMappedFile csv;
+    if ( !csv.open( csvFile ) )
+    {
+        std::cerr << "KDCsvPoints::load() is unable to open "
+                  << "'" << csvFile << "' for reading"
+                  << std::endl;
+        return false;
+    }
+
+    // First an up to date sidecar
+    KDCsv::Fingerprint source;
+    KDCsv::CacheHeader header;
+    const bool cacheable = useCache &&
+                           KDCsv::fingerprint( csvFile, csv, source );
+    if ( cacheable &&
+         m_cache.open( KDCsv::cacheName( csvFile ) ) &&
+         KDCsv::matches( m_cache, source, sizeof( T ), header ) )
+    {
+        m_data = reinterpret_cast< const T* >( m_cache.data() +
+                                               sizeof( header ) );
+        m_size      = static_cast< size_t >( header.numPoints );
+        m_dimension = static_cast< size_t >( header.dimension );
+        m_fromCache = true;
+        return true;
+    }
+    m_cache.close();
+
+    // Second the text itself
+    if ( !parse( csv.data(), csv.size() ) )
+    {
+        std::cerr << "KDCsvPoints::load() encountered a malformed point "
+                  << m_size << " in '" << csvFile << "'"
+                  << std::endl;
+        m_values.clear();
+        m_size      = 0u;
+        m_dimension = 0u;
+        return false;
+    }
+    m_data = m_values.empty() ? nullptr : &m_values[ 0 ];
+
+    if ( cacheable )
+    {
+        std::memcpy( header.magic, Constants::KDTREE_CSV_CACHE_MAGIC.data(),
+                     sizeof( header.magic ) );
+        header.source    = source;
+        header.valueSize = sizeof( T );
+        header.numPoints = m_size;
+        header.dimension = m_dimension;
+        if ( !KDCsv::writeCache( KDCsv::cacheName( csvFile ), header, m_data,
+                                 m_values.size() * sizeof( T ) ) )
+        {
+            std::cerr << "KDCsvPoints::load() is unable to write a cache "
+                      << "of '" << csvFile << "'"
+                      << std::endl;
+        }
+    }
+
+    return true;
+}
+
+template< typename T >
+bool
+KDCsvPoints< T >::parse( const char* text, const size_t size )
+{
+    // Coordinates are parsed in place, which needs a character that cannot
+    // continue a number after each of them. Only the last line may lack its
+    // line break, so it is parsed from a null terminated copy.
+    const char* cursor = text;
+    const char* end    = text + size;
+    std::string lastLine;
+
+    while ( cursor != end )
+    {
+        const char* line    = cursor;
+        const char* lineEnd = static_cast< const char* >(
+                                      std::memchr( cursor, '\n',
+                                                   end - cursor ) );
+        if ( lineEnd )
+        {
+            cursor = lineEnd + 1;
+        }
+        else
+        {
+            lastLine.assign( cursor, end );
+            line    = lastLine.c_str();
+            lineEnd = line + lastLine.size();
+            cursor  = end;
+        }
+
+        if ( ( lineEnd != line ) && ( '\r' == *( lineEnd - 1 ) ) )
+        {
+            --lineEnd;
+        }
+
+        if ( lineEnd == line )
+        {
+            continue;
+        }
+
+        size_t count;
+        if ( !KDCsv::parseLine( line, lineEnd, m_values, count ) ||
+             ( m_size && ( count != m_dimension ) ) )
+        {
+            return false;
+        }
+
+        m_dimension = count;
+        ++m_size;
+    }
+
+    return true;
+}
+
+//============================================================================
+//                  ACCESSORS
+//============================================================================
+
+template< typename T >
+size_t
+KDCsvPoints< T >::size() const
+{
+    return m_size;
+}
+
+template< typename T >
+size_t
+KDCsvPoints< T >::dimension() const
+{
+    return m_dimension;
+}
+
+template< typename T >
+const T*
+KDCsvPoints< T >::data() const
+{
+    return m_data;
+}
+
+template< typename T >
+Types::Points< T >
+KDCsvPoints< T >::points() const
+{
+    Types::Points< T > result;
+    result.reserve( m_size );
+    for ( size_t i = 0; i < m_size; ++i )
+    {
+        result.push_back( Types::Point< T >( m_data + i * m_dimension,
+                                             m_data + ( i + 1u ) *
+                                                      m_dimension ) );
+    }
+
+    return result;
+}
+
+template< typename T >
+bool
+KDCsvPoints< T >::fromCache() const
+{
+    return m_fromCache;
+}
+
+template< typename T >
+std::ostream&
+KDCsvPoints< T >::print( std::ostream& out ) const
+{
+    out << "KDCsvPoints:[ "
+        << "size = "      << m_size      << ", "
+        << "dimension = " << m_dimension << ", "
+        << "from cache = '" << ( m_fromCache ? "yes" : "no" ) << "' ]";
+
+    return out;
+}
+
+//============================================================================
+//                  INDEPENDENT OPERATORS
+//============================================================================
+
+template< typename T >
+std::ostream& operator<<( std::ostream& lhs, const KDCsvPoints< T >& rhs )
+{
+    return rhs.print( lhs );
+}
+
+} // namespace datastructures
+
+#endif // KDTREE_CSV_H
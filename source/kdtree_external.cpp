@@ -0,0 +1,5 @@
+#include "kdtree_external.h"
+
+namespace datastructures {
+
+} // namespace datastructures
@@ -0,0 +1,757 @@
+#ifndef KDTREE_EXTERNAL_H
+#define KDTREE_EXTERNAL_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "kdtree_types.h"
+#include "kdtree.h"
+#include "kdtree_node.h"
+#include "kdtree_hyperplane.h"
+#include "kdtree_options.h"
+#include "kdtree_constants.h"
+#include "kdtree_csv.h"
+
+// @Purpose
+//
+// This class builds a serialized KDTree out of a sample file too large to be
+// loaded into memory at once, keeping to a memory budget.
+//
+// The sample file is read once and converted into a binary scratch file of
+// ( input index, coordinates ) records, while the bounding box of the points
+// is collected. A partition - the root one being the whole scratch file -
+// whose points fit the budget is loaded and built into an in-memory KDTree.
+// A larger partition is split on disk instead: its axis of widest range is
+// split at the median of a random sample of its points, and its records are
+// streamed into two child partitions, which are processed recursively.
+//
+// The serialized tree is written sequentially: the header and the points are
+// copied from the scratch file, then the structure is appended in preorder
+// as partitions are split and built, leaf indexes of in-memory subtrees
+// mapped back to input order indexes. The result is read by
+// KDTree::deserialize() like any other serialized KDTree.
+//
+// Scratch files are named after the scratch prefix and removed as soon as
+// they are consumed.
+//
+
+namespace datastructures {
+
+template< typename T >
+class KDExternalBuilder {
+public:
+    // CREATORS
+    explicit KDExternalBuilder( const size_t       memoryBudget,
+                                const std::string& scratchPrefix
+                                                            = std::string() );
+        // Constructor, memoryBudget is the peak number of bytes of point
+        // data and tree structure held in memory during build(). Scratch
+        // files are created next to the tree file unless scratchPrefix is
+        // provided.
+
+    virtual ~KDExternalBuilder();
+        // Destructor
+
+    // PRIMARY INTERFACE
+    bool build( const std::string& sampleFile,
+                const std::string& treeFile );
+        // Builds a KDTree on the points of sampleFile, one comma separated
+        // point per line, and serializes it to treeFile.
+        // Returns true on success and false otherwise.
+
+    static size_t bytesPerPoint( const size_t dimension );
+        // Returns estimated number of bytes an in-memory build takes per
+        // point of the provided dimension
+
+    // ACCESSORS
+    size_t memoryBudget() const;
+        // Returns the memory budget in bytes
+
+    size_t numPoints() const;
+        // Returns number of points of the last build()
+
+    size_t numPartitions() const;
+        // Returns number of partitions built in memory by the last build()
+
+    size_t largestPartition() const;
+        // Returns number of points of the largest partition built in memory
+        // by the last build()
+
+    std::ostream& print( std::ostream& out ) const;
+        // Prints the KDExternalBuilder in a easy to read format
+
+private:
+    class Subtree : public KDTree< T > {
+    public:
+        Subtree( const T*     data,
+                 const size_t count,
+                 const size_t dimension );
+            // Constructor, builds the tree over the provided flat buffer
+
+        void serializeStructure( std::ostream&                fileStream,
+                                 const std::vector< uint64_t >& indexes )
+                                                                        const;
+            // Writes the structure as KDTree::serialize() does, leaf index i
+            // written as indexes[ i ]
+
+    private:
+        static KDTreeOptions arenaOptions();
+            // Returns options of the in-memory builds, nodes in an arena
+
+        void serializeHelper( std::ostream&                  fileStream,
+                              const typename KDTree< T >::NodePtr& root,
+                              const std::vector< uint64_t >& indexes ) const;
+            // A recursive helper function of the above
+    };
+
+    bool splitPartition( const std::string&            partition,
+                         const size_t                  count,
+                         const Types::AxisMinMax< T >& box,
+                         std::ostream&                 treeData );
+        // Builds the partition, appending its structure to treeData, and
+        // removes the partition file. Splits it on disk if it exceeds the
+        // budget, calls buildPartition() otherwise.
+
+    bool buildPartition( const std::string& partition,
+                         const size_t       count,
+                         std::ostream&      treeData );
+        // Loads the partition, builds it in memory and appends its structure
+        // to treeData
+
+    bool sampleMedian( const std::string& partition,
+                       const size_t       axis,
+                       T&                 median );
+        // Finds median of a random sample of the partition's values on axis
+
+    bool nextValue( const std::string& partition,
+                    const size_t       axis,
+                    const T            lowest,
+                    T&                 next ) const;
+        // Finds the smallest of the partition's values on axis above lowest.
+        // Returns false if there is none or the partition cannot be read.
+
+    std::string scratchFile();
+        // Returns a fresh scratch file name
+
+    bool readRecord( std::istream& in, uint64_t& index, T* point ) const;
+        // Reads a scratch record. Returns false at the end of the stream.
+
+    void writeRecord( std::ostream&  out,
+                      const uint64_t index,
+                      const T*       point ) const;
+        // Writes a scratch record
+
+    static bool parsePoint( const std::string&  line,
+                            Types::Point< T >&  point );
+        // Parses a comma separated point as KDCsvPoints does, leaving point
+        // empty for a blank line. Returns true on success and false
+        // otherwise.
+
+    static void extend( Types::AxisMinMax< T >& box, const T* point,
+                        const size_t dimension );
+        // Grows box to contain point
+
+    size_t              m_memoryBudget;
+        // Peak number of bytes held by build()
+
+    std::string         m_scratchPrefix;
+        // Prefix of scratch file names
+
+    std::string         m_activePrefix;
+        // Prefix of scratch file names of the running build()
+
+    size_t              m_dimension;
+        // Cardinality of the points of the last build()
+
+    size_t              m_numPoints;
+        // Number of points of the last build()
+
+    size_t              m_numPartitions;
+        // Number of partitions built in memory by the last build()
+
+    size_t              m_largestPartition;
+        // Largest partition built in memory by the last build()
+
+    size_t              m_numScratchFiles;
+        // Number of scratch files created by the running build()
+
+    std::mt19937        m_generator;
+        // Source of the median samples
+};
+
+//============================================================================
+//                  CREATORS
+//============================================================================
+
+template< typename T >
+KDExternalBuilder< T >::KDExternalBuilder( const size_t       memoryBudget,
+                                           const std::string& scratchPrefix )
+: m_memoryBudget( memoryBudget )
+, m_scratchPrefix( scratchPrefix )
+, m_dimension( 0u )
+, m_numPoints( 0u )
+, m_numPartitions( 0u )
+, m_largestPartition( 0u )
+, m_numScratchFiles( 0u )
+{
+    // nothing to do here
+}
+
+template< typename T >
+KDExternalBuilder< T >::~KDExternalBuilder()
+{
+    // nothing to do here
+}
+
+template< typename T >
+KDExternalBuilder< T >::Subtree::Subtree( const T*     data,
+                                          const size_t count,
+                                          const size_t dimension )
+: KDTree< T >( data, count, dimension, dimension, arenaOptions() )
+{
+    // nothing to do here
+}
+
+//============================================================================
+//                  PRIMARY INTERFACE
+//============================================================================
+
+template< typename T >
+bool
+KDExternalBuilder< T >::build( const std::string& sampleFile,
+                               const std::string& treeFile )
+{
+    m_activePrefix     = m_scratchPrefix.empty() ? treeFile + ".scratch"
+                                                 : m_scratchPrefix;
+    m_dimension        = 0u;
+    m_numPoints        = 0u;
+    m_numPartitions    = 0u;
+    m_largestPartition = 0u;
+    m_numScratchFiles  = 0u;
+    m_generator.seed( std::mt19937::default_seed );
+
+    std::ifstream sampleData( sampleFile );
+    if ( !sampleData.is_open() )
+    {
+        std::cerr << "KDExternalBuilder::build() is unable to open "
+                  << "'" << sampleFile << "' for reading"
+                  << std::endl;
+        return false;
+    }
+
+    // First pass - convert the sample file into the root partition
+    const std::string root = scratchFile();
+    std::ofstream rootData( root, std::ios::binary | std::ios::trunc );
+    if ( !rootData.is_open() )
+    {
+        std::cerr << "KDExternalBuilder::build() is unable to open "
+                  << "'" << root << "' for writing"
+                  << std::endl;
+        return false;
+    }
+
+    Types::AxisMinMax< T > box;
+    Types::Point< T > point;
+    std::string line;
+    size_t lineNumber = 0u;
+    while ( getline( sampleData, line ) )
+    {
+        ++lineNumber;
+        const bool parsed = parsePoint( line, point );
+        if ( parsed && point.empty() )
+        {
+            continue;
+        }
+
+        if ( !parsed || ( m_numPoints && ( point.size() != m_dimension ) ) )
+        {
+            std::cerr << "KDExternalBuilder::build() invalid point on line "
+                      << lineNumber << " of '" << sampleFile << "'"
+                      << std::endl;
+            rootData.close();
+            std::remove( root.c_str() );
+            return false;
+        }
+
+        m_dimension = point.size();
+        extend( box, point.data(), m_dimension );
+        writeRecord( rootData, m_numPoints++, point.data() );
+    }
+    sampleData.close();
+    rootData.close();
+
+    std::ofstream treeData( treeFile, std::ios::trunc );
+    if ( !treeData.is_open() )
+    {
+        std::cerr << "KDExternalBuilder::build() is unable to open "
+                  << "'" << treeFile << "' for writing"
+                  << std::endl;
+        std::remove( root.c_str() );
+        return false;
+    }
+
+    // Second pass - header and points, in input order
+    treeData << Constants::KDTREE_SIMPLE_VARIETY << '\n';
+    treeData << m_numPoints << '\n';
+
+    std::ifstream points( root, std::ios::binary );
+    uint64_t index;
+    point.resize( m_dimension );
+    while ( readRecord( points, index, point.data() ) )
+    {
+        treeData << point[ 0 ];
+        for ( size_t j = 1; j < m_dimension; ++j )
+        {
+            treeData << ',' << point[ j ];
+        }
+        treeData << '\n';
+    }
+    points.close();
+
+    // Remaining passes - structure in preorder
+    if ( !m_numPoints )
+    {
+        std::remove( root.c_str() );
+        treeData << Constants::KDTREE_EMPTY_MARKER << '\n';
+        return treeData.good();
+    }
+
+    if ( !splitPartition( root, m_numPoints, box, treeData ) )
+    {
+        treeData.close();
+        std::remove( treeFile.c_str() );
+        return false;
+    }
+
+    return treeData.good();
+}
+
+template< typename T >
+size_t
+KDExternalBuilder< T >::bytesPerPoint( const size_t dimension )
+{
+    // Coordinates and input index of the loaded point, two arena nodes, and
+    // the index containers of the median build recursion
+    return dimension * sizeof( T ) + sizeof( uint64_t ) +
+           2u * sizeof( typename KDTree< T >::Node ) + 3u * sizeof( size_t );
+}
+
+template< typename T >
+void
+KDExternalBuilder< T >::Subtree::serializeStructure(
+        std::ostream&                  fileStream,
+        const std::vector< uint64_t >& indexes ) const
+{
+    serializeHelper( fileStream, this->m_root, indexes );
+}
+
+template< typename T >
+KDTreeOptions
+KDExternalBuilder< T >::Subtree::arenaOptions()
+{
+    KDTreeOptions options;
+    options.nodeAllocation = KDTreeOptions::ARENA_NODES;
+    return options;
+}
+
+template< typename T >
+void
+KDExternalBuilder< T >::Subtree::serializeHelper(
+        std::ostream&                        fileStream,
+        const typename KDTree< T >::NodePtr& root,
+        const std::vector< uint64_t >&       indexes ) const
+{
+    if ( root->isLeaf() )
+    {
+        fileStream << Constants::KDTREE_LEAF_MARKER << '\n';
+        fileStream << indexes[ root->leafPointIndex() ] << '\n';
+        return;
+    }
+
+    fileStream << Constants::KDTREE_HYPERPLANE_MARKER << '\n';
+    fileStream << root->hyperplane().serialize() << '\n';
+
+    serializeHelper( fileStream, root->left(),  indexes );
+    serializeHelper( fileStream, root->right(), indexes );
+}
+
+template< typename T >
+bool
+KDExternalBuilder< T >::splitPartition( const std::string&            partition,
+                                        const size_t                  count,
+                                        const Types::AxisMinMax< T >& box,
+                                        std::ostream&                 treeData )
+{
+    if ( ( count < 2u ) ||
+         ( count <= m_memoryBudget / bytesPerPoint( m_dimension ) ) )
+    {
+        const bool result = buildPartition( partition, count, treeData );
+        std::remove( partition.c_str() );
+        return result;
+    }
+
+    // Axis of the widest range, as KDTree::chooseBestSplit()
+    size_t axis = 0u;
+    for ( size_t i = 1; i < box.size(); ++i )
+    {
+        if ( box[ i ].second - box[ i ].first >
+             box[ axis ].second - box[ axis ].first )
+        {
+            axis = i;
+        }
+    }
+
+    // Keep both sides non-empty: the value must be above the smallest
+    // coordinate and not above the largest. A median at the smallest
+    // coordinate, e.g. of an axis with many ties, is replaced by the next
+    // distinct value, which sends all the ties left as KDTree::partition()
+    // does. If all the points coincide, any halving will do.
+    const bool coincide = !( box[ axis ].first < box[ axis ].second );
+    T value = box[ axis ].first;
+    if ( !coincide )
+    {
+        bool found = sampleMedian( partition, axis, value );
+        if ( found && !( box[ axis ].first < value ) )
+        {
+            found = nextValue( partition, axis, box[ axis ].first, value );
+        }
+
+        if ( !found )
+        {
+            std::remove( partition.c_str() );
+            return false;
+        }
+    }
+
+    const std::string left  = scratchFile();
+    const std::string right = scratchFile();
+
+    std::ifstream partitionData( partition, std::ios::binary );
+    std::ofstream leftData(  left,  std::ios::binary | std::ios::trunc );
+    std::ofstream rightData( right, std::ios::binary | std::ios::trunc );
+    if ( !partitionData.is_open() || !leftData.is_open() ||
+         !rightData.is_open() )
+    {
+        std::cerr << "KDExternalBuilder::build() is unable to split "
+                  << "'" << partition << "'"
+                  << std::endl;
+        std::remove( partition.c_str() );
+        std::remove( left.c_str() );
+        std::remove( right.c_str() );
+        return false;
+    }
+
+    Types::AxisMinMax< T > leftBox;
+    Types::AxisMinMax< T > rightBox;
+    size_t leftCount  = 0u;
+    size_t rightCount = 0u;
+
+    std::vector< T > point( m_dimension );
+    uint64_t index;
+    while ( readRecord( partitionData, index, point.data() ) )
+    {
+        const bool goesLeft = coincide ? ( leftCount < count / 2u )
+                                       : ( point[ axis ] < value );
+        if ( goesLeft )
+        {
+            extend( leftBox, point.data(), m_dimension );
+            writeRecord( leftData, index, point.data() );
+            ++leftCount;
+        }
+        else
+        {
+            extend( rightBox, point.data(), m_dimension );
+            writeRecord( rightData, index, point.data() );
+            ++rightCount;
+        }
+    }
+    partitionData.close();
+    leftData.close();
+    rightData.close();
+    std::remove( partition.c_str() );
+
+    treeData << Constants::KDTREE_HYPERPLANE_MARKER << '\n';
+    treeData << KDHyperplane< T >( axis, value ).serialize() << '\n';
+
+    const bool result = splitPartition( left, leftCount, leftBox, treeData );
+    if ( !result )
+    {
+        std::remove( right.c_str() );
+        return false;
+    }
+
+    return splitPartition( right, rightCount, rightBox, treeData );
+}
+
+template< typename T >
+bool
+KDExternalBuilder< T >::buildPartition( const std::string& partition,
+                                        const size_t       count,
+                                        std::ostream&      treeData )
+{
+    std::ifstream partitionData( partition, std::ios::binary );
+    if ( !partitionData.is_open() )
+    {
+        std::cerr << "KDExternalBuilder::build() is unable to open "
+                  << "'" << partition << "' for reading"
+                  << std::endl;
+        return false;
+    }
+
+    std::vector< T >        data( count * m_dimension );
+    std::vector< uint64_t > indexes( count );
+    for ( size_t i = 0; i < count; ++i )
+    {
+        if ( !readRecord( partitionData, indexes[ i ],
+                          data.data() + i * m_dimension ) )
+        {
+            std::cerr << "KDExternalBuilder::build() '" << partition << "' "
+                      << "is truncated"
+                      << std::endl;
+            return false;
+        }
+    }
+    partitionData.close();
+
+    const Subtree subtree( data.data(), count, m_dimension );
+    subtree.serializeStructure( treeData, indexes );
+
+    ++m_numPartitions;
+    m_largestPartition = std::max( m_largestPartition, count );
+
+    return true;
+}
+
+template< typename T >
+bool
+KDExternalBuilder< T >::sampleMedian( const std::string& partition,
+                                      const size_t       axis,
+                                      T&                 median )
+{
+    std::ifstream partitionData( partition, std::ios::binary );
+    if ( !partitionData.is_open() )
+    {
+        std::cerr << "KDExternalBuilder::build() is unable to open "
+                  << "'" << partition << "' for reading"
+                  << std::endl;
+        return false;
+    }
+
+    // Reservoir sample, bounded by the budget
+    const size_t sampleSize = std::max< size_t >( 1u, std::min(
+            Constants::KDTREE_SPLIT_SAMPLE_SIZE,
+            m_memoryBudget / sizeof( T ) ) );
+
+    std::vector< T > sample;
+    sample.reserve( sampleSize );
+
+    std::vector< T > point( m_dimension );
+    uint64_t index;
+    size_t seen = 0u;
+    while ( readRecord( partitionData, index, point.data() ) )
+    {
+        if ( sample.size() < sampleSize )
+        {
+            sample.push_back( point[ axis ] );
+        }
+        else
+        {
+            std::uniform_int_distribution< size_t > draw( 0u, seen );
+            const size_t slot = draw( m_generator );
+            if ( slot < sampleSize )
+            {
+                sample[ slot ] = point[ axis ];
+            }
+        }
+        ++seen;
+    }
+
+    if ( sample.empty() )
+    {
+        return false;
+    }
+
+    const size_t n = sample.size() / 2;
+    std::nth_element( sample.begin(), sample.begin() + n, sample.end() );
+    median = sample[ n ];
+
+    return true;
+}
+
+template< typename T >
+bool
+KDExternalBuilder< T >::nextValue( const std::string& partition,
+                                   const size_t       axis,
+                                   const T            lowest,
+                                   T&                 next ) const
+{
+    std::ifstream partitionData( partition, std::ios::binary );
+    if ( !partitionData.is_open() )
+    {
+        std::cerr << "KDExternalBuilder::build() is unable to open "
+                  << "'" << partition << "' for reading"
+                  << std::endl;
+        return false;
+    }
+
+    bool found = false;
+    std::vector< T > point( m_dimension );
+    uint64_t index;
+    while ( readRecord( partitionData, index, point.data() ) )
+    {
+        if ( ( lowest < point[ axis ] ) && ( !found || point[ axis ] < next ) )
+        {
+            next  = point[ axis ];
+            found = true;
+        }
+    }
+
+    return found;
+}
+
+template< typename T >
+std::string
+KDExternalBuilder< T >::scratchFile()
+{
+    std::ostringstream name;
+    name << m_activePrefix << '.' << m_numScratchFiles++;
+    return name.str();
+}
+
+template< typename T >
+bool
+KDExternalBuilder< T >::readRecord( std::istream& in,
+                                    uint64_t&     index,
+                                    T*            point ) const
+{
+    in.read( reinterpret_cast< char* >( &index ), sizeof( index ) );
+    in.read( reinterpret_cast< char* >( point ), m_dimension * sizeof( T ) );
+
+    return static_cast< bool >( in );
+}
+
+template< typename T >
+void
+KDExternalBuilder< T >::writeRecord( std::ostream&  out,
+                                     const uint64_t index,
+                                     const T*       point ) const
+{
+    out.write( reinterpret_cast< const char* >( &index ), sizeof( index ) );
+    out.write( reinterpret_cast< const char* >( point ),
+               m_dimension * sizeof( T ) );
+}
+
+template< typename T >
+bool
+KDExternalBuilder< T >::parsePoint( const std::string& line,
+                                    Types::Point< T >& point )
+{
+    point.clear();
+
+    // The terminating null of the line cannot continue a number
+    const char* begin = line.c_str();
+    const char* end   = begin + line.size();
+    if ( ( end != begin ) && ( '\r' == *( end - 1 ) ) )
+    {
+        --end;
+    }
+
+    size_t count;
+    if ( ( end != begin ) &&
+         !KDCsv::parseLine( begin, end, point, count ) )
+    {
+        point.clear();
+        return false;
+    }
+
+    return true;
+}
+
+template< typename T >
+void
+KDExternalBuilder< T >::extend( Types::AxisMinMax< T >& box,
+                                const T*                point,
+                                const size_t            dimension )
+{
+    if ( box.empty() )
+    {
+        for ( size_t i = 0; i < dimension; ++i )
+        {
+            box.push_back( std::pair< T, T >( point[ i ], point[ i ] ) );
+        }
+        return;
+    }
+
+    for ( size_t i = 0; i < dimension; ++i )
+    {
+        box[ i ].first  = std::min( box[ i ].first,  point[ i ] );
+        box[ i ].second = std::max( box[ i ].second, point[ i ] );
+    }
+}
+
+//============================================================================
+//                  ACCESSORS
+//============================================================================
+
+template< typename T >
+size_t
+KDExternalBuilder< T >::memoryBudget() const
+{
+    return m_memoryBudget;
+}
+
+template< typename T >
+size_t
+KDExternalBuilder< T >::numPoints() const
+{
+    return m_numPoints;
+}
+
+template< typename T >
+size_t
+KDExternalBuilder< T >::numPartitions() const
+{
+    return m_numPartitions;
+}
+
+template< typename T >
+size_t
+KDExternalBuilder< T >::largestPartition() const
+{
+    return m_largestPartition;
+}
+
+template< typename T >
+std::ostream&
+KDExternalBuilder< T >::print( std::ostream& out ) const
+{
+    out << "KDExternalBuilder:[ "
+        << "memory budget = "     << m_memoryBudget     << ", "
+        << "num points = "        << m_numPoints        << ", "
+        << "num partitions = "    << m_numPartitions    << ", "
+        << "largest partition = " << m_largestPartition << " ] ";
+
+    return out;
+}
+
+//============================================================================
+//                  INDEPENDENT OPERATORS
+//============================================================================
+
+template< typename T >
+std::ostream& operator<<( std::ostream&                 lhs,
+                          const KDExternalBuilder< T >& rhs )
+{
+    return rhs.print( lhs );
+}
+
+} // namespace datastructures
+
+#endif // KDTREE_EXTERNAL_H
@@ -0,0 +1,221 @@
+#include "kdtree_file.h"
+
+#include <cerrno>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace datastructures {
+
+//============================================================================
+//                  CREATORS
+//============================================================================
+
+KDFile::KDFile()
+: m_descriptor( -1 )
+{
+    // nothing to do here
+}
+
+KDFile::~KDFile()
+{
+    close();
+}
+
+KDMappedFile::KDMappedFile()
+: m_data( nullptr )
+, m_size( 0u )
+, m_open( false )
+{
+    // nothing to do here
+}
+
+KDMappedFile::~KDMappedFile()
+{
+    close();
+}
+
+//============================================================================
+//                  PRIMARY INTERFACE
+//============================================================================
+
+bool
+KDFile::open( const std::string& filename, const Mode mode )
+{
+    close();
+
+    m_descriptor = WRITE == mode ?
+                   ::open( filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC,
+                           0644 ) :
+                   ::open( filename.c_str(), O_RDONLY );
+
+    return isOpen();
+}
+
+void
+KDFile::close()
+{
+    if ( isOpen() )
+    {
+        ::close( m_descriptor );
+        m_descriptor = -1;
+    }
+}
+
+bool
+KDFile::readAt( const uint64_t offset,
+                void*          buffer,
+                const size_t   size ) const
+{
+    char*  bytes = static_cast< char* >( buffer );
+    size_t done  = 0u;
+    while ( done < size )
+    {
+        const off_t   position = static_cast< off_t >( offset + done );
+        const ssize_t result   = ::pread( m_descriptor, bytes + done,
+                                          size - done, position );
+        if ( ( result < 0 ) && ( EINTR == errno ) )
+        {
+            continue;
+        }
+
+        if ( result <= 0 )
+        {
+            return false;
+        }
+
+        done += static_cast< size_t >( result );
+    }
+
+    return true;
+}
+
+bool
+KDFile::writeAt( const uint64_t offset,
+                 const void*    buffer,
+                 const size_t   size ) const
+{
+    const char* bytes = static_cast< const char* >( buffer );
+    size_t      done  = 0u;
+    while ( done < size )
+    {
+        const off_t   position = static_cast< off_t >( offset + done );
+        const ssize_t result   = ::pwrite( m_descriptor, bytes + done,
+                                           size - done, position );
+        if ( ( result < 0 ) && ( EINTR == errno ) )
+        {
+            continue;
+        }
+
+        if ( result <= 0 )
+        {
+            return false;
+        }
+
+        done += static_cast< size_t >( result );
+    }
+
+    return true;
+}
+
+bool
+KDFile::resize( const uint64_t size ) const
+{
+    return 0 == ::ftruncate( m_descriptor, static_cast< off_t >( size ) );
+}
+
+bool
+KDMappedFile::open( const std::string& filename )
+{
+    close();
+
+    const int descriptor = ::open( filename.c_str(), O_RDONLY );
+    if ( descriptor < 0 )
+    {
+        return false;
+    }
+
+    struct stat status;
+    if ( 0 != ::fstat( descriptor, &status ) )
+    {
+        ::close( descriptor );
+        return false;
+    }
+
+    m_size = static_cast< size_t >( status.st_size );
+    if ( m_size )
+    {
+        void* mapping = ::mmap( nullptr, m_size, PROT_READ, MAP_PRIVATE,
+                                descriptor, 0 );
+        if ( MAP_FAILED == mapping )
+        {
+            ::close( descriptor );
+            m_size = 0u;
+            return false;
+        }
+        m_data = mapping;
+    }
+
+    // The mapping outlives the descriptor
+    ::close( descriptor );
+    m_open = true;
+
+    return true;
+}
+
+void
+KDMappedFile::close()
+{
+    if ( m_data )
+    {
+        ::munmap( m_data, m_size );
+    }
+
+    m_data = nullptr;
+    m_size = 0u;
+    m_open = false;
+}
+
+//============================================================================
+//                  ACCESSORS
+//============================================================================
+
+bool
+KDFile::isOpen() const
+{
+    return m_descriptor >= 0;
+}
+
+uint64_t
+KDFile::size() const
+{
+    struct stat status;
+    if ( !isOpen() || ( 0 != ::fstat( m_descriptor, &status ) ) )
+    {
+        return 0u;
+    }
+
+    return static_cast< uint64_t >( status.st_size );
+}
+
+bool
+KDMappedFile::isOpen() const
+{
+    return m_open;
+}
+
+const char*
+KDMappedFile::data() const
+{
+    return static_cast< const char* >( m_data );
+}
+
+size_t
+KDMappedFile::size() const
+{
+    return m_size;
+}
+
+} // namespace datastructures
@@ -0,0 +1,200 @@
+#ifndef KDTREE_FILE_H
+#define KDTREE_FILE_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+// @Purpose
+//
+// This class is a thin wrapper around a POSIX file descriptor providing
+// positioned reads and writes. Unlike streams, positioned I/O keeps no file
+// offset, so any number of threads can read or write disjoint ranges of the
+// same open file at once.
+//
+// It also provides forEach(), which hands tasks out to a pool of threads one
+// at a time, so that chunks of uneven size keep all the threads busy.
+//
+// KDMappedFile maps a whole file read-only into memory, so that large
+// inputs are paged in on demand rather than copied.
+//
+
+namespace datastructures {
+
+class KDFile {
+public:
+    // TYPES
+    enum Mode {
+        READ,
+            // Opens an existing file for reading
+
+        WRITE
+            // Creates or truncates a file for writing
+    };
+
+    // CREATORS
+    KDFile();
+        // Default constructor, no file is open
+
+    ~KDFile();
+        // Destructor, closes the file
+
+    // PRIMARY INTERFACE
+    bool open( const std::string& filename, const Mode mode );
+        // Opens the provided file, closing any file open before.
+        // Returns true on success and false otherwise.
+
+    void close();
+        // Closes the file, if any
+
+    bool readAt( const uint64_t offset,
+                 void*          buffer,
+                 const size_t   size ) const;
+        // Reads size bytes at offset into buffer. Safe to call from several
+        // threads at once. Returns false on an error or a short file.
+
+    bool writeAt( const uint64_t offset,
+                  const void*    buffer,
+                  const size_t   size ) const;
+        // Writes size bytes of buffer at offset. Safe to call from several
+        // threads at once. Returns false on an error.
+
+    bool resize( const uint64_t size ) const;
+        // Sets size of the file, so that writes past its end do not have
+        // to extend it one by one. Returns false on an error.
+
+    template< typename F >
+    static bool forEach( const size_t numTasks,
+                         const size_t numThreads,
+                         F            function );
+        // Calls function( task ), returning bool, for every task of
+        // [0, numTasks) on up to numThreads threads, 0 for all hardware
+        // threads. Tasks are handed out in order, one at a time; once a
+        // task fails or throws the remaining ones are skipped.
+        // Returns true if every task succeeded.
+
+    // ACCESSORS
+    bool isOpen() const;
+        // Returns true if a file is open
+
+    uint64_t size() const;
+        // Returns size of the file, 0 if none is open
+
+private:
+    // NOT IMPLEMENTED
+    KDFile( const KDFile& );
+    KDFile& operator=( const KDFile& );
+
+    int     m_descriptor;
+        // Descriptor of the open file, -1 if none
+};
+
+class KDMappedFile {
+public:
+    // CREATORS
+    KDMappedFile();
+        // Default constructor, no file is mapped
+
+    ~KDMappedFile();
+        // Destructor, unmaps the file
+
+    // PRIMARY INTERFACE
+    bool open( const std::string& filename );
+        // Maps the whole of the provided file read-only, unmapping any file
+        // mapped before. An empty file is open with no data.
+        // Returns true on success and false otherwise.
+
+    void close();
+        // Unmaps the file, if any
+
+    // ACCESSORS
+    bool isOpen() const;
+        // Returns true if a file is mapped
+
+    const char* data() const;
+        // Returns first byte of the file, nullptr if it is empty. Note that
+        // the contents are not null terminated.
+
+    size_t size() const;
+        // Returns size of the file, 0 if none is mapped
+
+private:
+    // NOT IMPLEMENTED
+    KDMappedFile( const KDMappedFile& );
+    KDMappedFile& operator=( const KDMappedFile& );
+
+    void*   m_data;
+        // Mapping of the file, nullptr if it is empty or none is mapped
+
+    size_t  m_size;
+        // Size of the mapping
+
+    bool    m_open;
+        // Whether a file is mapped
+};
+
+//============================================================================
+//                  PRIMARY INTERFACE
+//============================================================================
+
+template< typename F >
+bool
+KDFile::forEach( const size_t numTasks,
+                 const size_t numThreads,
+                 F            function )
+{
+    const size_t hardware = std::max< size_t >(
+                                    1u, std::thread::hardware_concurrency() );
+    const size_t threads  = std::min< size_t >(
+                                    numThreads ? numThreads : hardware,
+                                    numTasks );
+
+    std::atomic< size_t > nextTask( 0u );
+    std::atomic< bool >   failed( false );
+    auto worker = [ & ]()
+    {
+        for ( size_t task = nextTask++; ( task < numTasks ) && !failed;
+              task = nextTask++ )
+        {
+            // An exception must not escape a thread, so it fails the task
+            try
+            {
+                if ( !function( task ) )
+                {
+                    failed = true;
+                }
+            }
+            catch ( ... )
+            {
+                failed = true;
+            }
+        }
+    };
+
+    if ( threads <= 1u )
+    {
+        worker();
+        return !failed;
+    }
+
+    std::vector< std::thread > workers;
+    workers.reserve( threads );
+    for ( size_t thread = 0; thread < threads; ++thread )
+    {
+        workers.push_back( std::thread( worker ) );
+    }
+
+    for ( size_t thread = 0; thread < threads; ++thread )
+    {
+        workers[ thread ].join();
+    }
+
+    return !failed;
+}
+
+} // namespace datastructures
+
+#endif // KDTREE_FILE_H
@@ -0,0 +1,5 @@
+#include "kdtree_flat.h"
+
+namespace datastructures {
+
+} // namespace datastructures
@@ -0,0 +1,268 @@
+#ifndef KDTREE_FLAT_H
+#define KDTREE_FLAT_H
+
+#include <cstdint>
+#include <vector>
+
+#include "kdtree_types.h"
+#include "kdtree_point_view.h"
+#include "kdtree_hyperplane.h"
+#include "kdtree_utils.h"
+#include "kdtree_constants.h"
+#include "kdtree.h"
+
+// @Purpose
+//
+// This struct holds what KDPagedTree and KDSharedTree have in common. Both
+// store a KDTree as an array of nodes referring to their children by id,
+// whether in the pages of a file or in a shared memory segment:
+//  - flatten() lists the nodes of a KDTree in preorder, so that the left
+//    child of a split is the node right after it, and numbers its leaves
+//    left to right. Those are the leaf order slots of the points.
+//  - isValid() checks a node read back from storage. It demands that
+//    children have higher ids than their parents, which is what bounds a
+//    search over nodes that come from a file.
+//  - nearest() searches the nodes wherever they are stored, reading them
+//    one at a time through a source that may fail.
+//
+// nearest() visits the nodes in the order KDTree::nearestPointIndex() does
+// and compares distances the same way, so that it reports the same point
+// for every query, ties included. Neither flatten() nor nearest() recurses,
+// so both cope with trees of any depth.
+//
+
+namespace datastructures {
+
+template< typename T >
+struct KDFlatNode {
+    uint64_t axis;
+        // Split axis, KDTREE_FLAT_LEAF for leaves
+
+    uint64_t left;
+        // Left child id of a split
+
+    uint64_t right;
+        // Right child id of a split
+
+    uint64_t slot;
+        // Leaf order slot of the point of a leaf
+
+    uint64_t index;
+        // Input order index of the point of a leaf
+
+    T        value;
+        // Split value
+};
+
+template< typename T >
+struct KDFlatTree {
+    // TYPES
+    typedef KDFlatNode< T > Node;
+
+    // PRIMARY INTERFACE
+    template< typename I, typename A >
+    static bool flatten( const KDTree< T, I, A >& tree,
+                         std::vector< Node >&     nodes );
+        // Lists nodes of tree in preorder, ids being positions in nodes.
+        // Returns false unless the tree has a leaf per point and two
+        // children per split.
+
+    static bool isValid( const uint64_t id,
+                         const Node&    node,
+                         const uint64_t numIds,
+                         const uint64_t numPoints,
+                         const uint64_t dimension );
+        // Returns true if a split under id has an axis below dimension and
+        // two distinct children with ids above id and below numIds, or a
+        // leaf has slot and index below numPoints
+
+    template< typename Source >
+    static bool nearest( const Source&           source,
+                         const KDPointView< T >& pointOfInterest,
+                         Node&                   best );
+        // Finds the leaf closest to the point of interest, root being node
+        // 0, and copies it into best. Source provides
+        //
+        //   bool node( const uint64_t id, Node& result ) const;
+        //   bool distance( const Node&             leaf,
+        //                  const KDPointView< T >& pointOfInterest,
+        //                  double&                 result ) const;
+        //
+        // both returning false if they fail, in which case so does
+        // nearest(). The point of interest must match the dimension of the
+        // tree and every node provided must be valid.
+};
+
+//============================================================================
+//                  PRIMARY INTERFACE
+//============================================================================
+
+template< typename T >
+template< typename I, typename A >
+bool
+KDFlatTree< T >::flatten( const KDTree< T, I, A >& tree,
+                          std::vector< Node >&     nodes )
+{
+    typedef typename KDTree< T, I, A >::NodePtr NodePtr;
+
+    const size_t numPoints = tree.pointsView().size();
+
+    nodes.clear();
+    nodes.reserve( numPoints ? 2u * numPoints - 1u : 0u );
+
+    // Every right child waits with the id of its parent, whose link it
+    // fills in once its own id is known
+    const uint64_t noParent = Constants::KDTREE_FLAT_LEAF;
+    std::vector< std::pair< NodePtr, uint64_t > > pending;
+    if ( tree.root() )
+    {
+        pending.push_back( std::make_pair( tree.root(), noParent ) );
+    }
+
+    uint64_t numLeaves = 0u;
+    while ( !pending.empty() )
+    {
+        const NodePtr  current = pending.back().first;
+        const uint64_t parent  = pending.back().second;
+        pending.pop_back();
+
+        const uint64_t id = nodes.size();
+        if ( noParent != parent )
+        {
+            nodes[ parent ].right = id;
+        }
+
+        Node node;
+        node.axis  = Constants::KDTREE_FLAT_LEAF;
+        node.left  = 0u;
+        node.right = 0u;
+        node.slot  = 0u;
+        node.index = 0u;
+        node.value = T();
+
+        if ( current->isLeaf() )
+        {
+            const size_t storage = current->leafPointIndex();
+            if ( ( numLeaves == numPoints ) || ( storage >= numPoints ) )
+            {
+                return false;
+            }
+
+            node.slot  = numLeaves++;
+            node.index = tree.inputIndex( storage );
+            nodes.push_back( node );
+            continue;
+        }
+
+        if ( !current->left() || !current->right() )
+        {
+            return false;
+        }
+
+        node.axis  = current->hyperplane().hyperplaneIndex();
+        node.value = current->hyperplane().value();
+        node.left  = id + 1u;
+        nodes.push_back( node );
+
+        pending.push_back( std::make_pair( current->right(), id ) );
+        pending.push_back( std::make_pair( current->left(),  noParent ) );
+    }
+
+    return numLeaves == numPoints;
+}
+
+template< typename T >
+bool
+KDFlatTree< T >::isValid( const uint64_t id,
+                          const Node&    node,
+                          const uint64_t numIds,
+                          const uint64_t numPoints,
+                          const uint64_t dimension )
+{
+    if ( Constants::KDTREE_FLAT_LEAF == node.axis )
+    {
+        return ( node.slot < numPoints ) && ( node.index < numPoints );
+    }
+
+    return ( node.axis  < dimension ) &&
+           ( node.left  > id ) && ( node.left  < numIds ) &&
+           ( node.right > id ) && ( node.right < numIds ) &&
+           ( node.left != node.right );
+}
+
+template< typename T >
+template< typename Source >
+bool
+KDFlatTree< T >::nearest( const Source&           source,
+                          const KDPointView< T >& pointOfInterest,
+                          Node&                   best )
+{
+    // A node still to be visited. The far side of a split waits beneath
+    // the near one and is only visited if, once the near side is done,
+    // its hyperplane is closer than the best point found.
+    struct Pending {
+        uint64_t id;
+        bool     isFar;
+        uint64_t axis;
+        T        value;
+    };
+
+    bool   found        = false;
+    double bestDistance = 0.0;
+
+    std::vector< Pending > pending;
+    const Pending root = { 0u, false, 0u, T() };
+    pending.push_back( root );
+    while ( !pending.empty() )
+    {
+        const Pending next = pending.back();
+        pending.pop_back();
+
+        if ( next.isFar &&
+             !( Utils::distance< T >( pointOfInterest,
+                                      KDHyperplane< T >( next.axis,
+                                                         next.value ) ) <
+                bestDistance ) )
+        {
+            continue;
+        }
+
+        Node current;
+        if ( !source.node( next.id, current ) )
+        {
+            return false;
+        }
+
+        if ( Constants::KDTREE_FLAT_LEAF == current.axis )
+        {
+            double candidate = 0.0;
+            if ( !source.distance( current, pointOfInterest, candidate ) )
+            {
+                return false;
+            }
+
+            if ( !found || ( candidate < bestDistance ) )
+            {
+                best         = current;
+                bestDistance = candidate;
+                found        = true;
+            }
+            continue;
+        }
+
+        const bool goesLeft = pointOfInterest[ current.axis ] < current.value;
+
+        const Pending farSide = { goesLeft ? current.right : current.left,
+                                  true, current.axis, current.value };
+        const Pending nearSide = { goesLeft ? current.left : current.right,
+                                   false, 0u, T() };
+        pending.push_back( farSide );
+        pending.push_back( nearSide );
+    }
+
+    return found;
+}
+
+} // namespace datastructures
+
+#endif // KDTREE_FLAT_H
@@ -0,0 +1,208 @@
+#include "kdtree_histogram.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace datastructures {
+
+namespace {
+
+size_t highestBit( const uint64_t value )
+    // Returns position of the highest bit set of the non-zero value
+{
+#if defined( __GNUC__ )
+    return 63u - static_cast< size_t >( __builtin_clzll( value ) );
+#else
+    size_t position = 0u;
+    for ( uint64_t rest = value >> 1; rest; rest >>= 1 )
+    {
+        ++position;
+    }
+    return position;
+#endif
+}
+
+} // namespace
+
+//============================================================================
+//                  CREATORS
+//============================================================================
+
+KDHistogram::KDHistogram()
+: m_counts( NUM_BUCKETS, 0u )
+, m_count( 0u )
+, m_min( std::numeric_limits< uint64_t >::max() )
+, m_max( 0u )
+, m_sum( 0.0 )
+{
+    // nothing to do here
+}
+
+//============================================================================
+//                  PRIMARY INTERFACE
+//============================================================================
+
+void
+KDHistogram::record( const uint64_t value )
+{
+    ++m_counts[ bucket( value ) ];
+    ++m_count;
+    m_min  = std::min( m_min, value );
+    m_max  = std::max( m_max, value );
+    m_sum += static_cast< double >( value );
+}
+
+void
+KDHistogram::merge( const KDHistogram& other )
+{
+    for ( size_t i = 0; i < NUM_BUCKETS; ++i )
+    {
+        m_counts[ i ] += other.m_counts[ i ];
+    }
+
+    m_count += other.m_count;
+    m_min    = std::min( m_min, other.m_min );
+    m_max    = std::max( m_max, other.m_max );
+    m_sum   += other.m_sum;
+}
+
+void
+KDHistogram::reset()
+{
+    std::fill( m_counts.begin(), m_counts.end(), 0u );
+    m_count = 0u;
+    m_min   = std::numeric_limits< uint64_t >::max();
+    m_max   = 0u;
+    m_sum   = 0.0;
+}
+
+size_t
+KDHistogram::bucket( const uint64_t value )
+{
+    if ( value < SUB_BUCKETS )
+    {
+        return static_cast< size_t >( value );
+    }
+
+    // The top SUB_BUCKET_BITS - 1 bits below the highest one pick the
+    // bucket within its power of two range
+    const size_t shift = highestBit( value ) - ( SUB_BUCKET_BITS - 1u );
+    const size_t top   = static_cast< size_t >( value >> shift );
+
+    return SUB_BUCKETS + ( shift - 1u ) * ( SUB_BUCKETS / 2u ) +
+           ( top - SUB_BUCKETS / 2u );
+}
+
+uint64_t
+KDHistogram::highestEquivalent( const size_t bucket )
+{
+    if ( bucket < SUB_BUCKETS )
+    {
+        return bucket;
+    }
+
+    const size_t   shift = ( bucket - SUB_BUCKETS ) / ( SUB_BUCKETS / 2u ) + 1u;
+    const uint64_t top   = ( bucket - SUB_BUCKETS ) % ( SUB_BUCKETS / 2u ) +
+                           SUB_BUCKETS / 2u;
+
+    // Wraps around to the largest uint64_t for the very last bucket
+    return ( ( top + 1u ) << shift ) - 1u;
+}
+
+//============================================================================
+//                  ACCESSORS
+//============================================================================
+
+uint64_t
+KDHistogram::count() const
+{
+    return m_count;
+}
+
+uint64_t
+KDHistogram::min() const
+{
+    return m_count ? m_min : 0u;
+}
+
+uint64_t
+KDHistogram::max() const
+{
+    return m_max;
+}
+
+double
+KDHistogram::mean() const
+{
+    return m_count ? m_sum / static_cast< double >( m_count ) : 0.0;
+}
+
+uint64_t
+KDHistogram::percentile( const double percent ) const
+{
+    if ( !m_count )
+    {
+        return 0u;
+    }
+
+    const double   clamped = std::min( 100.0, std::max( 0.0, percent ) );
+    const uint64_t rank    = std::max< uint64_t >(
+            1u, static_cast< uint64_t >( std::ceil(
+                        clamped / 100.0 * static_cast< double >( m_count ) ) ) );
+
+    uint64_t seen = 0u;
+    for ( size_t i = 0; i < NUM_BUCKETS; ++i )
+    {
+        seen += m_counts[ i ];
+        if ( seen >= rank )
+        {
+            return std::min( highestEquivalent( i ), m_max );
+        }
+    }
+
+    return m_max;
+}
+
+std::ostream&
+KDHistogram::print( std::ostream& out ) const
+{
+    out << "KDHistogram:[ "
+        << "count = " << count()              << ", "
+        << "min = "   << min()                << ", "
+        << "mean = "  << mean()               << ", "
+        << "p50 = "   << percentile( 50.0 )   << ", "
+        << "p90 = "   << percentile( 90.0 )   << ", "
+        << "p99 = "   << percentile( 99.0 )   << ", "
+        << "p99.9 = " << percentile( 99.9 )   << ", "
+        << "max = "   << max()                << " ]";
+
+    return out;
+}
+
+std::ostream&
+KDHistogram::printJson( std::ostream& out ) const
+{
+    out << "{ "
+        << "\"count\": " << count()            << ", "
+        << "\"min\": "   << min()              << ", "
+        << "\"mean\": "  << mean()             << ", "
+        << "\"p50\": "   << percentile( 50.0 ) << ", "
+        << "\"p90\": "   << percentile( 90.0 ) << ", "
+        << "\"p99\": "   << percentile( 99.0 ) << ", "
+        << "\"p99.9\": " << percentile( 99.9 ) << ", "
+        << "\"max\": "   << max()              << " }";
+
+    return out;
+}
+
+//============================================================================
+//                  INDEPENDENT OPERATORS
+//============================================================================
+
+std::ostream& operator<<( std::ostream& lhs, const KDHistogram& rhs )
+{
+    return rhs.print( lhs );
+}
+
+} // namespace datastructures
@@ -0,0 +1,109 @@
+#ifndef KDTREE_HISTOGRAM_H
+#define KDTREE_HISTOGRAM_H
+
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+// @Purpose
+//
+// This class counts values, e.g. query latencies in nanoseconds, in
+// logarithmically sized buckets, in the manner of an HDR histogram.
+//
+// Values below SUB_BUCKETS are counted exactly. Every power of two range
+// above that is split into SUB_BUCKETS / 2 buckets of equal width, so any
+// value is known to within 1 / 64 of itself whatever its magnitude, and the
+// whole uint64_t range fits in a fixed array of a few thousand counts.
+//
+// record() is a count leading zeros, a shift and an increment, with no
+// allocation and no locking. Threads record into histograms of their own,
+// merged once they are done, since merging adds the counts up bucket by
+// bucket and loses nothing.
+//
+
+namespace datastructures {
+
+class KDHistogram {
+public:
+    // CREATORS
+    KDHistogram();
+        // Default constructor, no values recorded
+
+    // PRIMARY INTERFACE
+    void record( const uint64_t value );
+        // Counts value
+
+    void merge( const KDHistogram& other );
+        // Adds values counted by other to this
+
+    void reset();
+        // Forgets all values counted
+
+    // ACCESSORS
+    uint64_t count() const;
+        // Returns number of values counted
+
+    uint64_t min() const;
+        // Returns smallest value counted exactly, 0 if none
+
+    uint64_t max() const;
+        // Returns largest value counted exactly, 0 if none
+
+    double mean() const;
+        // Returns mean of the values counted exactly, 0 if none
+
+    uint64_t percentile( const double percent ) const;
+        // Returns the value that percent of the values counted do not
+        // exceed, to within the bucket precision and never above max().
+        // Returns 0 if no values were counted.
+
+    std::ostream& print( std::ostream& out ) const;
+        // Prints the histogram in a easy to read format
+
+    std::ostream& printJson( std::ostream& out ) const;
+        // Prints count, min, mean, percentiles 50, 90, 99 and 99.9 and max
+        // as a JSON object
+
+private:
+    // PRIVATE CONSTANTS
+    enum {
+        SUB_BUCKET_BITS = 7u,
+            // Precision of the buckets
+
+        SUB_BUCKETS     = 1u << SUB_BUCKET_BITS,
+            // Number of exactly counted values, and twice the number of
+            // buckets of every power of two range above them
+
+        NUM_BUCKETS     = SUB_BUCKETS +
+                          ( 64u - SUB_BUCKET_BITS ) * ( SUB_BUCKETS / 2u )
+            // Number of buckets covering the whole uint64_t range
+    };
+
+    static size_t bucket( const uint64_t value );
+        // Returns bucket of value
+
+    static uint64_t highestEquivalent( const size_t bucket );
+        // Returns largest value of bucket
+
+    std::vector< uint64_t >   m_counts;
+        // Number of values of every bucket
+
+    uint64_t                  m_count;
+        // Number of values counted
+
+    uint64_t                  m_min;
+        // Smallest value counted
+
+    uint64_t                  m_max;
+        // Largest value counted
+
+    double                    m_sum;
+        // Sum of the values counted
+};
+
+// INDEPENDENT OPERATORS
+std::ostream& operator<<( std::ostream& lhs, const KDHistogram& rhs );
+
+} // namespace datastructures
+
+#endif // KDTREE_HISTOGRAM_H
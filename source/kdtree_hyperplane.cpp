@@ -1,5 +1,5 @@
-#include "kdtree_hyperplane.h"
-
-namespace datastructures {
-
+#include "kdtree_hyperplane.h"
+
+namespace datastructures {
+
 } //namespace datastructures
\ No newline at end of file
@@ -0,0 +1,5 @@
+#include "kdtree_implicit.h"
+
+namespace datastructures {
+
+} // namespace datastructures
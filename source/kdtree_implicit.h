@@ -0,0 +1,576 @@
+#ifndef KDTREE_IMPLICIT_H
+#define KDTREE_IMPLICIT_H
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+#include "kdtree_types.h"
+#include "kdtree_point_view.h"
+#include "kdtree_constants.h"
+
+// @Purpose
+//
+// This class is a read-only, build-once variant of KDTree that stores no
+// child pointers at all.
+//
+// Points are permuted into median order: the points of a subtree occupy a
+// contiguous range [begin, end) of the storage and the point splitting it
+// sits in the middle of that range, at begin + ( end - begin ) / 2. The
+// left subtree is the range below the middle and the right subtree is the
+// range above it, so children are found arithmetically. Every point is a
+// node; there are no separate leaves.
+//
+// The only per-node data is the split axis - one byte per point with
+// VARIANCE_AXIS, nothing at all with CYCLIC_AXIS. Coordinates are kept in a
+// single flat array in median order, next to an I-typed array of input
+// order indexes which nearestPointIndex() reports, and its inverse, which
+// pointAt() looks points up by.
+//
+// Template parameters:
+//  T - coordinate type
+//  I - index type used for the input order indexes, see KDTree
+//
+
+namespace datastructures {
+
+template< typename T, typename I = size_t >
+class KDImplicitTree {
+public:
+    // TYPES
+    enum SplitAxis {
+        VARIANCE_AXIS,
+            // Split on the axis of largest variance, as KDTree does with
+            // KDTreeOptions::VARIANCE_MEDIAN. Axis is stored per node.
+
+        CYCLIC_AXIS
+            // Split on axis depth % dimension, nothing is stored per node
+    };
+
+    // CREATORS
+    KDImplicitTree();
+        // Default constructor, creates an empty tree
+
+    explicit KDImplicitTree( const Types::Points< T >& points,
+                             const SplitAxis           splitAxis
+                                                            = VARIANCE_AXIS );
+        // Constructor, builds the tree on the provided points.
+        // Results in an empty tree in case points are of different length.
+
+    virtual ~KDImplicitTree();
+        // Destructor
+
+    // OPERATORS
+    bool operator==( const KDImplicitTree& other ) const;
+        // Equality. Calls equals.
+
+    bool operator!=( const KDImplicitTree& other ) const;
+        // Non-equality. Calls equals.
+
+    // PRIMARY INTERFACE
+    size_t nearestPointIndex( const Types::Point< T >& pointOfInterest ) const;
+        // Returns input order index of the closest point in the tree to the
+        // point of interest. In case the tree is empty or there is a
+        // cardinality mismatch - KDTREE_ERROR_INDEX is returned
+
+    size_t nearestPointIndex( const T*     pointOfInterest,
+                              const size_t dimension ) const;
+        // Same as above, reads dimension coordinates of the point of
+        // interest straight from the caller's buffer
+
+    KDPointView< T > nearestPointView(
+            const Types::Point< T >& pointOfInterest ) const;
+        // Returns a view of the closest point in the tree to the point of
+        // interest, empty view in the same cases nearestPointIndex() fails
+
+    KDPointView< T > pointAt( const size_t index ) const;
+        // Returns a view of the point with the provided input order index.
+        // Returns empty view in case the index is out of range.
+
+    // ACCESSORS
+    size_t size() const;
+        // Returns number of points in the tree
+
+    bool empty() const;
+        // Returns true if there are no points in the tree
+
+    size_t dimension() const;
+        // Returns cardinality of the points in the tree
+
+    SplitAxis splitAxis() const;
+        // Returns the split axis policy the tree was built with
+
+    size_t memoryFootprint() const;
+        // Returns number of bytes held by the tree's arrays
+
+    bool equals( const KDImplicitTree& other ) const;
+        // Worker for equality, compares the stored points in input order
+
+    std::ostream& print( std::ostream& out ) const;
+        // Prints the KDImplicitTree in a easy to read format
+
+private:
+    void build( std::vector< I >&         order,
+                const Types::Points< T >& points,
+                const size_t              begin,
+                const size_t              end,
+                const size_t              depth );
+        // A recursive helper function, puts the median of [begin, end) in
+        // the middle of the range and builds both halves
+
+    size_t chooseAxis( const std::vector< I >&   order,
+                       const Types::Points< T >& points,
+                       const size_t              begin,
+                       const size_t              end,
+                       const size_t              depth ) const;
+        // Returns the axis to split [begin, end) on
+
+    size_t axisAt( const size_t position, const size_t depth ) const;
+        // Returns the axis the node at position splits on
+
+    const T* coordinates( const size_t position ) const;
+        // Returns the coordinates of the point at position
+
+    double squaredDistance( const T* p1, const T* p2 ) const;
+        // Returns squared euclidean distance between two stored-size points
+
+    void nearestPointHelper( const T*     pointOfInterest,
+                             const size_t begin,
+                             const size_t end,
+                             const size_t depth,
+                             size_t&      bestPosition,
+                             double&      bestDistance ) const;
+        // A recursive helper function, finds the closest point within
+        // [begin, end) to the point of interest
+
+    std::vector< T >        m_coordinates;
+        // Coordinates of all the points, in median order
+
+    std::vector< I >        m_indexes;
+        // Input order index of every point, in median order
+
+    std::vector< I >        m_positions;
+        // Median order position of every point, in input order. The inverse
+        // of m_indexes, kept so that pointAt() need not search m_indexes,
+        // as KDTree keeps its inverse permutation
+
+    std::vector< uint8_t >  m_axes;
+        // Split axis of every node, in median order. Empty with CYCLIC_AXIS
+
+    size_t                  m_dimension;
+        // Cardinality of the stored points
+
+    SplitAxis               m_splitAxis;
+        // Split axis policy
+};
+
+//============================================================================
+//                  CREATORS
+//============================================================================
+
+template< typename T, typename I >
+KDImplicitTree< T, I >::KDImplicitTree()
+: m_dimension( 0u )
+, m_splitAxis( VARIANCE_AXIS )
+{
+    // nothing to do here
+}
+
+template< typename T, typename I >
+KDImplicitTree< T, I >::KDImplicitTree( const Types::Points< T >& points,
+                                        const SplitAxis           splitAxis )
+: m_dimension( points.empty() ? 0u : points[ 0 ].size() )
+, m_splitAxis( splitAxis )
+{
+    // Sanity
+    for ( typename Types::Points< T >::const_iterator it = points.cbegin();
+          it != points.cend(); ++it )
+    {
+        if ( it->size() != m_dimension )
+        {
+            std::cerr << "KDImplicitTree< T >::KDImplicitTree() points "
+                      << "are of different cardinality" << std::endl;
+            m_dimension = 0u;
+            return;
+        }
+    }
+    if ( !points.empty() && !m_dimension )
+    {
+        std::cerr << "KDImplicitTree< T >::KDImplicitTree() points "
+                  << "are of zero cardinality" << std::endl;
+        return;
+    }
+    if ( points.size() >= static_cast< size_t >( Constants::errorIndex< I >() ) )
+    {
+        std::cerr << "KDImplicitTree< T >::KDImplicitTree() "
+                  << points.size() << " points exceed the capacity of the "
+                  << "index type" << std::endl;
+        m_dimension = 0u;
+        return;
+    }
+    if ( ( VARIANCE_AXIS == m_splitAxis ) &&
+         ( m_dimension > std::numeric_limits< uint8_t >::max() + 1u ) )
+    {
+        std::cerr << "KDImplicitTree< T >::KDImplicitTree() "
+                  << "cardinality " << m_dimension << " does not fit into "
+                  << "per-node axis, using cyclic axes" << std::endl;
+        m_splitAxis = CYCLIC_AXIS;
+    }
+
+    std::vector< I > order;
+    order.reserve( points.size() );
+    for ( size_t i = 0; i < points.size(); ++i )
+    {
+        order.push_back( static_cast< I >( i ) );
+    }
+
+    if ( VARIANCE_AXIS == m_splitAxis )
+    {
+        m_axes.resize( points.size() );
+    }
+    build( order, points, 0u, order.size(), 0u );
+
+    // Lay the points out in median order
+    m_coordinates.reserve( points.size() * m_dimension );
+    m_positions.resize( points.size() );
+    for ( size_t i = 0; i < order.size(); ++i )
+    {
+        const Types::Point< T >& point = points[ order[ i ] ];
+        m_coordinates.insert( m_coordinates.end(), point.begin(), point.end() );
+        m_positions[ order[ i ] ] = static_cast< I >( i );
+    }
+    m_indexes.swap( order );
+}
+
+template< typename T, typename I >
+KDImplicitTree< T, I >::~KDImplicitTree()
+{
+    // nothing to do here
+}
+
+//============================================================================
+//                  OPERATORS
+//============================================================================
+
+template< typename T, typename I >
+bool
+KDImplicitTree< T, I >::operator==( const KDImplicitTree< T, I >& other ) const
+{
+    return equals( other );
+}
+
+template< typename T, typename I >
+bool
+KDImplicitTree< T, I >::operator!=( const KDImplicitTree< T, I >& other ) const
+{
+    return !equals( other );
+}
+
+//============================================================================
+//                  PRIMARY INTERFACE
+//============================================================================
+
+template< typename T, typename I >
+size_t
+KDImplicitTree< T, I >::nearestPointIndex(
+        const Types::Point< T >& pointOfInterest ) const
+{
+    return nearestPointIndex( pointOfInterest.data(), pointOfInterest.size() );
+}
+
+template< typename T, typename I >
+size_t
+KDImplicitTree< T, I >::nearestPointIndex( const T*     pointOfInterest,
+                                           const size_t dimension ) const
+{
+    // Sanity
+    if ( empty() || ( dimension != m_dimension ) )
+    {
+        return Constants::KDTREE_ERROR_INDEX;
+    }
+
+    size_t bestPosition = 0u;
+    double bestDistance = std::numeric_limits< double >::max();
+    nearestPointHelper( pointOfInterest,
+                        0u,
+                        size(),
+                        0u,
+                        bestPosition,
+                        bestDistance );
+
+    return static_cast< size_t >( m_indexes[ bestPosition ] );
+}
+
+template< typename T, typename I >
+KDPointView< T >
+KDImplicitTree< T, I >::nearestPointView(
+        const Types::Point< T >& pointOfInterest ) const
+{
+    return pointAt( nearestPointIndex( pointOfInterest ) );
+}
+
+template< typename T, typename I >
+KDPointView< T >
+KDImplicitTree< T, I >::pointAt( const size_t index ) const
+{
+    if ( index >= size() )
+    {
+        return KDPointView< T >();
+    }
+
+    return KDPointView< T >( coordinates( m_positions[ index ] ),
+                             m_dimension );
+}
+
+template< typename T, typename I >
+void
+KDImplicitTree< T, I >::build( std::vector< I >&         order,
+                               const Types::Points< T >& points,
+                               const size_t              begin,
+                               const size_t              end,
+                               const size_t              depth )
+{
+    if ( end - begin < 2u )
+    {
+        if ( ( end > begin ) && !m_axes.empty() )
+        {
+            m_axes[ begin ] = 0u;
+        }
+        return;
+    }
+
+    const size_t axis   = chooseAxis( order, points, begin, end, depth );
+    const size_t middle = begin + ( end - begin ) / 2u;
+
+    std::nth_element( order.begin() + begin,
+                      order.begin() + middle,
+                      order.begin() + end,
+                      [ &points, axis ]( const I lhs, const I rhs )
+                      {
+                          return points[ lhs ][ axis ] <
+                                 points[ rhs ][ axis ];
+                      } );
+
+    if ( !m_axes.empty() )
+    {
+        m_axes[ middle ] = static_cast< uint8_t >( axis );
+    }
+
+    build( order, points, begin,      middle, depth + 1u );
+    build( order, points, middle + 1, end,    depth + 1u );
+}
+
+template< typename T, typename I >
+size_t
+KDImplicitTree< T, I >::chooseAxis( const std::vector< I >&   order,
+                                    const Types::Points< T >& points,
+                                    const size_t              begin,
+                                    const size_t              end,
+                                    const size_t              depth ) const
+{
+    if ( CYCLIC_AXIS == m_splitAxis )
+    {
+        return depth % m_dimension;
+    }
+
+    // Welford's running mean and sum of squared deviations, all the axes
+    // in one pass over the points, as KDTree does. Ties go to the lower
+    // axis.
+    std::vector< double > means( m_dimension, 0.0 );
+    std::vector< double > deviations( m_dimension, 0.0 );
+    size_t count = 0u;
+    for ( size_t i = begin; i < end; ++i )
+    {
+        const Types::Point< T >& point = points[ order[ i ] ];
+        ++count;
+        for ( size_t axis = 0; axis < m_dimension; ++axis )
+        {
+            const double value = static_cast< double >( point[ axis ] );
+            const double delta = value - means[ axis ];
+            means[ axis ]      += delta / count;
+            deviations[ axis ] += delta * ( value - means[ axis ] );
+        }
+    }
+
+    return std::max_element( deviations.begin(), deviations.end() ) -
+           deviations.begin();
+}
+
+template< typename T, typename I >
+size_t
+KDImplicitTree< T, I >::axisAt( const size_t position,
+                                const size_t depth ) const
+{
+    if ( m_axes.empty() )
+    {
+        return depth % m_dimension;
+    }
+
+    return m_axes[ position ];
+}
+
+template< typename T, typename I >
+const T*
+KDImplicitTree< T, I >::coordinates( const size_t position ) const
+{
+    return m_coordinates.data() + position * m_dimension;
+}
+
+template< typename T, typename I >
+double
+KDImplicitTree< T, I >::squaredDistance( const T* p1, const T* p2 ) const
+{
+    double result = 0.0;
+    for ( size_t i = 0; i < m_dimension; ++i )
+    {
+        const double diff = static_cast< double >( p1[ i ] ) -
+                            static_cast< double >( p2[ i ] );
+        result += diff * diff;
+    }
+
+    return result;
+}
+
+template< typename T, typename I >
+void
+KDImplicitTree< T, I >::nearestPointHelper( const T*     pointOfInterest,
+                                            const size_t begin,
+                                            const size_t end,
+                                            const size_t depth,
+                                            size_t&      bestPosition,
+                                            double&      bestDistance ) const
+{
+    if ( begin >= end )
+    {
+        return;
+    }
+
+    const size_t middle = begin + ( end - begin ) / 2u;
+    const T*     node   = coordinates( middle );
+
+    const double distance = squaredDistance( node, pointOfInterest );
+    if ( distance < bestDistance )
+    {
+        bestDistance = distance;
+        bestPosition = middle;
+    }
+
+    const size_t axis = axisAt( middle, depth );
+    const double diff = static_cast< double >( pointOfInterest[ axis ] ) -
+                        static_cast< double >( node[ axis ] );
+
+    // Near side first, far side only if it can hold a closer point
+    if ( diff < 0.0 )
+    {
+        nearestPointHelper( pointOfInterest, begin, middle, depth + 1u,
+                            bestPosition, bestDistance );
+        if ( diff * diff < bestDistance )
+        {
+            nearestPointHelper( pointOfInterest, middle + 1u, end,
+                                depth + 1u, bestPosition, bestDistance );
+        }
+    }
+    else
+    {
+        nearestPointHelper( pointOfInterest, middle + 1u, end, depth + 1u,
+                            bestPosition, bestDistance );
+        if ( diff * diff < bestDistance )
+        {
+            nearestPointHelper( pointOfInterest, begin, middle, depth + 1u,
+                                bestPosition, bestDistance );
+        }
+    }
+}
+
+//============================================================================
+//                  ACCESSORS
+//============================================================================
+
+template< typename T, typename I >
+size_t
+KDImplicitTree< T, I >::size() const
+{
+    return m_indexes.size();
+}
+
+template< typename T, typename I >
+bool
+KDImplicitTree< T, I >::empty() const
+{
+    return m_indexes.empty();
+}
+
+template< typename T, typename I >
+size_t
+KDImplicitTree< T, I >::dimension() const
+{
+    return m_dimension;
+}
+
+template< typename T, typename I >
+typename KDImplicitTree< T, I >::SplitAxis
+KDImplicitTree< T, I >::splitAxis() const
+{
+    return m_splitAxis;
+}
+
+template< typename T, typename I >
+size_t
+KDImplicitTree< T, I >::memoryFootprint() const
+{
+    return m_coordinates.capacity() * sizeof( T ) +
+           m_indexes.capacity()     * sizeof( I ) +
+           m_positions.capacity()   * sizeof( I ) +
+           m_axes.capacity()        * sizeof( uint8_t );
+}
+
+template< typename T, typename I >
+bool
+KDImplicitTree< T, I >::equals( const KDImplicitTree< T, I >& other ) const
+{
+    if ( ( other.size() != size() ) || ( other.dimension() != m_dimension ) )
+    {
+        return false;
+    }
+
+    for ( size_t i = 0; i < size(); ++i )
+    {
+        if ( other.pointAt( i ) != pointAt( i ) )
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+template< typename T, typename I >
+std::ostream&
+KDImplicitTree< T, I >::print( std::ostream& out ) const
+{
+    out << "KDImplicitTree:[ "
+        << "num points stored = " << size()       << ", "
+        << "dimension = "         << m_dimension  << ", "
+        << "split axis = '"
+        << ( CYCLIC_AXIS == m_splitAxis ? "cyclic" : "variance" ) << "', "
+        << "memory footprint = "  << memoryFootprint() << " ] ";
+
+    return out;
+}
+
+//============================================================================
+//                  INDEPENDENT OPERATORS
+//============================================================================
+
+template< typename T, typename I >
+std::ostream& operator<<( std::ostream&                 lhs,
+                          const KDImplicitTree< T, I >& rhs )
+{
+    return rhs.print( lhs );
+}
+
+} // namespace datastructures
+
+#endif // KDTREE_IMPLICIT_H
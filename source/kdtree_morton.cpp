@@ -0,0 +1,56 @@
+#include "kdtree_morton.h"
+
+namespace datastructures {
+
+//============================================================================
+//                  PRIMARY INTERFACE
+//============================================================================
+
+size_t
+Morton::bitsPerAxis( const size_t dimension )
+{
+    const size_t codeBits = sizeof( Code ) * 8u;
+
+    // Sanity
+    if ( !dimension || dimension > codeBits )
+    {
+        return 0u;
+    }
+
+    return std::min< size_t >( codeBits / dimension, 32u );
+}
+
+size_t
+Morton::axisOfBit( const size_t bit, const size_t dimension )
+{
+    // Every group of dimension bits holds axis 0 in its most significant bit
+    return dimension - 1u - ( bit % dimension );
+}
+
+size_t
+Morton::highestBit( const Code code )
+{
+    size_t bit = 0u;
+    for ( size_t shift = sizeof( Code ) * 4u; shift; shift /= 2u )
+    {
+        if ( code >> ( bit + shift ) )
+        {
+            bit += shift;
+        }
+    }
+
+    return bit;
+}
+
+size_t
+Morton::numThreads( const size_t requested, const size_t numItems )
+{
+    size_t threads = requested ? requested
+                               : std::thread::hardware_concurrency();
+    threads = std::min( threads,
+                        numItems / Constants::KDTREE_PARALLEL_BUILD_GRAIN );
+
+    return std::max< size_t >( 1u, threads );
+}
+
+} // namespace datastructures
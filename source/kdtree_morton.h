@@ -0,0 +1,247 @@
+#ifndef KDTREE_MORTON_H
+#define KDTREE_MORTON_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "kdtree_types.h"
+#include "kdtree_point_view.h"
+#include "kdtree_utils.h"
+#include "kdtree_constants.h"
+
+// @Purpose
+//
+// This struct provides the building blocks of the Morton code based linear
+// KDTree builder: quantization of points onto a grid spanning their bounding
+// box, bit interleaving into Morton codes, and a parallel LSD radix sort of
+// the codes.
+//
+// A Morton code interleaves the grid coordinates of a point from the most
+// significant bit down, axis 0 first. Sorting points by their codes puts
+// them in Z-order, and the points sharing a code prefix form a box of the
+// grid - which is what lets the builder derive kd-style splits straight from
+// the code prefixes.
+//
+
+namespace datastructures {
+
+struct Morton {
+    // TYPES
+    typedef uint64_t Code;
+
+    // PRIMARY INTERFACE
+    static size_t bitsPerAxis( const size_t dimension );
+        // Returns number of grid bits per axis used for points of the
+        // provided dimension. Returns 0 in case the dimension is too high
+        // for a 64-bit code.
+
+    static size_t axisOfBit( const size_t bit, const size_t dimension );
+        // Returns the axis the provided bit of a code - counting from the
+        // least significant bit - belongs to
+
+    static size_t highestBit( const Code code );
+        // Returns position of the most significant set bit of a non-zero
+        // code
+
+    template< typename T, typename A >
+    static void encode( const KDPointsView< T, A >& points,
+                        std::vector< Code >&        codes,
+                        const size_t                numThreads );
+        // Computes codes of all the points, quantized to the grid spanning
+        // their bounding box as found by Utils::minMaxPerAxis(). The
+        // quantization is monotone: a point with a smaller grid coordinate
+        // than another has a smaller coordinate as well.
+
+    template< typename V >
+    static void radixSort( std::vector< Code >& codes,
+                           V&                   values,
+                           const size_t         numBits,
+                           const size_t         numThreads );
+        // Stable sort of codes, whose set bits are all below numBits, with
+        // values permuted alongside. Each 8-bit digit pass splits the work
+        // into numThreads chunks.
+
+    static size_t numThreads( const size_t requested,
+                              const size_t numItems );
+        // Returns number of threads to use for numItems items, given the
+        // requested number of threads (0 for all hardware threads), keeping
+        // at least KDTREE_PARALLEL_BUILD_GRAIN items per thread
+
+private:
+    template< typename F >
+    static void parallelFor( const size_t numItems,
+                             const size_t numThreads,
+                             F            function );
+        // Calls function( thread, begin, end ) for numThreads contiguous
+        // chunks of [0, numItems), each on its own thread
+};
+
+//============================================================================
+//                  PRIMARY INTERFACE
+//============================================================================
+
+template< typename T, typename A >
+void
+Morton::encode( const KDPointsView< T, A >& points,
+                std::vector< Code >&        codes,
+                const size_t                numThreads )
+{
+    codes.assign( points.size(), 0u );
+    if ( points.empty() )
+    {
+        return;
+    }
+
+    const size_t dimension = points[ 0u ].size();
+    const size_t bits      = bitsPerAxis( dimension );
+    if ( !bits )
+    {
+        return;
+    }
+
+    const Types::AxisMinMax< T > axisMinMax = Utils::minMaxPerAxis( points );
+    const double maxCell = static_cast< double >(
+                                   ( static_cast< Code >( 1u ) << bits ) - 1u );
+
+    std::vector< double > minimums;
+    std::vector< double > scales;
+    for ( size_t axis = 0; axis < dimension; ++axis )
+    {
+        const double minimum = static_cast< double >( axisMinMax[ axis ].first );
+        const double extent  = static_cast< double >( axisMinMax[ axis ].second )
+                               - minimum;
+
+        minimums.push_back( minimum );
+        scales.push_back( extent > 0.0 ? maxCell / extent : 0.0 );
+    }
+
+    parallelFor( points.size(), numThreads,
+                 [ & ]( const size_t, const size_t begin, const size_t end )
+                 {
+                     std::vector< Code > cells( dimension );
+                     for ( size_t i = begin; i < end; ++i )
+                     {
+                         const KDPointView< T > point = points[ i ];
+                         for ( size_t axis = 0; axis < dimension; ++axis )
+                         {
+                             const double cell = std::floor(
+                                 ( static_cast< double >( point[ axis ] ) -
+                                   minimums[ axis ] ) * scales[ axis ] );
+                             cells[ axis ] = static_cast< Code >(
+                                 std::min( std::max( cell, 0.0 ), maxCell ) );
+                         }
+
+                         Code code = 0u;
+                         for ( size_t bit = bits; bit-- > 0; )
+                         {
+                             for ( size_t axis = 0; axis < dimension; ++axis )
+                             {
+                                 code = ( code << 1 ) |
+                                        ( ( cells[ axis ] >> bit ) & 1u );
+                             }
+                         }
+                         codes[ i ] = code;
+                     }
+                 } );
+}
+
+template< typename V >
+void
+Morton::radixSort( std::vector< Code >& codes,
+                   V&                   values,
+                   const size_t         numBits,
+                   const size_t         numThreads )
+{
+    const size_t numItems  = codes.size();
+    const size_t threads   = std::max< size_t >( 1u,
+                                     std::min( numThreads, numItems ) );
+    const size_t radix     = 256u;
+
+    std::vector< Code > codesBuffer( numItems );
+    V                   valuesBuffer( numItems );
+    std::vector< size_t > counts( threads * radix );
+
+    for ( size_t shift = 0; shift < numBits; shift += 8u )
+    {
+        // Per chunk digit histograms
+        std::fill( counts.begin(), counts.end(), 0u );
+        parallelFor( numItems, threads,
+                     [ & ]( const size_t thread,
+                            const size_t begin,
+                            const size_t end )
+                     {
+                         size_t* count = &counts[ thread * radix ];
+                         for ( size_t i = begin; i < end; ++i )
+                         {
+                             ++count[ ( codes[ i ] >> shift ) & 0xFFu ];
+                         }
+                     } );
+
+        // Digit major, chunk minor offsets keep the pass stable
+        size_t offset = 0u;
+        for ( size_t digit = 0; digit < radix; ++digit )
+        {
+            for ( size_t thread = 0; thread < threads; ++thread )
+            {
+                const size_t count = counts[ thread * radix + digit ];
+                counts[ thread * radix + digit ] = offset;
+                offset += count;
+            }
+        }
+
+        parallelFor( numItems, threads,
+                     [ & ]( const size_t thread,
+                            const size_t begin,
+                            const size_t end )
+                     {
+                         size_t* position = &counts[ thread * radix ];
+                         for ( size_t i = begin; i < end; ++i )
+                         {
+                             const size_t target =
+                                 position[ ( codes[ i ] >> shift ) & 0xFFu ]++;
+                             codesBuffer[ target ]  = codes[ i ];
+                             valuesBuffer[ target ] = values[ i ];
+                         }
+                     } );
+
+        codes.swap( codesBuffer );
+        values.swap( valuesBuffer );
+    }
+}
+
+template< typename F >
+void
+Morton::parallelFor( const size_t numItems,
+                     const size_t numThreads,
+                     F            function )
+{
+    const size_t threads   = std::max< size_t >( 1u, numThreads );
+    const size_t chunkSize = ( numItems + threads - 1u ) / threads;
+
+    if ( threads == 1u )
+    {
+        function( 0u, 0u, numItems );
+        return;
+    }
+
+    std::vector< std::thread > workers;
+    workers.reserve( threads );
+    for ( size_t thread = 0; thread < threads; ++thread )
+    {
+        const size_t begin = std::min( numItems, thread * chunkSize );
+        const size_t end   = std::min( numItems, begin + chunkSize );
+        workers.push_back( std::thread( function, thread, begin, end ) );
+    }
+
+    for ( size_t thread = 0; thread < threads; ++thread )
+    {
+        workers[ thread ].join();
+    }
+}
+
+} // namespace datastructures
+
+#endif // KDTREE_MORTON_H
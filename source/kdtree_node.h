@@ -1,266 +1,346 @@
-#ifndef KDTREE_NODE_H
-#define KDTREE_NODE_H
-
-#include <iostream>
-#include <memory>
-#include <sstream>
-
-#include "kdtree_types.h"
-#include "kdtree_constants.h"
-#include "kdtree_hyperplane.h"
-
-namespace datastructures {
-
-// PURPOSE:
-//
-// A class that defines individual notes within a KD-Tree. Used to
-// represent both leaf and non-leaf nodes.
-//
-template< typename T >
-class KDNode {
-public:
-    // CREATORS
-    KDNode();
-    // Default constructor
-
-    KDNode( const KDHyperplane< T >&              hyperplane,
-            const std::shared_ptr< KDNode< T > >& left,
-            const std::shared_ptr< KDNode< T > >& right );
-        // Non-leaf Constructor
-
-    KDNode( const size_t leafPointIndex );
-        // Leaf Constructor
-
-    KDNode( const KDNode& other );
-        // Copy constructor, calls copy().
-
-    virtual ~KDNode();
-        // Destructor
-
-    // OPERATORS
-    KDNode& operator=( const KDNode& other );
-        // Assignment operator. Calls copy.
-        // Note that this operator performs a shallow copy as its
-        // use is targeted at containers.
-
-    bool operator==( const KDNode& other ) const;
-        // Equality. Calls equals.
-
-    bool operator!=( const KDNode& other ) const;
-        // Non-equality. Calls equals.
-
-    // PRIMARY INTERFACE
-    const KDHyperplane< T >& hyperplane() const;
-        // Returns diving hyperplane represented by this node
-
-    std::shared_ptr< KDNode< T > > left() const;
-        // Return shared pointer to the left subtree
-
-    std::shared_ptr< KDNode< T > > right() const;
-        // Return shared pointer to the right subtree
-
-    size_t leafPointIndex() const;
-        // Return index point stored in KDTree that this node
-        // represents. Note that non-leaf nodes will return
-        // KDTREE_ERROR_INDEX.
-
-    bool isLeaf() const;
-        // Returns true if a node is leaf and false otherwise
-
-    // MANIPULATORS
-    void copy( const KDNode& other );
-        // Copies the value of other into this
-
-    // ACCESSORS
-    bool equals( const KDNode& other ) const;
-        // Worker for equality - call this in child classes when overloading
-        // == and != operator
-
-    std::ostream& print( std::ostream& out ) const;
-        // Prints the contents of the KDNode object in a easy to read
-        // format
-
-private:
-    KDHyperplane< T >                  m_hyperplane;
-        // Defines hyperplane of this node
-
-    std::shared_ptr< KDNode< T > >     m_left;
-        // Left subtree
-
-    std::shared_ptr< KDNode< T > >     m_right;
-        // Right subtree
-
-    size_t                             m_leafPointIndex;
-        // Index of leaf point in the KDTree
-};
-
-// INDEPENDENT OPERATORS
-template< typename T >
-std::ostream& operator<<( std::ostream& lhs,
-                          const KDNode< T >& rhs );
-
-//============================================================================
-//                  CREATORS
-//============================================================================
-
-template< typename T >
-KDNode< T >::KDNode()
-: m_left(           nullptr )
-, m_right(          nullptr )
-, m_leafPointIndex( Constants::KDTREE_ERROR_INDEX )
-{
-    // nothing to do here
-}
-
-template< typename T >
-KDNode< T >::KDNode( const KDHyperplane< T >&               hyperplane,
-                     const std::shared_ptr< KDNode< T > >&  left,
-                     const std::shared_ptr< KDNode< T > >&  right )
-: m_hyperplane(     hyperplane )
-, m_left(           left )
-, m_right(          right )
-, m_leafPointIndex( Constants::KDTREE_ERROR_INDEX )
-{
-    // nothing to do here
-}
-
-template< typename T >
-KDNode< T >::KDNode( const size_t leafPointIndex )
-: m_left(           nullptr )
-, m_right(          nullptr )
-, m_leafPointIndex( leafPointIndex )
-{
-    // nothing to do here
-}
-
-template< typename T >
-KDNode< T >::KDNode( const KDNode& other )
-{
-    copy( other );
-}
-
-template< typename T >
-KDNode< T >::~KDNode()
-{
-    // nothing to do here
-}
-
-//============================================================================
-//                  OPERATORS
-//============================================================================
-
-template< typename T >
-KDNode< T >&
-KDNode< T >::operator=( const KDNode< T >& other )
-{
-    copy( other );
-    return *this;
-}
-
-template< typename T >
-bool
-KDNode< T >::operator==( const KDNode< T >& other ) const
-{
-    return equals( other );
-}
-
-template< typename T >
-bool KDNode< T >::operator!=(
-        const KDNode< T >& other ) const
-{
-    return !equals( other );
-}
-
-//============================================================================
-//                  PRIMARY INTERFACE
-//============================================================================
-template< typename T >
-const KDHyperplane< T >&
-KDNode< T >::hyperplane() const
-{
-    return m_hyperplane;
-}
-
-template< typename T >
-std::shared_ptr< KDNode< T > >
-KDNode< T >::left() const
-{
-    return m_left;
-}
-
-template< typename T >
-std::shared_ptr< KDNode< T > >
-KDNode< T >::right() const
-{
-    return m_right;
-}
-
-template< typename T >
-size_t
-KDNode< T >::leafPointIndex() const
-{
-    return m_leafPointIndex;
-}
-
-
-template< typename T >
-bool
-KDNode< T >::isLeaf() const
-{
-    return ( m_leafPointIndex != Constants::KDTREE_ERROR_INDEX );
-}
-
-//============================================================================
-//                  MANIPULATORS
-//============================================================================
-
-template< typename T >
-void
-KDNode< T >::copy( const KDNode< T >& other )
-{
-    m_hyperplane      = other.hyperplane();
-    m_left            = other.left();
-    m_right           = other.right();
-    m_leafPointIndex  = other.leafPointIndex();
-}
-
-//============================================================================
-//                  ACCESSORS
-//============================================================================
-
-template< typename T >
-bool
-KDNode< T >::equals( const KDNode< T >& other ) const
-{
-    return ( ( other.hyperplane()     == m_hyperplane     ) &&
-             ( other.left()           == m_left           ) &&
-             ( other.right()          == m_right          ) &&
-             ( other.leafPointIndex() == m_leafPointIndex ) );
-}
-
-template< typename T >
-std::ostream&
-KDNode< T >::print( std::ostream& out ) const
-{
-    out << "KDNode:[ "
-        << "is leaf = '"         << ( isLeaf() ? "yes" : "no" )  << "', "
-        << "hyperplane = "       << m_hyperplane                 << ", "
-        << "left ptr = '"        << std::hex << m_left           << "', "
-        << "right ptr = '"       << std::hex << m_right          << "', "
-        << "leaf point index = " << std::dec << m_leafPointIndex << " ]";
-
-    return out;
-}
-
-//============================================================================
-//                  INDEPENDENT OPERATORS
-//============================================================================
-template< typename T >
-std::ostream& operator<<( std::ostream& lhs, const KDNode< T >& rhs )
-{
-    return rhs.print( lhs );
-}
-
-} // close namespace datastructures
-
-#endif // KDTREE_NODE_H
+#ifndef KDTREE_NODE_H
+#define KDTREE_NODE_H
+
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <sstream>
+
+#include "kdtree_types.h"
+#include "kdtree_constants.h"
+#include "kdtree_hyperplane.h"
+
+namespace datastructures {
+
+// PURPOSE:
+//
+// A class that defines individual notes within a KD-Tree. Used to
+// represent both leaf and non-leaf nodes.
+//
+// Leaf point indexes and split axes share a single field of type I, which
+// may be narrowed to e.g. uint32_t for trees of fewer than 4 billion points
+// and dimensions. The interface always speaks size_t and
+// Constants::KDTREE_ERROR_INDEX regardless of I. The split value is stored
+// next to it rather than in a KDHyperplane, and the class has no virtual
+// functions, so that a KDNode< double, uint32_t > takes 48 bytes, two thirds
+// of which are the child pointers.
+//
+// Nodes allocated by create() come from A rebound to KDNode, together with
+// their reference count.
+//
+template< typename T,
+          typename I = size_t,
+          typename A = std::allocator< T > >
+class KDNode {
+public:
+    // TYPES
+    typedef std::shared_ptr< KDNode >                   NodePtr;
+        // Pointer to a (sub)tree
+
+    typedef typename std::allocator_traits< A >::template
+            rebind_alloc< KDNode >                      Allocator;
+        // Allocator of nodes
+
+    // CREATORS
+    KDNode();
+    // Default constructor
+
+    KDNode( const KDHyperplane< T >& hyperplane,
+            const NodePtr&           left,
+            const NodePtr&           right );
+        // Non-leaf Constructor. Note that the hyperplane index must be
+        // representable as I.
+
+    KDNode( const size_t leafPointIndex );
+        // Leaf Constructor. Note that leafPointIndex must be representable
+        // as I.
+
+    KDNode( const KDNode& other );
+        // Copy constructor, calls copy().
+
+    ~KDNode();
+        // Destructor. Not virtual, so as not to add a pointer to every node.
+
+    template< typename... Args >
+    static NodePtr create( Args&&... args );
+        // Allocates a node constructed from args, and its reference count,
+        // through Allocator
+
+    // OPERATORS
+    KDNode& operator=( const KDNode& other );
+        // Assignment operator. Calls copy.
+        // Note that this operator performs a shallow copy as its
+        // use is targeted at containers.
+
+    bool operator==( const KDNode& other ) const;
+        // Equality. Calls equals.
+
+    bool operator!=( const KDNode& other ) const;
+        // Non-equality. Calls equals.
+
+    // PRIMARY INTERFACE
+    const KDHyperplane< T > hyperplane() const;
+        // Returns diving hyperplane represented by this node, a default
+        // constructed one for leaves
+
+    NodePtr left() const;
+        // Return shared pointer to the left subtree
+
+    NodePtr right() const;
+        // Return shared pointer to the right subtree
+
+    size_t leafPointIndex() const;
+        // Return index point stored in KDTree that this node
+        // represents. Note that non-leaf nodes will return
+        // KDTREE_ERROR_INDEX.
+
+    bool isLeaf() const;
+        // Returns true if a node is leaf and false otherwise
+
+    // MANIPULATORS
+    void copy( const KDNode& other );
+        // Copies the value of other into this
+
+    // ACCESSORS
+    bool equals( const KDNode& other ) const;
+        // Worker for equality - call this in child classes when overloading
+        // == and != operator
+
+    std::ostream& print( std::ostream& out ) const;
+        // Prints the contents of the KDNode object in a easy to read
+        // format
+
+private:
+    static I uninitializedAxis();
+        // Counterpart of KDTREE_UNINITIALIZED_HYPERPLANE_INDEX for I
+
+    NodePtr     m_left;
+        // Left subtree
+
+    NodePtr     m_right;
+        // Right subtree
+
+    T           m_value;
+        // Split value of a non-leaf node
+
+    I           m_index;
+        // Split axis of a non-leaf node, index of leaf point in the KDTree
+        // otherwise. Constants::errorIndex< I >() if there is neither.
+
+    bool        m_split;
+        // Whether the node is a non-leaf node
+};
+
+// INDEPENDENT OPERATORS
+template< typename T, typename I, typename A >
+std::ostream& operator<<( std::ostream& lhs,
+                          const KDNode< T, I, A >& rhs );
+
+//============================================================================
+//                  CREATORS
+//============================================================================
+
+template< typename T, typename I, typename A >
+KDNode< T, I, A >::KDNode()
+: m_left(  nullptr )
+, m_right( nullptr )
+, m_value( static_cast< T >(
+                   Constants::KDTREE_UNINITIALIZED_HYPERPLANE_VALUE ) )
+, m_index( Constants::errorIndex< I >() )
+, m_split( false )
+{
+    // nothing to do here
+}
+
+template< typename T, typename I, typename A >
+KDNode< T, I, A >::KDNode( const KDHyperplane< T >& hyperplane,
+                           const NodePtr&           left,
+                           const NodePtr&           right )
+: m_left(  left )
+, m_right( right )
+, m_value( hyperplane.value() )
+, m_index( Constants::KDTREE_UNINITIALIZED_HYPERPLANE_INDEX ==
+                   hyperplane.hyperplaneIndex()
+           ? uninitializedAxis()
+           : static_cast< I >( hyperplane.hyperplaneIndex() ) )
+, m_split( true )
+{
+    // nothing to do here
+}
+
+template< typename T, typename I, typename A >
+KDNode< T, I, A >::KDNode( const size_t leafPointIndex )
+: m_left(  nullptr )
+, m_right( nullptr )
+, m_value( static_cast< T >(
+                   Constants::KDTREE_UNINITIALIZED_HYPERPLANE_VALUE ) )
+, m_index( Constants::KDTREE_ERROR_INDEX == leafPointIndex
+           ? Constants::errorIndex< I >()
+           : static_cast< I >( leafPointIndex ) )
+, m_split( false )
+{
+    // nothing to do here
+}
+
+template< typename T, typename I, typename A >
+KDNode< T, I, A >::KDNode( const KDNode& other )
+{
+    copy( other );
+}
+
+template< typename T, typename I, typename A >
+KDNode< T, I, A >::~KDNode()
+{
+    // nothing to do here
+}
+
+template< typename T, typename I, typename A >
+template< typename... Args >
+typename KDNode< T, I, A >::NodePtr
+KDNode< T, I, A >::create( Args&&... args )
+{
+    return std::allocate_shared< KDNode >( Allocator(),
+                                           std::forward< Args >( args )... );
+}
+
+//============================================================================
+//                  OPERATORS
+//============================================================================
+
+template< typename T, typename I, typename A >
+KDNode< T, I, A >&
+KDNode< T, I, A >::operator=( const KDNode< T, I, A >& other )
+{
+    copy( other );
+    return *this;
+}
+
+template< typename T, typename I, typename A >
+bool
+KDNode< T, I, A >::operator==( const KDNode< T, I, A >& other ) const
+{
+    return equals( other );
+}
+
+template< typename T, typename I, typename A >
+bool KDNode< T, I, A >::operator!=(
+        const KDNode< T, I, A >& other ) const
+{
+    return !equals( other );
+}
+
+//============================================================================
+//                  PRIMARY INTERFACE
+//============================================================================
+template< typename T, typename I, typename A >
+const KDHyperplane< T >
+KDNode< T, I, A >::hyperplane() const
+{
+    if ( !m_split )
+    {
+        return KDHyperplane< T >();
+    }
+
+    return KDHyperplane< T >(
+            uninitializedAxis() == m_index
+            ? Constants::KDTREE_UNINITIALIZED_HYPERPLANE_INDEX
+            : static_cast< size_t >( m_index ),
+            m_value );
+}
+
+template< typename T, typename I, typename A >
+typename KDNode< T, I, A >::NodePtr
+KDNode< T, I, A >::left() const
+{
+    return m_left;
+}
+
+template< typename T, typename I, typename A >
+typename KDNode< T, I, A >::NodePtr
+KDNode< T, I, A >::right() const
+{
+    return m_right;
+}
+
+template< typename T, typename I, typename A >
+size_t
+KDNode< T, I, A >::leafPointIndex() const
+{
+    if ( !isLeaf() )
+    {
+        return Constants::KDTREE_ERROR_INDEX;
+    }
+
+    return static_cast< size_t >( m_index );
+}
+
+
+template< typename T, typename I, typename A >
+bool
+KDNode< T, I, A >::isLeaf() const
+{
+    return !m_split && ( m_index != Constants::errorIndex< I >() );
+}
+
+template< typename T, typename I, typename A >
+I
+KDNode< T, I, A >::uninitializedAxis()
+{
+    return std::numeric_limits< I >::max() - 1;
+}
+
+//============================================================================
+//                  MANIPULATORS
+//============================================================================
+
+template< typename T, typename I, typename A >
+void
+KDNode< T, I, A >::copy( const KDNode< T, I, A >& other )
+{
+    m_left  = other.m_left;
+    m_right = other.m_right;
+    m_value = other.m_value;
+    m_index = other.m_index;
+    m_split = other.m_split;
+}
+
+//============================================================================
+//                  ACCESSORS
+//============================================================================
+
+template< typename T, typename I, typename A >
+bool
+KDNode< T, I, A >::equals( const KDNode< T, I, A >& other ) const
+{
+    return ( ( other.hyperplane()     == hyperplane()     ) &&
+             ( other.left()           == m_left           ) &&
+             ( other.right()          == m_right          ) &&
+             ( other.leafPointIndex() == leafPointIndex() ) );
+}
+
+template< typename T, typename I, typename A >
+std::ostream&
+KDNode< T, I, A >::print( std::ostream& out ) const
+{
+    out << "KDNode:[ "
+        << "is leaf = '"         << ( isLeaf() ? "yes" : "no" )  << "', "
+        << "hyperplane = "       << hyperplane()                 << ", "
+        << "left ptr = '"        << std::hex << m_left           << "', "
+        << "right ptr = '"       << std::hex << m_right          << "', "
+        << "leaf point index = " << std::dec << leafPointIndex() << " ]";
+
+    return out;
+}
+
+//============================================================================
+//                  INDEPENDENT OPERATORS
+//============================================================================
+template< typename T, typename I, typename A >
+std::ostream& operator<<( std::ostream& lhs, const KDNode< T, I, A >& rhs )
+{
+    return rhs.print( lhs );
+}
+
+} // close namespace datastructures
+
+#endif // KDTREE_NODE_H
@@ -0,0 +1,163 @@
+#include "kdtree_options.h"
+#include "kdtree_constants.h"
+
+namespace datastructures {
+
+//============================================================================
+//                  CREATORS
+//============================================================================
+
+KDTreeOptions::KDTreeOptions()
+: nodeAllocation( SHARED_NODES )
+, nodeLayout( BUILD_ORDER )
+, pointOrder( INPUT_ORDER )
+, pointPrecision( FULL_PRECISION )
+, builder( MEDIAN_BUILDER )
+, buildThreads( 0u )
+, splitPolicy( WIDEST_RANGE_MEDIAN )
+, splitSampleThreshold( 0u )
+, splitSampleSize( Constants::KDTREE_SPLIT_SAMPLE_SIZE )
+, splitSampleSeed( 0u )
+, fileFormat( TEXT_FORMAT )
+, pointCompression( RAW_POINTS )
+, chunkDepth( Constants::KDTREE_CHUNK_DEPTH )
+, ioThreads( 0u )
+, profileBuild( false )
+{
+    // nothing to do here
+}
+
+//============================================================================
+//                  OPERATORS
+//============================================================================
+
+bool
+KDTreeOptions::operator==( const KDTreeOptions& other ) const
+{
+    return equals( other );
+}
+
+bool
+KDTreeOptions::operator!=( const KDTreeOptions& other ) const
+{
+    return !equals( other );
+}
+
+//============================================================================
+//                  PRIMARY INTERFACE
+//============================================================================
+
+std::string
+KDTreeOptions::splitPolicyName( const SplitPolicy policy )
+{
+    switch ( policy )
+    {
+    case VARIANCE_MEDIAN:
+        return "variance median";
+    case SLIDING_MIDPOINT:
+        return "sliding midpoint";
+    case COST_MODEL:
+        return "cost model";
+    case CYCLIC_MEDIAN:
+        return "cyclic median";
+    case WIDEST_RANGE_MEDIAN:
+    default:
+        return "widest range median";
+    }
+}
+
+bool
+KDTreeOptions::splitPolicyFromName( const std::string& name,
+                                    SplitPolicy&       policy )
+{
+    const SplitPolicy policies[] = {
+        WIDEST_RANGE_MEDIAN,
+        VARIANCE_MEDIAN,
+        SLIDING_MIDPOINT,
+        COST_MODEL,
+        CYCLIC_MEDIAN
+    };
+
+    for ( size_t i = 0; i < sizeof( policies ) / sizeof( policies[ 0 ] ); ++i )
+    {
+        if ( splitPolicyName( policies[ i ] ) == name )
+        {
+            policy = policies[ i ];
+            return true;
+        }
+    }
+
+    return false;
+}
+
+//============================================================================
+//                  ACCESSORS
+//============================================================================
+
+bool
+KDTreeOptions::equals( const KDTreeOptions& other ) const
+{
+    return ( ( other.nodeAllocation == nodeAllocation ) &&
+             ( other.nodeLayout     == nodeLayout     ) &&
+             ( other.pointOrder     == pointOrder     ) &&
+             ( other.pointPrecision == pointPrecision ) &&
+             ( other.builder        == builder        ) &&
+             ( other.buildThreads   == buildThreads   ) &&
+             ( other.splitPolicy    == splitPolicy    ) &&
+             ( other.splitSampleThreshold == splitSampleThreshold ) &&
+             ( other.splitSampleSize      == splitSampleSize      ) &&
+             ( other.splitSampleSeed      == splitSampleSeed      ) &&
+             ( other.fileFormat           == fileFormat           ) &&
+             ( other.pointCompression     == pointCompression     ) &&
+             ( other.chunkDepth           == chunkDepth           ) &&
+             ( other.ioThreads            == ioThreads            ) &&
+             ( other.profileBuild         == profileBuild         ) );
+}
+
+std::ostream&
+KDTreeOptions::print( std::ostream& out ) const
+{
+    out << "KDTreeOptions:[ "
+        << "node allocation = '"
+        << ( ARENA_NODES == nodeAllocation ? "arena" : "shared" ) << "', "
+        << "node layout = '"
+        << ( VAN_EMDE_BOAS_LAYOUT == nodeLayout ? "van emde boas" : "build" )
+        << "', "
+        << "point order = '"
+        << ( LEAF_ORDER == pointOrder ? "leaf" : "input" ) << "', "
+        << "point precision = '"
+        << ( BFLOAT16_PRECISION == pointPrecision ? "bfloat16" :
+             SCALAR_8_PRECISION == pointPrecision ? "scalar 8" : "full" )
+        << "', "
+        << "builder = '"
+        << ( PRESORTED_BUILDER == builder ? "presorted" :
+             MORTON_BUILDER    == builder ? "morton"    : "median" ) << "', "
+        << "build threads = " << buildThreads << ", "
+        << "split policy = '" << splitPolicyName( splitPolicy ) << "', "
+        << "split sample threshold = " << splitSampleThreshold << ", "
+        << "split sample size = "      << splitSampleSize      << ", "
+        << "split sample seed = "      << splitSampleSeed      << ", "
+        << "file format = '"
+        << ( COMPACT_FORMAT == fileFormat ? "compact" :
+             CHUNKED_FORMAT == fileFormat ? "chunked" : "text" ) << "', "
+        << "point compression = '"
+        << ( XOR_DELTA_POINTS    == pointCompression ? "xor delta"    :
+             BYTE_SHUFFLE_POINTS == pointCompression ? "byte shuffle" :
+                                                       "raw" ) << "', "
+        << "chunk depth = " << chunkDepth << ", "
+        << "io threads = "  << ioThreads  << ", "
+        << "profile build = '" << ( profileBuild ? "yes" : "no" ) << "' ]";
+
+    return out;
+}
+
+//============================================================================
+//                  INDEPENDENT OPERATORS
+//============================================================================
+
+std::ostream& operator<<( std::ostream& lhs, const KDTreeOptions& rhs )
+{
+    return rhs.print( lhs );
+}
+
+} // namespace datastructures
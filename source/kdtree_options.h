@@ -0,0 +1,240 @@
+#ifndef KDTREE_OPTIONS_H
+#define KDTREE_OPTIONS_H
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+// @Purpose
+//
+// This struct gathers the knobs controlling how a KDTree lays out and builds
+// its structure. Default constructed options reproduce the baseline
+// KDTree behaviour.
+
+namespace datastructures {
+
+struct KDTreeOptions {
+    // TYPES
+    enum NodeAllocation {
+        SHARED_NODES,
+            // Every node is allocated separately and owned by its parent
+            // through a std::shared_ptr
+
+        ARENA_NODES
+            // Nodes are carved out of KDNodeArena slabs owned by the tree and
+            // released in a single pass. Child pointers are non-owning, so
+            // subtrees handed out by KDNode::left()/right() are only valid
+            // while the tree's root is alive.
+    };
+
+    enum NodeLayout {
+        BUILD_ORDER,
+            // Nodes stay in the order they are created by build() or
+            // deserialize()
+
+        VAN_EMDE_BOAS_LAYOUT
+            // Once built, nodes are moved into a single arena slab in van
+            // Emde Boas order: the top half of the tree's levels first, then
+            // each of the bottom subtrees, recursively. A root-to-leaf path
+            // then touches about log_B(n) cache lines for any cache line
+            // size B. Implies arena storage regardless of nodeAllocation.
+    };
+
+    enum PointOrder {
+        INPUT_ORDER,
+            // Points are stored in the order they were provided in
+
+        LEAF_ORDER
+            // Once built, points owned by the tree are permuted into the
+            // left-to-right order of the leaves referring to them, so that
+            // neighbouring leaves refer to neighbouring points. Indexes
+            // returned by and passed to the tree remain input order indexes.
+            // Has no effect on trees built over a caller-owned buffer.
+    };
+
+    enum PointPrecision {
+        FULL_PRECISION,
+            // Search reads the stored points only
+
+        BFLOAT16_PRECISION,
+            // Search first compares against bfloat16 copies of the points
+            // and reads a stored point only when its compact copy cannot
+            // rule it out. Results are exact.
+
+        SCALAR_8_PRECISION
+            // Same as BFLOAT16_PRECISION with 8-bit codes, scaled per axis
+            // to the range of the stored points
+    };
+
+    enum TreeBuilder {
+        MEDIAN_BUILDER,
+            // Calls KDTree::chooseBestSplit() at every node
+
+        PRESORTED_BUILDER,
+            // Sorts the points once per axis up front and stable-partitions
+            // the sorted orders down the recursion, so that range and median
+            // of every split are looked up in O(1). Produces the same
+            // structure as MEDIAN_BUILDER with the default chooseBestSplit(),
+            // ignoring any override of it.
+
+        MORTON_BUILDER
+            // Quantizes the points to a grid spanning their bounding box,
+            // sorts their Morton codes with a parallel radix sort and splits
+            // at the highest differing code bit, as in LBVH construction.
+            // Near-linear and meant for low-dimensional points; splits are
+            // spatial midpoints rather than medians. Points sharing a grid
+            // cell, and points of more than 64 dimensions, are built by
+            // MEDIAN_BUILDER.
+    };
+
+    enum SplitPolicy {
+        WIDEST_RANGE_MEDIAN,
+            // Axis of the widest range of the points, split at the median.
+            // Calls KDTree::chooseBestSplit(), so subclasses overriding it
+            // keep working.
+
+        VARIANCE_MEDIAN,
+            // Axis of the largest variance of the points, computed in a
+            // single pass, split at the median
+
+        SLIDING_MIDPOINT,
+            // Widest side of the node's cell, split at its midpoint. If all
+            // the points fall on one side, the split slides to the closest
+            // of them. Bounds the aspect ratio of cells.
+
+        COST_MODEL,
+            // Surface area heuristic: candidate planes at evenly spaced
+            // positions on every axis, picks the one minimizing the points
+            // on each side weighted by the half perimeter of their bounding
+            // box. Cuts off empty space around clustered data.
+
+        CYCLIC_MEDIAN
+            // Axis depth % dimension, split at the median
+    };
+
+    enum FileFormat {
+        TEXT_FORMAT,
+            // serialize() writes one marker or value per line, coordinates
+            // printed as decimal text
+
+        COMPACT_FORMAT,
+            // serialize() writes the binary format of KDCodec: split axes
+            // packed into bits, leaf indexes as varint deltas and exact
+            // coordinates encoded as pointCompression prescribes.
+            // deserialize() recognizes any format.
+
+        CHUNKED_FORMAT
+            // COMPACT_FORMAT split into independently encoded chunks: one
+            // per block of points and one per subtree at chunkDepth, behind
+            // a header holding the splits above them and the chunk sizes.
+            // serialize() and deserialize() encode and transfer the chunks
+            // on ioThreads threads with positioned I/O.
+    };
+
+    enum PointCompression {
+        RAW_POINTS,
+            // Coordinates are copied as they are
+
+        XOR_DELTA_POINTS,
+            // Points are written in the leaf order of the tree, every
+            // coordinate XORed with the same coordinate of the previous
+            // point and its leading and trailing zeros left out
+
+        BYTE_SHUFFLE_POINTS
+            // Coordinates are transposed into byte planes, each plane
+            // run-length encoded
+    };
+
+    // CREATORS
+    KDTreeOptions();
+        // Default constructor, baseline behaviour
+
+    // OPERATORS
+    bool operator==( const KDTreeOptions& other ) const;
+        // Equality. Calls equals.
+
+    bool operator!=( const KDTreeOptions& other ) const;
+        // Non-equality. Calls equals.
+
+    // PRIMARY INTERFACE
+    static std::string splitPolicyName( const SplitPolicy policy );
+        // Returns the textual name of the policy
+
+    static bool splitPolicyFromName( const std::string& name,
+                                     SplitPolicy&       policy );
+        // Sets policy to the one with the provided textual name.
+        // Returns true on success and false otherwise.
+
+    // ACCESSORS
+    bool equals( const KDTreeOptions& other ) const;
+        // Worker for equality
+
+    std::ostream& print( std::ostream& out ) const;
+        // Prints the options in a easy to read format
+
+    // DATA
+    NodeAllocation  nodeAllocation;
+        // How nodes are allocated by build() and deserialize()
+
+    NodeLayout      nodeLayout;
+        // How nodes are ordered in memory once the tree is built
+
+    PointOrder      pointOrder;
+        // How points are ordered in memory once the tree is built
+
+    PointPrecision  pointPrecision;
+        // Which compact copies of the points search filters candidates with.
+        // Not recorded in serialized files.
+
+    TreeBuilder     builder;
+        // How build() constructs the structure
+
+    size_t          buildThreads;
+        // Number of threads parallel builders may use, 0 for all hardware
+        // threads
+
+    SplitPolicy     splitPolicy;
+        // How MEDIAN_BUILDER chooses splits. PRESORTED_BUILDER supports
+        // WIDEST_RANGE_MEDIAN only and falls back to MEDIAN_BUILDER for the
+        // others; MORTON_BUILDER has a split rule of its own. Recorded in
+        // the tree type.
+
+    size_t          splitSampleThreshold;
+        // Subsets of more points than this have their split chosen from a
+        // random sample of splitSampleSize points rather than from all of
+        // them, 0 to always use all the points. Trades balance for build
+        // time at the top levels of large trees. Applies to MEDIAN_BUILDER.
+
+    size_t          splitSampleSize;
+        // Number of points drawn for sampled splits
+
+    uint32_t        splitSampleSeed;
+        // Seed of the sampling, builds with equal seeds are identical
+
+    FileFormat      fileFormat;
+        // Which format serialize() writes
+
+    PointCompression pointCompression;
+        // How COMPACT_FORMAT and CHUNKED_FORMAT encode coordinates and split
+        // values
+
+    size_t          chunkDepth;
+        // Depth of the subtrees CHUNKED_FORMAT writes as separate chunks,
+        // up to 2^chunkDepth of them. Not recorded in serialized files.
+
+    size_t          ioThreads;
+        // Number of threads CHUNKED_FORMAT reads and writes with, 0 for all
+        // hardware threads. Not recorded in serialized files.
+
+    bool            profileBuild;
+        // Whether build() times its phases, see KDTree::buildProfile().
+        // Off by default, as it reads the clock several times per node.
+        // Not recorded in serialized files.
+};
+
+// INDEPENDENT OPERATORS
+std::ostream& operator<<( std::ostream& lhs, const KDTreeOptions& rhs );
+
+} // namespace datastructures
+
+#endif // KDTREE_OPTIONS_H
@@ -0,0 +1,5 @@
+#include "kdtree_paged.h"
+
+namespace datastructures {
+
+} // namespace datastructures
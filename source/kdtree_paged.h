@@ -0,0 +1,873 @@
+#ifndef KDTREE_PAGED_H
+#define KDTREE_PAGED_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "kdtree_types.h"
+#include "kdtree_point_view.h"
+#include "kdtree_hyperplane.h"
+#include "kdtree_utils.h"
+#include "kdtree_constants.h"
+#include "kdtree.h"
+#include "kdtree_flat.h"
+
+// @Purpose
+//
+// This class answers nearest point queries straight from a paged on-disk
+// KDTree file, keeping only a bounded number of pages in memory.
+//
+// The paged file is a sequence of fixed-size pages:
+//  - page 0 holds the header
+//  - node pages follow, each holding whole subtree fragments: the first
+//    fragment of the tree is its top levels, taken breadth first from the
+//    root until the page is full. Every child left out of a fragment roots
+//    a fragment of its own, packed into the current page if it fits and
+//    into a fresh page otherwise.
+//  - point pages follow, points stored in leaf order so that neighbouring
+//    leaves refer to the same page
+//
+// The first node page - the top levels of the tree - is the directory, held
+// in memory for as long as the file is open. All the other pages are faulted
+// in on demand through a least recently used cache of a fixed number of
+// pages, whose hits and misses are counted. open() checks the header against
+// the size of the file; every node is checked as a query reaches it, so that
+// a corrupt page fails the query rather than the process. The search itself
+// is KDFlatTree::nearest(), fed one node at a time from the pages.
+//
+// write() converts a file written by KDTree::serialize(), in any of its
+// formats, into the paged layout. It loads the whole tree through
+// KDTree::deserialize(), so it is meant to be run once on a machine large
+// enough to do so.
+//
+// Note that queries update the cache, so a KDPagedTree must not be queried
+// from several threads at once.
+//
+
+namespace datastructures {
+
+template< typename T >
+class KDPagedTree {
+public:
+    // CREATORS
+    KDPagedTree();
+        // Default constructor, no file is open
+
+    virtual ~KDPagedTree();
+        // Destructor, calls close()
+
+    // PRIMARY INTERFACE
+    static bool write( const std::string& treeFile,
+                       const std::string& pagedFile,
+                       const size_t       pageSize
+                                                = Constants::KDTREE_PAGE_SIZE );
+        // Converts the serialized KDTree in treeFile into a paged file of
+        // pageSize byte pages.
+        // Returns true on success and false otherwise.
+
+    bool open( const std::string& pagedFile,
+               const size_t       cachePages
+                                        = Constants::KDTREE_PAGE_CACHE_SIZE );
+        // Opens the paged file, loading its header and directory, with room
+        // for cachePages other pages in the cache.
+        // Returns true on success and false otherwise.
+
+    void close();
+        // Closes the file and empties the cache
+
+    size_t nearestPointIndex( const Types::Point< T >& pointOfInterest ) const;
+        // Returns input order index of the closest point in the tree to the
+        // point of interest, as KDTree::nearestPointIndex() does.
+        // In case the tree is empty, there is a cardinality mismatch or a
+        // page is unreadable or malformed - KDTREE_ERROR_INDEX is returned
+
+    const Types::Point< T > nearestPoint(
+            const Types::Point< T >& pointOfInterest ) const;
+        // Returns a copy of the closest point in the tree to the point of
+        // interest. In case the tree is empty, there is a cardinality
+        // mismatch or a page is unreadable or malformed - empty point is
+        // returned
+
+    // MANIPULATORS
+    void resetStatistics();
+        // Zeroes the cache hit and miss counts
+
+    // ACCESSORS
+    bool isOpen() const;
+        // Returns true if a paged file is open
+
+    size_t size() const;
+        // Returns number of points of the tree
+
+    size_t dimension() const;
+        // Returns cardinality of the points of the tree
+
+    size_t pageSize() const;
+        // Returns size of a page in bytes
+
+    size_t numPages() const;
+        // Returns number of pages of the file, header included
+
+    size_t cachePages() const;
+        // Returns capacity of the cache in pages, directory excluded
+
+    size_t residentPages() const;
+        // Returns number of pages currently held in memory, directory
+        // included
+
+    size_t cacheHits() const;
+        // Returns number of page requests served from the cache
+
+    size_t cacheMisses() const;
+        // Returns number of page requests read from the file
+
+    double hitRate() const;
+        // Returns share of page requests served from the cache, 0 if there
+        // were none. Directory requests are not counted.
+
+    std::ostream& print( std::ostream& out ) const;
+        // Prints the KDPagedTree in a easy to read format
+
+private:
+    // NOT IMPLEMENTED
+    KDPagedTree( const KDPagedTree& );
+    KDPagedTree& operator=( const KDPagedTree& );
+
+    // PRIVATE TYPES
+    struct Node {
+        uint64_t axis;
+            // Split axis, KDTREE_PAGED_LEAF for leaves
+
+        uint64_t first;
+            // Left child node id, input order point index for leaves
+
+        uint64_t second;
+            // Right child node id, leaf order point slot for leaves
+
+        T        value;
+            // Split value
+    };
+
+    struct Header {
+        uint64_t valueSize;
+        uint64_t dimension;
+        uint64_t numPoints;
+        uint64_t pageSize;
+        uint64_t nodesPerPage;
+        uint64_t numNodePages;
+        uint64_t pointsPerPage;
+        uint64_t numPointPages;
+    };
+
+    typedef KDFlatNode< T >                                     FlatNode;
+
+    struct Reader {
+        const KDPagedTree*  tree;
+            // The tree whose pages are read
+
+        std::vector< T >*   scratch;
+            // Room for the coordinates of a point
+
+        bool node( const uint64_t id, FlatNode& result ) const;
+            // Reads the node under id, see KDPagedTree::node()
+
+        bool distance( const FlatNode&         leaf,
+                       const KDPointView< T >& pointOfInterest,
+                       double&                 result ) const;
+            // Reads the point of the leaf and measures its euclidean
+            // distance to the point of interest. Returns false if its page
+            // cannot be read.
+    };
+        // Feeds the pages to KDFlatTree::nearest()
+
+    typedef std::list< size_t >                                 Recency;
+    typedef std::pair< std::vector< char >, Recency::iterator > CachedPage;
+
+    static const size_t NODE_SIZE = 3u * sizeof( uint64_t ) +
+                                    ( ( sizeof( T ) + 7u ) & ~size_t( 7u ) );
+        // Bytes of a node record
+
+    static bool load( const std::string&       treeFile,
+                      std::vector< T >&        coordinates,
+                      size_t&                  dimension,
+                      std::vector< FlatNode >& nodes );
+        // Loads a file written by KDTree::serialize() into nodes flattened
+        // in preorder and flat coordinates in leaf order
+
+    const char* page( const size_t pageIndex ) const;
+        // Returns bytes of the page, reading it into the cache if needed,
+        // nullptr if it cannot be read. Valid until the next call.
+
+    bool node( const uint64_t id, FlatNode& result ) const;
+        // Reads the node under id into result. Returns false if its page
+        // cannot be read or KDFlatTree::isValid() rejects it, which keeps a
+        // query over a corrupt file from looping or reading past the pages.
+
+    bool point( const uint64_t slot, std::vector< T >& coordinates ) const;
+        // Copies coordinates of the point in leaf order slot. Returns false
+        // if its page cannot be read.
+
+    mutable std::ifstream                           m_file;
+        // The paged file
+
+    Header                                          m_header;
+        // Header of the paged file
+
+    std::vector< char >                             m_directory;
+        // The first node page
+
+    size_t                                          m_cachePages;
+        // Capacity of the cache
+
+    mutable std::unordered_map< size_t, CachedPage > m_cache;
+        // Cached pages by page index
+
+    mutable Recency                                 m_recency;
+        // Cached page indexes, most recently used first
+
+    mutable size_t                                  m_hits;
+        // Page requests served from the cache
+
+    mutable size_t                                  m_misses;
+        // Page requests read from the file
+};
+
+//============================================================================
+//                  CREATORS
+//============================================================================
+
+template< typename T >
+KDPagedTree< T >::KDPagedTree()
+: m_cachePages( 0u )
+, m_hits( 0u )
+, m_misses( 0u )
+{
+    std::memset( &m_header, 0, sizeof( m_header ) );
+}
+
+template< typename T >
+KDPagedTree< T >::~KDPagedTree()
+{
+    close();
+}
+
+//============================================================================
+//                  PRIMARY INTERFACE
+//============================================================================
+
+template< typename T >
+bool
+KDPagedTree< T >::write( const std::string& treeFile,
+                         const std::string& pagedFile,
+                         const size_t       pageSize )
+{
+    std::vector< T >        coordinates;
+    std::vector< FlatNode > nodes;
+    size_t                  dimension = 0u;
+    if ( !load( treeFile, coordinates, dimension, nodes ) )
+    {
+        return false;
+    }
+
+    Header header;
+    header.valueSize     = sizeof( T );
+    header.dimension     = dimension;
+    header.numPoints     = dimension ? coordinates.size() / dimension : 0u;
+    header.pageSize      = pageSize;
+    header.nodesPerPage  = pageSize / NODE_SIZE;
+    header.numNodePages  = 0u;
+    header.pointsPerPage = dimension ? pageSize / ( dimension * sizeof( T ) )
+                                     : 0u;
+    header.numPointPages = 0u;
+
+    if ( ( pageSize < Constants::KDTREE_PAGED_MAGIC.size() + sizeof( header ) )
+         || !header.nodesPerPage ||
+         ( header.numPoints && !header.pointsPerPage ) )
+    {
+        std::cerr << "KDPagedTree::write() page size " << pageSize << " "
+                  << "is too small"
+                  << std::endl;
+        return false;
+    }
+
+    // Fragments: breadth first from every fragment root until the page is
+    // full, the children left out queued as fragment roots
+    std::vector< uint64_t > ids( nodes.size() );
+    std::vector< size_t >   order;
+    order.reserve( nodes.size() );
+
+    std::deque< size_t > fragmentRoots;
+    if ( !nodes.empty() )
+    {
+        fragmentRoots.push_back( 0u );
+    }
+
+    size_t used = header.nodesPerPage;
+    while ( !fragmentRoots.empty() )
+    {
+        std::deque< size_t > frontier( 1u, fragmentRoots.front() );
+        fragmentRoots.pop_front();
+
+        std::vector< size_t > fragment;
+        while ( !frontier.empty() && ( fragment.size() < header.nodesPerPage ) )
+        {
+            const size_t current = frontier.front();
+            frontier.pop_front();
+            fragment.push_back( current );
+
+            if ( Constants::KDTREE_FLAT_LEAF != nodes[ current ].axis )
+            {
+                frontier.push_back( nodes[ current ].left );
+                frontier.push_back( nodes[ current ].right );
+            }
+        }
+        fragmentRoots.insert( fragmentRoots.end(),
+                              frontier.begin(), frontier.end() );
+
+        if ( used + fragment.size() > header.nodesPerPage )
+        {
+            ++header.numNodePages;
+            used = 0u;
+        }
+        for ( size_t i = 0; i < fragment.size(); ++i )
+        {
+            ids[ fragment[ i ] ] =
+                    ( header.numNodePages - 1u ) * header.nodesPerPage + used++;
+            order.push_back( fragment[ i ] );
+        }
+    }
+
+    header.numPointPages = header.numPoints ?
+            ( header.numPoints + header.pointsPerPage - 1u ) /
+                    header.pointsPerPage : 0u;
+
+    std::ofstream pagedData( pagedFile, std::ios::binary | std::ios::trunc );
+    if ( !pagedData.is_open() )
+    {
+        std::cerr << "KDPagedTree::write() is unable to open "
+                  << "'" << pagedFile << "' for writing"
+                  << std::endl;
+        return false;
+    }
+
+    std::vector< char > bytes( pageSize, 0 );
+
+    // Header page
+    std::memcpy( &bytes[ 0 ], Constants::KDTREE_PAGED_MAGIC.data(),
+                 Constants::KDTREE_PAGED_MAGIC.size() );
+    std::memcpy( &bytes[ Constants::KDTREE_PAGED_MAGIC.size() ],
+                 &header, sizeof( header ) );
+    pagedData.write( &bytes[ 0 ], pageSize );
+
+    // Node pages
+    std::vector< char > nodePages( header.numNodePages * pageSize, 0 );
+    for ( size_t i = 0; i < order.size(); ++i )
+    {
+        const FlatNode& source = nodes[ order[ i ] ];
+        const bool      isLeaf = Constants::KDTREE_FLAT_LEAF == source.axis;
+
+        Node record;
+        std::memset( &record, 0, sizeof( record ) );
+        record.axis   = isLeaf ? Constants::KDTREE_PAGED_LEAF : source.axis;
+        record.first  = isLeaf ? source.index : ids[ source.left ];
+        record.second = isLeaf ? source.slot  : ids[ source.right ];
+        record.value  = source.value;
+
+        const uint64_t id     = ids[ order[ i ] ];
+        char*          target = &nodePages[
+                ( id / header.nodesPerPage ) * pageSize +
+                ( id % header.nodesPerPage ) * NODE_SIZE ];
+        std::memcpy( target, &record.axis, sizeof( uint64_t ) );
+        std::memcpy( target + sizeof( uint64_t ), &record.first,
+                     sizeof( uint64_t ) );
+        std::memcpy( target + 2u * sizeof( uint64_t ), &record.second,
+                     sizeof( uint64_t ) );
+        std::memcpy( target + 3u * sizeof( uint64_t ), &record.value,
+                     sizeof( T ) );
+    }
+    if ( !nodePages.empty() )
+    {
+        pagedData.write( &nodePages[ 0 ], nodePages.size() );
+    }
+
+    // Point pages
+    const size_t pointSize = dimension * sizeof( T );
+    for ( size_t p = 0; p < header.numPointPages; ++p )
+    {
+        std::fill( bytes.begin(), bytes.end(), 0 );
+        for ( size_t s = 0; s < header.pointsPerPage; ++s )
+        {
+            const size_t slot = p * header.pointsPerPage + s;
+            if ( slot >= header.numPoints )
+            {
+                break;
+            }
+
+            std::memcpy( &bytes[ s * pointSize ],
+                         &coordinates[ slot * dimension ], pointSize );
+        }
+        pagedData.write( &bytes[ 0 ], pageSize );
+    }
+
+    return pagedData.good();
+}
+
+template< typename T >
+bool
+KDPagedTree< T >::open( const std::string& pagedFile,
+                        const size_t       cachePages )
+{
+    close();
+
+    m_file.open( pagedFile, std::ios::binary );
+    if ( !m_file.is_open() )
+    {
+        std::cerr << "KDPagedTree::open() is unable to open "
+                  << "'" << pagedFile << "' for reading"
+                  << std::endl;
+        return false;
+    }
+
+    std::string magic( Constants::KDTREE_PAGED_MAGIC.size(), '\0' );
+    m_file.read( &magic[ 0 ], magic.size() );
+    m_file.read( reinterpret_cast< char* >( &m_header ), sizeof( m_header ) );
+
+    if ( !m_file || ( Constants::KDTREE_PAGED_MAGIC != magic ) ||
+         ( m_header.valueSize != sizeof( T ) ) ||
+         ( m_header.pageSize < magic.size() + sizeof( m_header ) ) ||
+         ( m_header.nodesPerPage != m_header.pageSize / NODE_SIZE ) ||
+         ( m_header.numPoints && ( !m_header.dimension ||
+                ( m_header.dimension > m_header.pageSize / sizeof( T ) ) ||
+                ( m_header.pointsPerPage != m_header.pageSize /
+                        ( m_header.dimension * sizeof( T ) ) ) ) ) )
+    {
+        std::cerr << "KDPagedTree::open() '" << pagedFile << "' is not a "
+                  << "paged KDTree of this coordinate type"
+                  << std::endl;
+        close();
+        return false;
+    }
+
+    // A node page holds at least one node and the point pages exactly the
+    // points, all of them within the file
+    m_file.seekg( 0, std::ios::end );
+    const uint64_t fileSize = static_cast< uint64_t >( m_file.tellg() );
+    const uint64_t numPages = fileSize / m_header.pageSize;
+    const uint64_t numNodes = m_header.numPoints ?
+                              2u * m_header.numPoints - 1u : 0u;
+    const bool valid =
+            m_file &&
+            ( m_header.numPoints <= fileSize ) &&
+            ( numPages * m_header.pageSize == fileSize ) &&
+            ( m_header.numNodePages < numPages ) &&
+            ( m_header.numPointPages < numPages ) &&
+            ( 1u + m_header.numNodePages + m_header.numPointPages ==
+              numPages ) &&
+            ( !m_header.numPoints == !m_header.numNodePages ) &&
+            ( m_header.numNodePages <= numNodes ) &&
+            ( m_header.numNodePages * m_header.nodesPerPage >= numNodes ) &&
+            ( m_header.numPointPages == ( m_header.numPoints ?
+                    ( m_header.numPoints + m_header.pointsPerPage - 1u ) /
+                            m_header.pointsPerPage : 0u ) );
+    if ( !valid )
+    {
+        std::cerr << "KDPagedTree::open() '" << pagedFile << "' "
+                  << "is truncated or has a malformed header"
+                  << std::endl;
+        close();
+        return false;
+    }
+
+    if ( m_header.numNodePages )
+    {
+        m_directory.resize( m_header.pageSize );
+        m_file.seekg( m_header.pageSize );
+        m_file.read( &m_directory[ 0 ], m_header.pageSize );
+        if ( !m_file )
+        {
+            std::cerr << "KDPagedTree::open() '" << pagedFile << "' "
+                      << "is truncated"
+                      << std::endl;
+            close();
+            return false;
+        }
+    }
+
+    m_cachePages = std::max< size_t >( 1u, cachePages );
+
+    return true;
+}
+
+template< typename T >
+void
+KDPagedTree< T >::close()
+{
+    if ( m_file.is_open() )
+    {
+        m_file.close();
+    }
+    m_file.clear();
+
+    std::memset( &m_header, 0, sizeof( m_header ) );
+    m_directory.clear();
+    m_cache.clear();
+    m_recency.clear();
+    m_cachePages = 0u;
+}
+
+template< typename T >
+size_t
+KDPagedTree< T >::nearestPointIndex(
+        const Types::Point< T >& pointOfInterest ) const
+{
+    // Sanity
+    if ( !m_header.numPoints || ( pointOfInterest.size() != m_header.dimension ) )
+    {
+        return Constants::KDTREE_ERROR_INDEX;
+    }
+
+    std::vector< T > scratch( m_header.dimension );
+    const Reader     reader = { this, &scratch };
+    FlatNode         best;
+    if ( !KDFlatTree< T >::nearest( reader,
+                                    KDPointView< T >( pointOfInterest ),
+                                    best ) )
+    {
+        return Constants::KDTREE_ERROR_INDEX;
+    }
+
+    return static_cast< size_t >( best.index );
+}
+
+template< typename T >
+const Types::Point< T >
+KDPagedTree< T >::nearestPoint(
+        const Types::Point< T >& pointOfInterest ) const
+{
+    // Sanity
+    if ( !m_header.numPoints || ( pointOfInterest.size() != m_header.dimension ) )
+    {
+        return Types::Point< T >();
+    }
+
+    std::vector< T > scratch( m_header.dimension );
+    const Reader     reader = { this, &scratch };
+    FlatNode         best;
+    if ( !KDFlatTree< T >::nearest( reader,
+                                    KDPointView< T >( pointOfInterest ),
+                                    best ) ||
+         !point( best.slot, scratch ) )
+    {
+        return Types::Point< T >();
+    }
+
+    return Types::Point< T >( scratch.begin(), scratch.end() );
+}
+
+template< typename T >
+bool
+KDPagedTree< T >::load( const std::string&       treeFile,
+                        std::vector< T >&        coordinates,
+                        size_t&                  dimension,
+                        std::vector< FlatNode >& nodes )
+{
+    // Any plain KDTree, whatever its split policy and file format
+    KDTree< T > tree;
+    if ( !tree.deserialize( treeFile ) )
+    {
+        std::cerr << "KDPagedTree::write() is unable to load "
+                  << "'" << treeFile << "'"
+                  << std::endl;
+        return false;
+    }
+
+    if ( !KDFlatTree< T >::flatten( tree, nodes ) )
+    {
+        std::cerr << "KDPagedTree::write() expects a tree with a leaf per "
+                  << "point and two children per split"
+                  << std::endl;
+        return false;
+    }
+
+    const size_t numPoints = tree.pointsView().size();
+    dimension = numPoints ? tree.pointAt( 0u ).size() : 0u;
+
+    coordinates.resize( numPoints * dimension );
+    for ( size_t i = 0; i < nodes.size(); ++i )
+    {
+        if ( Constants::KDTREE_FLAT_LEAF != nodes[ i ].axis )
+        {
+            continue;
+        }
+
+        const KDPointView< T > point = tree.pointAt( nodes[ i ].index );
+        for ( size_t axis = 0; axis < dimension; ++axis )
+        {
+            coordinates[ nodes[ i ].slot * dimension + axis ] = point[ axis ];
+        }
+    }
+
+    return true;
+}
+
+template< typename T >
+const char*
+KDPagedTree< T >::page( const size_t pageIndex ) const
+{
+    // Directory
+    if ( 1u == pageIndex )
+    {
+        return &m_directory[ 0 ];
+    }
+
+    typename std::unordered_map< size_t, CachedPage >::iterator it =
+            m_cache.find( pageIndex );
+    if ( it != m_cache.end() )
+    {
+        ++m_hits;
+        m_recency.splice( m_recency.begin(), m_recency, it->second.second );
+        return &it->second.first[ 0 ];
+    }
+
+    ++m_misses;
+
+    // Reuse the buffer of the least recently used page
+    std::vector< char > bytes;
+    if ( m_cache.size() >= m_cachePages )
+    {
+        const size_t evicted = m_recency.back();
+        m_recency.pop_back();
+        bytes.swap( m_cache[ evicted ].first );
+        m_cache.erase( evicted );
+    }
+    bytes.resize( m_header.pageSize );
+
+    m_file.clear();
+    m_file.seekg( static_cast< std::streamoff >( pageIndex *
+                                                 m_header.pageSize ) );
+    m_file.read( &bytes[ 0 ], m_header.pageSize );
+    if ( !m_file )
+    {
+        std::cerr << "KDPagedTree is unable to read page " << pageIndex
+                  << std::endl;
+        return nullptr;
+    }
+
+    m_recency.push_front( pageIndex );
+    CachedPage& cached = m_cache[ pageIndex ];
+    cached.first.swap( bytes );
+    cached.second = m_recency.begin();
+
+    return &cached.first[ 0 ];
+}
+
+template< typename T >
+bool
+KDPagedTree< T >::node( const uint64_t id, FlatNode& result ) const
+{
+    const char* bytes = page( 1u + id / m_header.nodesPerPage );
+    if ( !bytes )
+    {
+        return false;
+    }
+    const char* source = bytes + ( id % m_header.nodesPerPage ) * NODE_SIZE;
+
+    Node record;
+    std::memcpy( &record.axis,   source, sizeof( uint64_t ) );
+    std::memcpy( &record.first,  source + sizeof( uint64_t ),
+                 sizeof( uint64_t ) );
+    std::memcpy( &record.second, source + 2u * sizeof( uint64_t ),
+                 sizeof( uint64_t ) );
+    std::memcpy( &record.value,  source + 3u * sizeof( uint64_t ),
+                 sizeof( T ) );
+
+    const bool isLeaf = Constants::KDTREE_PAGED_LEAF == record.axis;
+    result.axis  = isLeaf ? Constants::KDTREE_FLAT_LEAF : record.axis;
+    result.left  = isLeaf ? 0u : record.first;
+    result.right = isLeaf ? 0u : record.second;
+    result.slot  = isLeaf ? record.second : 0u;
+    result.index = isLeaf ? record.first  : 0u;
+    result.value = record.value;
+
+    // Ids count the unused tails of the node pages too
+    const bool valid = KDFlatTree< T >::isValid(
+            id, result, m_header.numNodePages * m_header.nodesPerPage,
+            m_header.numPoints, m_header.dimension );
+    if ( !valid )
+    {
+        std::cerr << "KDPagedTree encountered malformed node " << id
+                  << std::endl;
+    }
+
+    return valid;
+}
+
+template< typename T >
+bool
+KDPagedTree< T >::point( const uint64_t    slot,
+                         std::vector< T >& coordinates ) const
+{
+    const size_t pointSize = m_header.dimension * sizeof( T );
+    const char*  bytes     = page( 1u + m_header.numNodePages +
+                                   slot / m_header.pointsPerPage );
+    if ( !bytes )
+    {
+        return false;
+    }
+
+    std::memcpy( &coordinates[ 0 ],
+                 bytes + ( slot % m_header.pointsPerPage ) * pointSize,
+                 pointSize );
+    return true;
+}
+
+template< typename T >
+bool
+KDPagedTree< T >::Reader::node( const uint64_t id, FlatNode& result ) const
+{
+    return tree->node( id, result );
+}
+
+template< typename T >
+bool
+KDPagedTree< T >::Reader::distance( const FlatNode&         leaf,
+                                    const KDPointView< T >& pointOfInterest,
+                                    double&                 result ) const
+{
+    if ( !tree->point( leaf.slot, *scratch ) )
+    {
+        return false;
+    }
+
+    result = Utils::distance< T >(
+            KDPointView< T >( &( *scratch )[ 0 ], scratch->size() ),
+            pointOfInterest );
+    return true;
+}
+
+//============================================================================
+//                  MANIPULATORS
+//============================================================================
+
+template< typename T >
+void
+KDPagedTree< T >::resetStatistics()
+{
+    m_hits   = 0u;
+    m_misses = 0u;
+}
+
+//============================================================================
+//                  ACCESSORS
+//============================================================================
+
+template< typename T >
+bool
+KDPagedTree< T >::isOpen() const
+{
+    return m_file.is_open();
+}
+
+template< typename T >
+size_t
+KDPagedTree< T >::size() const
+{
+    return m_header.numPoints;
+}
+
+template< typename T >
+size_t
+KDPagedTree< T >::dimension() const
+{
+    return m_header.dimension;
+}
+
+template< typename T >
+size_t
+KDPagedTree< T >::pageSize() const
+{
+    return m_header.pageSize;
+}
+
+template< typename T >
+size_t
+KDPagedTree< T >::numPages() const
+{
+    return isOpen() ? 1u + m_header.numNodePages + m_header.numPointPages
+                    : 0u;
+}
+
+template< typename T >
+size_t
+KDPagedTree< T >::cachePages() const
+{
+    return m_cachePages;
+}
+
+template< typename T >
+size_t
+KDPagedTree< T >::residentPages() const
+{
+    return m_cache.size() + ( m_directory.empty() ? 0u : 1u );
+}
+
+template< typename T >
+size_t
+KDPagedTree< T >::cacheHits() const
+{
+    return m_hits;
+}
+
+template< typename T >
+size_t
+KDPagedTree< T >::cacheMisses() const
+{
+    return m_misses;
+}
+
+template< typename T >
+double
+KDPagedTree< T >::hitRate() const
+{
+    const size_t requests = m_hits + m_misses;
+    return requests ? static_cast< double >( m_hits ) / requests : 0.0;
+}
+
+template< typename T >
+std::ostream&
+KDPagedTree< T >::print( std::ostream& out ) const
+{
+    out << "KDPagedTree:[ "
+        << "num points = "     << size()          << ", "
+        << "dimension = "      << dimension()     << ", "
+        << "page size = "      << pageSize()      << ", "
+        << "num pages = "      << numPages()      << ", "
+        << "cache pages = "    << m_cachePages    << ", "
+        << "resident pages = " << residentPages() << ", "
+        << "hit rate = "       << hitRate()       << " ] ";
+
+    return out;
+}
+
+//============================================================================
+//                  INDEPENDENT OPERATORS
+//============================================================================
+
+template< typename T >
+std::ostream& operator<<( std::ostream& lhs, const KDPagedTree< T >& rhs )
+{
+    return rhs.print( lhs );
+}
+
+} // namespace datastructures
+
+#endif // KDTREE_PAGED_H
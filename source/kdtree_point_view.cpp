@@ -0,0 +1,5 @@
+#include "kdtree_point_view.h"
+
+namespace datastructures {
+
+} // namespace datastructures
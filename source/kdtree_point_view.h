@@ -0,0 +1,450 @@
+#ifndef KDTREE_POINT_VIEW_H
+#define KDTREE_POINT_VIEW_H
+
+#include <iostream>
+
+#include "kdtree_types.h"
+
+namespace datastructures {
+
+// PURPOSE:
+//
+// A non-owning, read-only view of a single n-dimensional point. Behaves
+// like a span: it stores a pointer to the first coordinate and the number
+// of coordinates, and never copies the data it refers to.
+//
+// Note that a view is only valid for as long as the memory it refers to.
+//
+template< typename T >
+class KDPointView {
+public:
+    // TYPES
+    typedef const T* const_iterator;
+
+    // CREATORS
+    KDPointView();
+        // Default constructor, creates an empty view
+
+    KDPointView( const T* data, const size_t size );
+        // Constructor, views size coordinates starting at data
+
+    KDPointView( const Types::Point< T >& point );
+        // Constructor, views the contents of point. Implicit on purpose so
+        // that points may be passed wherever a view is expected.
+
+    // OPERATORS
+    const T& operator[]( const size_t axis ) const;
+        // Returns the coordinate on the provided axis. No bounds checking.
+
+    bool operator==( const KDPointView& other ) const;
+        // Equality. Calls equals.
+
+    bool operator!=( const KDPointView& other ) const;
+        // Non-equality. Calls equals.
+
+    // PRIMARY INTERFACE
+    const T* data() const;
+        // Returns pointer to the first coordinate
+
+    size_t size() const;
+        // Returns the number of coordinates, i.e. cardinality of the point
+
+    bool empty() const;
+        // Returns true if the view refers to no coordinates
+
+    const_iterator begin() const;
+        // Returns iterator to the first coordinate
+
+    const_iterator end() const;
+        // Returns iterator past the last coordinate
+
+    Types::Point< T > toPoint() const;
+        // Returns an owning copy of the viewed point
+
+    // ACCESSORS
+    bool equals( const KDPointView& other ) const;
+        // Worker for equality, compares coordinates not addresses
+
+    std::ostream& print( std::ostream& out ) const;
+        // Prints the contents of the viewed point in a easy to read format
+
+private:
+    const T*    m_data;
+        // First coordinate of the viewed point
+
+    size_t      m_size;
+        // Number of coordinates in the viewed point
+};
+
+// PURPOSE:
+//
+// A non-owning, read-only view of a set of n-dimensional points. Hands out
+// a KDPointView for each of the points without copying any of them.
+//
+// The viewed points either live in a Types::BasicPoints container using
+// allocator A or in a flat, caller-owned buffer where point i starts at
+// data + i * stride and spans dimension consecutive coordinates.
+//
+template< typename T, typename A = std::allocator< T > >
+class KDPointsView {
+public:
+    // CREATORS
+    KDPointsView();
+        // Default constructor, creates an empty view
+
+    KDPointsView( const Types::BasicPoints< T, A >& points );
+        // Constructor, views the contents of points
+
+    KDPointsView( const T*     data,
+                  const size_t count,
+                  const size_t dimension,
+                  const size_t stride );
+        // Constructor, views count points of the provided dimension in a
+        // flat buffer. Note that stride is expressed in elements of T, not
+        // in bytes, and must not be smaller than dimension.
+
+    // OPERATORS
+    KDPointView< T > operator[]( const size_t index ) const;
+        // Returns view of the point at the provided index. No bounds
+        // checking.
+
+    bool operator==( const KDPointsView& other ) const;
+        // Equality. Calls equals.
+
+    bool operator!=( const KDPointsView& other ) const;
+        // Non-equality. Calls equals.
+
+    // PRIMARY INTERFACE
+    size_t size() const;
+        // Returns the number of viewed points
+
+    bool empty() const;
+        // Returns true if the view refers to no points
+
+    bool isStrided() const;
+        // Returns true if the view refers to a flat buffer rather than a
+        // Types::Points container
+
+    Types::Points< T > toPoints() const;
+        // Returns an owning copy of the viewed points
+
+    // ACCESSORS
+    bool equals( const KDPointsView& other ) const;
+        // Worker for equality, compares coordinates not addresses
+
+private:
+    const Types::BasicPoints< T, A >*
+                                m_points;
+        // Viewed points, null for an empty or strided view
+
+    const T*                    m_data;
+        // First coordinate of the first point of a strided view
+
+    size_t                      m_count;
+        // Number of points in a strided view
+
+    size_t                      m_dimension;
+        // Cardinality of points in a strided view
+
+    size_t                      m_stride;
+        // Distance between consecutive points of a strided view, in
+        // elements of T
+};
+
+// INDEPENDENT OPERATORS
+template< typename T >
+std::ostream& operator<<( std::ostream& lhs,
+                          const KDPointView< T >& rhs );
+
+//============================================================================
+//                  KDPointView CREATORS
+//============================================================================
+
+template< typename T >
+KDPointView< T >::KDPointView()
+: m_data( nullptr )
+, m_size( 0u )
+{
+    // nothing to do here
+}
+
+template< typename T >
+KDPointView< T >::KDPointView( const T* data, const size_t size )
+: m_data( data )
+, m_size( size )
+{
+    // nothing to do here
+}
+
+template< typename T >
+KDPointView< T >::KDPointView( const Types::Point< T >& point )
+: m_data( point.data() )
+, m_size( point.size() )
+{
+    // nothing to do here
+}
+
+//============================================================================
+//                  KDPointView OPERATORS
+//============================================================================
+
+template< typename T >
+const T&
+KDPointView< T >::operator[]( const size_t axis ) const
+{
+    return m_data[ axis ];
+}
+
+template< typename T >
+bool
+KDPointView< T >::operator==( const KDPointView< T >& other ) const
+{
+    return equals( other );
+}
+
+template< typename T >
+bool
+KDPointView< T >::operator!=( const KDPointView< T >& other ) const
+{
+    return !equals( other );
+}
+
+//============================================================================
+//                  KDPointView PRIMARY INTERFACE
+//============================================================================
+
+template< typename T >
+const T*
+KDPointView< T >::data() const
+{
+    return m_data;
+}
+
+template< typename T >
+size_t
+KDPointView< T >::size() const
+{
+    return m_size;
+}
+
+template< typename T >
+bool
+KDPointView< T >::empty() const
+{
+    return ( 0u == m_size );
+}
+
+template< typename T >
+typename KDPointView< T >::const_iterator
+KDPointView< T >::begin() const
+{
+    return m_data;
+}
+
+template< typename T >
+typename KDPointView< T >::const_iterator
+KDPointView< T >::end() const
+{
+    return m_data + m_size;
+}
+
+template< typename T >
+Types::Point< T >
+KDPointView< T >::toPoint() const
+{
+    return Types::Point< T >( begin(), end() );
+}
+
+//============================================================================
+//                  KDPointView ACCESSORS
+//============================================================================
+
+template< typename T >
+bool
+KDPointView< T >::equals( const KDPointView< T >& other ) const
+{
+    if ( other.size() != m_size )
+    {
+        return false;
+    }
+
+    for ( size_t i = 0; i < m_size; ++i )
+    {
+        if ( other[ i ] != m_data[ i ] )
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+template< typename T >
+std::ostream&
+KDPointView< T >::print( std::ostream& out ) const
+{
+    out << "PointView:[ "
+        << "cardinality = '" << std::dec << m_size << "'";
+
+    if ( m_size )
+    {
+        out << ", pos = ( '" << std::dec << m_data[ 0 ] << "'";
+        for ( size_t i = 1; i < m_size; ++i )
+        {
+            out << ", '" << std::dec << m_data[ i ] << "'";
+        }
+        out << " ) ";
+    }
+
+    out << "]";
+
+    return out;
+}
+
+//============================================================================
+//                  KDPointsView CREATORS
+//============================================================================
+
+template< typename T, typename A >
+KDPointsView< T, A >::KDPointsView()
+: m_points(    nullptr )
+, m_data(      nullptr )
+, m_count(     0u )
+, m_dimension( 0u )
+, m_stride(    0u )
+{
+    // nothing to do here
+}
+
+template< typename T, typename A >
+KDPointsView< T, A >::KDPointsView( const Types::BasicPoints< T, A >& points )
+: m_points(    &points )
+, m_data(      nullptr )
+, m_count(     0u )
+, m_dimension( 0u )
+, m_stride(    0u )
+{
+    // nothing to do here
+}
+
+template< typename T, typename A >
+KDPointsView< T, A >::KDPointsView( const T*     data,
+                                    const size_t count,
+                                    const size_t dimension,
+                                    const size_t stride )
+: m_points(    nullptr )
+, m_data(      data )
+, m_count(     count )
+, m_dimension( dimension )
+, m_stride(    stride )
+{
+    // nothing to do here
+}
+
+//============================================================================
+//                  KDPointsView OPERATORS
+//============================================================================
+
+template< typename T, typename A >
+KDPointView< T >
+KDPointsView< T, A >::operator[]( const size_t index ) const
+{
+    if ( nullptr == m_points )
+    {
+        return KDPointView< T >( m_data + index * m_stride, m_dimension );
+    }
+
+    return KDPointView< T >( ( *m_points )[ index ].data(),
+                             ( *m_points )[ index ].size() );
+}
+
+template< typename T, typename A >
+bool
+KDPointsView< T, A >::operator==( const KDPointsView< T, A >& other ) const
+{
+    return equals( other );
+}
+
+template< typename T, typename A >
+bool
+KDPointsView< T, A >::operator!=( const KDPointsView< T, A >& other ) const
+{
+    return !equals( other );
+}
+
+//============================================================================
+//                  KDPointsView PRIMARY INTERFACE
+//============================================================================
+
+template< typename T, typename A >
+size_t
+KDPointsView< T, A >::size() const
+{
+    return ( nullptr == m_points ) ? m_count : m_points->size();
+}
+
+template< typename T, typename A >
+bool
+KDPointsView< T, A >::empty() const
+{
+    return ( 0u == size() );
+}
+
+template< typename T, typename A >
+bool
+KDPointsView< T, A >::isStrided() const
+{
+    return ( nullptr != m_data );
+}
+
+template< typename T, typename A >
+Types::Points< T >
+KDPointsView< T, A >::toPoints() const
+{
+    Types::Points< T > points;
+    points.reserve( size() );
+
+    for ( size_t i = 0; i < size(); ++i )
+    {
+        points.push_back( ( *this )[ i ].toPoint() );
+    }
+
+    return points;
+}
+
+//============================================================================
+//                  KDPointsView ACCESSORS
+//============================================================================
+
+template< typename T, typename A >
+bool
+KDPointsView< T, A >::equals( const KDPointsView< T, A >& other ) const
+{
+    if ( other.size() != size() )
+    {
+        return false;
+    }
+
+    for ( size_t i = 0; i < size(); ++i )
+    {
+        if ( other[ i ] != ( *this )[ i ] )
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//============================================================================
+//                  INDEPENDENT OPERATORS
+//============================================================================
+template< typename T >
+std::ostream& operator<<( std::ostream& lhs, const KDPointView< T >& rhs )
+{
+    return rhs.print( lhs );
+}
+
+} // close namespace datastructures
+
+#endif // KDTREE_POINT_VIEW_H
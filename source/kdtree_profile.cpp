@@ -0,0 +1,92 @@
+#include "kdtree_profile.h"
+
+#include <chrono>
+
+namespace datastructures {
+
+namespace {
+
+double seconds( const uint64_t nanoseconds )
+    // Returns nanoseconds in seconds
+{
+    return static_cast< double >( nanoseconds ) / 1e9;
+}
+
+} // namespace
+
+//============================================================================
+//                  CREATORS
+//============================================================================
+
+KDBuildProfile::KDBuildProfile()
+: sortNanoseconds( 0u )
+, splitNanoseconds( 0u )
+, partitionNanoseconds( 0u )
+, allocationNanoseconds( 0u )
+, finishNanoseconds( 0u )
+, totalNanoseconds( 0u )
+{
+    // nothing to do here
+}
+
+//============================================================================
+//                  PRIMARY INTERFACE
+//============================================================================
+
+uint64_t
+KDBuildProfile::now()
+{
+    return static_cast< uint64_t >(
+            std::chrono::duration_cast< std::chrono::nanoseconds >(
+                    std::chrono::steady_clock::now().time_since_epoch() )
+                    .count() );
+}
+
+//============================================================================
+//                  ACCESSORS
+//============================================================================
+
+bool
+KDBuildProfile::empty() const
+{
+    return !totalNanoseconds;
+}
+
+std::ostream&
+KDBuildProfile::print( std::ostream& out ) const
+{
+    out << "KDBuildProfile:[ "
+        << "sort = "       << seconds( sortNanoseconds )       << "s, "
+        << "split = "      << seconds( splitNanoseconds )      << "s, "
+        << "partition = "  << seconds( partitionNanoseconds )  << "s, "
+        << "allocation = " << seconds( allocationNanoseconds ) << "s, "
+        << "finish = "     << seconds( finishNanoseconds )     << "s, "
+        << "total = "      << seconds( totalNanoseconds )      << "s ]";
+
+    return out;
+}
+
+std::ostream&
+KDBuildProfile::printJson( std::ostream& out ) const
+{
+    out << "{ "
+        << "\"sort\": "       << seconds( sortNanoseconds )       << ", "
+        << "\"split\": "      << seconds( splitNanoseconds )      << ", "
+        << "\"partition\": "  << seconds( partitionNanoseconds )  << ", "
+        << "\"allocation\": " << seconds( allocationNanoseconds ) << ", "
+        << "\"finish\": "     << seconds( finishNanoseconds )     << ", "
+        << "\"total\": "      << seconds( totalNanoseconds )      << " }";
+
+    return out;
+}
+
+//============================================================================
+//                  INDEPENDENT OPERATORS
+//============================================================================
+
+std::ostream& operator<<( std::ostream& lhs, const KDBuildProfile& rhs )
+{
+    return rhs.print( lhs );
+}
+
+} // namespace datastructures
@@ -0,0 +1,66 @@
+#ifndef KDTREE_PROFILE_H
+#define KDTREE_PROFILE_H
+
+#include <cstdint>
+#include <iostream>
+
+// @Purpose
+//
+// This struct holds the wall time a KDTree build spent in each of its
+// phases, recorded when KDTreeOptions::profileBuild is set.
+//
+// Phases are timed where the builders call them, so nested phases are never
+// counted twice: the time of a split, for instance, excludes the subtrees
+// built below it. Whatever the phases do not cover - recursion, bookkeeping
+// and the clock itself - is the difference between the total and their sum.
+//
+
+namespace datastructures {
+
+struct KDBuildProfile {
+    // CREATORS
+    KDBuildProfile();
+        // Default constructor, all phases take no time
+
+    // PRIMARY INTERFACE
+    static uint64_t now();
+        // Returns a monotonic clock reading in nanoseconds
+
+    // ACCESSORS
+    bool empty() const;
+        // Returns true if no build was profiled
+
+    std::ostream& print( std::ostream& out ) const;
+        // Prints the profile in a easy to read format
+
+    std::ostream& printJson( std::ostream& out ) const;
+        // Prints the profile as a JSON object of seconds per phase
+
+    // DATA
+    uint64_t    sortNanoseconds;
+        // Presorting the points per axis, or encoding and sorting their
+        // Morton codes
+
+    uint64_t    splitNanoseconds;
+        // Choosing the hyperplanes
+
+    uint64_t    partitionNanoseconds;
+        // Splitting the points of every node between its children
+
+    uint64_t    allocationNanoseconds;
+        // Allocating the nodes
+
+    uint64_t    finishNanoseconds;
+        // Reordering and quantizing the points and laying out the nodes once
+        // the structure is complete
+
+    uint64_t    totalNanoseconds;
+        // The whole build
+};
+
+// INDEPENDENT OPERATORS
+std::ostream& operator<<( std::ostream& lhs, const KDBuildProfile& rhs );
+
+} // namespace datastructures
+
+#endif // KDTREE_PROFILE_H
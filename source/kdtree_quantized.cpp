@@ -0,0 +1,5 @@
+#include "kdtree_quantized.h"
+
+namespace datastructures {
+
+} // namespace datastructures
@@ -0,0 +1,389 @@
+#ifndef KDTREE_QUANTIZED_H
+#define KDTREE_QUANTIZED_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+#include "kdtree_types.h"
+#include "kdtree_point_view.h"
+#include "kdtree_options.h"
+#include "kdtree_utils.h"
+
+// @Purpose
+//
+// This class keeps reduced-precision copies of a set of points, used by
+// KDTree to filter search candidates without reading the full-precision
+// points.
+//
+// Two encodings are supported:
+//  - bfloat16: the upper 16 bits of the float representation of every
+//    coordinate, rounded to nearest even
+//  - 8-bit scalar quantization: every coordinate is mapped to one of 256
+//    evenly spaced values spanning the range of its axis, as found by
+//    Utils::minMaxPerAxis()
+//
+// Alongside the codes every point carries an upper bound of the euclidean
+// distance between the point and its decoded copy. By the triangle
+// inequality the distance from any query to the decoded copy, less that
+// bound, never exceeds the distance to the point itself - lowerBound() -
+// which lets the caller skip a point exactly.
+//
+
+namespace datastructures {
+
+template< typename T >
+class KDQuantizedPoints {
+public:
+    // CREATORS
+    KDQuantizedPoints();
+        // Default constructor, holds no points
+
+    template< typename A >
+    KDQuantizedPoints( const KDPointsView< T, A >&         points,
+                       const KDTreeOptions::PointPrecision precision );
+        // Constructor, encodes the provided points. FULL_PRECISION results
+        // in no points being held.
+
+    virtual ~KDQuantizedPoints();
+        // Destructor
+
+    // PRIMARY INTERFACE
+    double approximateDistance( const size_t            index,
+                                const KDPointView< T >& pointOfInterest ) const;
+        // Returns distance between the point of interest and the decoded
+        // copy of the point under index. No bounds checking.
+
+    double lowerBound( const size_t            index,
+                       const KDPointView< T >& pointOfInterest ) const;
+        // Returns a value not greater than the distance between the point
+        // of interest and the point under index. No bounds checking.
+
+    Types::Point< double > decode( const size_t index ) const;
+        // Returns the decoded copy of the point under index. No bounds
+        // checking.
+
+    // ACCESSORS
+    size_t size() const;
+        // Returns number of points held
+
+    bool empty() const;
+        // Returns true if no points are held
+
+    size_t dimension() const;
+        // Returns cardinality of the points held
+
+    KDTreeOptions::PointPrecision precision() const;
+        // Returns encoding of the points held
+
+    double errorBound( const size_t index ) const;
+        // Returns upper bound of the distance between the point under index
+        // and its decoded copy. No bounds checking.
+
+    size_t memoryFootprint() const;
+        // Returns number of bytes held by the codes, ranges and bounds
+
+    std::ostream& print( std::ostream& out ) const;
+        // Prints the KDQuantizedPoints in a easy to read format
+
+private:
+    static uint16_t toBfloat16( const double value );
+        // Returns bfloat16 bits of value, rounded to nearest even
+
+    static double fromBfloat16( const uint16_t bits );
+        // Returns value of bfloat16 bits
+
+    double decode( const size_t index, const size_t axis ) const;
+        // Returns decoded coordinate axis of the point under index
+
+    std::vector< uint16_t >             m_bfloat16Codes;
+        // Codes of all the points with BFLOAT16_PRECISION, point after point
+
+    std::vector< uint8_t >              m_scalarCodes;
+        // Codes of all the points with SCALAR_8_PRECISION, point after point
+
+    std::vector< double >               m_minimums;
+        // Smallest value of every axis with SCALAR_8_PRECISION
+
+    std::vector< double >               m_steps;
+        // Distance between consecutive codes of every axis with
+        // SCALAR_8_PRECISION
+
+    std::vector< float >                m_errorBounds;
+        // Distance bound between every point and its decoded copy
+
+    size_t                              m_dimension;
+        // Cardinality of the points held
+
+    KDTreeOptions::PointPrecision       m_precision;
+        // Encoding of the points held
+};
+
+//============================================================================
+//                  CREATORS
+//============================================================================
+
+template< typename T >
+KDQuantizedPoints< T >::KDQuantizedPoints()
+: m_dimension( 0u )
+, m_precision( KDTreeOptions::FULL_PRECISION )
+{
+    // nothing to do here
+}
+
+template< typename T >
+template< typename A >
+KDQuantizedPoints< T >::KDQuantizedPoints(
+        const KDPointsView< T, A >&         points,
+        const KDTreeOptions::PointPrecision precision )
+: m_dimension( points.empty() ? 0u : points[ 0u ].size() )
+, m_precision( precision )
+{
+    if ( ( KDTreeOptions::FULL_PRECISION == m_precision ) || points.empty() )
+    {
+        m_dimension = 0u;
+        return;
+    }
+
+    if ( KDTreeOptions::SCALAR_8_PRECISION == m_precision )
+    {
+        const Types::AxisMinMax< T > axisMinMax =
+                Utils::minMaxPerAxis( points );
+
+        m_minimums.reserve( m_dimension );
+        m_steps.reserve( m_dimension );
+        for ( size_t axis = 0; axis < m_dimension; ++axis )
+        {
+            const double minimum =
+                    static_cast< double >( axisMinMax[ axis ].first );
+            const double maximum =
+                    static_cast< double >( axisMinMax[ axis ].second );
+
+            m_minimums.push_back( minimum );
+            m_steps.push_back( ( maximum - minimum ) /
+                               std::numeric_limits< uint8_t >::max() );
+        }
+
+        m_scalarCodes.reserve( points.size() * m_dimension );
+    }
+    else
+    {
+        m_bfloat16Codes.reserve( points.size() * m_dimension );
+    }
+
+    m_errorBounds.reserve( points.size() );
+    for ( size_t i = 0; i < points.size(); ++i )
+    {
+        const KDPointView< T > point = points[ i ];
+        for ( size_t axis = 0; axis < m_dimension; ++axis )
+        {
+            const double value = static_cast< double >( point[ axis ] );
+            if ( KDTreeOptions::SCALAR_8_PRECISION == m_precision )
+            {
+                const double code = m_steps[ axis ] > 0.0 ?
+                        std::floor( ( value - m_minimums[ axis ] ) /
+                                    m_steps[ axis ] + 0.5 ) :
+                        0.0;
+                m_scalarCodes.push_back( static_cast< uint8_t >(
+                        std::min( code, static_cast< double >(
+                                std::numeric_limits< uint8_t >::max() ) ) ) );
+            }
+            else
+            {
+                m_bfloat16Codes.push_back( toBfloat16( value ) );
+            }
+        }
+
+        double error2 = 0.0;
+        for ( size_t axis = 0; axis < m_dimension; ++axis )
+        {
+            const double diff = static_cast< double >( point[ axis ] ) -
+                                decode( i, axis );
+            error2 += diff * diff;
+        }
+
+        // Rounded up generously, so that floating point error in
+        // lowerBound() can not make it exceed the true distance
+        const double error = std::sqrt( error2 ) * ( 1.0 + 1e-6 ) + 1e-9;
+        m_errorBounds.push_back( std::nextafter(
+                static_cast< float >( error ),
+                std::numeric_limits< float >::infinity() ) );
+    }
+}
+
+template< typename T >
+KDQuantizedPoints< T >::~KDQuantizedPoints()
+{
+    // nothing to do here
+}
+
+//============================================================================
+//                  PRIMARY INTERFACE
+//============================================================================
+
+template< typename T >
+double
+KDQuantizedPoints< T >::approximateDistance(
+        const size_t            index,
+        const KDPointView< T >& pointOfInterest ) const
+{
+    double dist2 = 0.0;
+    for ( size_t axis = 0; axis < m_dimension; ++axis )
+    {
+        const double diff = static_cast< double >( pointOfInterest[ axis ] ) -
+                            decode( index, axis );
+        dist2 += diff * diff;
+    }
+
+    return std::sqrt( dist2 );
+}
+
+template< typename T >
+double
+KDQuantizedPoints< T >::lowerBound(
+        const size_t            index,
+        const KDPointView< T >& pointOfInterest ) const
+{
+    // Relative slack covers rounding of the distance computations
+    return approximateDistance( index, pointOfInterest ) * ( 1.0 - 1e-12 ) -
+           static_cast< double >( m_errorBounds[ index ] );
+}
+
+template< typename T >
+Types::Point< double >
+KDQuantizedPoints< T >::decode( const size_t index ) const
+{
+    Types::Point< double > point;
+    point.reserve( m_dimension );
+    for ( size_t axis = 0; axis < m_dimension; ++axis )
+    {
+        point.push_back( decode( index, axis ) );
+    }
+
+    return point;
+}
+
+template< typename T >
+uint16_t
+KDQuantizedPoints< T >::toBfloat16( const double value )
+{
+    const float asFloat = static_cast< float >( value );
+
+    uint32_t bits;
+    std::memcpy( &bits, &asFloat, sizeof( bits ) );
+
+    // Keep NaN a NaN, round everything else to nearest even
+    if ( asFloat != asFloat )
+    {
+        return static_cast< uint16_t >( ( bits >> 16 ) | 0x40u );
+    }
+    bits += 0x7FFFu + ( ( bits >> 16 ) & 1u );
+
+    return static_cast< uint16_t >( bits >> 16 );
+}
+
+template< typename T >
+double
+KDQuantizedPoints< T >::fromBfloat16( const uint16_t bits )
+{
+    const uint32_t widened = static_cast< uint32_t >( bits ) << 16;
+
+    float asFloat;
+    std::memcpy( &asFloat, &widened, sizeof( asFloat ) );
+
+    return static_cast< double >( asFloat );
+}
+
+template< typename T >
+double
+KDQuantizedPoints< T >::decode( const size_t index, const size_t axis ) const
+{
+    const size_t offset = index * m_dimension + axis;
+    if ( KDTreeOptions::SCALAR_8_PRECISION == m_precision )
+    {
+        return m_minimums[ axis ] + m_scalarCodes[ offset ] * m_steps[ axis ];
+    }
+
+    return fromBfloat16( m_bfloat16Codes[ offset ] );
+}
+
+//============================================================================
+//                  ACCESSORS
+//============================================================================
+
+template< typename T >
+size_t
+KDQuantizedPoints< T >::size() const
+{
+    return m_errorBounds.size();
+}
+
+template< typename T >
+bool
+KDQuantizedPoints< T >::empty() const
+{
+    return m_errorBounds.empty();
+}
+
+template< typename T >
+size_t
+KDQuantizedPoints< T >::dimension() const
+{
+    return m_dimension;
+}
+
+template< typename T >
+KDTreeOptions::PointPrecision
+KDQuantizedPoints< T >::precision() const
+{
+    return m_precision;
+}
+
+template< typename T >
+double
+KDQuantizedPoints< T >::errorBound( const size_t index ) const
+{
+    return static_cast< double >( m_errorBounds[ index ] );
+}
+
+template< typename T >
+size_t
+KDQuantizedPoints< T >::memoryFootprint() const
+{
+    return m_bfloat16Codes.capacity() * sizeof( uint16_t ) +
+           m_scalarCodes.capacity()   * sizeof( uint8_t )  +
+           m_minimums.capacity()      * sizeof( double )   +
+           m_steps.capacity()         * sizeof( double )   +
+           m_errorBounds.capacity()   * sizeof( float );
+}
+
+template< typename T >
+std::ostream&
+KDQuantizedPoints< T >::print( std::ostream& out ) const
+{
+    out << "KDQuantizedPoints:[ "
+        << "num points = "       << size()      << ", "
+        << "dimension = "        << m_dimension << ", "
+        << "memory footprint = " << memoryFootprint() << " ] ";
+
+    return out;
+}
+
+//============================================================================
+//                  INDEPENDENT OPERATORS
+//============================================================================
+
+template< typename T >
+std::ostream& operator<<( std::ostream&                lhs,
+                          const KDQuantizedPoints< T >& rhs )
+{
+    return rhs.print( lhs );
+}
+
+} // namespace datastructures
+
+#endif // KDTREE_QUANTIZED_H
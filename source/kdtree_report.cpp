@@ -0,0 +1,5 @@
+#include "kdtree_report.h"
+
+namespace datastructures {
+
+} // namespace datastructures
@@ -0,0 +1,600 @@
+#ifndef KDTREE_REPORT_H
+#define KDTREE_REPORT_H
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include "kdtree_types.h"
+#include "kdtree_point_view.h"
+#include "kdtree_profile.h"
+#include "kdtree.h"
+
+// @Purpose
+//
+// This class describes the shape of a built KDTree, for telling a good
+// split policy from a bad one on a given data set:
+//  - how deep the leaves are, against the ceil(log2 n) of a perfectly
+//    balanced tree
+//  - how evenly every split divides the leaves between its sides
+//  - how often every axis is split
+//  - how elongated the cells of the nodes are. Cells start from the
+//    bounding box of the points and every split cuts its cell in two at the
+//    hyperplane; the aspect ratio of a cell is its longest side over its
+//    shortest. Long thin cells make the search visit more of the tree.
+//  - where the build spent its time, if KDTreeOptions::profileBuild was set
+//
+// Every leaf of a KDTree holds a single point, so there are as many leaves
+// as points and the depth of the leaves says all there is to say about
+// their sizes.
+//
+// Every statistic is gathered in a single pass over the nodes. The pass
+// carries the cell of every pending node on a stack of its own rather than
+// the call stack, since the trees worth reporting on are often the
+// degenerate, deep ones.
+//
+
+namespace datastructures {
+
+template< typename T >
+class KDTreeReport {
+public:
+    // CREATORS
+    KDTreeReport();
+        // Default constructor, describes an empty tree
+
+    template< typename I, typename A >
+    explicit KDTreeReport( const KDTree< T, I, A >& tree );
+        // Constructor, describes tree
+
+    // ACCESSORS
+    size_t numPoints() const;
+        // Returns number of points of the tree
+
+    size_t dimension() const;
+        // Returns cardinality of the points
+
+    size_t numNodes() const;
+        // Returns number of splits and leaves
+
+    size_t numLeaves() const;
+        // Returns number of leaves
+
+    const std::vector< size_t >& leafDepths() const;
+        // Returns number of leaves at every depth, the root being at depth 0
+
+    size_t maxDepth() const;
+        // Returns depth of the deepest leaf
+
+    size_t optimalDepth() const;
+        // Returns depth of the deepest leaf of a perfectly balanced tree of
+        // as many leaves, ceil(log2 numLeaves())
+
+    double meanLeafDepth() const;
+        // Returns mean depth of the leaves
+
+    double minBalance() const;
+        // Returns smallest ratio of the leaves on the smaller side of a
+        // split to those on the larger side. 1 for a perfectly balanced
+        // tree, or one without splits.
+
+    double meanBalance() const;
+        // Returns mean of the above over all the splits
+
+    const std::vector< size_t >& axisSplits() const;
+        // Returns number of splits on every axis
+
+    double minAspectRatio() const;
+        // Returns smallest aspect ratio of a cell
+
+    double meanAspectRatio() const;
+        // Returns mean aspect ratio of the cells
+
+    double maxAspectRatio() const;
+        // Returns largest aspect ratio of a cell
+
+    size_t numDegenerateCells() const;
+        // Returns number of cells that are flat on some axis, for which the
+        // aspect ratio is undefined and left out of the above
+
+    const KDBuildProfile& profile() const;
+        // Returns time spent building the tree, see KDTree::buildProfile()
+
+    std::ostream& print( std::ostream& out ) const;
+        // Prints the report in a easy to read format
+
+    std::ostream& printJson( std::ostream& out ) const;
+        // Prints the report as a JSON object, its keys in snake case as
+        // the query and evaluation tools print theirs
+
+private:
+    void addCell( const Types::AxisMinMax< double >& cell );
+        // Accounts for the aspect ratio of cell
+
+    size_t                  m_numPoints;
+        // Number of points of the tree
+
+    size_t                  m_dimension;
+        // Cardinality of the points
+
+    size_t                  m_numNodes;
+        // Number of splits and leaves
+
+    std::vector< size_t >   m_leafDepths;
+        // Number of leaves at every depth
+
+    double                  m_minBalance;
+        // Smallest balance of a split
+
+    double                  m_sumBalance;
+        // Sum of the balances of the splits
+
+    std::vector< size_t >   m_axisSplits;
+        // Number of splits on every axis
+
+    double                  m_minAspectRatio;
+        // Smallest aspect ratio of a cell
+
+    double                  m_maxAspectRatio;
+        // Largest aspect ratio of a cell
+
+    double                  m_sumAspectRatio;
+        // Sum of the aspect ratios of the cells that are not degenerate
+
+    size_t                  m_numDegenerateCells;
+        // Number of cells flat on some axis
+
+    KDBuildProfile          m_profile;
+        // Time spent building the tree
+};
+
+// INDEPENDENT OPERATORS
+template< typename T >
+std::ostream& operator<<( std::ostream& lhs, const KDTreeReport< T >& rhs );
+
+//============================================================================
+//                  CREATORS
+//============================================================================
+
+template< typename T >
+KDTreeReport< T >::KDTreeReport()
+: m_numPoints( 0u )
+, m_dimension( 0u )
+, m_numNodes( 0u )
+, m_minBalance( 1.0 )
+, m_sumBalance( 0.0 )
+, m_minAspectRatio( 0.0 )
+, m_maxAspectRatio( 0.0 )
+, m_sumAspectRatio( 0.0 )
+, m_numDegenerateCells( 0u )
+{
+    // nothing to do here
+}
+
+template< typename T >
+template< typename I, typename A >
+KDTreeReport< T >::KDTreeReport( const KDTree< T, I, A >& tree )
+: m_numPoints( 0u )
+, m_dimension( 0u )
+, m_numNodes( 0u )
+, m_minBalance( 1.0 )
+, m_sumBalance( 0.0 )
+, m_minAspectRatio( 0.0 )
+, m_maxAspectRatio( 0.0 )
+, m_sumAspectRatio( 0.0 )
+, m_numDegenerateCells( 0u )
+, m_profile( tree.buildProfile() )
+{
+    typedef typename KDTree< T, I, A >::Node Node;
+
+    struct Pending {
+        const Node*                 node;
+            // Node to visit
+
+        size_t                      depth;
+            // Depth of the node
+
+        size_t                      parent;
+            // Preorder id of the parent of the node, 0 for the root
+
+        Types::AxisMinMax< double > cell;
+            // Cell of the node
+    };
+
+    const typename KDTree< T, I, A >::PointsView points = tree.pointsView();
+    m_numPoints = points.size();
+    m_dimension = m_numPoints ? points[ 0u ].size() : 0u;
+    m_axisSplits.assign( m_dimension, 0u );
+    if ( !tree.root() )
+    {
+        return;
+    }
+
+    // The root cell is the bounding box of the points
+    Pending root;
+    root.node   = tree.root().get();
+    root.depth  = 0u;
+    root.parent = 0u;
+    for ( size_t axis = 0; axis < m_dimension; ++axis )
+    {
+        root.cell.push_back( std::make_pair(
+                static_cast< double >( points[ 0u ][ axis ] ),
+                static_cast< double >( points[ 0u ][ axis ] ) ) );
+    }
+    for ( size_t i = 1; i < m_numPoints; ++i )
+    {
+        const KDPointView< T > point = points[ i ];
+        for ( size_t axis = 0; axis < m_dimension; ++axis )
+        {
+            const double value = static_cast< double >( point[ axis ] );
+            root.cell[ axis ].first  = std::min( root.cell[ axis ].first,
+                                                 value );
+            root.cell[ axis ].second = std::max( root.cell[ axis ].second,
+                                                 value );
+        }
+    }
+
+    // Preorder, so that every node follows its parent. Leaves are counted
+    // per subtree on the way back, from the last node to the first.
+    std::vector< size_t >  parents;
+    std::vector< size_t >  leaves;
+    std::vector< Pending > pending( 1u, root );
+    while ( !pending.empty() )
+    {
+        Pending current;
+        std::swap( current, pending.back() );
+        pending.pop_back();
+
+        const Node*  node = current.node;
+        const size_t id   = parents.size();
+        parents.push_back( current.parent );
+        leaves.push_back( 0u );
+        addCell( current.cell );
+
+        if ( node->isLeaf() )
+        {
+            if ( current.depth >= m_leafDepths.size() )
+            {
+                m_leafDepths.resize( current.depth + 1u, 0u );
+            }
+            ++m_leafDepths[ current.depth ];
+            leaves[ id ] = 1u;
+            continue;
+        }
+
+        const size_t axis  = node->hyperplane().hyperplaneIndex();
+        const double value = static_cast< double >(
+                                     node->hyperplane().value() );
+        if ( axis < m_dimension )
+        {
+            ++m_axisSplits[ axis ];
+        }
+
+        // Points at the hyperplane go right, see KDTree::partition()
+        if ( node->right() )
+        {
+            Pending right;
+            right.node   = node->right().get();
+            right.depth  = current.depth + 1u;
+            right.parent = id;
+            right.cell   = current.cell;
+            if ( axis < m_dimension )
+            {
+                right.cell[ axis ].first = value;
+            }
+            pending.push_back( Pending() );
+            std::swap( pending.back(), right );
+        }
+        if ( node->left() )
+        {
+            Pending left;
+            left.node   = node->left().get();
+            left.depth  = current.depth + 1u;
+            left.parent = id;
+            std::swap( left.cell, current.cell );
+            if ( axis < m_dimension )
+            {
+                left.cell[ axis ].second = value;
+            }
+            pending.push_back( Pending() );
+            std::swap( pending.back(), left );
+        }
+    }
+    m_numNodes = parents.size();
+
+    // Children of a split follow it, so its leaves are complete by the
+    // time it is reached
+    std::vector< size_t > larger( m_numNodes, 0u );
+    std::vector< size_t > smaller( m_numNodes, 0u );
+    for ( size_t id = m_numNodes; id-- > 1u; )
+    {
+        const size_t parent = parents[ id ];
+        leaves[ parent ] += leaves[ id ];
+        if ( leaves[ id ] > larger[ parent ] )
+        {
+            smaller[ parent ] = larger[ parent ];
+            larger[ parent ]  = leaves[ id ];
+        }
+        else if ( leaves[ id ] > smaller[ parent ] )
+        {
+            smaller[ parent ] = leaves[ id ];
+        }
+    }
+
+    for ( size_t id = 0; id < m_numNodes; ++id )
+    {
+        if ( !larger[ id ] )
+        {
+            continue;
+        }
+
+        const double balance = static_cast< double >( smaller[ id ] ) /
+                               static_cast< double >( larger[ id ] );
+        m_minBalance  = std::min( m_minBalance, balance );
+        m_sumBalance += balance;
+    }
+}
+
+//============================================================================
+//                  ACCESSORS
+//============================================================================
+
+template< typename T >
+size_t
+KDTreeReport< T >::numPoints() const
+{
+    return m_numPoints;
+}
+
+template< typename T >
+size_t
+KDTreeReport< T >::dimension() const
+{
+    return m_dimension;
+}
+
+template< typename T >
+size_t
+KDTreeReport< T >::numNodes() const
+{
+    return m_numNodes;
+}
+
+template< typename T >
+size_t
+KDTreeReport< T >::numLeaves() const
+{
+    size_t count = 0u;
+    for ( size_t depth = 0; depth < m_leafDepths.size(); ++depth )
+    {
+        count += m_leafDepths[ depth ];
+    }
+
+    return count;
+}
+
+template< typename T >
+const std::vector< size_t >&
+KDTreeReport< T >::leafDepths() const
+{
+    return m_leafDepths;
+}
+
+template< typename T >
+size_t
+KDTreeReport< T >::maxDepth() const
+{
+    return m_leafDepths.empty() ? 0u : m_leafDepths.size() - 1u;
+}
+
+template< typename T >
+size_t
+KDTreeReport< T >::optimalDepth() const
+{
+    size_t depth = 0u;
+    for ( size_t capacity = 1u; capacity < numLeaves(); capacity *= 2u )
+    {
+        ++depth;
+    }
+
+    return depth;
+}
+
+template< typename T >
+double
+KDTreeReport< T >::meanLeafDepth() const
+{
+    double sum = 0.0;
+    for ( size_t depth = 0; depth < m_leafDepths.size(); ++depth )
+    {
+        sum += static_cast< double >( depth * m_leafDepths[ depth ] );
+    }
+
+    const size_t count = numLeaves();
+    return count ? sum / static_cast< double >( count ) : 0.0;
+}
+
+template< typename T >
+double
+KDTreeReport< T >::minBalance() const
+{
+    return m_minBalance;
+}
+
+template< typename T >
+double
+KDTreeReport< T >::meanBalance() const
+{
+    const size_t numSplits = m_numNodes - numLeaves();
+    return numSplits ? m_sumBalance / static_cast< double >( numSplits )
+                     : 1.0;
+}
+
+template< typename T >
+const std::vector< size_t >&
+KDTreeReport< T >::axisSplits() const
+{
+    return m_axisSplits;
+}
+
+template< typename T >
+double
+KDTreeReport< T >::minAspectRatio() const
+{
+    return m_minAspectRatio;
+}
+
+template< typename T >
+double
+KDTreeReport< T >::meanAspectRatio() const
+{
+    const size_t count = m_numNodes - m_numDegenerateCells;
+    return count ? m_sumAspectRatio / static_cast< double >( count ) : 0.0;
+}
+
+template< typename T >
+double
+KDTreeReport< T >::maxAspectRatio() const
+{
+    return m_maxAspectRatio;
+}
+
+template< typename T >
+size_t
+KDTreeReport< T >::numDegenerateCells() const
+{
+    return m_numDegenerateCells;
+}
+
+template< typename T >
+const KDBuildProfile&
+KDTreeReport< T >::profile() const
+{
+    return m_profile;
+}
+
+template< typename T >
+std::ostream&
+KDTreeReport< T >::print( std::ostream& out ) const
+{
+    out << "KDTreeReport:[ "
+        << "points = "          << m_numPoints        << ", "
+        << "dimension = "       << m_dimension        << ", "
+        << "nodes = "           << m_numNodes         << ", "
+        << "leaves = "          << numLeaves()        << ", "
+        << "max depth = "       << maxDepth()         << ", "
+        << "optimal depth = "   << optimalDepth()     << ", "
+        << "mean leaf depth = " << meanLeafDepth()    << ", "
+        << "min balance = "     << m_minBalance       << ", "
+        << "mean balance = "    << meanBalance()      << ", "
+        << "axis splits = [";
+    for ( size_t axis = 0; axis < m_axisSplits.size(); ++axis )
+    {
+        out << ( axis ? ", " : " " ) << m_axisSplits[ axis ];
+    }
+    out << " ], "
+        << "aspect ratio = [ "
+        << "min = "  << m_minAspectRatio    << ", "
+        << "mean = " << meanAspectRatio()   << ", "
+        << "max = "  << m_maxAspectRatio    << " ], "
+        << "degenerate cells = " << m_numDegenerateCells << ", "
+        << m_profile << " ]";
+
+    return out;
+}
+
+template< typename T >
+std::ostream&
+KDTreeReport< T >::printJson( std::ostream& out ) const
+{
+    out << "{ "
+        << "\"points\": "    << m_numPoints << ", "
+        << "\"dimension\": " << m_dimension << ", "
+        << "\"nodes\": "     << m_numNodes  << ", "
+        << "\"leaves\": "    << numLeaves() << ", "
+        << "\"depth\": { "
+        << "\"max\": "     << maxDepth()      << ", "
+        << "\"optimal\": " << optimalDepth()  << ", "
+        << "\"mean\": "    << meanLeafDepth() << ", "
+        << "\"leaves_per_depth\": [";
+    for ( size_t depth = 0; depth < m_leafDepths.size(); ++depth )
+    {
+        out << ( depth ? ", " : " " ) << m_leafDepths[ depth ];
+    }
+    out << " ] }, "
+        << "\"balance\": { "
+        << "\"min\": "  << m_minBalance  << ", "
+        << "\"mean\": " << meanBalance() << " }, "
+        << "\"axis_splits\": [";
+    for ( size_t axis = 0; axis < m_axisSplits.size(); ++axis )
+    {
+        out << ( axis ? ", " : " " ) << m_axisSplits[ axis ];
+    }
+    out << " ], "
+        << "\"aspect_ratio\": { "
+        << "\"min\": "  << m_minAspectRatio  << ", "
+        << "\"mean\": " << meanAspectRatio() << ", "
+        << "\"max\": "  << m_maxAspectRatio  << ", "
+        << "\"degenerate_cells\": " << m_numDegenerateCells << " }, "
+        << "\"build_seconds\": ";
+    m_profile.printJson( out );
+    out << " }";
+
+    return out;
+}
+
+//============================================================================
+//                  PRIVATE
+//============================================================================
+
+template< typename T >
+void
+KDTreeReport< T >::addCell( const Types::AxisMinMax< double >& cell )
+{
+    if ( cell.empty() )
+    {
+        ++m_numDegenerateCells;
+        return;
+    }
+
+    double shortest = cell[ 0 ].second - cell[ 0 ].first;
+    double longest  = shortest;
+    for ( size_t axis = 1; axis < cell.size(); ++axis )
+    {
+        const double side = cell[ axis ].second - cell[ axis ].first;
+        shortest = std::min( shortest, side );
+        longest  = std::max( longest,  side );
+    }
+
+    if ( !( shortest > 0.0 ) || !std::isfinite( longest ) )
+    {
+        ++m_numDegenerateCells;
+        return;
+    }
+
+    // Ratios are at least 1, a zero sum means this is the first one
+    const double ratio = longest / shortest;
+    if ( !( m_sumAspectRatio > 0.0 ) )
+    {
+        m_minAspectRatio = ratio;
+        m_maxAspectRatio = ratio;
+    }
+    m_minAspectRatio  = std::min( m_minAspectRatio, ratio );
+    m_maxAspectRatio  = std::max( m_maxAspectRatio, ratio );
+    m_sumAspectRatio += ratio;
+}
+
+//============================================================================
+//                  INDEPENDENT OPERATORS
+//============================================================================
+
+template< typename T >
+std::ostream& operator<<( std::ostream& lhs, const KDTreeReport< T >& rhs )
+{
+    return rhs.print( lhs );
+}
+
+} // namespace datastructures
+
+#endif // KDTREE_REPORT_H
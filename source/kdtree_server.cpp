@@ -0,0 +1,312 @@
+#include "kdtree_server.h"
+
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace datastructures {
+
+//============================================================================
+//                  CREATORS
+//============================================================================
+
+KDWorkerPool::KDWorkerPool( const size_t numWorkers )
+: m_stopping( false )
+{
+    m_workers.reserve( numWorkers );
+    for ( size_t i = 0; i < numWorkers; ++i )
+    {
+        m_workers.push_back( std::thread( &KDWorkerPool::work, this ) );
+    }
+}
+
+KDWorkerPool::~KDWorkerPool()
+{
+    {
+        std::lock_guard< std::mutex > lock( m_mutex );
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+
+    for ( size_t i = 0; i < m_workers.size(); ++i )
+    {
+        m_workers[ i ].join();
+    }
+}
+
+//============================================================================
+//                  PRIMARY INTERFACE
+//============================================================================
+
+bool
+KDQueryProtocol::readFully( const int    descriptor,
+                            void*        buffer,
+                            const size_t size )
+{
+    char* cursor = static_cast< char* >( buffer );
+    size_t remaining = size;
+    while ( remaining )
+    {
+        const ssize_t done = ::read( descriptor, cursor, remaining );
+        if ( done < 0 && EINTR == errno )
+        {
+            continue;
+        }
+
+        if ( done <= 0 )
+        {
+            return false;
+        }
+
+        cursor    += done;
+        remaining -= static_cast< size_t >( done );
+    }
+
+    return true;
+}
+
+bool
+KDQueryProtocol::writeFully( const int    descriptor,
+                             const void*  buffer,
+                             const size_t size )
+{
+    const char* cursor = static_cast< const char* >( buffer );
+    size_t remaining = size;
+    while ( remaining )
+    {
+        // A peer gone away must not raise SIGPIPE on sockets
+        const ssize_t done = ::send( descriptor, cursor, remaining,
+                                     MSG_NOSIGNAL );
+        const ssize_t written = done < 0 && ENOTSOCK == errno ?
+                                ::write( descriptor, cursor, remaining ) :
+                                done;
+        if ( written < 0 && EINTR == errno )
+        {
+            continue;
+        }
+
+        if ( written <= 0 )
+        {
+            return false;
+        }
+
+        cursor    += written;
+        remaining -= static_cast< size_t >( written );
+    }
+
+    return true;
+}
+
+int
+KDQueryProtocol::listen( const std::string& socketPath )
+{
+    sockaddr_un address;
+    std::memset( &address, 0, sizeof( address ) );
+    if ( socketPath.empty() ||
+         ( socketPath.size() >= sizeof( address.sun_path ) ) )
+    {
+        return -1;
+    }
+    address.sun_family = AF_UNIX;
+    std::memcpy( address.sun_path, socketPath.data(), socketPath.size() );
+
+    // Only a socket left behind by a server that did not stop cleanly is
+    // replaced, never a live server's socket or any other file
+    struct stat status;
+    if ( 0 == ::lstat( socketPath.c_str(), &status ) )
+    {
+        if ( !S_ISSOCK( status.st_mode ) )
+        {
+            std::cerr << "KDQueryProtocol::listen() will not replace "
+                      << "'" << socketPath << "', which is not a socket"
+                      << std::endl;
+            return -1;
+        }
+
+        const int live = connect( socketPath );
+        if ( live >= 0 )
+        {
+            close( live );
+            std::cerr << "KDQueryProtocol::listen() found a server "
+                      << "already listening on '" << socketPath << "'"
+                      << std::endl;
+            return -1;
+        }
+
+        ::unlink( socketPath.c_str() );
+    }
+
+    const int descriptor = ::socket( AF_UNIX, SOCK_STREAM, 0 );
+    if ( descriptor < 0 )
+    {
+        return -1;
+    }
+
+    if ( ::bind( descriptor, reinterpret_cast< sockaddr* >( &address ),
+                 sizeof( address ) ) ||
+         ::listen( descriptor, SOMAXCONN ) )
+    {
+        ::close( descriptor );
+        return -1;
+    }
+
+    return descriptor;
+}
+
+int
+KDQueryProtocol::accept( const int listener )
+{
+    while ( true )
+    {
+        const int descriptor = ::accept( listener, nullptr, nullptr );
+        if ( descriptor >= 0 || EINTR != errno )
+        {
+            return descriptor;
+        }
+    }
+}
+
+int
+KDQueryProtocol::connect( const std::string& socketPath )
+{
+    sockaddr_un address;
+    std::memset( &address, 0, sizeof( address ) );
+    if ( socketPath.empty() ||
+         ( socketPath.size() >= sizeof( address.sun_path ) ) )
+    {
+        return -1;
+    }
+    address.sun_family = AF_UNIX;
+    std::memcpy( address.sun_path, socketPath.data(), socketPath.size() );
+
+    const int descriptor = ::socket( AF_UNIX, SOCK_STREAM, 0 );
+    if ( descriptor < 0 )
+    {
+        return -1;
+    }
+
+    if ( ::connect( descriptor, reinterpret_cast< sockaddr* >( &address ),
+                    sizeof( address ) ) )
+    {
+        ::close( descriptor );
+        return -1;
+    }
+
+    return descriptor;
+}
+
+void
+KDQueryProtocol::close( const int descriptor )
+{
+    if ( descriptor >= 0 )
+    {
+        ::close( descriptor );
+    }
+}
+
+void
+KDQueryProtocol::shutdown( const int descriptor )
+{
+    if ( descriptor >= 0 )
+    {
+        ::shutdown( descriptor, SHUT_RDWR );
+    }
+}
+
+void
+KDWorkerPool::parallel(
+        const size_t                                 numTasks,
+        const std::function< void( const size_t ) >& function )
+{
+    if ( !numTasks )
+    {
+        return;
+    }
+
+    Job job;
+    job.function  = &function;
+    job.numTasks  = numTasks;
+    job.nextTask  = 0u;
+    job.remaining = numTasks;
+
+    std::unique_lock< std::mutex > lock( m_mutex );
+    if ( numTasks > 1u && !m_workers.empty() )
+    {
+        m_jobs.push_back( &job );
+        m_wake.notify_all();
+    }
+
+    // The caller works on its own job rather than waiting idle
+    while ( runTask( lock, job ) )
+    {
+        // nothing to do here
+    }
+
+    m_done.wait( lock, [ & ]() { return !job.remaining; } );
+}
+
+bool
+KDWorkerPool::runTask( std::unique_lock< std::mutex >& lock, Job& job )
+{
+    if ( job.nextTask == job.numTasks )
+    {
+        return false;
+    }
+
+    const size_t task = job.nextTask++;
+    if ( job.nextTask == job.numTasks )
+    {
+        // Fully handed out, no worker is to pick it up again
+        const std::deque< Job* >::iterator it =
+                std::find( m_jobs.begin(), m_jobs.end(), &job );
+        if ( it != m_jobs.end() )
+        {
+            m_jobs.erase( it );
+        }
+    }
+
+    lock.unlock();
+    ( *job.function )( task );
+    lock.lock();
+
+    if ( !--job.remaining )
+    {
+        m_done.notify_all();
+    }
+
+    return true;
+}
+
+void
+KDWorkerPool::work()
+{
+    std::unique_lock< std::mutex > lock( m_mutex );
+    while ( true )
+    {
+        m_wake.wait( lock,
+                     [ & ]() { return m_stopping || !m_jobs.empty(); } );
+        if ( m_jobs.empty() )
+        {
+            return;
+        }
+
+        runTask( lock, *m_jobs.front() );
+    }
+}
+
+//============================================================================
+//                  ACCESSORS
+//============================================================================
+
+size_t
+KDWorkerPool::numWorkers() const
+{
+    return m_workers.size();
+}
+
+} // namespace datastructures
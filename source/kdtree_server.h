@@ -0,0 +1,759 @@
+#ifndef KDTREE_SERVER_H
+#define KDTREE_SERVER_H
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "kdtree_types.h"
+#include "kdtree_point_view.h"
+#include "kdtree_utils.h"
+#include "kdtree_constants.h"
+#include "kdtree.h"
+
+// @Purpose
+//
+// This component keeps a loaded KDTree answering batches of nearest point
+// queries, so that callers pay for deserialization once rather than once
+// per batch.
+//
+// Requests and responses are framed in binary, in host byte order:
+//
+//   request  - RequestHeader, then count * dimension coordinates of type T
+//   response - ResponseHeader, then count uint64_t input order indexes,
+//              then count double distances if WITH_DISTANCES was requested
+//
+// A connection carries any number of requests, answered in order. A
+// request the server cannot answer gets a response with an error status and
+// no payload, after which the server closes the connection, since it can
+// no longer tell where the next request starts.
+//
+// KDQueryServer serves either a pair of descriptors, such as stdin and
+// stdout, or every connection to a Unix domain socket, each on its own
+// thread. The queries of a batch are spread over a pool of workers kept
+// for the lifetime of the server. KDQueryClient is the matching client.
+//
+
+namespace datastructures {
+
+struct KDQueryProtocol {
+    // TYPES
+    enum Flags {
+        WITH_DISTANCES = 1u
+            // Response carries distances after the indexes
+    };
+
+    enum Status {
+        OK,
+            // Payload follows
+
+        DIMENSION_MISMATCH,
+            // Points of the request differ in cardinality from the tree,
+            // or the tree is empty and the request is not
+
+        VALUE_SIZE_MISMATCH,
+            // Coordinates of the request differ in size from the tree's
+
+        BATCH_TOO_LARGE,
+            // More than KDTREE_QUERY_MAX_BATCH points or
+            // KDTREE_QUERY_MAX_VALUES coordinates, or malformed header
+
+        INVALID_POINTS
+            // Some points of the request could not be answered
+    };
+
+    struct RequestHeader {
+        uint32_t    magic;
+            // KDTREE_QUERY_MAGIC
+
+        uint32_t    flags;
+            // Combination of Flags
+
+        uint32_t    valueSize;
+            // Size of a coordinate in bytes
+
+        uint32_t    dimension;
+            // Number of coordinates of every point
+
+        uint64_t    count;
+            // Number of points
+    };
+
+    struct ResponseHeader {
+        uint32_t    magic;
+            // KDTREE_QUERY_MAGIC
+
+        uint32_t    status;
+            // One of Status
+
+        uint64_t    count;
+            // Number of answers
+    };
+
+    // PRIMARY INTERFACE
+    static bool readFully( const int descriptor,
+                           void*     buffer,
+                           const size_t size );
+        // Reads exactly size bytes into buffer. Returns false at the end of
+        // input or on an error.
+
+    static bool writeFully( const int    descriptor,
+                            const void*  buffer,
+                            const size_t size );
+        // Writes exactly size bytes of buffer. Returns false on an error.
+
+    static int listen( const std::string& socketPath );
+        // Binds a Unix domain socket to socketPath, replacing a socket no
+        // server listens on any more, and listens on it. Returns its
+        // descriptor, -1 on an error or if socketPath is another file or
+        // a live server's socket.
+
+    static int accept( const int listener );
+        // Accepts a connection to the listening socket. Returns its
+        // descriptor, -1 on an error or once the socket is shut down.
+
+    static int connect( const std::string& socketPath );
+        // Connects to the Unix domain socket at socketPath. Returns its
+        // descriptor, -1 on an error.
+
+    static void close( const int descriptor );
+        // Closes the descriptor
+
+    static void shutdown( const int descriptor );
+        // Stops both directions of the socket, waking up any thread
+        // blocked on it
+};
+
+class KDWorkerPool {
+public:
+    // CREATORS
+    explicit KDWorkerPool( const size_t numWorkers );
+        // Constructor, starts numWorkers threads. With none, the calling
+        // thread runs all the tasks itself.
+
+    ~KDWorkerPool();
+        // Destructor, stops the threads once they are idle
+
+    // PRIMARY INTERFACE
+    void parallel( const size_t                                 numTasks,
+                   const std::function< void( const size_t ) >& function );
+        // Calls function( task ) for every task of [0, numTasks) on the
+        // workers and the calling thread, returning once all are done.
+        // May be called from several threads at once.
+
+    // ACCESSORS
+    size_t numWorkers() const;
+        // Returns number of threads of the pool, the callers aside
+
+private:
+    // TYPES
+    struct Job {
+        const std::function< void( const size_t ) >* function;
+        size_t  numTasks;
+        size_t  nextTask;
+        size_t  remaining;
+    };
+
+    // NOT IMPLEMENTED
+    KDWorkerPool( const KDWorkerPool& );
+    KDWorkerPool& operator=( const KDWorkerPool& );
+
+    bool runTask( std::unique_lock< std::mutex >& lock, Job& job );
+        // Runs the next task of job, if any, unlocking around the call.
+        // Returns false if all tasks of job were handed out already.
+
+    void work();
+        // Worker thread body
+
+    std::vector< std::thread >  m_workers;
+        // Threads of the pool
+
+    std::deque< Job* >          m_jobs;
+        // Jobs with tasks not yet handed out, oldest first
+
+    std::mutex                  m_mutex;
+        // Guards m_jobs, m_stopping and the jobs themselves
+
+    std::condition_variable     m_wake;
+        // Signalled on new jobs and on stopping
+
+    std::condition_variable     m_done;
+        // Signalled when a job is complete
+
+    bool                        m_stopping;
+        // Whether the workers are to exit
+};
+
+template< typename T >
+class KDQueryServer {
+public:
+    // CREATORS
+    KDQueryServer( const KDTree< T >& tree, const size_t numWorkers = 0u );
+        // Constructor, answers queries against tree, which must outlive
+        // the server, on a pool of numWorkers threads, 0 for all hardware
+        // threads
+
+    ~KDQueryServer();
+        // Destructor, calls stop()
+
+    // PRIMARY INTERFACE
+    bool serve( const int inDescriptor, const int outDescriptor );
+        // Answers requests read from inDescriptor on outDescriptor until
+        // the end of input. Returns true if the input ended between
+        // requests and false on a malformed request or an error.
+
+    bool listen( const std::string& socketPath );
+        // Binds the server to a Unix domain socket at socketPath.
+        // Returns true on success and false otherwise.
+
+    void run();
+        // Accepts connections to the socket bound by listen() and serves
+        // each on its own detached thread, until stop() is called. Returns
+        // once all the connections are closed.
+
+    void stop();
+        // Makes run() return, closing the connections being served. May be
+        // called from any thread.
+
+    // ACCESSORS
+    size_t numWorkers() const;
+        // Returns number of threads answering queries
+
+    uint64_t numBatches() const;
+        // Returns number of requests answered so far
+
+    uint64_t numQueries() const;
+        // Returns number of points answered so far
+
+    std::ostream& print( std::ostream& out ) const;
+        // Prints the server in a easy to read format
+
+private:
+    // NOT IMPLEMENTED
+    KDQueryServer( const KDQueryServer& );
+    KDQueryServer& operator=( const KDQueryServer& );
+
+    void answer( const std::vector< T >&  points,
+                 const size_t             dimension,
+                 std::vector< uint64_t >& indexes,
+                 std::vector< double >*   distances );
+        // Fills indexes and, if provided, distances of the nearest stored
+        // points of points on the worker pool
+
+    void serveConnection( const int descriptor );
+        // Thread body serving a connection, closes it when done
+
+    const KDTree< T >&  m_tree;
+        // Tree answering the queries
+
+    size_t              m_dimension;
+        // Cardinality of the stored points, 0 for an empty tree
+
+    KDWorkerPool        m_pool;
+        // Workers answering the queries
+
+    int                 m_listener;
+        // Descriptor of the listening socket, -1 if none
+
+    std::string         m_socketPath;
+        // Path of the listening socket, removed by stop()
+
+    mutable std::mutex  m_mutex;
+        // Guards the members below
+
+    std::set< int >     m_connections;
+        // Descriptors of the connections being served
+
+    std::condition_variable m_closed;
+        // Signalled whenever a connection is closed
+
+    bool                m_stopping;
+        // Whether stop() was called
+
+    uint64_t            m_numBatches;
+        // Number of requests answered so far
+
+    uint64_t            m_numQueries;
+        // Number of points answered so far
+};
+
+template< typename T >
+class KDQueryClient {
+public:
+    // CREATORS
+    KDQueryClient();
+        // Default constructor, not connected
+
+    ~KDQueryClient();
+        // Destructor, closes a connection made by connect()
+
+    // PRIMARY INTERFACE
+    bool connect( const std::string& socketPath );
+        // Connects to a server listening at socketPath.
+        // Returns true on success and false otherwise.
+
+    void attach( const int inDescriptor, const int outDescriptor );
+        // Talks to a server reading requests from outDescriptor and
+        // writing responses to inDescriptor, e.g. over pipes. The
+        // descriptors remain owned by the caller.
+
+    KDQueryProtocol::Status query( const T*                 points,
+                                   const size_t             count,
+                                   const size_t             dimension,
+                                   std::vector< uint64_t >& indexes,
+                                   std::vector< double >*   distances =
+                                                                nullptr );
+        // Sends count points of the provided dimension, point i starting
+        // at points + i * dimension, and fills indexes and, if provided,
+        // distances with the answers. Returns the status of the response,
+        // or BATCH_TOO_LARGE if no valid response arrived.
+
+private:
+    // NOT IMPLEMENTED
+    KDQueryClient( const KDQueryClient& );
+    KDQueryClient& operator=( const KDQueryClient& );
+
+    int     m_in;
+        // Descriptor responses are read from, -1 if none
+
+    int     m_out;
+        // Descriptor requests are written to, -1 if none
+
+    bool    m_owned;
+        // Whether the descriptors were opened by connect()
+};
+
+// INDEPENDENT OPERATORS
+template< typename T >
+std::ostream& operator<<( std::ostream& lhs, const KDQueryServer< T >& rhs );
+
+//============================================================================
+//                  CREATORS
+//============================================================================
+
+template< typename T >
+KDQueryServer< T >::KDQueryServer( const KDTree< T >& tree,
+                                   const size_t       numWorkers )
+: m_tree( tree )
+, m_dimension( tree.pointsView().empty() ? 0u : tree.pointAt( 0u ).size() )
+, m_pool( ( numWorkers ?
+            numWorkers :
+            std::max< size_t >( 1u, std::thread::hardware_concurrency() ) ) -
+          1u )
+, m_listener( -1 )
+, m_stopping( false )
+, m_numBatches( 0u )
+, m_numQueries( 0u )
+{
+    // nothing to do here
+}
+
+template< typename T >
+KDQueryServer< T >::~KDQueryServer()
+{
+    stop();
+}
+
+template< typename T >
+KDQueryClient< T >::KDQueryClient()
+: m_in( -1 )
+, m_out( -1 )
+, m_owned( false )
+{
+    // nothing to do here
+}
+
+template< typename T >
+KDQueryClient< T >::~KDQueryClient()
+{
+    if ( m_owned )
+    {
+        KDQueryProtocol::close( m_in );
+    }
+}
+
+//============================================================================
+//                  PRIMARY INTERFACE
+//============================================================================
+
+template< typename T >
+bool
+KDQueryServer< T >::serve( const int inDescriptor, const int outDescriptor )
+{
+    std::vector< T >        points;
+    std::vector< uint64_t > indexes;
+    std::vector< double >   distances;
+
+    while ( true )
+    {
+        KDQueryProtocol::RequestHeader request;
+        if ( !KDQueryProtocol::readFully( inDescriptor, &request,
+                                          sizeof( request ) ) )
+        {
+            // The end of input between requests is the normal way out
+            return true;
+        }
+
+        KDQueryProtocol::ResponseHeader response;
+        response.magic  = Constants::KDTREE_QUERY_MAGIC;
+        response.status = KDQueryProtocol::OK;
+        response.count  = 0u;
+
+        if ( ( Constants::KDTREE_QUERY_MAGIC != request.magic ) ||
+             ( request.count > Constants::KDTREE_QUERY_MAX_BATCH ) ||
+             ( request.count * request.dimension >
+               Constants::KDTREE_QUERY_MAX_VALUES ) ||
+             ( request.count && !request.dimension ) )
+        {
+            response.status = KDQueryProtocol::BATCH_TOO_LARGE;
+        }
+        else if ( sizeof( T ) != request.valueSize )
+        {
+            response.status = KDQueryProtocol::VALUE_SIZE_MISMATCH;
+        }
+        else if ( m_dimension != request.dimension )
+        {
+            response.status = KDQueryProtocol::DIMENSION_MISMATCH;
+        }
+
+        if ( KDQueryProtocol::OK != response.status )
+        {
+            KDQueryProtocol::writeFully( outDescriptor, &response,
+                                         sizeof( response ) );
+            return false;
+        }
+
+        const size_t count     = static_cast< size_t >( request.count );
+        const size_t dimension = request.dimension;
+        points.resize( count * dimension );
+        if ( !points.empty() &&
+             !KDQueryProtocol::readFully( inDescriptor, &points[ 0 ],
+                                          points.size() * sizeof( T ) ) )
+        {
+            return false;
+        }
+
+        const bool withDistances =
+                request.flags & KDQueryProtocol::WITH_DISTANCES;
+        answer( points, dimension, indexes,
+                withDistances ? &distances : nullptr );
+
+        // Empty trees have no answers
+        response.count = count;
+        if ( count && ( Constants::KDTREE_ERROR_INDEX ==
+                        static_cast< size_t >( indexes[ 0 ] ) ) )
+        {
+            response.status = KDQueryProtocol::INVALID_POINTS;
+        }
+
+        {
+            std::lock_guard< std::mutex > lock( m_mutex );
+            ++m_numBatches;
+            m_numQueries += count;
+        }
+
+        if ( !KDQueryProtocol::writeFully( outDescriptor, &response,
+                                           sizeof( response ) ) ||
+             ( count &&
+               !KDQueryProtocol::writeFully( outDescriptor, &indexes[ 0 ],
+                                             count * sizeof( uint64_t ) ) ) ||
+             ( count && withDistances &&
+               !KDQueryProtocol::writeFully( outDescriptor, &distances[ 0 ],
+                                             count * sizeof( double ) ) ) )
+        {
+            return false;
+        }
+    }
+}
+
+template< typename T >
+bool
+KDQueryServer< T >::listen( const std::string& socketPath )
+{
+    std::lock_guard< std::mutex > lock( m_mutex );
+    if ( m_listener >= 0 )
+    {
+        return false;
+    }
+
+    m_listener = KDQueryProtocol::listen( socketPath );
+    if ( m_listener < 0 )
+    {
+        std::cerr << "KDQueryServer::listen() is unable to listen on "
+                  << "'" << socketPath << "'"
+                  << std::endl;
+        return false;
+    }
+
+    m_socketPath = socketPath;
+    m_stopping   = false;
+    return true;
+}
+
+template< typename T >
+void
+KDQueryServer< T >::run()
+{
+    while ( true )
+    {
+        int listener;
+        {
+            std::lock_guard< std::mutex > lock( m_mutex );
+            listener = m_stopping ? -1 : m_listener;
+        }
+
+        const int connection = listener < 0 ? -1 :
+                               KDQueryProtocol::accept( listener );
+        {
+            std::lock_guard< std::mutex > lock( m_mutex );
+            if ( m_stopping || ( listener < 0 ) )
+            {
+                if ( connection >= 0 )
+                {
+                    KDQueryProtocol::close( connection );
+                }
+                break;
+            }
+
+            if ( connection < 0 )
+            {
+                continue;
+            }
+            m_connections.insert( connection );
+        }
+
+        // Each connection removes itself from m_connections when done, so
+        // no thread outlives it
+        std::thread( &KDQueryServer::serveConnection,
+                     this, connection ).detach();
+    }
+
+    std::unique_lock< std::mutex > lock( m_mutex );
+    while ( !m_connections.empty() )
+    {
+        m_closed.wait( lock );
+    }
+}
+
+template< typename T >
+void
+KDQueryServer< T >::stop()
+{
+    std::lock_guard< std::mutex > lock( m_mutex );
+    m_stopping = true;
+
+    if ( m_listener >= 0 )
+    {
+        KDQueryProtocol::shutdown( m_listener );
+        KDQueryProtocol::close( m_listener );
+        std::remove( m_socketPath.c_str() );
+        m_listener = -1;
+    }
+
+    for ( std::set< int >::const_iterator it = m_connections.begin();
+          it != m_connections.end(); ++it )
+    {
+        KDQueryProtocol::shutdown( *it );
+    }
+}
+
+template< typename T >
+void
+KDQueryServer< T >::answer( const std::vector< T >&  points,
+                            const size_t             dimension,
+                            std::vector< uint64_t >& indexes,
+                            std::vector< double >*   distances )
+{
+    const size_t count = dimension ? points.size() / dimension : 0u;
+    indexes.resize( count );
+    if ( distances )
+    {
+        distances->resize( count );
+    }
+
+    // Batches are split into tasks small enough to balance the workers
+    const size_t grain    = Constants::KDTREE_QUERY_TASK_SIZE;
+    const size_t numTasks = ( count + grain - 1u ) / grain;
+    m_pool.parallel( numTasks, [ & ]( const size_t task )
+    {
+        const size_t end = std::min( count, ( task + 1u ) * grain );
+        for ( size_t i = task * grain; i < end; ++i )
+        {
+            const T* point = &points[ i * dimension ];
+            const size_t index = m_tree.nearestPointIndex( point, dimension );
+            indexes[ i ] = index;
+
+            if ( distances )
+            {
+                ( *distances )[ i ] =
+                        Constants::KDTREE_ERROR_INDEX == index ?
+                        std::numeric_limits< double >::infinity() :
+                        Utils::distance( KDPointView< T >( point, dimension ),
+                                         m_tree.pointAt( index ) );
+            }
+        }
+    } );
+}
+
+template< typename T >
+void
+KDQueryServer< T >::serveConnection( const int descriptor )
+{
+    serve( descriptor, descriptor );
+
+    // Notified under the lock, since run() may return, and the server be
+    // destroyed, as soon as it is released
+    std::lock_guard< std::mutex > lock( m_mutex );
+    m_connections.erase( descriptor );
+    KDQueryProtocol::close( descriptor );
+    m_closed.notify_all();
+}
+
+template< typename T >
+bool
+KDQueryClient< T >::connect( const std::string& socketPath )
+{
+    if ( m_owned )
+    {
+        KDQueryProtocol::close( m_in );
+    }
+
+    m_in    = KDQueryProtocol::connect( socketPath );
+    m_out   = m_in;
+    m_owned = m_in >= 0;
+
+    return m_owned;
+}
+
+template< typename T >
+void
+KDQueryClient< T >::attach( const int inDescriptor, const int outDescriptor )
+{
+    if ( m_owned )
+    {
+        KDQueryProtocol::close( m_in );
+    }
+
+    m_in    = inDescriptor;
+    m_out   = outDescriptor;
+    m_owned = false;
+}
+
+template< typename T >
+KDQueryProtocol::Status
+KDQueryClient< T >::query( const T*                 points,
+                           const size_t             count,
+                           const size_t             dimension,
+                           std::vector< uint64_t >& indexes,
+                           std::vector< double >*   distances )
+{
+    KDQueryProtocol::RequestHeader request;
+    request.magic     = Constants::KDTREE_QUERY_MAGIC;
+    request.flags     = distances ? KDQueryProtocol::WITH_DISTANCES : 0u;
+    request.valueSize = sizeof( T );
+    request.dimension = static_cast< uint32_t >( dimension );
+    request.count     = count;
+
+    // A server refusing the request may close the connection before all
+    // of it is written, yet its response is still there to read
+    if ( KDQueryProtocol::writeFully( m_out, &request, sizeof( request ) ) &&
+         count && dimension )
+    {
+        KDQueryProtocol::writeFully( m_out, points,
+                                     count * dimension * sizeof( T ) );
+    }
+
+    KDQueryProtocol::ResponseHeader response;
+    if ( !KDQueryProtocol::readFully( m_in, &response, sizeof( response ) ) ||
+         ( Constants::KDTREE_QUERY_MAGIC != response.magic ) ||
+         ( response.count && ( response.count != count ) ) )
+    {
+        return KDQueryProtocol::BATCH_TOO_LARGE;
+    }
+
+    indexes.resize( static_cast< size_t >( response.count ) );
+    if ( !indexes.empty() &&
+         !KDQueryProtocol::readFully( m_in, &indexes[ 0 ],
+                                      indexes.size() * sizeof( uint64_t ) ) )
+    {
+        return KDQueryProtocol::BATCH_TOO_LARGE;
+    }
+
+    if ( distances )
+    {
+        distances->resize( indexes.size() );
+        if ( !distances->empty() &&
+             !KDQueryProtocol::readFully( m_in, &( *distances )[ 0 ],
+                                          distances->size() *
+                                                  sizeof( double ) ) )
+        {
+            return KDQueryProtocol::BATCH_TOO_LARGE;
+        }
+    }
+
+    return static_cast< KDQueryProtocol::Status >( response.status );
+}
+
+//============================================================================
+//                  ACCESSORS
+//============================================================================
+
+template< typename T >
+size_t
+KDQueryServer< T >::numWorkers() const
+{
+    return m_pool.numWorkers() + 1u;
+}
+
+template< typename T >
+uint64_t
+KDQueryServer< T >::numBatches() const
+{
+    std::lock_guard< std::mutex > lock( m_mutex );
+    return m_numBatches;
+}
+
+template< typename T >
+uint64_t
+KDQueryServer< T >::numQueries() const
+{
+    std::lock_guard< std::mutex > lock( m_mutex );
+    return m_numQueries;
+}
+
+template< typename T >
+std::ostream&
+KDQueryServer< T >::print( std::ostream& out ) const
+{
+    out << "KDQueryServer:[ "
+        << "workers = "   << numWorkers() << ", "
+        << "dimension = " << m_dimension  << ", "
+        << "batches = "   << numBatches() << ", "
+        << "queries = "   << numQueries() << " ]";
+
+    return out;
+}
+
+//============================================================================
+//                  INDEPENDENT OPERATORS
+//============================================================================
+
+template< typename T >
+std::ostream& operator<<( std::ostream& lhs, const KDQueryServer< T >& rhs )
+{
+    return rhs.print( lhs );
+}
+
+} // namespace datastructures
+
+#endif // KDTREE_SERVER_H
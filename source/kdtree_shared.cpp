@@ -0,0 +1,149 @@
+#include "kdtree_shared.h"
+
+#include <cstdio>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace datastructures {
+
+//============================================================================
+//                  CREATORS
+//============================================================================
+
+KDSharedSegment::KDSharedSegment()
+: m_data( nullptr )
+, m_size( 0u )
+{
+    // nothing to do here
+}
+
+KDSharedSegment::~KDSharedSegment()
+{
+    close();
+}
+
+//============================================================================
+//                  PRIMARY INTERFACE
+//============================================================================
+
+bool
+KDSharedSegment::create( const std::string& name,
+                         const Location     location,
+                         const size_t       size )
+{
+    close();
+
+    // A fresh object rather than a truncated one, so that processes still
+    // mapping the old one are not cut short
+    remove( name, location );
+    const int descriptor = openDescriptor( name, location,
+                                           O_RDWR | O_CREAT | O_EXCL );
+    if ( descriptor < 0 )
+    {
+        return false;
+    }
+
+    void* data = MAP_FAILED;
+    if ( size && !::ftruncate( descriptor, static_cast< off_t >( size ) ) )
+    {
+        data = ::mmap( nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                       descriptor, 0 );
+    }
+    ::close( descriptor );
+
+    if ( MAP_FAILED == data )
+    {
+        remove( name, location );
+        return false;
+    }
+
+    m_data = data;
+    m_size = size;
+    return true;
+}
+
+bool
+KDSharedSegment::open( const std::string& name, const Location location )
+{
+    close();
+
+    const int descriptor = openDescriptor( name, location, O_RDONLY );
+    if ( descriptor < 0 )
+    {
+        return false;
+    }
+
+    // The mapping outlives the descriptor
+    struct stat status;
+    void* data = MAP_FAILED;
+    if ( !::fstat( descriptor, &status ) && ( status.st_size > 0 ) )
+    {
+        data = ::mmap( nullptr, static_cast< size_t >( status.st_size ),
+                       PROT_READ, MAP_SHARED, descriptor, 0 );
+    }
+    ::close( descriptor );
+
+    if ( MAP_FAILED == data )
+    {
+        return false;
+    }
+
+    m_data = data;
+    m_size = static_cast< size_t >( status.st_size );
+    return true;
+}
+
+void
+KDSharedSegment::close()
+{
+    if ( m_data )
+    {
+        ::munmap( m_data, m_size );
+    }
+
+    m_data = nullptr;
+    m_size = 0u;
+}
+
+bool
+KDSharedSegment::remove( const std::string& name, const Location location )
+{
+    return SHARED_MEMORY == location ? !::shm_unlink( name.c_str() ) :
+                                       !std::remove( name.c_str() );
+}
+
+int
+KDSharedSegment::openDescriptor( const std::string& name,
+                                 const Location     location,
+                                 const int          flags )
+{
+    return SHARED_MEMORY == location ? ::shm_open( name.c_str(), flags, 0644 )
+                                     : ::open( name.c_str(), flags, 0644 );
+}
+
+//============================================================================
+//                  ACCESSORS
+//============================================================================
+
+bool
+KDSharedSegment::isOpen() const
+{
+    return nullptr != m_data;
+}
+
+char*
+KDSharedSegment::data() const
+{
+    return static_cast< char* >( m_data );
+}
+
+size_t
+KDSharedSegment::size() const
+{
+    return m_size;
+}
+
+} // namespace datastructures
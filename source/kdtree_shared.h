@@ -0,0 +1,715 @@
+#ifndef KDTREE_SHARED_H
+#define KDTREE_SHARED_H
+
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "kdtree_types.h"
+#include "kdtree_point_view.h"
+#include "kdtree_hyperplane.h"
+#include "kdtree_utils.h"
+#include "kdtree_constants.h"
+#include "kdtree.h"
+#include "kdtree_flat.h"
+
+// @Purpose
+//
+// This class lets several processes on one host query a single copy of a
+// KDTree, rather than each of them holding its own.
+//
+// write() flattens a built KDTree into a segment - a named POSIX shared
+// memory object or a file - holding nothing but offsets, so that it is
+// valid wherever it is mapped:
+//  - the header, led by KDTREE_SHARED_MAGIC
+//  - the nodes in preorder. The left child of a split is the node right
+//    after it, so a split records only its axis, value and right child;
+//    a leaf records the slot of its point.
+//  - the coordinates of the points, one slot per leaf, left to right
+//  - the input order index of every slot, and the slot of every input
+//    order index
+//
+// Sections start on cache line boundaries. Every process open()s the
+// segment read-only and queries the mapping in place, so the operating
+// system keeps a single copy of it in memory however many processes use
+// it. Queries read the mapping only and are safe from any number of threads.
+//
+// write() replaces an existing segment of the same name with a new one, so
+// that processes still using the old segment are not disturbed; they keep
+// it until they close() it. The magic is written last, so that a process
+// opening the segment while it is being written rejects it.
+//
+// Answers are those of the KDTree the segment was written from. Queries run
+// KDFlatTree::nearest() over the mapped nodes, which open() validates once
+// up front so that the search itself does no checking.
+//
+
+namespace datastructures {
+
+class KDSharedSegment {
+public:
+    // TYPES
+    enum Location {
+        SHARED_MEMORY,
+            // A POSIX shared memory object, named as shm_open() expects,
+            // e.g. "/kdtree"
+
+        REGULAR_FILE
+            // A file, e.g. on a RAM disk
+    };
+
+    // CREATORS
+    KDSharedSegment();
+        // Default constructor, no segment is mapped
+
+    ~KDSharedSegment();
+        // Destructor, unmaps the segment
+
+    // PRIMARY INTERFACE
+    bool create( const std::string& name,
+                 const Location     location,
+                 const size_t       size );
+        // Replaces any segment of the provided name with a fresh one of
+        // size bytes, mapped read-write, unmapping any segment mapped
+        // before. Returns true on success and false otherwise.
+
+    bool open( const std::string& name, const Location location );
+        // Maps the whole of an existing segment read-only, unmapping any
+        // segment mapped before. Returns true on success and false
+        // otherwise.
+
+    void close();
+        // Unmaps the segment, if any
+
+    static bool remove( const std::string& name, const Location location );
+        // Removes the segment of the provided name. Processes that mapped
+        // it keep it until they unmap it.
+        // Returns true on success and false otherwise.
+
+    // ACCESSORS
+    bool isOpen() const;
+        // Returns true if a segment is mapped
+
+    char* data() const;
+        // Returns first byte of the segment, nullptr if none is mapped.
+        // Writable only if the segment was mapped by create().
+
+    size_t size() const;
+        // Returns size of the segment, 0 if none is mapped
+
+private:
+    // NOT IMPLEMENTED
+    KDSharedSegment( const KDSharedSegment& );
+    KDSharedSegment& operator=( const KDSharedSegment& );
+
+    static int openDescriptor( const std::string& name,
+                               const Location     location,
+                               const int          flags );
+        // Opens the segment with the provided open() flags
+
+    void*   m_data;
+        // Mapping of the segment, nullptr if none is mapped
+
+    size_t  m_size;
+        // Size of the mapping
+};
+
+template< typename T >
+class KDSharedTree {
+public:
+    // CREATORS
+    KDSharedTree();
+        // Default constructor, no segment is open
+
+    virtual ~KDSharedTree();
+        // Destructor, calls close()
+
+    // PRIMARY INTERFACE
+    template< typename I, typename A >
+    static bool write( const KDTree< T, I, A >&        tree,
+                       const std::string&              name,
+                       const KDSharedSegment::Location location =
+                                        KDSharedSegment::SHARED_MEMORY );
+        // Writes tree into the segment of the provided name, replacing any
+        // segment of that name.
+        // Returns true on success and false otherwise.
+
+    bool open( const std::string&              name,
+               const KDSharedSegment::Location location =
+                                        KDSharedSegment::SHARED_MEMORY );
+        // Maps the segment of the provided name read-only and validates it,
+        // closing any segment open before.
+        // Returns true on success and false otherwise.
+
+    void close();
+        // Unmaps the segment
+
+    static bool remove( const std::string&              name,
+                        const KDSharedSegment::Location location =
+                                        KDSharedSegment::SHARED_MEMORY );
+        // Removes the segment of the provided name, see
+        // KDSharedSegment::remove()
+
+    size_t nearestPointIndex( const Types::Point< T >& pointOfInterest ) const;
+        // Returns input order index of the closest point in the tree to the
+        // point of interest, as KDTree::nearestPointIndex() does.
+        // In case the tree is empty or there is a cardinality mismatch -
+        // KDTREE_ERROR_INDEX is returned
+
+    size_t nearestPointIndex( const T*     pointOfInterest,
+                              const size_t dimension ) const;
+        // Same as above, reads dimension coordinates of the point of
+        // interest straight from the caller's buffer
+
+    KDPointView< T > nearestPointView( const T*     pointOfInterest,
+                                       const size_t dimension ) const;
+        // Returns a view of the closest point in the tree to the point of
+        // interest, valid until close(). In case the tree is empty or there
+        // is a cardinality mismatch - empty view is returned
+
+    KDPointView< T > pointAt( const size_t index ) const;
+        // Returns a view of the point under the provided input order index,
+        // valid until close(). Returns empty view in case the index is out
+        // of range.
+
+    // ACCESSORS
+    bool isOpen() const;
+        // Returns true if a segment is open
+
+    size_t size() const;
+        // Returns number of points of the tree
+
+    size_t dimension() const;
+        // Returns cardinality of the points of the tree
+
+    size_t numNodes() const;
+        // Returns number of nodes of the tree
+
+    size_t segmentSize() const;
+        // Returns size of the mapped segment in bytes
+
+    std::ostream& print( std::ostream& out ) const;
+        // Prints the KDSharedTree in a easy to read format
+
+private:
+    // NOT IMPLEMENTED
+    KDSharedTree( const KDSharedTree& );
+    KDSharedTree& operator=( const KDSharedTree& );
+
+    // PRIVATE TYPES
+    struct Header {
+        uint64_t valueSize;
+        uint64_t dimension;
+        uint64_t numPoints;
+        uint64_t numNodes;
+        uint64_t nodesOffset;
+        uint64_t pointsOffset;
+        uint64_t indexesOffset;
+        uint64_t slotsOffset;
+        uint64_t segmentSize;
+    };
+
+    struct Node {
+        uint64_t axis;
+            // Split axis, KDTREE_SHARED_LEAF for leaves
+
+        uint64_t link;
+            // Right child node id, slot of the point for leaves
+
+        T        value;
+            // Split value
+    };
+
+    typedef KDFlatNode< T > FlatNode;
+
+    struct Reader {
+        const KDSharedTree* tree;
+            // The tree whose mapping is read
+
+        bool node( const uint64_t id, FlatNode& result ) const;
+            // Copies the node under id, see KDSharedTree::node()
+
+        bool distance( const FlatNode&         leaf,
+                       const KDPointView< T >& pointOfInterest,
+                       double&                 result ) const;
+            // Measures euclidean distance between the point of the leaf and
+            // the point of interest
+    };
+        // Feeds the mapped nodes to KDFlatTree::nearest()
+
+    // PRIVATE CONSTANTS
+    enum {
+        SECTION_ALIGNMENT = 64u
+            // Sections of a segment start at multiples of this
+    };
+
+    static Header layout( const size_t numPoints, const size_t dimension );
+        // Returns header of a segment of numPoints points of the provided
+        // dimension
+
+    static uint64_t align( const uint64_t offset );
+        // Rounds offset up to SECTION_ALIGNMENT
+
+    bool validate() const;
+        // Returns true if the mapped segment is complete and consistent, so
+        // that queries stay within it
+
+    const T* slotPoint( const uint64_t slot ) const;
+        // Returns coordinates of the point in the slot
+
+    FlatNode node( const uint64_t id ) const;
+        // Returns the node under id, its left child being id + 1
+
+    uint64_t nearestSlot( const KDPointView< T >& pointOfInterest ) const;
+        // Returns slot of the closest point, KDTREE_ERROR_INDEX in case the
+        // tree is empty or there is a cardinality mismatch
+
+    KDSharedSegment     m_segment;
+        // The mapped segment
+
+    Header              m_header;
+        // Header of the segment, zeroed if none is open
+
+    const Node*         m_nodes;
+        // Nodes of the segment
+
+    const T*            m_coordinates;
+        // Coordinates of the points of the segment, in slot order
+
+    const uint64_t*     m_indexes;
+        // Input order index of every slot
+
+    const uint64_t*     m_slots;
+        // Slot of every input order index
+};
+
+// INDEPENDENT OPERATORS
+template< typename T >
+std::ostream& operator<<( std::ostream& lhs, const KDSharedTree< T >& rhs );
+
+//============================================================================
+//                  CREATORS
+//============================================================================
+
+template< typename T >
+KDSharedTree< T >::KDSharedTree()
+: m_nodes( nullptr )
+, m_coordinates( nullptr )
+, m_indexes( nullptr )
+, m_slots( nullptr )
+{
+    std::memset( &m_header, 0, sizeof( m_header ) );
+}
+
+template< typename T >
+KDSharedTree< T >::~KDSharedTree()
+{
+    close();
+}
+
+//============================================================================
+//                  PRIMARY INTERFACE
+//============================================================================
+
+template< typename T >
+template< typename I, typename A >
+bool
+KDSharedTree< T >::write( const KDTree< T, I, A >&        tree,
+                          const std::string&              name,
+                          const KDSharedSegment::Location location )
+{
+    std::vector< FlatNode > flat;
+    if ( !KDFlatTree< T >::flatten( tree, flat ) )
+    {
+        std::cerr << "KDSharedTree::write() expects a tree with a leaf per "
+                  << "point and two children per split"
+                  << std::endl;
+        return false;
+    }
+
+    const size_t numPoints = tree.pointsView().size();
+    const size_t dimension = numPoints ? tree.pointAt( 0u ).size() : 0u;
+    const Header header    = layout( numPoints, dimension );
+
+    KDSharedSegment segment;
+    if ( !segment.create( name, location,
+                          static_cast< size_t >( header.segmentSize ) ) )
+    {
+        std::cerr << "KDSharedTree::write() is unable to create "
+                  << "'" << name << "'"
+                  << std::endl;
+        return false;
+    }
+
+    char*     base        = segment.data();
+    Node*     nodes       = reinterpret_cast< Node* >(
+                                    base + header.nodesOffset );
+    T*        coordinates = reinterpret_cast< T* >(
+                                    base + header.pointsOffset );
+    uint64_t* indexes     = reinterpret_cast< uint64_t* >(
+                                    base + header.indexesOffset );
+    uint64_t* slots       = reinterpret_cast< uint64_t* >(
+                                    base + header.slotsOffset );
+
+    // Flattened in preorder, so that the left child needs no link
+    for ( uint64_t id = 0; id < header.numNodes; ++id )
+    {
+        const FlatNode& source = flat[ id ];
+        Node&           node   = nodes[ id ];
+        if ( Constants::KDTREE_FLAT_LEAF != source.axis )
+        {
+            node.axis  = source.axis;
+            node.link  = source.right;
+            node.value = source.value;
+            continue;
+        }
+
+        node.axis  = Constants::KDTREE_SHARED_LEAF;
+        node.link  = source.slot;
+        node.value = T();
+
+        const KDPointView< T > point = tree.pointAt( source.index );
+        for ( size_t axis = 0; axis < dimension; ++axis )
+        {
+            coordinates[ source.slot * dimension + axis ] = point[ axis ];
+        }
+        indexes[ source.slot ]  = source.index;
+        slots[ source.index ]   = source.slot;
+    }
+
+    // The magic last, so that a segment being written is rejected
+    std::memcpy( base + Constants::KDTREE_SHARED_MAGIC.size(),
+                 &header, sizeof( header ) );
+    std::memcpy( base, Constants::KDTREE_SHARED_MAGIC.data(),
+                 Constants::KDTREE_SHARED_MAGIC.size() );
+
+    return true;
+}
+
+template< typename T >
+bool
+KDSharedTree< T >::open( const std::string&              name,
+                         const KDSharedSegment::Location location )
+{
+    close();
+
+    if ( !m_segment.open( name, location ) )
+    {
+        std::cerr << "KDSharedTree::open() is unable to open "
+                  << "'" << name << "' for reading"
+                  << std::endl;
+        return false;
+    }
+
+    const size_t magicSize = Constants::KDTREE_SHARED_MAGIC.size();
+    if ( ( m_segment.size() < magicSize + sizeof( m_header ) ) ||
+         std::memcmp( m_segment.data(), Constants::KDTREE_SHARED_MAGIC.data(),
+                      magicSize ) )
+    {
+        std::cerr << "KDSharedTree::open() '" << name << "' is not a "
+                  << "shared KDTree"
+                  << std::endl;
+        close();
+        return false;
+    }
+
+    std::memcpy( &m_header, m_segment.data() + magicSize, sizeof( m_header ) );
+    const char* base = m_segment.data();
+    m_nodes       = reinterpret_cast< const Node* >(
+                            base + m_header.nodesOffset );
+    m_coordinates = reinterpret_cast< const T* >(
+                            base + m_header.pointsOffset );
+    m_indexes     = reinterpret_cast< const uint64_t* >(
+                            base + m_header.indexesOffset );
+    m_slots       = reinterpret_cast< const uint64_t* >(
+                            base + m_header.slotsOffset );
+
+    if ( !validate() )
+    {
+        std::cerr << "KDSharedTree::open() '" << name << "' is not a "
+                  << "shared KDTree of this coordinate type"
+                  << std::endl;
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+template< typename T >
+void
+KDSharedTree< T >::close()
+{
+    m_segment.close();
+    std::memset( &m_header, 0, sizeof( m_header ) );
+    m_nodes       = nullptr;
+    m_coordinates = nullptr;
+    m_indexes     = nullptr;
+    m_slots       = nullptr;
+}
+
+template< typename T >
+bool
+KDSharedTree< T >::remove( const std::string&              name,
+                           const KDSharedSegment::Location location )
+{
+    return KDSharedSegment::remove( name, location );
+}
+
+template< typename T >
+size_t
+KDSharedTree< T >::nearestPointIndex(
+        const Types::Point< T >& pointOfInterest ) const
+{
+    return nearestPointIndex( pointOfInterest.data(), pointOfInterest.size() );
+}
+
+template< typename T >
+size_t
+KDSharedTree< T >::nearestPointIndex( const T*     pointOfInterest,
+                                      const size_t dimension ) const
+{
+    const uint64_t slot = nearestSlot( KDPointView< T >( pointOfInterest,
+                                                         dimension ) );
+    if ( Constants::KDTREE_ERROR_INDEX == slot )
+    {
+        return Constants::KDTREE_ERROR_INDEX;
+    }
+
+    return static_cast< size_t >( m_indexes[ slot ] );
+}
+
+template< typename T >
+KDPointView< T >
+KDSharedTree< T >::nearestPointView( const T*     pointOfInterest,
+                                     const size_t dimension ) const
+{
+    const uint64_t slot = nearestSlot( KDPointView< T >( pointOfInterest,
+                                                         dimension ) );
+    if ( Constants::KDTREE_ERROR_INDEX == slot )
+    {
+        return KDPointView< T >();
+    }
+
+    return KDPointView< T >( slotPoint( slot ), m_header.dimension );
+}
+
+template< typename T >
+KDPointView< T >
+KDSharedTree< T >::pointAt( const size_t index ) const
+{
+    if ( index >= m_header.numPoints )
+    {
+        return KDPointView< T >();
+    }
+
+    return KDPointView< T >( slotPoint( m_slots[ index ] ),
+                             m_header.dimension );
+}
+
+template< typename T >
+typename KDSharedTree< T >::Header
+KDSharedTree< T >::layout( const size_t numPoints, const size_t dimension )
+{
+    Header header;
+    header.valueSize     = sizeof( T );
+    header.dimension     = dimension;
+    header.numPoints     = numPoints;
+    header.numNodes      = numPoints ? 2u * numPoints - 1u : 0u;
+    header.nodesOffset   = align( Constants::KDTREE_SHARED_MAGIC.size() +
+                                  sizeof( header ) );
+    header.pointsOffset  = align( header.nodesOffset +
+                                  header.numNodes * sizeof( Node ) );
+    header.indexesOffset = align( header.pointsOffset +
+                                  numPoints * dimension * sizeof( T ) );
+    header.slotsOffset   = header.indexesOffset +
+                           numPoints * sizeof( uint64_t );
+    header.segmentSize   = header.slotsOffset +
+                           numPoints * sizeof( uint64_t );
+
+    return header;
+}
+
+template< typename T >
+uint64_t
+KDSharedTree< T >::align( const uint64_t offset )
+{
+    return ( offset + SECTION_ALIGNMENT - 1u ) /
+           SECTION_ALIGNMENT * SECTION_ALIGNMENT;
+}
+
+template< typename T >
+bool
+KDSharedTree< T >::validate() const
+{
+    // Offsets follow from the number and cardinality of the points
+    const Header expected = layout( static_cast< size_t >(
+                                            m_header.numPoints ),
+                                    static_cast< size_t >(
+                                            m_header.dimension ) );
+    if ( std::memcmp( &expected, &m_header, sizeof( expected ) ) ||
+         ( m_header.numPoints && !m_header.dimension ) ||
+         ( m_segment.size() < m_header.segmentSize ) )
+    {
+        return false;
+    }
+
+    // Indexes first, leaves look their input order index up
+    for ( uint64_t i = 0; i < m_header.numPoints; ++i )
+    {
+        if ( ( m_indexes[ i ] >= m_header.numPoints ) ||
+             ( m_slots[ i ] >= m_header.numPoints ) )
+        {
+            return false;
+        }
+    }
+
+    // Every node once, queries then trust the mapping
+    for ( uint64_t id = 0; id < m_header.numNodes; ++id )
+    {
+        if ( !KDFlatTree< T >::isValid( id, node( id ), m_header.numNodes,
+                                        m_header.numPoints,
+                                        m_header.dimension ) )
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+template< typename T >
+const T*
+KDSharedTree< T >::slotPoint( const uint64_t slot ) const
+{
+    return m_coordinates + slot * m_header.dimension;
+}
+
+template< typename T >
+uint64_t
+KDSharedTree< T >::nearestSlot( const KDPointView< T >& pointOfInterest ) const
+{
+    // Sanity
+    if ( !m_header.numPoints ||
+         ( pointOfInterest.size() != m_header.dimension ) )
+    {
+        return Constants::KDTREE_ERROR_INDEX;
+    }
+
+    const Reader reader = { this };
+    FlatNode     best;
+    if ( !KDFlatTree< T >::nearest( reader, pointOfInterest, best ) )
+    {
+        return Constants::KDTREE_ERROR_INDEX;
+    }
+
+    return best.slot;
+}
+
+template< typename T >
+typename KDSharedTree< T >::FlatNode
+KDSharedTree< T >::node( const uint64_t id ) const
+{
+    const Node& source = m_nodes[ id ];
+    const bool  isLeaf = Constants::KDTREE_SHARED_LEAF == source.axis;
+
+    FlatNode result;
+    result.axis  = isLeaf ? Constants::KDTREE_FLAT_LEAF : source.axis;
+    result.left  = isLeaf ? 0u : id + 1u;
+    result.right = isLeaf ? 0u : source.link;
+    result.slot  = isLeaf ? source.link : 0u;
+    result.index = isLeaf && ( source.link < m_header.numPoints ) ?
+                   m_indexes[ source.link ] : 0u;
+    result.value = source.value;
+
+    return result;
+}
+
+template< typename T >
+bool
+KDSharedTree< T >::Reader::node( const uint64_t id, FlatNode& result ) const
+{
+    result = tree->node( id );
+    return true;
+}
+
+template< typename T >
+bool
+KDSharedTree< T >::Reader::distance( const FlatNode&         leaf,
+                                     const KDPointView< T >& pointOfInterest,
+                                     double&                 result ) const
+{
+    result = Utils::distance< T >(
+            KDPointView< T >( tree->slotPoint( leaf.slot ),
+                              tree->m_header.dimension ),
+            pointOfInterest );
+    return true;
+}
+
+//============================================================================
+//                  ACCESSORS
+//============================================================================
+
+template< typename T >
+bool
+KDSharedTree< T >::isOpen() const
+{
+    return m_segment.isOpen();
+}
+
+template< typename T >
+size_t
+KDSharedTree< T >::size() const
+{
+    return static_cast< size_t >( m_header.numPoints );
+}
+
+template< typename T >
+size_t
+KDSharedTree< T >::dimension() const
+{
+    return static_cast< size_t >( m_header.dimension );
+}
+
+template< typename T >
+size_t
+KDSharedTree< T >::numNodes() const
+{
+    return static_cast< size_t >( m_header.numNodes );
+}
+
+template< typename T >
+size_t
+KDSharedTree< T >::segmentSize() const
+{
+    return m_segment.size();
+}
+
+template< typename T >
+std::ostream&
+KDSharedTree< T >::print( std::ostream& out ) const
+{
+    out << "KDSharedTree:[ "
+        << "size = "         << size()        << ", "
+        << "dimension = "    << dimension()   << ", "
+        << "nodes = "        << numNodes()    << ", "
+        << "segment size = " << segmentSize() << " ]";
+
+    return out;
+}
+
+//============================================================================
+//                  INDEPENDENT OPERATORS
+//============================================================================
+
+template< typename T >
+std::ostream& operator<<( std::ostream& lhs, const KDSharedTree< T >& rhs )
+{
+    return rhs.print( lhs );
+}
+
+} // namespace datastructures
+
+#endif // KDTREE_SHARED_H
@@ -0,0 +1,5 @@
+#include "kdtree_snapshot.h"
+
+namespace datastructures {
+
+} // namespace datastructures
@@ -0,0 +1,334 @@
+#ifndef KDTREE_SNAPSHOT_H
+#define KDTREE_SNAPSHOT_H
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "kdtree_types.h"
+#include "kdtree_constants.h"
+#include "kdtree.h"
+
+// @Purpose
+//
+// This class publishes immutable KDTree snapshots to concurrent readers.
+//
+// Readers call acquire() and receive a shared pointer to the tree that was
+// current at that moment. A reader keeps using its snapshot for as long as it
+// holds the pointer, regardless of what writers do in the meantime.
+//
+// Writers build a replacement tree off to the side - rebuild() and reload()
+// do this for the caller - and publish() it with a single atomic pointer
+// swap. No tree is ever built or destroyed while the swap is in progress. A
+// retired snapshot is reclaimed when the last reader holding it releases its
+// pointer.
+//
+// The read path takes no lock. The published tree is held by a heap record
+// behind an atomic raw pointer. A reader announces the record it is about to
+// copy the tree pointer from in a hazard slot of its own, checks that the
+// record is still the published one, copies the pointer and clears the slot.
+// Writers are serialized by a mutex which readers never touch; publish()
+// retires the previous record and frees the retired records that no hazard
+// slot announces, after its critical section. A reader only ever retries when
+// a publish() lands between its two loads, and allocates only when there are
+// more concurrent readers than hazard slots so far.
+//
+
+namespace datastructures {
+
+template< typename T >
+class KDTreeSnapshot {
+public:
+    // TYPES
+    typedef std::shared_ptr< const KDTree< T > > TreePtr;
+
+    // CREATORS
+    KDTreeSnapshot();
+        // Default constructor, publishes an empty tree
+
+    explicit KDTreeSnapshot( const TreePtr& tree );
+        // Constructor, publishes the provided tree. Null pointer is replaced
+        // by an empty tree.
+
+    virtual ~KDTreeSnapshot();
+        // Destructor. Snapshots still held by readers stay valid.
+
+    // PRIMARY INTERFACE
+    TreePtr acquire() const;
+        // Returns the currently published tree. Never returns null.
+        // Safe to call concurrently with publish().
+
+    TreePtr publish( const TreePtr& tree );
+        // Atomically replaces the published tree and returns the previous
+        // one. Null pointer is replaced by an empty tree.
+
+    TreePtr rebuild( const Types::Points< T >& points );
+        // Builds a new tree on the provided points outside of any critical
+        // section, then publishes it. Returns the previous tree.
+
+    bool reload( const std::string& filename );
+        // Deserializes a new tree from the provided file outside of any
+        // critical section, then publishes it.
+        // Returns true on success and false otherwise. The published tree
+        // is left untouched on failure.
+
+    size_t nearestPointIndex( const Types::Point< T >& pointOfInterest ) const;
+        // Convenience wrapper, queries the currently published tree.
+        // See KDTree::nearestPointIndex()
+
+    // ACCESSORS
+    size_t generation() const;
+        // Returns the number of publish() calls made so far
+
+private:
+    // NOT IMPLEMENTED
+    KDTreeSnapshot( const KDTreeSnapshot& );
+    KDTreeSnapshot& operator=( const KDTreeSnapshot& );
+
+    struct HazardSlot {
+        std::atomic< const TreePtr* >   record;
+            // Record being read, null when none
+
+        std::atomic< bool >             active;
+            // Whether a reader owns the slot
+
+        HazardSlot*                     next;
+            // Next slot of the list, immutable once the slot is linked
+    };
+
+    HazardSlot* claimSlot() const;
+        // Returns a hazard slot owned by the calling reader, linking a new
+        // one if all the slots are active
+
+    void reclaim( std::vector< const TreePtr* >& reclaimed );
+        // Moves the retired records that no hazard slot announces to
+        // reclaimed. Called with m_writerMutex held.
+
+    std::atomic< const TreePtr* >       m_current;
+        // Record of the currently published tree, never null
+
+    mutable std::atomic< HazardSlot* >  m_slots;
+        // Hazard slots of the readers, only ever grown
+
+    std::mutex                          m_writerMutex;
+        // Serializes publish() calls
+
+    std::vector< const TreePtr* >       m_retired;
+        // Records replaced but still possibly read. Guarded by
+        // m_writerMutex.
+
+    std::atomic< size_t >               m_generation;
+        // Number of trees published so far
+};
+
+//============================================================================
+//                  CREATORS
+//============================================================================
+
+template< typename T >
+KDTreeSnapshot< T >::KDTreeSnapshot()
+: m_current( new TreePtr( std::make_shared< const KDTree< T > >() ) )
+, m_slots( nullptr )
+, m_generation( 0u )
+{
+    // nothing to do here
+}
+
+template< typename T >
+KDTreeSnapshot< T >::KDTreeSnapshot( const TreePtr& tree )
+: m_current( new TreePtr( tree ? tree
+                             : std::make_shared< const KDTree< T > >() ) )
+, m_slots( nullptr )
+, m_generation( 0u )
+{
+    // nothing to do here
+}
+
+template< typename T >
+KDTreeSnapshot< T >::~KDTreeSnapshot()
+{
+    delete m_current.load();
+    for ( size_t i = 0; i < m_retired.size(); ++i )
+    {
+        delete m_retired[ i ];
+    }
+
+    HazardSlot* slot = m_slots.load();
+    while ( nullptr != slot )
+    {
+        HazardSlot* next = slot->next;
+        delete slot;
+        slot = next;
+    }
+}
+
+//============================================================================
+//                  PRIMARY INTERFACE
+//============================================================================
+
+template< typename T >
+typename KDTreeSnapshot< T >::TreePtr
+KDTreeSnapshot< T >::acquire() const
+{
+    HazardSlot* slot = claimSlot();
+
+    // Once the slot announces a record that is still published afterwards,
+    // the publish() retiring it scans the slot too late to free it
+    const TreePtr* record = m_current.load();
+    for ( ;; )
+    {
+        slot->record.store( record );
+        const TreePtr* published = m_current.load();
+        if ( published == record )
+        {
+            break;
+        }
+        record = published;
+    }
+
+    TreePtr tree = *record;
+
+    slot->record.store( nullptr, std::memory_order_release );
+    slot->active.store( false, std::memory_order_release );
+
+    return tree;
+}
+
+template< typename T >
+typename KDTreeSnapshot< T >::TreePtr
+KDTreeSnapshot< T >::publish( const TreePtr& tree )
+{
+    const TreePtr* record = new TreePtr(
+            tree ? tree : std::make_shared< const KDTree< T > >() );
+
+    TreePtr previous;
+    std::vector< const TreePtr* > reclaimed;
+    {
+        std::lock_guard< std::mutex > lock( m_writerMutex );
+
+        const TreePtr* retired = m_current.exchange( record );
+        previous = *retired;
+        ++m_generation;
+
+        m_retired.push_back( retired );
+        reclaim( reclaimed );
+    }
+
+    // Records, and trees no reader holds any more, are released outside of
+    // the critical section. The previous tree is released by the caller.
+    for ( size_t i = 0; i < reclaimed.size(); ++i )
+    {
+        delete reclaimed[ i ];
+    }
+
+    return previous;
+}
+
+template< typename T >
+typename KDTreeSnapshot< T >::TreePtr
+KDTreeSnapshot< T >::rebuild( const Types::Points< T >& points )
+{
+    return publish( std::make_shared< const KDTree< T > >( points ) );
+}
+
+template< typename T >
+bool
+KDTreeSnapshot< T >::reload( const std::string& filename )
+{
+    std::shared_ptr< KDTree< T > > tree = std::make_shared< KDTree< T > >();
+
+    if ( !tree->deserialize( filename ) )
+    {
+        std::cerr << "KDTreeSnapshot::reload() is unable to load "
+                  << "'" << filename << "', keeping current tree"
+                  << std::endl;
+        return false;
+    }
+
+    publish( tree );
+    return true;
+}
+
+template< typename T >
+size_t
+KDTreeSnapshot< T >::nearestPointIndex(
+        const Types::Point< T >& pointOfInterest ) const
+{
+    return acquire()->nearestPointIndex( pointOfInterest );
+}
+
+template< typename T >
+typename KDTreeSnapshot< T >::HazardSlot*
+KDTreeSnapshot< T >::claimSlot() const
+{
+    for ( HazardSlot* slot = m_slots.load( std::memory_order_acquire );
+          nullptr != slot; slot = slot->next )
+    {
+        bool idle = false;
+        if ( !slot->active.load( std::memory_order_relaxed ) &&
+             slot->active.compare_exchange_strong( idle, true ) )
+        {
+            return slot;
+        }
+    }
+
+    HazardSlot* slot = new HazardSlot;
+    slot->record.store( nullptr );
+    slot->active.store( true );
+    slot->next = m_slots.load();
+    while ( !m_slots.compare_exchange_weak( slot->next, slot ) )
+    {
+        // slot->next now holds the current head, try again
+    }
+
+    return slot;
+}
+
+template< typename T >
+void
+KDTreeSnapshot< T >::reclaim( std::vector< const TreePtr* >& reclaimed )
+{
+    std::vector< const TreePtr* > hazards;
+    for ( HazardSlot* slot = m_slots.load(); nullptr != slot;
+          slot = slot->next )
+    {
+        const TreePtr* record = slot->record.load();
+        if ( nullptr != record )
+        {
+            hazards.push_back( record );
+        }
+    }
+
+    std::vector< const TreePtr* > kept;
+    for ( size_t i = 0; i < m_retired.size(); ++i )
+    {
+        if ( std::find( hazards.begin(), hazards.end(), m_retired[ i ] ) ==
+             hazards.end() )
+        {
+            reclaimed.push_back( m_retired[ i ] );
+        }
+        else
+        {
+            kept.push_back( m_retired[ i ] );
+        }
+    }
+    m_retired.swap( kept );
+}
+
+//============================================================================
+//                  ACCESSORS
+//============================================================================
+
+template< typename T >
+size_t
+KDTreeSnapshot< T >::generation() const
+{
+    return m_generation.load();
+}
+
+} // namespace datastructures
+
+#endif // KDTREE_SNAPSHOT_H
@@ -1,5 +1,5 @@
-#include "kdtree_types.h"
-
-namespace datastructures {
-
-} // namespace datastructures
+#include "kdtree_types.h"
+
+namespace datastructures {
+
+} // namespace datastructures
@@ -1,1324 +1,2636 @@
-#include <iostream>
-#include <fstream>
-#include <cstdio>
-
-#include "gtest/gtest.h"
-
-#include "kdtree_types.h"
-#include "kdtree.h"
-#include "kdtree_utils.h"
-
-using namespace datastructures;
-
-namespace {
-
-//////////////////////////////////////////////////////////////////////////////
-// LOCAL TYPES AND DEFINITIONS
-//////////////////////////////////////////////////////////////////////////////
-
-typedef Types::Point< int >   TestPoint;
-typedef Types::Points< int >  TestPoints;
-typedef KDHyperplane< int >   TestHyperplane;
-
-class TestKDTree : public KDTree< int >
-{
-public:
-    TestKDTree()
-            : KDTree< int >()
-    {
-        // nothing to do here
-    }
-
-    TestKDTree( const TestPoints& testPoints )
-            : KDTree< int >( testPoints )
-    {
-        // nothing to do here
-    }
-
-    virtual const TestHyperplane chooseBestSplit(
-            const Types::Indexes& indexes ) const
-    {
-        return KDTree< int >::chooseBestSplit( indexes );
-    }
-
-    std::shared_ptr< KDNode< int > > root()
-    {
-        return m_root;
-    }
-
-    TestPoints points()
-    {
-        return m_points;
-    }
-};
-
-const std::string testFile = "really_long_and_unique_test_file_name_42.txt";
-
-class TestFileGuard
-{
-public:
-    TestFileGuard( const std::string& testFileName )
-    : m_testFileName( testFileName )
-    {
-        // nothing to do here
-    }
-
-    ~TestFileGuard()
-    {
-        std::remove( m_testFileName.c_str() );
-    }
-
-private:
-    std::string   m_testFileName;
-};
-
-//////////////////////////////////////////////////////////////////////////////
-// HELPER FUNCTIONS
-//////////////////////////////////////////////////////////////////////////////
-
-TestPoint bruteForceClosest( const TestPoints& points,
-                             const TestPoint& pointOfInterest )
-{
-    // Sanity
-    if ( !points.size() )
-    {
-        return TestPoint();
-    }
-
-    typename TestPoints::const_iterator it = points.cbegin();
-    TestPoint closestSoFar = ( *it );
-    double smallestDist = Utils::distance< int >( pointOfInterest, ( *it ) );
-    ++it;
-
-    for (;it != points.cend(); ++it )
-    {
-        const double temp = Utils::distance< int >( pointOfInterest, ( *it ) );
-        if ( temp <= smallestDist )
-        {
-            smallestDist = temp;
-            closestSoFar = ( *it );
-        }
-    }
-
-    return closestSoFar;
-}
-
-size_t bruteForceClosestIndex( const std::vector< Types::Point< float > >& points,
-                               const Types::Point< float >& pointOfInterest )
-{
-    Types::Point< float > closestSoFar = points[ 0 ];
-    double smallestDist = Utils::distance< float >( pointOfInterest, closestSoFar );
-    size_t closestIndex = 0;
-
-    for ( size_t i = 1; i < points.size(); ++i )
-    {
-        const double temp = Utils::distance< float >( pointOfInterest, points[ i ] );
-        if ( temp < smallestDist )
-        {
-            smallestDist = temp;
-            closestSoFar = points[ i ];
-            closestIndex = i;
-        }
-    }
-
-    return closestIndex;
-}
-
-//////////////////////////////////////////////////////////////////////////////
-// TEST FUNCTIONS
-//////////////////////////////////////////////////////////////////////////////
-
-TEST( Helpers, TestBruteForceClosest )
-{
-    TestPoint p1;
-    p1.push_back( -1 ); // x
-    p1.push_back(  1 ); // y
-
-    TestPoint p2;
-    p2.push_back( 0 ); // x
-    p2.push_back( 1 ); // y
-
-    TestPoint p3;
-    p3.push_back( 1 ); // x
-    p3.push_back( 1 ); // y
-
-    TestPoints points;
-    points.push_back( p1 );
-    points.push_back( p2 );
-    points.push_back( p3 );
-
-    TestPoint pOfInterest;
-    pOfInterest.push_back( 0 ); // x
-    pOfInterest.push_back( 0 ); // y
-
-    ASSERT_EQ( bruteForceClosest( points, pOfInterest ), p2 );
-}
-
-TEST( Helpers, TestBruteForceClosestIndex )
-{
-    Types::Point< float > p1;
-    p1.push_back( -1.0 ); // x
-    p1.push_back(  1.0 ); // y
-
-    Types::Point< float > p2;
-    p2.push_back( 0.0 ); // x
-    p2.push_back( 1.0 ); // y
-
-    Types::Point< float > p3;
-    p3.push_back( 1 ); // x
-    p3.push_back( 1 ); // y
-
-    Types::Points< float > points;
-    points.push_back( p1 );
-    points.push_back( p2 );
-    points.push_back( p3 );
-
-    Types::Point< float > pOfInterest;
-    pOfInterest.push_back( 0.0 ); // x
-    pOfInterest.push_back( 0.0 ); // y
-
-    ASSERT_EQ( bruteForceClosestIndex( points, pOfInterest ), 1u );
-}
-
-TEST( KDTree, TestZero )
-{
-    // initial object
-    TestKDTree zero;
-
-    ASSERT_TRUE( zero == zero );
-    ASSERT_TRUE( !( zero != zero ) );
-    ASSERT_TRUE( zero.equals( zero ) );
-
-    // Empty configs must be equivalent
-    TestKDTree zero2;
-
-    ASSERT_TRUE( zero == zero2 );
-    ASSERT_TRUE( !( zero != zero2 ) );
-    ASSERT_TRUE( zero.equals( zero2 ) );
-
-    // copy of initial object
-    TestKDTree zeroCopy( zero );
-
-    ASSERT_TRUE( zero == zeroCopy );
-    ASSERT_TRUE( !( zero != zeroCopy ) );
-    ASSERT_TRUE( zero.equals( zeroCopy ) );
-
-    // assign of initial object
-    TestKDTree zeroAssign;
-    zeroAssign = zero;
-    ASSERT_TRUE( zero == zeroAssign );
-    ASSERT_TRUE( !( zero != zeroAssign ) );
-    ASSERT_TRUE( zero.equals( zeroAssign ) );
-}
-
-TEST( KDTree, TestUninitializedState )
-{
-    TestKDTree dummyTree;
-    TestPoints dummyPoints;
-
-    ASSERT_EQ( dummyTree.root(),   nullptr );
-    ASSERT_EQ( dummyTree.points(), dummyPoints );
-    ASSERT_EQ( dummyTree.type(),   Constants::KDTREE_SIMPLE_VARIETY );
-
-    std::cout << dummyTree << std::endl;
-}
-
-TEST( KDTree, TreeOnOneNode )
-{
-    TestPoint p1;
-    p1.push_back( 1 );
-    p1.push_back( 2 );
-    p1.push_back( 3 );
-
-    TestPoints sanityPoints;
-    sanityPoints.push_back( p1 );
-
-    TestHyperplane emptyHyperplane;
-
-    TestKDTree sanityTree( sanityPoints );
-
-    std::cout << sanityTree << std::endl;
-    std::cout << *sanityTree.root() << std::endl;
-
-    ASSERT_TRUE( sanityTree.root()->isLeaf() );
-    ASSERT_EQ  ( sanityTree.root()->leafPointIndex(), 0u );
-
-    //ASSERT_EQ  ( sanityTree.root()->leafPoint()     , p1 );
-
-    ASSERT_EQ  ( sanityTree.points()            , sanityPoints );
-    ASSERT_EQ  ( sanityTree.root()->hyperplane(), emptyHyperplane );
-    ASSERT_EQ  ( sanityTree.root()->left()      , nullptr );
-    ASSERT_EQ  ( sanityTree.root()->right()     , nullptr );
-}
-
-TEST( KDTree, TreeOnTwoNodes )
-{
-    TestHyperplane sanityHyperplane( 0u, 1 );
-
-    TestPoint p1;
-    p1.push_back( -1 );
-
-    TestPoint p2;
-    p2.push_back( 1 );
-
-    TestPoints sanityPoints;
-    sanityPoints.push_back( p1 );
-    sanityPoints.push_back( p2 );
-
-    TestKDTree sanityTree( sanityPoints );
-
-    std::cout << sanityTree << std::endl;
-
-    ASSERT_FALSE( sanityTree.root()->isLeaf() );
-    ASSERT_TRUE(  sanityTree.root()->left()  != nullptr );
-    ASSERT_TRUE(  sanityTree.root()->right() != nullptr );
-    ASSERT_EQ(    sanityTree.root()->hyperplane(), sanityHyperplane );
-
-    ASSERT_TRUE(  sanityTree.root()->left()->isLeaf()  );
-    ASSERT_TRUE(  sanityTree.root()->right()->isLeaf() );
-
-    ASSERT_EQ(    sanityTree.root()->left()->leafPointIndex() , 0u );
-    ASSERT_EQ(    sanityTree.root()->right()->leafPointIndex(), 1u );
-
-    //ASSERT_EQ(    sanityTree.root()->left()->leafPoint()      , p1 );
-    //ASSERT_EQ(    sanityTree.root()->right()->leafPoint()     , p2 );
-
-    ASSERT_EQ(    sanityTree.points(), sanityPoints );
-}
-
-TEST( KDTree, TreeOnThreeNodes )
-{
-    TestHyperplane sanityHyperplane1( 0u, 0 );
-    TestHyperplane sanityHyperplane2( 0u, 1 );
-
-    TestPoint p1;
-    p1.push_back( -3 );
-
-    TestPoint p2;
-    p2.push_back( 0 );
-
-    TestPoint p3;
-    p3.push_back( 1 );
-
-    TestPoints sanityPoints;
-    sanityPoints.push_back( p1 );
-    sanityPoints.push_back( p2 );
-    sanityPoints.push_back( p3 );
-
-    TestKDTree sanityTree( sanityPoints );
-    std::cout << sanityTree << std::endl;
-
-    ASSERT_FALSE( sanityTree.root()->isLeaf() );
-    ASSERT_TRUE(  sanityTree.root()->left()  != nullptr );
-    ASSERT_TRUE(  sanityTree.root()->right() != nullptr );
-    ASSERT_EQ(    sanityTree.root()->hyperplane(), sanityHyperplane1 );
-
-    // Left part must be a leaf on "-2"
-    ASSERT_TRUE(  sanityTree.root()->left()->isLeaf() );
-    ASSERT_EQ(    sanityTree.root()->left()->leafPointIndex(), 0u );
-
-    //ASSERT_EQ(    sanityTree.root()->left()->leafPoint(), p1 );
-
-    // Right part must not be a leaf and contain "0", "1"
-    ASSERT_FALSE( sanityTree.root()->right()->isLeaf() );
-    ASSERT_EQ(    sanityTree.root()->right()->hyperplane(),
-                  sanityHyperplane2 );
-
-    ASSERT_EQ(    sanityTree.root()->right()->left()->leafPointIndex() , 1u );
-    ASSERT_EQ(    sanityTree.root()->right()->right()->leafPointIndex(), 2u );
-
-//    ASSERT_EQ(    sanityTree.root()->right()->left()->leafPoint() , p2 );
-//    ASSERT_EQ(    sanityTree.root()->right()->right()->leafPoint(), p3 );
-}
-
-TEST( KDTree, TreeOnFourNodes )
-{
-    TestHyperplane centerHyperplane( 0u, 6 );
-    TestHyperplane leftHyperplane(   1u, 2 );
-    TestHyperplane rightHyperplane(  1u, 4 );
-
-    TestPoint upperLeft;
-    upperLeft.push_back( -6 ); // x
-    upperLeft.push_back(  2 ); // y
-
-    TestPoint bottomLeft;
-    bottomLeft.push_back( -6 ); // x
-    bottomLeft.push_back( -2 ); // y
-
-    TestPoint upperRight;
-    upperRight.push_back( 6 ); // x
-    upperRight.push_back( 4 ); // y
-
-    TestPoint bottomRight;
-    bottomRight.push_back(  6 ); // x
-    bottomRight.push_back( -4 ); // y
-
-    TestPoints sanityPoints;
-    sanityPoints.push_back( upperLeft );
-    sanityPoints.push_back( bottomLeft );
-    sanityPoints.push_back( upperRight );
-    sanityPoints.push_back( bottomRight );
-
-    TestKDTree sanityTree( sanityPoints );
-    std::cout << sanityTree << std::endl;
-
-    // First node must partition on x due to higher [ -6; 6 ] spread
-    ASSERT_FALSE( sanityTree.root()->isLeaf() );
-    ASSERT_TRUE(  sanityTree.root()->left()  != nullptr );
-    ASSERT_TRUE(  sanityTree.root()->right() != nullptr );
-    ASSERT_EQ(    sanityTree.root()->hyperplane(), centerHyperplane );
-
-    // Left node must partition on x due to higher [ -2; 2 ] spread
-    ASSERT_FALSE( sanityTree.root()->left()->isLeaf() );
-    ASSERT_TRUE(  sanityTree.root()->left()->left()  != nullptr );
-    ASSERT_TRUE(  sanityTree.root()->left()->right() != nullptr );
-    ASSERT_EQ(    sanityTree.root()->left()->hyperplane(),
-                      leftHyperplane );
-
-
-    ASSERT_EQ( sanityTree.root()->left()->left()->leafPointIndex(),  1u );
-    ASSERT_EQ( sanityTree.root()->left()->right()->leafPointIndex(), 0u );
-
-//    ASSERT_EQ( sanityTree.root()->left()->left()->leafPoint(),  bottomLeft );
-//    ASSERT_EQ( sanityTree.root()->left()->right()->leafPoint(), upperLeft );
-
-    // Left node must partition on x due to higher [ -4; 4 ] spread
-    ASSERT_FALSE( sanityTree.root()->right()->isLeaf() );
-    ASSERT_TRUE(  sanityTree.root()->right()->left()  != nullptr );
-    ASSERT_TRUE(  sanityTree.root()->right()->right() != nullptr );
-    ASSERT_EQ(    sanityTree.root()->right()->hyperplane(),
-                      rightHyperplane );
-
-    ASSERT_EQ( sanityTree.root()->right()->left()->leafPointIndex(), 3u );
-    ASSERT_EQ( sanityTree.root()->right()->right()->leafPointIndex(),2u );
-
-//    ASSERT_EQ( sanityTree.root()->right()->left()->leafPoint(), bottomRight );
-//    ASSERT_EQ( sanityTree.root()->right()->right()->leafPoint(), upperRight );
-}
-
-TEST( KDTree, SearchOnEmptyTree )
-{
-    TestKDTree sanityTree;
-
-    TestPoint pointOfInterest;
-    pointOfInterest.push_back( 0 );
-
-    ASSERT_EQ( TestPoint(), sanityTree.nearestPoint( pointOfInterest ) );
-}
-
-TEST( KDTree, SearchTreeOnOneNode )
-{
-    TestPoint p1;
-    p1.push_back( 0 );
-
-    TestPoints sanityData;
-    sanityData.push_back( p1 );
-
-    TestKDTree sanityTree( sanityData  );
-    std::cout << sanityTree << std::endl;
-
-    TestPoint pointOfInterest;
-    pointOfInterest.push_back( 1 );
-
-    ASSERT_EQ( p1, sanityTree.nearestPoint( pointOfInterest ) );
-}
-
-TEST( KDTree, SearchTreeOnTwoNodes )
-{
-    TestPoint p1;
-    p1.push_back( -3 );
-
-    TestPoint p2;
-    p2.push_back( 3 );
-
-    TestPoints sanityData;
-    sanityData.push_back( p1 );
-    sanityData.push_back( p2 );
-
-    TestKDTree sanityTree( sanityData  );
-    std::cout << sanityTree << std::endl;
-
-    TestPoint pointOfInterest;
-    pointOfInterest.push_back( 1 );
-
-    ASSERT_EQ( p2, sanityTree.nearestPoint( pointOfInterest ) );
-}
-
-TEST( KDTree, SearchTreeOnThreeNodes )
-{
-    TestPoint p1;
-    p1.push_back( -3 ); // x
-    p1.push_back(  0 ); // y
-
-    TestPoint p2;
-    p2.push_back( 0 ); // x
-    p2.push_back( 0 ); // y
-
-    TestPoint p3;
-    p3.push_back( 4 ); // x
-    p3.push_back( 0 ); // y
-
-    TestPoints sanityPoints;
-    sanityPoints.push_back( p1 );
-    sanityPoints.push_back( p2 );
-    sanityPoints.push_back( p3 );
-
-    TestKDTree sanityTree( sanityPoints );
-    std::cout << sanityTree << std::endl;
-
-    TestPoint pointOfInterest0;
-    pointOfInterest0.push_back( -100 ); // x
-    pointOfInterest0.push_back(  0 );  // y
-    ASSERT_EQ( p1, sanityTree.nearestPoint( pointOfInterest0 ) );
-
-    TestPoint pointOfInterest1;
-    pointOfInterest1.push_back( -5 ); // x
-    pointOfInterest1.push_back(  0 ); // y
-    ASSERT_EQ( p1, sanityTree.nearestPoint( pointOfInterest1 ) );
-
-    TestPoint pointOfInterest2;
-    pointOfInterest2.push_back( -2 ); // x
-    pointOfInterest2.push_back(  0 ); // y
-    ASSERT_EQ( p1, sanityTree.nearestPoint( pointOfInterest2 ) );
-
-    TestPoint pointOfInterest3;
-    pointOfInterest3.push_back( -1 ); // x
-    pointOfInterest3.push_back(  0 ); // y
-    ASSERT_EQ( p2, sanityTree.nearestPoint( pointOfInterest3 ) );
-
-    TestPoint pointOfInterest4;
-    pointOfInterest4.push_back( 0 ); // x
-    pointOfInterest4.push_back( 0 ); // y
-    ASSERT_EQ( p2, sanityTree.nearestPoint( pointOfInterest4 ) );
-
-    TestPoint pointOfInterest5;
-    pointOfInterest5.push_back( 1 ); // x
-    pointOfInterest5.push_back( 0 ); // y
-    ASSERT_EQ( p2, sanityTree.nearestPoint( pointOfInterest5 ) );
-
-    TestPoint pointOfInterest6;
-    pointOfInterest6.push_back( 3 ); // x
-    pointOfInterest6.push_back( 0 ); // y
-    ASSERT_EQ( p3, sanityTree.nearestPoint( pointOfInterest6 ) );
-
-    TestPoint pointOfInterest7;
-    pointOfInterest7.push_back( 5 ); // x
-    pointOfInterest7.push_back( 0 ); // y
-    ASSERT_EQ( p3, sanityTree.nearestPoint( pointOfInterest7 ) );
-
-    TestPoint pointOfInterest8;
-    pointOfInterest8.push_back( 100 ); // x
-    pointOfInterest8.push_back( 0 );   // y
-    ASSERT_EQ( p3, sanityTree.nearestPoint( pointOfInterest8 ) );
-}
-
-TEST( KDTree, StressTest )
-{
-    TestPoint upperLeft;
-    upperLeft.push_back( -11 ); // x
-    upperLeft.push_back(  5 ); // y
-
-    TestPoint bottomLeft;
-    bottomLeft.push_back( -10 ); // x
-    bottomLeft.push_back( -6 ); // y
-
-    TestPoint upperRight;
-    upperRight.push_back( 11 ); // x
-    upperRight.push_back( 6 ); // y
-
-    TestPoint bottomRight;
-    bottomRight.push_back(  12 ); // x
-    bottomRight.push_back( -7 ); // y
-
-    TestPoints sanityPoints;
-    sanityPoints.push_back( upperLeft );
-    sanityPoints.push_back( bottomLeft );
-    sanityPoints.push_back( upperRight );
-    sanityPoints.push_back( bottomRight );
-
-    TestKDTree sanityTree( sanityPoints );
-    std::cout << sanityTree << std::endl;
-
-    std::vector< TestPoint > testPoints;
-    for ( int x = -15; x < 16; ++x )
-    {
-        for ( int y = -10; y < 10; ++y )
-        {
-            TestPoint test;
-            test.push_back( x );
-            test.push_back( y );
-            testPoints.push_back( test );
-        }
-    }
-
-    for ( typename std::vector< TestPoint >::const_iterator it
-              = testPoints.cbegin();
-          it < testPoints.cend(); ++it )
-    {
-        //std::cout << "Checking " << ( *it ) << std::endl;
-
-        TestPoint bruteForcePoint = bruteForceClosest( sanityPoints, ( *it ) );
-        TestPoint treePoint       = sanityTree.nearestPoint( *it );
-
-        ASSERT_EQ( bruteForcePoint, treePoint );
-    }
-}
-
-TEST( KDTREE, SerializeEmptyTreeTest )
-{
-    TestFileGuard guard( testFile );
-    TestPoints treePoints;
-
-    TestKDTree sampleTree( treePoints );
-    std::cout << sampleTree << std::endl;
-
-    ASSERT_TRUE( sampleTree.serialize( testFile ) );
-
-    std::ifstream treeData( testFile );
-    ASSERT_TRUE( treeData.is_open() );
-
-    {
-        std::string serialized;
-        ASSERT_TRUE( getline( treeData, serialized ) );
-        ASSERT_EQ( Constants::KDTREE_SIMPLE_VARIETY, serialized );
-    }
-    {
-        const std::string expected1 = "0";
-        std::string serialized1;
-        ASSERT_TRUE( getline( treeData, serialized1 ) );
-        ASSERT_EQ( expected1, serialized1 );
-    }
-    {
-        std::string serialized2;
-        ASSERT_TRUE( getline( treeData, serialized2 ) );
-        ASSERT_EQ( Constants::KDTREE_EMPTY_MARKER, serialized2 );
-    }
-
-    {
-        std::string serialized;
-        ASSERT_FALSE( getline( treeData, serialized ) );
-    }
-}
-
-TEST( KDTREE, DeserializeEmptyTreeTest )
-{
-    TestFileGuard guard( testFile );
-    TestPoints treePoints;
-
-    TestKDTree sampleTree( treePoints );
-    std::cout << sampleTree << std::endl;
-
-    ASSERT_TRUE( sampleTree.serialize( testFile ) );
-
-    TestKDTree deserialized;
-    ASSERT_TRUE( deserialized.deserialize( testFile ) );
-
-    ASSERT_EQ( sampleTree, deserialized );
-}
-
-TEST( KDTREE, SerializeTreeOnOneNodeTest )
-{
-    TestFileGuard guard( testFile );
-    TestPoints treePoints;
-    {
-        TestPoint p;
-        p.push_back( 1 );
-        treePoints.push_back( p );
-    }
-
-    TestKDTree sampleTree( treePoints );
-    std::cout << sampleTree << std::endl;
-
-    ASSERT_TRUE( sampleTree.serialize( testFile ) );
-
-    std::ifstream treeData( testFile );
-    ASSERT_TRUE( treeData.is_open() );
-
-    {
-        std::string serialized;
-        ASSERT_TRUE( getline( treeData, serialized ) );
-        ASSERT_EQ( Constants::KDTREE_SIMPLE_VARIETY, serialized );
-    }
-    {
-        const std::string expected = "1";
-        std::string serialized;
-        ASSERT_TRUE( getline( treeData, serialized ) );
-        ASSERT_EQ( expected, serialized );
-    }
-    {
-        const std::string expected = "1";
-        std::string serialized;
-        ASSERT_TRUE( getline( treeData, serialized ) );
-        ASSERT_EQ( expected, serialized );
-    }
-
-    {
-        std::string serialized;
-        ASSERT_TRUE( getline( treeData, serialized ) );
-        ASSERT_EQ( Constants::KDTREE_LEAF_MARKER, serialized );
-    }
-    {
-        const std::string expected = "0";
-        std::string serialized;
-        ASSERT_TRUE( getline( treeData, serialized ) );
-        ASSERT_EQ( expected, serialized );
-    }
-
-
-
-    {
-        std::string serialized;
-        ASSERT_FALSE( getline( treeData, serialized ) );
-    }
-}
-
-TEST( KDTREE, DeserializeTreeOnOneNodesTest )
-{
-    TestFileGuard guard( testFile );
-    TestPoints treePoints;
-    {
-        TestPoint p;
-        p.push_back( 1 );
-        treePoints.push_back( p );
-    }
-
-    TestKDTree sampleTree( treePoints );
-    std::cout << sampleTree << std::endl;
-
-    ASSERT_TRUE( sampleTree.serialize( testFile ) );
-
-    TestKDTree deserialized;
-    ASSERT_TRUE( deserialized.deserialize( testFile ) );
-
-    ASSERT_EQ( sampleTree, deserialized );
-}
-
-TEST( KDTREE, SerializeTreeOnTwoNodesTest )
-{
-    TestFileGuard guard( testFile );
-    TestPoints treePoints;
-    {
-        TestPoint p;
-        p.push_back( 1 );
-        treePoints.push_back( p );
-    }
-    {
-        TestPoint p;
-        p.push_back( 2 );
-        treePoints.push_back( p );
-    }
-
-    TestKDTree sampleTree( treePoints );
-    std::cout << sampleTree << std::endl;
-
-    ASSERT_TRUE( sampleTree.serialize( testFile ) );
-
-    std::ifstream treeData( testFile );
-    ASSERT_TRUE( treeData.is_open() );
-
-    {
-        std::string serialized;
-        ASSERT_TRUE( getline( treeData, serialized ) );
-        ASSERT_EQ( Constants::KDTREE_SIMPLE_VARIETY, serialized );
-    }
-    {
-        const std::string expected = "2";
-        std::string serialized;
-        ASSERT_TRUE( getline( treeData, serialized ) );
-        ASSERT_EQ( expected, serialized );
-    }
-    {
-        const std::string expected = "1";
-        std::string serialized;
-        ASSERT_TRUE( getline( treeData, serialized ) );
-        ASSERT_EQ( expected, serialized );
-    }
-    {
-        const std::string expected = "2";
-        std::string serialized;
-        ASSERT_TRUE( getline( treeData, serialized ) );
-        ASSERT_EQ( expected, serialized );
-    }
-
-    {
-        std::string serialized;
-        ASSERT_TRUE( getline( treeData, serialized ) );
-        ASSERT_EQ( Constants::KDTREE_HYPERPLANE_MARKER, serialized );
-    }
-    {
-        const std::string expected = "0 2";
-        std::string serialized;
-        ASSERT_TRUE( getline( treeData, serialized ) );
-        ASSERT_EQ( expected, serialized );
-    }
-    {
-        std::string serialized;
-        ASSERT_TRUE( getline( treeData, serialized ) );
-        ASSERT_EQ( Constants::KDTREE_LEAF_MARKER, serialized );
-    }
-    {
-        const std::string expected = "0";
-        std::string serialized;
-        ASSERT_TRUE( getline( treeData, serialized ) );
-        ASSERT_EQ( expected, serialized );
-    }
-    {
-        std::string serialized;
-        ASSERT_TRUE( getline( treeData, serialized ) );
-        ASSERT_EQ( Constants::KDTREE_LEAF_MARKER, serialized );
-    }
-    {
-        const std::string expected = "1";
-        std::string serialized;
-        ASSERT_TRUE( getline( treeData, serialized ) );
-        ASSERT_EQ( expected, serialized );
-    }
-
-
-
-    {
-        std::string serialized;
-        ASSERT_FALSE( getline( treeData, serialized ) );
-    }
-}
-
-TEST( KDTREE, DeserializeTreeOnTwoNodesTest )
-{
-    TestFileGuard guard( testFile );
-    TestPoints treePoints;
-    {
-        TestPoint p;
-        p.push_back( 1 );
-        treePoints.push_back( p );
-    }
-    {
-        TestPoint p;
-        p.push_back( 2 );
-        treePoints.push_back( p );
-    }
-
-    TestKDTree sampleTree( treePoints );
-    std::cout << sampleTree << std::endl;
-
-    ASSERT_TRUE( sampleTree.serialize( testFile ) );
-
-    TestKDTree deserialized;
-    ASSERT_TRUE( deserialized.deserialize( testFile ) );
-    std::cout << deserialized << std::endl;
-
-    ASSERT_EQ( sampleTree.root()->isLeaf(),
-             deserialized.root()->isLeaf() );
-    ASSERT_EQ( sampleTree.root()->hyperplane(),
-             deserialized.root()->hyperplane() );
-
-    ASSERT_EQ( sampleTree.root()->left()->isLeaf(),
-             deserialized.root()->left()->isLeaf() );
-    ASSERT_EQ( sampleTree.root()->left()->leafPointIndex(),
-             deserialized.root()->left()->leafPointIndex() );
-
-    ASSERT_EQ( sampleTree.root()->right()->isLeaf(),
-             deserialized.root()->right()->isLeaf() );
-    ASSERT_EQ( sampleTree.root()->right()->leafPointIndex(),
-             deserialized.root()->right()->leafPointIndex() );
-
-    ASSERT_EQ( sampleTree, deserialized );
-}
-
-TEST( KDTREE, SerializeTreeOnThreeNodesTest )
-{
-    TestFileGuard guard( testFile );
-    TestPoints treePoints;
-    {
-        TestPoint p;
-        p.push_back( 1 );
-        treePoints.push_back( p );
-    }
-    {
-        TestPoint p;
-        p.push_back( 2 );
-        treePoints.push_back( p );
-    }
-    {
-        TestPoint p;
-        p.push_back( 3 );
-        treePoints.push_back( p );
-    }
-
-    TestKDTree sampleTree( treePoints );
-    std::cout << sampleTree << std::endl;
-
-    ASSERT_TRUE( sampleTree.serialize( testFile ) );
-
-    std::ifstream treeData( testFile );
-    ASSERT_TRUE( treeData.is_open() );
-
-    {
-        std::string serialized;
-        ASSERT_TRUE( getline( treeData, serialized ) );
-        ASSERT_EQ( Constants::KDTREE_SIMPLE_VARIETY, serialized );
-    }
-    {
-        const std::string expected = "3";
-        std::string serialized;
-        ASSERT_TRUE( getline( treeData, serialized ) );
-        ASSERT_EQ( expected, serialized );
-    }
-    {
-        const std::string expected = "1";
-        std::string serialized;
-        ASSERT_TRUE( getline( treeData, serialized ) );
-        ASSERT_EQ( expected, serialized );
-    }
-    {
-        const std::string expected = "2";
-        std::string serialized;
-        ASSERT_TRUE( getline( treeData, serialized ) );
-        ASSERT_EQ( expected, serialized );
-    }
-    {
-        const std::string expected = "3";
-        std::string serialized;
-        ASSERT_TRUE( getline( treeData, serialized ) );
-        ASSERT_EQ( expected, serialized );
-    }
-
-    {
-        std::string serialized;
-        ASSERT_TRUE( getline( treeData, serialized ) );
-        ASSERT_EQ( Constants::KDTREE_HYPERPLANE_MARKER, serialized );
-    }
-    {
-        const std::string expected = "0 2";
-        std::string serialized;
-        ASSERT_TRUE( getline( treeData, serialized ) );
-        ASSERT_EQ( expected, serialized );
-    }
-    {
-        std::string serialized;
-        ASSERT_TRUE( getline( treeData, serialized ) );
-        ASSERT_EQ( Constants::KDTREE_LEAF_MARKER, serialized );
-    }
-    {
-        const std::string expected = "0";
-        std::string serialized;
-        ASSERT_TRUE( getline( treeData, serialized ) );
-        ASSERT_EQ( expected, serialized );
-    }
-
-    {
-        std::string serialized;
-        ASSERT_TRUE( getline( treeData, serialized ) );
-        ASSERT_EQ( Constants::KDTREE_HYPERPLANE_MARKER, serialized );
-    }
-    {
-        const std::string expected = "0 3";
-        std::string serialized;
-        ASSERT_TRUE( getline( treeData, serialized ) );
-        ASSERT_EQ( expected, serialized );
-    }
-
-    {
-        std::string serialized;
-        ASSERT_TRUE( getline( treeData, serialized ) );
-        ASSERT_EQ( Constants::KDTREE_LEAF_MARKER, serialized );
-    }
-    {
-        const std::string expected = "1";
-        std::string serialized;
-        ASSERT_TRUE( getline( treeData, serialized ) );
-        ASSERT_EQ( expected, serialized );
-    }
-
-    {
-        std::string serialized;
-        ASSERT_TRUE( getline( treeData, serialized ) );
-        ASSERT_EQ( Constants::KDTREE_LEAF_MARKER, serialized );
-    }
-    {
-        const std::string expected = "2";
-        std::string serialized;
-        ASSERT_TRUE( getline( treeData, serialized ) );
-        ASSERT_EQ( expected, serialized );
-    }
-
-
-
-
-    {
-        std::string serialized;
-        ASSERT_FALSE( getline( treeData, serialized ) );
-    }
-}
-
-TEST( KDTREE, DeserializeTreeOnThreeNodesTest )
-{
-    //TestFileGuard guard( testFile );
-    TestPoints treePoints;
-    {
-        TestPoint p;
-        p.push_back( 1 );
-        treePoints.push_back( p );
-    }
-    {
-        TestPoint p;
-        p.push_back( 2 );
-        treePoints.push_back( p );
-    }
-    {
-        TestPoint p;
-        p.push_back( 3 );
-        treePoints.push_back( p );
-    }
-
-    TestKDTree sampleTree( treePoints );
-    std::cout << sampleTree << std::endl;
-
-    ASSERT_TRUE( sampleTree.serialize( testFile ) );
-
-    TestKDTree deserialized;
-    ASSERT_TRUE( deserialized.deserialize( testFile ) );
-
-    ASSERT_EQ( sampleTree.root()->isLeaf(),
-             deserialized.root()->isLeaf() );
-    ASSERT_EQ( sampleTree.root()->hyperplane(),
-             deserialized.root()->hyperplane() );
-
-    ASSERT_EQ( sampleTree.root()->left()->isLeaf(),
-             deserialized.root()->left()->isLeaf() );
-    ASSERT_EQ( sampleTree.root()->left()->leafPointIndex(),
-             deserialized.root()->left()->leafPointIndex() );
-
-    ASSERT_EQ( sampleTree.root()->right()->isLeaf(),
-             deserialized.root()->right()->isLeaf() );
-    ASSERT_EQ( sampleTree.root()->right()->hyperplane(),
-             deserialized.root()->right()->hyperplane() );
-
-    ASSERT_EQ( sampleTree.root()->right()->left()->isLeaf(),
-             deserialized.root()->right()->left()->isLeaf() );
-    ASSERT_EQ( sampleTree.root()->right()->left()->leafPointIndex(),
-             deserialized.root()->right()->left()->leafPointIndex() );
-
-    ASSERT_EQ( sampleTree.root()->right()->left()->isLeaf(),
-             deserialized.root()->right()->left()->isLeaf() );
-    ASSERT_EQ( sampleTree.root()->right()->left()->leafPointIndex(),
-             deserialized.root()->right()->left()->leafPointIndex() );
-
-    ASSERT_EQ( sampleTree, deserialized );
-}
-
-TEST( KDTREE, SerializeTreeOnFourNodesTest )
-{
-    TestFileGuard guard( testFile );
-    TestPoints treePoints;
-    {
-        TestPoint p;
-        p.push_back( -6 ); // x
-        p.push_back(  2 ); // x
-        treePoints.push_back( p );
-    }
-    {
-        TestPoint p;
-        p.push_back( -6 ); // x
-        p.push_back( -2 ); // x
-        treePoints.push_back( p );
-    }
-    {
-        TestPoint p;
-        p.push_back( 6 ); // x
-        p.push_back( 4 ); // x
-        treePoints.push_back( p );
-    }
-    {
-        TestPoint p;
-        p.push_back(  6 ); // x
-        p.push_back( -4 ); // x
-        treePoints.push_back( p );
-    }
-
-    TestKDTree sampleTree( treePoints );
-    std::cout << sampleTree << std::endl;
-
-    ASSERT_TRUE( sampleTree.serialize( testFile ) );
-
-    std::ifstream treeData( testFile );
-    ASSERT_TRUE( treeData.is_open() );
-
-    {
-        std::string serialized;
-        ASSERT_TRUE( getline( treeData, serialized ) );
-        ASSERT_EQ( Constants::KDTREE_SIMPLE_VARIETY, serialized );
-    }
-    {
-        const std::string expected = "4";
-        std::string serialized;
-        ASSERT_TRUE( getline( treeData, serialized ) );
-        ASSERT_EQ( expected, serialized );
-    }
-    {
-        const std::string expected = "-6,2";
-        std::string serialized;
-        ASSERT_TRUE( getline( treeData, serialized ) );
-        ASSERT_EQ( expected, serialized );
-    }
-    {
-        const std::string expected = "-6,-2";
-        std::string serialized;
-        ASSERT_TRUE( getline( treeData, serialized ) );
-        ASSERT_EQ( expected, serialized );
-    }
-    {
-        const std::string expected = "6,4";
-        std::string serialized;
-        ASSERT_TRUE( getline( treeData, serialized ) );
-        ASSERT_EQ( expected, serialized );
-    }
-    {
-        const std::string expected = "6,-4";
-        std::string serialized;
-        ASSERT_TRUE( getline( treeData, serialized ) );
-        ASSERT_EQ( expected, serialized );
-    }
-
-    {
-        std::string serialized;
-        ASSERT_TRUE( getline( treeData, serialized ) );
-        ASSERT_EQ( Constants::KDTREE_HYPERPLANE_MARKER, serialized );
-    }
-    {
-        const std::string expected = "0 6";
-        std::string serialized;
-        ASSERT_TRUE( getline( treeData, serialized ) );
-        ASSERT_EQ( expected, serialized );
-    }
-    {
-        std::string serialized;
-        ASSERT_TRUE( getline( treeData, serialized ) );
-        ASSERT_EQ( Constants::KDTREE_HYPERPLANE_MARKER, serialized );
-    }
-    {
-        const std::string expected = "1 2";
-        std::string serialized;
-        ASSERT_TRUE( getline( treeData, serialized ) );
-        ASSERT_EQ( expected, serialized );
-    }
-    {
-        std::string serialized;
-        ASSERT_TRUE( getline( treeData, serialized ) );
-        ASSERT_EQ( Constants::KDTREE_LEAF_MARKER, serialized );
-    }
-    {
-        const std::string expected = "1";
-        std::string serialized;
-        ASSERT_TRUE( getline( treeData, serialized ) );
-        ASSERT_EQ( expected, serialized );
-    }
-    {
-        std::string serialized;
-        ASSERT_TRUE( getline( treeData, serialized ) );
-        ASSERT_EQ( Constants::KDTREE_LEAF_MARKER, serialized );
-    }
-    {
-        const std::string expected = "0";
-        std::string serialized;
-        ASSERT_TRUE( getline( treeData, serialized ) );
-        ASSERT_EQ( expected, serialized );
-    }
-    {
-        std::string serialized;
-        ASSERT_TRUE( getline( treeData, serialized ) );
-        ASSERT_EQ( Constants::KDTREE_HYPERPLANE_MARKER, serialized );
-    }
-    {
-        const std::string expected = "1 4";
-        std::string serialized;
-        ASSERT_TRUE( getline( treeData, serialized ) );
-        ASSERT_EQ( expected, serialized );
-    }
-    {
-        std::string serialized;
-        ASSERT_TRUE( getline( treeData, serialized ) );
-        ASSERT_EQ( Constants::KDTREE_LEAF_MARKER, serialized );
-    }
-    {
-        const std::string expected = "3";
-        std::string serialized;
-        ASSERT_TRUE( getline( treeData, serialized ) );
-        ASSERT_EQ( expected, serialized );
-    }
-    {
-        std::string serialized;
-        ASSERT_TRUE( getline( treeData, serialized ) );
-        ASSERT_EQ( Constants::KDTREE_LEAF_MARKER, serialized );
-    }
-    {
-        const std::string expected = "2";
-        std::string serialized;
-        ASSERT_TRUE( getline( treeData, serialized ) );
-        ASSERT_EQ( expected, serialized );
-    }
-
-
-
-    {
-    std::string serialized;
-    ASSERT_FALSE( getline( treeData, serialized ) );
-    }
-}
-
-TEST( KDTREE, DeserializeTreeOnFourNodesTest )
-{
-    TestFileGuard guard( testFile );
-    TestPoints treePoints;
-    {
-        TestPoint p;
-        p.push_back( -6 ); // x
-        p.push_back(  2 ); // x
-        treePoints.push_back( p );
-    }
-    {
-        TestPoint p;
-        p.push_back( -6 ); // x
-        p.push_back( -2 ); // x
-        treePoints.push_back( p );
-    }
-    {
-        TestPoint p;
-        p.push_back( 6 ); // x
-        p.push_back( 4 ); // x
-        treePoints.push_back( p );
-    }
-    {
-        TestPoint p;
-        p.push_back(  6 ); // x
-        p.push_back( -4 ); // x
-        treePoints.push_back( p );
-    }
-
-    TestKDTree sampleTree( treePoints );
-    std::cout << sampleTree << std::endl;
-
-    ASSERT_TRUE( sampleTree.serialize( testFile ) );
-
-    TestKDTree deserialized;
-    ASSERT_TRUE( deserialized.deserialize( testFile ) );
-
-    ASSERT_EQ( sampleTree.root()->isLeaf(),
-             deserialized.root()->isLeaf() );
-    ASSERT_EQ( sampleTree.root()->hyperplane(),
-             deserialized.root()->hyperplane() );
-
-    ASSERT_EQ( sampleTree.root()->left()->isLeaf(),
-             deserialized.root()->left()->isLeaf() );
-    ASSERT_EQ( sampleTree.root()->left()->hyperplane(),
-             deserialized.root()->left()->hyperplane() );
-
-    ASSERT_EQ( sampleTree.root()->left()->left()->isLeaf(),
-             deserialized.root()->left()->left()->isLeaf() );
-    ASSERT_EQ( sampleTree.root()->left()->left()->leafPointIndex(),
-             deserialized.root()->left()->left()->leafPointIndex() );
-
-    ASSERT_EQ( sampleTree.root()->left()->right()->isLeaf(),
-             deserialized.root()->left()->right()->isLeaf() );
-    ASSERT_EQ( sampleTree.root()->left()->right()->leafPointIndex(),
-             deserialized.root()->left()->right()->leafPointIndex() );
-
-    ASSERT_EQ( sampleTree.root()->right()->isLeaf(),
-             deserialized.root()->right()->isLeaf() );
-    ASSERT_EQ( sampleTree.root()->right()->hyperplane(),
-             deserialized.root()->right()->hyperplane() );
-
-    ASSERT_EQ( sampleTree.root()->right()->left()->isLeaf(),
-             deserialized.root()->right()->left()->isLeaf() );
-    ASSERT_EQ( sampleTree.root()->right()->left()->leafPointIndex(),
-             deserialized.root()->right()->left()->leafPointIndex() );
-
-    ASSERT_EQ( sampleTree.root()->right()->right()->isLeaf(),
-             deserialized.root()->right()->right()->isLeaf() );
-    ASSERT_EQ( sampleTree.root()->right()->right()->leafPointIndex(),
-             deserialized.root()->right()->right()->leafPointIndex() );
-}
-
-TEST( KDTREE, CompleteSanity )
-{
-    TestFileGuard guard( testFile );
-
-    const std::string dataFilename = "data/sample_data.csv";
-    std::ifstream treeData( dataFilename );
-
-    ASSERT_TRUE( treeData.is_open() );
-
-    std::string line;
-    Types::Points< float > treePoints;
-
-    while ( getline ( treeData, line ) )
-    {
-        Types::Point< float > treePoint;
-
-        size_t pos = 0;
-
-        while ( true )
-        {
-            treePoint.push_back( static_cast< float >( stof( line, &pos ) ) );
-
-            if ( line[ pos ] == ',')
-            {
-                line = line.substr( pos + 1u );
-            }
-            else
-            {
-                break;
-            }
-        }
-
-        treePoints.push_back( treePoint );
-    }
-    treeData.close();
-
-    KDTree< float > serializedTree( treePoints );
-    std::cout << serializedTree << std::endl;
-
-    ASSERT_TRUE( serializedTree.serialize( testFile ) );
-
-    KDTree< float > deserializedTree;
-    ASSERT_TRUE( deserializedTree.deserialize( testFile ) );
-    std::cout << deserializedTree << std::endl;
-
-    const std::string queryFilename = "data/query_data.csv";
-    std::ifstream queryData( queryFilename );
-
-    ASSERT_TRUE( queryData.is_open() );
-
-    while ( getline ( queryData, line ) )
-    {
-        Types::Point< float > queryPoint;
-
-        size_t pos = 0;
-        while ( true )
-        {
-            queryPoint.push_back( stof( line, &pos ) );
-
-            if ( line[ pos ] == ',')
-            {
-                line = line.substr( pos + 1u );
-            }
-            else
-            {
-                break;
-            }
-        }
-
-        const size_t bruteIndex =
-                bruteForceClosestIndex( treePoints, queryPoint );
-        const size_t serializedTreeIndex =
-                serializedTree.nearestPointIndex( queryPoint ) ;
-        const size_t deserializedTreeIndex =
-                deserializedTree.nearestPointIndex( queryPoint ) ;
-
-        ASSERT_EQ( bruteIndex, serializedTreeIndex );
-        ASSERT_EQ( bruteIndex, deserializedTreeIndex );
-    }
-
-    queryData.close();
-}
-
+#include <iostream>
+#include <fstream>
+#include <cstdio>
+#include <iterator>
+#include <string>
+#include <type_traits>
+#include <cstdint>
+#include <memory>
+#include <sstream>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "kdtree_types.h"
+#include "kdtree.h"
+#include "kdtree_utils.h"
+#include "kdtree_codec.h"
+#include "kdtree_csv.h"
+
+using namespace datastructures;
+
+namespace {
+
+//////////////////////////////////////////////////////////////////////////////
+// LOCAL TYPES AND DEFINITIONS
+//////////////////////////////////////////////////////////////////////////////
+
+typedef Types::Point< int >   TestPoint;
+typedef Types::Points< int >  TestPoints;
+typedef KDHyperplane< int >   TestHyperplane;
+
+class TestKDTree : public KDTree< int >
+{
+public:
+    TestKDTree()
+            : KDTree< int >()
+    {
+        // nothing to do here
+    }
+
+    TestKDTree( const TestPoints& testPoints )
+            : KDTree< int >( testPoints )
+    {
+        // nothing to do here
+    }
+
+    TestKDTree( const TestPoints& testPoints, const KDTreeOptions& options )
+            : KDTree< int >( testPoints, options )
+    {
+        // nothing to do here
+    }
+
+    virtual const TestHyperplane chooseBestSplit(
+            const Types::Indexes& indexes ) const
+    {
+        return KDTree< int >::chooseBestSplit( indexes );
+    }
+
+    std::shared_ptr< KDNode< int > > root()
+    {
+        return m_root;
+    }
+
+    TestPoints points()
+    {
+        return m_points;
+    }
+};
+
+class OtherTypeKDTree : public KDTree< int >
+{
+public:
+    OtherTypeKDTree()
+            : KDTree< int >( "Other Test KDTree Implementation" )
+            , m_numSplits( 0u )
+    {
+        // nothing to do here
+    }
+
+    virtual const TestHyperplane chooseBestSplit(
+            const Types::Indexes& indexes ) const
+    {
+        ++m_numSplits;
+        return KDTree< int >::chooseBestSplit( indexes );
+    }
+
+    size_t numSplits() const
+    {
+        return m_numSplits;
+    }
+
+    std::shared_ptr< KDNode< int > > root()
+    {
+        return m_root;
+    }
+
+private:
+    mutable size_t m_numSplits;
+};
+
+size_t countingAllocations = 0u;
+
+template< typename T >
+class CountingAllocator : public std::allocator< T >
+{
+public:
+    typedef T value_type;
+
+    template< typename U >
+    struct rebind
+    {
+        typedef CountingAllocator< U > other;
+    };
+
+    CountingAllocator()
+    {
+        // nothing to do here
+    }
+
+    template< typename U >
+    CountingAllocator( const CountingAllocator< U >& )
+    {
+        // nothing to do here
+    }
+
+    T* allocate( const size_t n )
+    {
+        ++countingAllocations;
+        return std::allocator< T >::allocate( n );
+    }
+};
+
+const std::string testFile = "really_long_and_unique_test_file_name_42.txt";
+
+class TestFileGuard
+{
+public:
+    TestFileGuard( const std::string& testFileName )
+    : m_testFileName( testFileName )
+    {
+        // nothing to do here
+    }
+
+    ~TestFileGuard()
+    {
+        std::remove( m_testFileName.c_str() );
+    }
+
+private:
+    std::string   m_testFileName;
+};
+
+//////////////////////////////////////////////////////////////////////////////
+// HELPER FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+std::string serializedStructure( const KDTree< int >& tree )
+{
+    TestFileGuard guard( testFile );
+    if ( !tree.serialize( testFile ) )
+    {
+        return std::string();
+    }
+
+    std::ifstream treeData( testFile );
+    std::string contents;
+    std::string line;
+    while ( getline( treeData, line ) )
+    {
+        contents += line + '\n';
+    }
+
+    return contents;
+}
+
+TestPoint bruteForceClosest( const TestPoints& points,
+                             const TestPoint& pointOfInterest )
+{
+    // Sanity
+    if ( !points.size() )
+    {
+        return TestPoint();
+    }
+
+    typename TestPoints::const_iterator it = points.cbegin();
+    TestPoint closestSoFar = ( *it );
+    double smallestDist = Utils::distance< int >( pointOfInterest, ( *it ) );
+    ++it;
+
+    for (;it != points.cend(); ++it )
+    {
+        const double temp = Utils::distance< int >( pointOfInterest, ( *it ) );
+        if ( temp <= smallestDist )
+        {
+            smallestDist = temp;
+            closestSoFar = ( *it );
+        }
+    }
+
+    return closestSoFar;
+}
+
+size_t bruteForceClosestIndex( const std::vector< Types::Point< float > >& points,
+                               const Types::Point< float >& pointOfInterest )
+{
+    Types::Point< float > closestSoFar = points[ 0 ];
+    double smallestDist = Utils::distance< float >( pointOfInterest, closestSoFar );
+    size_t closestIndex = 0;
+
+    for ( size_t i = 1; i < points.size(); ++i )
+    {
+        const double temp = Utils::distance< float >( pointOfInterest, points[ i ] );
+        if ( temp < smallestDist )
+        {
+            smallestDist = temp;
+            closestSoFar = points[ i ];
+            closestIndex = i;
+        }
+    }
+
+    return closestIndex;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// TEST FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+TEST( Helpers, TestBruteForceClosest )
+{
+    TestPoint p1;
+    p1.push_back( -1 ); // x
+    p1.push_back(  1 ); // y
+
+    TestPoint p2;
+    p2.push_back( 0 ); // x
+    p2.push_back( 1 ); // y
+
+    TestPoint p3;
+    p3.push_back( 1 ); // x
+    p3.push_back( 1 ); // y
+
+    TestPoints points;
+    points.push_back( p1 );
+    points.push_back( p2 );
+    points.push_back( p3 );
+
+    TestPoint pOfInterest;
+    pOfInterest.push_back( 0 ); // x
+    pOfInterest.push_back( 0 ); // y
+
+    ASSERT_EQ( bruteForceClosest( points, pOfInterest ), p2 );
+}
+
+TEST( Helpers, TestBruteForceClosestIndex )
+{
+    Types::Point< float > p1;
+    p1.push_back( -1.0 ); // x
+    p1.push_back(  1.0 ); // y
+
+    Types::Point< float > p2;
+    p2.push_back( 0.0 ); // x
+    p2.push_back( 1.0 ); // y
+
+    Types::Point< float > p3;
+    p3.push_back( 1 ); // x
+    p3.push_back( 1 ); // y
+
+    Types::Points< float > points;
+    points.push_back( p1 );
+    points.push_back( p2 );
+    points.push_back( p3 );
+
+    Types::Point< float > pOfInterest;
+    pOfInterest.push_back( 0.0 ); // x
+    pOfInterest.push_back( 0.0 ); // y
+
+    ASSERT_EQ( bruteForceClosestIndex( points, pOfInterest ), 1u );
+}
+
+TEST( KDTree, TestZero )
+{
+    // initial object
+    TestKDTree zero;
+
+    ASSERT_TRUE( zero == zero );
+    ASSERT_TRUE( !( zero != zero ) );
+    ASSERT_TRUE( zero.equals( zero ) );
+
+    // Empty configs must be equivalent
+    TestKDTree zero2;
+
+    ASSERT_TRUE( zero == zero2 );
+    ASSERT_TRUE( !( zero != zero2 ) );
+    ASSERT_TRUE( zero.equals( zero2 ) );
+
+    // copy of initial object
+    TestKDTree zeroCopy( zero );
+
+    ASSERT_TRUE( zero == zeroCopy );
+    ASSERT_TRUE( !( zero != zeroCopy ) );
+    ASSERT_TRUE( zero.equals( zeroCopy ) );
+
+    // assign of initial object
+    TestKDTree zeroAssign;
+    zeroAssign = zero;
+    ASSERT_TRUE( zero == zeroAssign );
+    ASSERT_TRUE( !( zero != zeroAssign ) );
+    ASSERT_TRUE( zero.equals( zeroAssign ) );
+}
+
+TEST( KDTree, TestUninitializedState )
+{
+    TestKDTree dummyTree;
+    TestPoints dummyPoints;
+
+    ASSERT_EQ( dummyTree.root(),   nullptr );
+    ASSERT_EQ( dummyTree.points(), dummyPoints );
+    ASSERT_EQ( dummyTree.type(),   Constants::KDTREE_SIMPLE_VARIETY );
+
+    std::cout << dummyTree << std::endl;
+}
+
+TEST( KDTree, TreeOnOneNode )
+{
+    TestPoint p1;
+    p1.push_back( 1 );
+    p1.push_back( 2 );
+    p1.push_back( 3 );
+
+    TestPoints sanityPoints;
+    sanityPoints.push_back( p1 );
+
+    TestHyperplane emptyHyperplane;
+
+    TestKDTree sanityTree( sanityPoints );
+
+    std::cout << sanityTree << std::endl;
+    std::cout << *sanityTree.root() << std::endl;
+
+    ASSERT_TRUE( sanityTree.root()->isLeaf() );
+    ASSERT_EQ  ( sanityTree.root()->leafPointIndex(), 0u );
+
+    //ASSERT_EQ  ( sanityTree.root()->leafPoint()     , p1 );
+
+    ASSERT_EQ  ( sanityTree.points()            , sanityPoints );
+    ASSERT_EQ  ( sanityTree.root()->hyperplane(), emptyHyperplane );
+    ASSERT_EQ  ( sanityTree.root()->left()      , nullptr );
+    ASSERT_EQ  ( sanityTree.root()->right()     , nullptr );
+}
+
+TEST( KDTree, TreeOnTwoNodes )
+{
+    TestHyperplane sanityHyperplane( 0u, 1 );
+
+    TestPoint p1;
+    p1.push_back( -1 );
+
+    TestPoint p2;
+    p2.push_back( 1 );
+
+    TestPoints sanityPoints;
+    sanityPoints.push_back( p1 );
+    sanityPoints.push_back( p2 );
+
+    TestKDTree sanityTree( sanityPoints );
+
+    std::cout << sanityTree << std::endl;
+
+    ASSERT_FALSE( sanityTree.root()->isLeaf() );
+    ASSERT_TRUE(  sanityTree.root()->left()  != nullptr );
+    ASSERT_TRUE(  sanityTree.root()->right() != nullptr );
+    ASSERT_EQ(    sanityTree.root()->hyperplane(), sanityHyperplane );
+
+    ASSERT_TRUE(  sanityTree.root()->left()->isLeaf()  );
+    ASSERT_TRUE(  sanityTree.root()->right()->isLeaf() );
+
+    ASSERT_EQ(    sanityTree.root()->left()->leafPointIndex() , 0u );
+    ASSERT_EQ(    sanityTree.root()->right()->leafPointIndex(), 1u );
+
+    //ASSERT_EQ(    sanityTree.root()->left()->leafPoint()      , p1 );
+    //ASSERT_EQ(    sanityTree.root()->right()->leafPoint()     , p2 );
+
+    ASSERT_EQ(    sanityTree.points(), sanityPoints );
+}
+
+TEST( KDTree, TreeOnThreeNodes )
+{
+    TestHyperplane sanityHyperplane1( 0u, 0 );
+    TestHyperplane sanityHyperplane2( 0u, 1 );
+
+    TestPoint p1;
+    p1.push_back( -3 );
+
+    TestPoint p2;
+    p2.push_back( 0 );
+
+    TestPoint p3;
+    p3.push_back( 1 );
+
+    TestPoints sanityPoints;
+    sanityPoints.push_back( p1 );
+    sanityPoints.push_back( p2 );
+    sanityPoints.push_back( p3 );
+
+    TestKDTree sanityTree( sanityPoints );
+    std::cout << sanityTree << std::endl;
+
+    ASSERT_FALSE( sanityTree.root()->isLeaf() );
+    ASSERT_TRUE(  sanityTree.root()->left()  != nullptr );
+    ASSERT_TRUE(  sanityTree.root()->right() != nullptr );
+    ASSERT_EQ(    sanityTree.root()->hyperplane(), sanityHyperplane1 );
+
+    // Left part must be a leaf on "-2"
+    ASSERT_TRUE(  sanityTree.root()->left()->isLeaf() );
+    ASSERT_EQ(    sanityTree.root()->left()->leafPointIndex(), 0u );
+
+    //ASSERT_EQ(    sanityTree.root()->left()->leafPoint(), p1 );
+
+    // Right part must not be a leaf and contain "0", "1"
+    ASSERT_FALSE( sanityTree.root()->right()->isLeaf() );
+    ASSERT_EQ(    sanityTree.root()->right()->hyperplane(),
+                  sanityHyperplane2 );
+
+    ASSERT_EQ(    sanityTree.root()->right()->left()->leafPointIndex() , 1u );
+    ASSERT_EQ(    sanityTree.root()->right()->right()->leafPointIndex(), 2u );
+
+//    ASSERT_EQ(    sanityTree.root()->right()->left()->leafPoint() , p2 );
+//    ASSERT_EQ(    sanityTree.root()->right()->right()->leafPoint(), p3 );
+}
+
+TEST( KDTree, TreeOnFourNodes )
+{
+    TestHyperplane centerHyperplane( 0u, 6 );
+    TestHyperplane leftHyperplane(   1u, 2 );
+    TestHyperplane rightHyperplane(  1u, 4 );
+
+    TestPoint upperLeft;
+    upperLeft.push_back( -6 ); // x
+    upperLeft.push_back(  2 ); // y
+
+    TestPoint bottomLeft;
+    bottomLeft.push_back( -6 ); // x
+    bottomLeft.push_back( -2 ); // y
+
+    TestPoint upperRight;
+    upperRight.push_back( 6 ); // x
+    upperRight.push_back( 4 ); // y
+
+    TestPoint bottomRight;
+    bottomRight.push_back(  6 ); // x
+    bottomRight.push_back( -4 ); // y
+
+    TestPoints sanityPoints;
+    sanityPoints.push_back( upperLeft );
+    sanityPoints.push_back( bottomLeft );
+    sanityPoints.push_back( upperRight );
+    sanityPoints.push_back( bottomRight );
+
+    TestKDTree sanityTree( sanityPoints );
+    std::cout << sanityTree << std::endl;
+
+    // First node must partition on x due to higher [ -6; 6 ] spread
+    ASSERT_FALSE( sanityTree.root()->isLeaf() );
+    ASSERT_TRUE(  sanityTree.root()->left()  != nullptr );
+    ASSERT_TRUE(  sanityTree.root()->right() != nullptr );
+    ASSERT_EQ(    sanityTree.root()->hyperplane(), centerHyperplane );
+
+    // Left node must partition on x due to higher [ -2; 2 ] spread
+    ASSERT_FALSE( sanityTree.root()->left()->isLeaf() );
+    ASSERT_TRUE(  sanityTree.root()->left()->left()  != nullptr );
+    ASSERT_TRUE(  sanityTree.root()->left()->right() != nullptr );
+    ASSERT_EQ(    sanityTree.root()->left()->hyperplane(),
+                      leftHyperplane );
+
+
+    ASSERT_EQ( sanityTree.root()->left()->left()->leafPointIndex(),  1u );
+    ASSERT_EQ( sanityTree.root()->left()->right()->leafPointIndex(), 0u );
+
+//    ASSERT_EQ( sanityTree.root()->left()->left()->leafPoint(),  bottomLeft );
+//    ASSERT_EQ( sanityTree.root()->left()->right()->leafPoint(), upperLeft );
+
+    // Left node must partition on x due to higher [ -4; 4 ] spread
+    ASSERT_FALSE( sanityTree.root()->right()->isLeaf() );
+    ASSERT_TRUE(  sanityTree.root()->right()->left()  != nullptr );
+    ASSERT_TRUE(  sanityTree.root()->right()->right() != nullptr );
+    ASSERT_EQ(    sanityTree.root()->right()->hyperplane(),
+                      rightHyperplane );
+
+    ASSERT_EQ( sanityTree.root()->right()->left()->leafPointIndex(), 3u );
+    ASSERT_EQ( sanityTree.root()->right()->right()->leafPointIndex(),2u );
+
+//    ASSERT_EQ( sanityTree.root()->right()->left()->leafPoint(), bottomRight );
+//    ASSERT_EQ( sanityTree.root()->right()->right()->leafPoint(), upperRight );
+}
+
+TEST( KDTree, SearchOnEmptyTree )
+{
+    TestKDTree sanityTree;
+
+    TestPoint pointOfInterest;
+    pointOfInterest.push_back( 0 );
+
+    ASSERT_EQ( TestPoint(), sanityTree.nearestPoint( pointOfInterest ) );
+}
+
+TEST( KDTree, SearchTreeOnOneNode )
+{
+    TestPoint p1;
+    p1.push_back( 0 );
+
+    TestPoints sanityData;
+    sanityData.push_back( p1 );
+
+    TestKDTree sanityTree( sanityData  );
+    std::cout << sanityTree << std::endl;
+
+    TestPoint pointOfInterest;
+    pointOfInterest.push_back( 1 );
+
+    ASSERT_EQ( p1, sanityTree.nearestPoint( pointOfInterest ) );
+}
+
+TEST( KDTree, SearchTreeOnTwoNodes )
+{
+    TestPoint p1;
+    p1.push_back( -3 );
+
+    TestPoint p2;
+    p2.push_back( 3 );
+
+    TestPoints sanityData;
+    sanityData.push_back( p1 );
+    sanityData.push_back( p2 );
+
+    TestKDTree sanityTree( sanityData  );
+    std::cout << sanityTree << std::endl;
+
+    TestPoint pointOfInterest;
+    pointOfInterest.push_back( 1 );
+
+    ASSERT_EQ( p2, sanityTree.nearestPoint( pointOfInterest ) );
+}
+
+TEST( KDTree, SearchTreeOnThreeNodes )
+{
+    TestPoint p1;
+    p1.push_back( -3 ); // x
+    p1.push_back(  0 ); // y
+
+    TestPoint p2;
+    p2.push_back( 0 ); // x
+    p2.push_back( 0 ); // y
+
+    TestPoint p3;
+    p3.push_back( 4 ); // x
+    p3.push_back( 0 ); // y
+
+    TestPoints sanityPoints;
+    sanityPoints.push_back( p1 );
+    sanityPoints.push_back( p2 );
+    sanityPoints.push_back( p3 );
+
+    TestKDTree sanityTree( sanityPoints );
+    std::cout << sanityTree << std::endl;
+
+    TestPoint pointOfInterest0;
+    pointOfInterest0.push_back( -100 ); // x
+    pointOfInterest0.push_back(  0 );  // y
+    ASSERT_EQ( p1, sanityTree.nearestPoint( pointOfInterest0 ) );
+
+    TestPoint pointOfInterest1;
+    pointOfInterest1.push_back( -5 ); // x
+    pointOfInterest1.push_back(  0 ); // y
+    ASSERT_EQ( p1, sanityTree.nearestPoint( pointOfInterest1 ) );
+
+    TestPoint pointOfInterest2;
+    pointOfInterest2.push_back( -2 ); // x
+    pointOfInterest2.push_back(  0 ); // y
+    ASSERT_EQ( p1, sanityTree.nearestPoint( pointOfInterest2 ) );
+
+    TestPoint pointOfInterest3;
+    pointOfInterest3.push_back( -1 ); // x
+    pointOfInterest3.push_back(  0 ); // y
+    ASSERT_EQ( p2, sanityTree.nearestPoint( pointOfInterest3 ) );
+
+    TestPoint pointOfInterest4;
+    pointOfInterest4.push_back( 0 ); // x
+    pointOfInterest4.push_back( 0 ); // y
+    ASSERT_EQ( p2, sanityTree.nearestPoint( pointOfInterest4 ) );
+
+    TestPoint pointOfInterest5;
+    pointOfInterest5.push_back( 1 ); // x
+    pointOfInterest5.push_back( 0 ); // y
+    ASSERT_EQ( p2, sanityTree.nearestPoint( pointOfInterest5 ) );
+
+    TestPoint pointOfInterest6;
+    pointOfInterest6.push_back( 3 ); // x
+    pointOfInterest6.push_back( 0 ); // y
+    ASSERT_EQ( p3, sanityTree.nearestPoint( pointOfInterest6 ) );
+
+    TestPoint pointOfInterest7;
+    pointOfInterest7.push_back( 5 ); // x
+    pointOfInterest7.push_back( 0 ); // y
+    ASSERT_EQ( p3, sanityTree.nearestPoint( pointOfInterest7 ) );
+
+    TestPoint pointOfInterest8;
+    pointOfInterest8.push_back( 100 ); // x
+    pointOfInterest8.push_back( 0 );   // y
+    ASSERT_EQ( p3, sanityTree.nearestPoint( pointOfInterest8 ) );
+}
+
+TEST( KDTree, StressTest )
+{
+    TestPoint upperLeft;
+    upperLeft.push_back( -11 ); // x
+    upperLeft.push_back(  5 ); // y
+
+    TestPoint bottomLeft;
+    bottomLeft.push_back( -10 ); // x
+    bottomLeft.push_back( -6 ); // y
+
+    TestPoint upperRight;
+    upperRight.push_back( 11 ); // x
+    upperRight.push_back( 6 ); // y
+
+    TestPoint bottomRight;
+    bottomRight.push_back(  12 ); // x
+    bottomRight.push_back( -7 ); // y
+
+    TestPoints sanityPoints;
+    sanityPoints.push_back( upperLeft );
+    sanityPoints.push_back( bottomLeft );
+    sanityPoints.push_back( upperRight );
+    sanityPoints.push_back( bottomRight );
+
+    TestKDTree sanityTree( sanityPoints );
+    std::cout << sanityTree << std::endl;
+
+    std::vector< TestPoint > testPoints;
+    for ( int x = -15; x < 16; ++x )
+    {
+        for ( int y = -10; y < 10; ++y )
+        {
+            TestPoint test;
+            test.push_back( x );
+            test.push_back( y );
+            testPoints.push_back( test );
+        }
+    }
+
+    for ( typename std::vector< TestPoint >::const_iterator it
+              = testPoints.cbegin();
+          it < testPoints.cend(); ++it )
+    {
+        //std::cout << "Checking " << ( *it ) << std::endl;
+
+        TestPoint bruteForcePoint = bruteForceClosest( sanityPoints, ( *it ) );
+        TestPoint treePoint       = sanityTree.nearestPoint( *it );
+
+        ASSERT_EQ( bruteForcePoint, treePoint );
+    }
+}
+
+TEST( KDTree, TiesAndDuplicatePoints )
+{
+    // Median equal to the smallest value on the split axis, and a number of
+    // identical points
+    TestPoints sanityPoints;
+    for ( int i = 0; i < 9; ++i )
+    {
+        TestPoint p;
+        p.push_back( i < 5 ? 0 : 10 ); // x
+        p.push_back( i % 2 );          // y
+        sanityPoints.push_back( p );
+    }
+
+    TestKDTree sanityTree( sanityPoints );
+    ASSERT_TRUE( nullptr != sanityTree.root() );
+
+    for ( int x = -3; x < 14; ++x )
+    {
+        for ( int y = -3; y < 4; ++y )
+        {
+            TestPoint pointOfInterest;
+            pointOfInterest.push_back( x );
+            pointOfInterest.push_back( y );
+
+            ASSERT_EQ( Utils::distance< int >(
+                           bruteForceClosest( sanityPoints, pointOfInterest ),
+                           pointOfInterest ),
+                       Utils::distance< int >(
+                           sanityTree.nearestPoint( pointOfInterest ),
+                           pointOfInterest ) );
+        }
+    }
+}
+
+TEST( KDTree, CopySharesStructure )
+{
+    TestPoints sanityPoints;
+    for ( int i = 0; i < 8; ++i )
+    {
+        TestPoint p;
+        p.push_back( i );     // x
+        p.push_back( i % 3 ); // y
+        sanityPoints.push_back( p );
+    }
+
+    TestKDTree sanityTree( sanityPoints );
+
+    // Same type - structure is shared, not rebuilt
+    TestKDTree copied( sanityTree );
+    ASSERT_EQ( sanityTree, copied );
+    ASSERT_EQ( sanityTree.root(), copied.root() );
+
+    TestKDTree assigned;
+    assigned = sanityTree;
+    ASSERT_EQ( sanityTree, assigned );
+    ASSERT_EQ( sanityTree.root(), assigned.root() );
+
+    // Self assignment is harmless
+    assigned = assigned;
+    ASSERT_EQ( sanityTree.root(), assigned.root() );
+
+    // Different type - structure is rebuilt by the receiving tree
+    OtherTypeKDTree other;
+    other.copy( sanityTree );
+    ASSERT_TRUE( nullptr != other.root() );
+    ASSERT_TRUE( sanityTree.root() != other.root() );
+    ASSERT_EQ( sanityTree.points(), other.points() );
+
+    for ( size_t i = 0; i < sanityPoints.size(); ++i )
+    {
+        ASSERT_EQ( i, other.nearestPointIndex( sanityPoints[ i ] ) );
+    }
+
+    // The rebuild uses the receiving tree's own builder and split policy,
+    // hence its chooseBestSplit(), whatever other was built with
+    KDTreeOptions options;
+    options.builder     = KDTreeOptions::PRESORTED_BUILDER;
+    options.splitPolicy = KDTreeOptions::VARIANCE_MEDIAN;
+    TestKDTree presorted( sanityPoints, options );
+
+    OtherTypeKDTree copiedOther;
+    copiedOther.copy( presorted );
+    ASSERT_EQ( sanityPoints.size() - 1u, copiedOther.numSplits() );
+    ASSERT_EQ( KDTreeOptions::MEDIAN_BUILDER, copiedOther.options().builder );
+    ASSERT_EQ( KDTreeOptions::WIDEST_RANGE_MEDIAN,
+               copiedOther.options().splitPolicy );
+
+    OtherTypeKDTree movedOther;
+    movedOther.transfer( presorted );
+    ASSERT_EQ( sanityPoints.size() - 1u, movedOther.numSplits() );
+    ASSERT_EQ( sanityPoints, movedOther.points() );
+}
+
+TEST( KDTree, MoveTransfersStructure )
+{
+    // Containers of trees move them when they grow
+    ASSERT_TRUE( std::is_nothrow_move_constructible< KDTree< int > >::value );
+    ASSERT_TRUE( std::is_nothrow_move_assignable< KDTree< int > >::value );
+
+    TestPoints sanityPoints;
+    for ( int i = 0; i < 8; ++i )
+    {
+        TestPoint p;
+        p.push_back( i );     // x
+        p.push_back( i % 3 ); // y
+        sanityPoints.push_back( p );
+    }
+
+    TestKDTree sanityTree( sanityPoints );
+    std::shared_ptr< KDNode< int > > root = sanityTree.root();
+
+    TestKDTree moved( std::move( sanityTree ) );
+    ASSERT_EQ( root, moved.root() );
+    ASSERT_EQ( sanityPoints, moved.points() );
+    ASSERT_EQ( nullptr, sanityTree.root() );
+    ASSERT_TRUE( sanityTree.points().empty() );
+
+    TestKDTree assigned;
+    assigned = std::move( moved );
+    ASSERT_EQ( root, assigned.root() );
+    ASSERT_EQ( sanityPoints, assigned.points() );
+    ASSERT_EQ( nullptr, moved.root() );
+
+    // Moved-from tree is a valid empty tree
+    ASSERT_EQ( Constants::KDTREE_ERROR_INDEX,
+               moved.nearestPointIndex( sanityPoints[ 0 ] ) );
+
+    // Points taking constructor
+    TestPoints pointsCopy( sanityPoints );
+    KDTree< int > owning( std::move( pointsCopy ) );
+    ASSERT_EQ( sanityPoints, owning.points() );
+    ASSERT_EQ( 3u, owning.nearestPointIndex( sanityPoints[ 3 ] ) );
+}
+
+TEST( KDTree, ZeroCopyAccessors )
+{
+    TestPoints sanityPoints;
+    for ( int i = 0; i < 6; ++i )
+    {
+        TestPoint p;
+        p.push_back( i * 2 ); // x
+        p.push_back( -i );    // y
+        sanityPoints.push_back( p );
+    }
+
+    KDTree< int > sanityTree( sanityPoints );
+
+    // Views refer to the storage of the tree
+    ASSERT_EQ( sanityPoints.size(), sanityTree.pointsView().size() );
+    ASSERT_EQ( sanityTree.pointsView()[ 3 ].data(),
+               sanityTree.pointAt( 3 ).data() );
+    ASSERT_EQ( sanityPoints[ 3 ], sanityTree.pointAt( 3 ).toPoint() );
+    ASSERT_TRUE( sanityTree.pointAt( sanityPoints.size() ).empty() );
+    ASSERT_TRUE( sanityTree.pointAt(
+                    Constants::KDTREE_ERROR_INDEX ).empty() );
+
+    // Raw buffer queries
+    const int raw[] = { 7, -3 };
+    ASSERT_EQ( 3u, sanityTree.nearestPointIndex( raw, 2u ) );
+    ASSERT_EQ( sanityTree.pointAt( 3 ).data(),
+               sanityTree.nearestPointView( raw, 2u ).data() );
+
+    TestPoint pointOfInterest( raw, raw + 2 );
+    ASSERT_EQ( sanityTree.pointAt( 3 ),
+               sanityTree.nearestPointView( pointOfInterest ) );
+    ASSERT_EQ( sanityPoints[ 3 ], sanityTree.nearestPoint( pointOfInterest ) );
+
+    // Cardinality mismatch
+    ASSERT_EQ( Constants::KDTREE_ERROR_INDEX,
+               sanityTree.nearestPointIndex( raw, 1u ) );
+    ASSERT_TRUE( sanityTree.nearestPointView( raw, 1u ).empty() );
+
+    // Empty tree
+    KDTree< int > emptyTree;
+    ASSERT_TRUE( emptyTree.pointsView().empty() );
+    ASSERT_TRUE( emptyTree.nearestPointView( raw, 2u ).empty() );
+}
+
+TEST( KDTree, ExternalStridedBuffer )
+{
+    TestFileGuard guard( testFile );
+
+    // Two dimensional points padded to a stride of three
+    const size_t numPoints = 7;
+    std::vector< int > buffer;
+    TestPoints sanityPoints;
+    for ( size_t i = 0; i < numPoints; ++i )
+    {
+        TestPoint p;
+        p.push_back( static_cast< int >( i * 3 ) % 5 ); // x
+        p.push_back( static_cast< int >( i ) );         // y
+        sanityPoints.push_back( p );
+
+        buffer.push_back( p[ 0 ] );
+        buffer.push_back( p[ 1 ] );
+        buffer.push_back( -1000 ); // padding, must never be read
+    }
+
+    KDTree< int > external( buffer.data(), numPoints, 2u, 3u );
+    KDTree< int > owning( sanityPoints );
+
+    ASSERT_FALSE( external.ownsPoints() );
+    ASSERT_TRUE(  owning.ownsPoints() );
+    ASSERT_EQ( owning, external );
+    ASSERT_EQ( sanityPoints, external.points() );
+
+    // Points are never copied into the tree
+    for ( size_t i = 0; i < numPoints; ++i )
+    {
+        ASSERT_EQ( buffer.data() + i * 3, external.pointAt( i ).data() );
+    }
+
+    for ( int x = -2; x < 7; ++x )
+    {
+        for ( int y = -2; y < 9; ++y )
+        {
+            TestPoint pointOfInterest;
+            pointOfInterest.push_back( x );
+            pointOfInterest.push_back( y );
+
+            // Ties are resolved differently, compare distances
+            ASSERT_EQ( Utils::distance< int >(
+                           bruteForceClosest( sanityPoints, pointOfInterest ),
+                           pointOfInterest ),
+                       Utils::distance< int >(
+                           external.nearestPoint( pointOfInterest ),
+                           pointOfInterest ) );
+            ASSERT_EQ( owning.nearestPointIndex( pointOfInterest ),
+                       external.nearestPointIndex( pointOfInterest ) );
+        }
+    }
+
+    // Copies keep referring to the caller's buffer
+    KDTree< int > copied( external );
+    ASSERT_FALSE( copied.ownsPoints() );
+    ASSERT_EQ( buffer.data(), copied.pointAt( 0 ).data() );
+
+    // Deserialized trees own their points
+    ASSERT_TRUE( external.serialize( testFile ) );
+
+    KDTree< int > deserialized;
+    ASSERT_TRUE( deserialized.deserialize( testFile ) );
+    ASSERT_TRUE( deserialized.ownsPoints() );
+    ASSERT_EQ( external, deserialized );
+
+    // Invalid buffers produce empty trees
+    KDTree< int > invalid( buffer.data(), numPoints, 3u, 2u );
+    ASSERT_TRUE( invalid.pointsView().empty() );
+}
+
+TEST( KDTree, IndexWidthAndAllocator )
+{
+    TestFileGuard guard( testFile );
+
+    typedef KDTree< int, uint32_t, CountingAllocator< int > > NarrowTree;
+
+    NarrowTree::StoredPoints narrowPoints;
+    TestPoints sanityPoints;
+    for ( int i = 0; i < 16; ++i )
+    {
+        TestPoint p;
+        p.push_back( ( i * 7 ) % 11 ); // x
+        p.push_back( i % 5 );          // y
+        sanityPoints.push_back( p );
+        narrowPoints.push_back(
+                Types::BasicPoint< int, CountingAllocator< int > >(
+                        p.begin(), p.end() ) );
+    }
+
+    ASSERT_EQ( sizeof( uint32_t ),
+               sizeof( NarrowTree::IndexContainer::value_type ) );
+
+    const size_t before = countingAllocations;
+    NarrowTree narrowTree( narrowPoints );
+    ASSERT_TRUE( countingAllocations > before );
+
+    KDTree< int > wideTree( sanityPoints );
+    ASSERT_EQ( sanityPoints, narrowTree.points() );
+
+    for ( int x = -2; x < 13; ++x )
+    {
+        for ( int y = -2; y < 7; ++y )
+        {
+            TestPoint pointOfInterest;
+            pointOfInterest.push_back( x );
+            pointOfInterest.push_back( y );
+
+            ASSERT_EQ( wideTree.nearestPointIndex( pointOfInterest ),
+                       narrowTree.nearestPointIndex( pointOfInterest ) );
+        }
+    }
+
+    // Narrow and wide trees share the serialized format
+    ASSERT_TRUE( narrowTree.serialize( testFile ) );
+
+    KDTree< int > deserialized;
+    ASSERT_TRUE( deserialized.deserialize( testFile ) );
+    ASSERT_EQ( sanityPoints, deserialized.points() );
+
+    NarrowTree narrowDeserialized;
+    ASSERT_TRUE( narrowDeserialized.deserialize( testFile ) );
+    ASSERT_EQ( narrowTree, narrowDeserialized );
+
+    // Error index maps back to KDTREE_ERROR_INDEX
+    NarrowTree emptyTree;
+    ASSERT_EQ( Constants::KDTREE_ERROR_INDEX,
+               emptyTree.nearestPointIndex( sanityPoints[ 0 ] ) );
+}
+
+TEST( KDTree, ArenaNodes )
+{
+    TestFileGuard guard( testFile );
+
+    TestPoints treePoints;
+    for ( int i = 0; i < 64; ++i )
+    {
+        TestPoint p;
+        p.push_back( ( i * 13 ) % 17 ); // x
+        p.push_back( ( i * 5 ) % 9 );   // y
+        treePoints.push_back( p );
+    }
+
+    KDTreeOptions options;
+    options.nodeAllocation = KDTreeOptions::ARENA_NODES;
+
+    KDTree< int > sharedTree( treePoints );
+    std::unique_ptr< KDTree< int > > arenaTree(
+            new KDTree< int >( treePoints, options ) );
+    ASSERT_EQ( options, arenaTree->options() );
+    ASSERT_EQ( KDTreeOptions(), sharedTree.options() );
+
+    // Same structure, same answers
+    ASSERT_EQ( sharedTree, *arenaTree );
+    for ( int x = -2; x < 19; ++x )
+    {
+        for ( int y = -2; y < 11; ++y )
+        {
+            TestPoint pointOfInterest;
+            pointOfInterest.push_back( x );
+            pointOfInterest.push_back( y );
+
+            ASSERT_EQ( sharedTree.nearestPointIndex( pointOfInterest ),
+                       arenaTree->nearestPointIndex( pointOfInterest ) );
+        }
+    }
+
+    // Copies keep the arena alive past the original
+    KDTree< int > copied( *arenaTree );
+    arenaTree.reset();
+    ASSERT_EQ( sharedTree.nearestPointIndex( treePoints[ 7 ] ),
+               copied.nearestPointIndex( treePoints[ 7 ] ) );
+
+    // Serialized format does not depend on node allocation
+    ASSERT_TRUE( copied.serialize( testFile ) );
+
+    KDTree< int > deserialized( options );
+    ASSERT_TRUE( deserialized.deserialize( testFile ) );
+    ASSERT_EQ( options, deserialized.options() );
+    ASSERT_EQ( sharedTree, deserialized );
+    ASSERT_EQ( sharedTree.nearestPointIndex( treePoints[ 42 ] ),
+               deserialized.nearestPointIndex( treePoints[ 42 ] ) );
+
+    // Moving transfers the arena, leaving the source empty
+    KDTree< int > moved( std::move( deserialized ) );
+    ASSERT_EQ( sharedTree, moved );
+    ASSERT_EQ( Constants::KDTREE_ERROR_INDEX,
+               deserialized.nearestPointIndex( treePoints[ 0 ] ) );
+}
+
+TEST( KDTree, VanEmdeBoasLayout )
+{
+    TestFileGuard guard( testFile );
+
+    TestPoints treePoints;
+    for ( int i = 0; i < 8; ++i )
+    {
+        TestPoint p;
+        p.push_back( i );     // x
+        p.push_back( 0 );     // y
+        treePoints.push_back( p );
+    }
+
+    KDTreeOptions options;
+    options.nodeLayout = KDTreeOptions::VAN_EMDE_BOAS_LAYOUT;
+
+    TestKDTree sharedTree( treePoints );
+    TestKDTree vebTree( treePoints, options );
+    ASSERT_EQ( sharedTree, vebTree );
+
+    // 4 levels: top 2 levels first, then four 3-node bottom subtrees
+    const KDNode< int >* root = vebTree.root().get();
+    ASSERT_EQ( root + 1, root->left().get() );
+    ASSERT_EQ( root + 2, root->right().get() );
+    ASSERT_EQ( root + 3, root->left()->left().get() );
+    ASSERT_EQ( root + 4, root->left()->left()->left().get() );
+    ASSERT_EQ( root + 5, root->left()->left()->right().get() );
+    ASSERT_EQ( root + 6, root->left()->right().get() );
+    ASSERT_EQ( root + 9, root->right()->left().get() );
+
+    for ( int x = -1; x < 10; ++x )
+    {
+        TestPoint pointOfInterest;
+        pointOfInterest.push_back( x );
+        pointOfInterest.push_back( 1 );
+
+        ASSERT_EQ( sharedTree.nearestPointIndex( pointOfInterest ),
+                   vebTree.nearestPointIndex( pointOfInterest ) );
+    }
+
+    // Layout survives serialization
+    ASSERT_TRUE( vebTree.serialize( testFile ) );
+
+    KDTree< int > deserialized;
+    ASSERT_TRUE( deserialized.deserialize( testFile ) );
+    ASSERT_EQ( options, deserialized.options() );
+    ASSERT_EQ( sharedTree, deserialized );
+    ASSERT_EQ( sharedTree.nearestPointIndex( treePoints[ 5 ] ),
+               deserialized.nearestPointIndex( treePoints[ 5 ] ) );
+
+    // Build order trees do not write layout
+    ASSERT_TRUE( sharedTree.serialize( testFile ) );
+
+    KDTree< int > buildOrder( options );
+    ASSERT_TRUE( buildOrder.deserialize( testFile ) );
+    ASSERT_EQ( options, buildOrder.options() );
+
+    KDTree< int > plain;
+    ASSERT_TRUE( plain.deserialize( testFile ) );
+    ASSERT_EQ( KDTreeOptions(), plain.options() );
+}
+
+TEST( KDTree, LeafPointOrder )
+{
+    TestFileGuard guard( testFile );
+
+    TestPoints treePoints;
+    for ( int i = 0; i < 32; ++i )
+    {
+        TestPoint p;
+        p.push_back( ( i * 11 ) % 13 ); // x
+        p.push_back( ( i * 3 ) % 7 );   // y
+        treePoints.push_back( p );
+    }
+
+    KDTreeOptions options;
+    options.pointOrder = KDTreeOptions::LEAF_ORDER;
+
+    TestKDTree inputOrder( treePoints );
+    TestKDTree leafOrder( treePoints, options );
+
+    // Indexes and points are reported in input order
+    ASSERT_EQ( inputOrder, leafOrder );
+    ASSERT_EQ( treePoints, leafOrder.KDTree< int >::points() );
+    for ( size_t i = 0; i < treePoints.size(); ++i )
+    {
+        ASSERT_EQ( treePoints[ i ], leafOrder.pointAt( i ).toPoint() );
+    }
+    for ( int x = -1; x < 14; ++x )
+    {
+        for ( int y = -1; y < 8; ++y )
+        {
+            TestPoint pointOfInterest;
+            pointOfInterest.push_back( x );
+            pointOfInterest.push_back( y );
+
+            ASSERT_EQ( inputOrder.nearestPointIndex( pointOfInterest ),
+                       leafOrder.nearestPointIndex( pointOfInterest ) );
+            ASSERT_EQ( inputOrder.nearestPointView( pointOfInterest ),
+                       leafOrder.nearestPointView( pointOfInterest ) );
+        }
+    }
+
+    // Storage follows the leaves left to right
+    std::vector< std::shared_ptr< KDNode< int > > > stack;
+    stack.push_back( leafOrder.root() );
+    size_t expectedIndex = 0;
+    while ( !stack.empty() )
+    {
+        std::shared_ptr< KDNode< int > > node = stack.back();
+        stack.pop_back();
+
+        if ( node->isLeaf() )
+        {
+            ASSERT_EQ( expectedIndex++, node->leafPointIndex() );
+            continue;
+        }
+        stack.push_back( node->right() );
+        stack.push_back( node->left() );
+    }
+    ASSERT_EQ( treePoints.size(), expectedIndex );
+
+    // Files use input order indexes
+    ASSERT_TRUE( leafOrder.serialize( testFile ) );
+
+    KDTree< int > deserialized;
+    ASSERT_TRUE( deserialized.deserialize( testFile ) );
+    ASSERT_EQ( options, deserialized.options() );
+    ASSERT_EQ( inputOrder, deserialized );
+    ASSERT_EQ( inputOrder.nearestPointIndex( treePoints[ 9 ] ),
+               deserialized.nearestPointIndex( treePoints[ 9 ] ) );
+
+    // Copies of a different type rebuild from input order
+    OtherTypeKDTree other;
+    other.copy( leafOrder );
+    ASSERT_EQ( treePoints, other.points() );
+    ASSERT_EQ( inputOrder.nearestPointIndex( treePoints[ 3 ] ),
+               other.nearestPointIndex( treePoints[ 3 ] ) );
+}
+
+TEST( KDTree, ReducedPrecisionPoints )
+{
+    Types::Points< float > treePoints;
+    uint32_t state = 2024u;
+    for ( int i = 0; i < 300; ++i )
+    {
+        Types::Point< float > p;
+        for ( int j = 0; j < 16; ++j )
+        {
+            state = state * 1664525u + 1013904223u;
+            p.push_back( static_cast< float >( state >> 20 ) / 64.0f );
+        }
+        treePoints.push_back( p );
+    }
+
+    KDTree< float > fullTree( treePoints );
+
+    const KDTreeOptions::PointPrecision precisions[] = {
+        KDTreeOptions::BFLOAT16_PRECISION,
+        KDTreeOptions::SCALAR_8_PRECISION
+    };
+    for ( size_t k = 0; k < 2; ++k )
+    {
+        KDTreeOptions options;
+        options.pointPrecision = precisions[ k ];
+
+        KDTree< float > compactTree( treePoints, options );
+        ASSERT_EQ( fullTree, compactTree );
+
+        // Candidates are refined against full precision, results are exact
+        for ( size_t i = 0; i < treePoints.size(); i += 3 )
+        {
+            Types::Point< float > pointOfInterest( treePoints[ i ] );
+            pointOfInterest[ i % 16 ] += 1.5f;
+
+            ASSERT_EQ( fullTree.nearestPointIndex( pointOfInterest ),
+                       compactTree.nearestPointIndex( pointOfInterest ) );
+        }
+
+        KDTree< float > copied( compactTree );
+        ASSERT_EQ( fullTree.nearestPointIndex( treePoints[ 17 ] ),
+                   copied.nearestPointIndex( treePoints[ 17 ] ) );
+    }
+}
+
+TEST( KDTree, PresortedBuilder )
+{
+    KDTreeOptions options;
+    options.builder = KDTreeOptions::PRESORTED_BUILDER;
+
+    // Ties, duplicates and constant axes
+    TestPoints tiedPoints;
+    for ( int i = 0; i < 9; ++i )
+    {
+        TestPoint p;
+        p.push_back( i < 5 ? 0 : 10 ); // x
+        p.push_back( i % 2 );          // y
+        p.push_back( 3 );              // z
+        tiedPoints.push_back( p );
+    }
+
+    TestPoints spreadPoints;
+    for ( int i = 0; i < 257; ++i )
+    {
+        TestPoint p;
+        p.push_back( ( i * 37 ) % 61 ); // x
+        p.push_back( ( i * 13 ) % 29 ); // y
+        p.push_back( ( i * 7 ) % 5 );   // z
+        spreadPoints.push_back( p );
+    }
+
+    const TestPoints* sets[] = { &tiedPoints, &spreadPoints };
+    for ( size_t k = 0; k < 2; ++k )
+    {
+        const TestPoints& treePoints = *sets[ k ];
+
+        KDTree< int > medianTree( treePoints );
+        KDTree< int > presortedTree( treePoints, options );
+
+        // Same structure as the default builder
+        const std::string expected = serializedStructure( medianTree );
+        ASSERT_FALSE( expected.empty() );
+        ASSERT_EQ( expected, serializedStructure( presortedTree ) );
+
+        for ( size_t i = 0; i < treePoints.size(); i += 5 )
+        {
+            ASSERT_EQ( medianTree.nearestPointIndex( treePoints[ i ] ),
+                       presortedTree.nearestPointIndex( treePoints[ i ] ) );
+        }
+    }
+
+    // Single point
+    KDTree< int > single( TestPoints( 1, tiedPoints[ 0 ] ), options );
+    ASSERT_EQ( 0u, single.nearestPointIndex( tiedPoints[ 7 ] ) );
+}
+
+TEST( KDTree, MortonBuilder )
+{
+    KDTreeOptions options;
+    options.builder      = KDTreeOptions::MORTON_BUILDER;
+    options.buildThreads = 4u;
+
+    for ( size_t dimension = 2; dimension < 4; ++dimension )
+    {
+        // Clustered points with duplicates and a constant axis in 3D
+        TestPoints treePoints;
+        for ( int i = 0; i < 500; ++i )
+        {
+            TestPoint p;
+            p.push_back( ( i * 37 ) % 101 + ( i % 3 ? 0 : 1000 ) ); // x
+            p.push_back( ( i * 13 ) % 17 );                         // y
+            if ( dimension == 3 )
+            {
+                p.push_back( 5 );                                   // z
+            }
+            treePoints.push_back( p );
+        }
+
+        KDTree< int > medianTree( treePoints );
+        KDTree< int > mortonTree( treePoints, options );
+        ASSERT_EQ( medianTree, mortonTree );
+
+        for ( int x = -5; x < 1110; x += 7 )
+        {
+            for ( int y = -2; y < 20; y += 3 )
+            {
+                TestPoint pointOfInterest;
+                pointOfInterest.push_back( x );
+                pointOfInterest.push_back( y );
+                if ( dimension == 3 )
+                {
+                    pointOfInterest.push_back( x % 11 );
+                }
+
+                ASSERT_DOUBLE_EQ(
+                    Utils::distance< int >(
+                        treePoints[ medianTree.nearestPointIndex(
+                                            pointOfInterest ) ],
+                        pointOfInterest ),
+                    Utils::distance< int >(
+                        treePoints[ mortonTree.nearestPointIndex(
+                                            pointOfInterest ) ],
+                        pointOfInterest ) );
+            }
+        }
+    }
+
+    // Single point
+    KDTree< int > single( TestPoints( 1, TestPoint( 2, 7 ) ), options );
+    ASSERT_EQ( 0u, single.nearestPointIndex( TestPoint( 2, 0 ) ) );
+}
+
+TEST( KDTree, SplitPolicies )
+{
+    // Two distant clusters with ties and a constant axis
+    TestPoints treePoints;
+    for ( int i = 0; i < 300; ++i )
+    {
+        TestPoint p;
+        p.push_back( ( i * 37 ) % 41 + ( i % 4 ? 0 : 5000 ) ); // x
+        p.push_back( ( i * 13 ) % 7 );                         // y
+        p.push_back( 2 );                                      // z
+        treePoints.push_back( p );
+    }
+
+    const KDTreeOptions::SplitPolicy policies[] = {
+        KDTreeOptions::WIDEST_RANGE_MEDIAN,
+        KDTreeOptions::VARIANCE_MEDIAN,
+        KDTreeOptions::SLIDING_MIDPOINT,
+        KDTreeOptions::COST_MODEL,
+        KDTreeOptions::CYCLIC_MEDIAN
+    };
+
+    for ( size_t k = 0; k < 5; ++k )
+    {
+        KDTreeOptions options;
+        options.splitPolicy = policies[ k ];
+
+        KDTree< int > tree( treePoints, options );
+        ASSERT_EQ( KDTreeOptions::WIDEST_RANGE_MEDIAN == policies[ k ],
+                   Constants::KDTREE_SIMPLE_VARIETY == tree.type() );
+
+        for ( int x = -3; x < 5050; x += 13 )
+        {
+            TestPoint pointOfInterest;
+            pointOfInterest.push_back( x );
+            pointOfInterest.push_back( x % 9 );
+            pointOfInterest.push_back( x % 3 );
+
+            ASSERT_DOUBLE_EQ(
+                Utils::distance< int >(
+                    bruteForceClosest( treePoints, pointOfInterest ),
+                    pointOfInterest ),
+                Utils::distance< int >(
+                    treePoints[ tree.nearestPointIndex( pointOfInterest ) ],
+                    pointOfInterest ) );
+        }
+
+        // Policy survives serialization into a default tree
+        ASSERT_TRUE( tree.serialize( testFile ) );
+
+        KDTree< int > deserialized;
+        ASSERT_TRUE( deserialized.deserialize( testFile ) );
+        ASSERT_EQ( tree.type(), deserialized.type() );
+        ASSERT_EQ( policies[ k ], deserialized.options().splitPolicy );
+        ASSERT_EQ( tree, deserialized );
+
+        // Assignment adopts the policy along with the options
+        KDTree< int > assigned;
+        assigned = tree;
+        ASSERT_EQ( tree.type(), assigned.type() );
+    }
+
+    // Single point
+    KDTreeOptions options;
+    options.splitPolicy = KDTreeOptions::COST_MODEL;
+    KDTree< int > single( TestPoints( 1, treePoints[ 0 ] ), options );
+    ASSERT_EQ( 0u, single.nearestPointIndex( treePoints[ 7 ] ) );
+}
+
+TEST( KDTree, SampledSplits )
+{
+    TestPoints treePoints;
+    for ( int i = 0; i < 5000; ++i )
+    {
+        TestPoint p;
+        p.push_back( ( i * 7919 ) % 1009 ); // x
+        p.push_back( ( i * 131 ) % 97 );    // y
+        p.push_back( i % 3 );               // z
+        treePoints.push_back( p );
+    }
+
+    KDTreeOptions options;
+    options.splitSampleThreshold = 1000u;
+    options.splitSampleSize      = 64u;
+
+    const KDTreeOptions::SplitPolicy policies[] = {
+        KDTreeOptions::WIDEST_RANGE_MEDIAN,
+        KDTreeOptions::SLIDING_MIDPOINT,
+        KDTreeOptions::COST_MODEL
+    };
+
+    for ( size_t k = 0; k < 3; ++k )
+    {
+        options.splitPolicy = policies[ k ];
+        KDTree< int > sampledTree( treePoints, options );
+
+        // Same seed, same tree
+        KDTree< int > sameSeedTree( treePoints, options );
+        ASSERT_EQ( serializedStructure( sampledTree ),
+                   serializedStructure( sameSeedTree ) );
+
+        for ( int x = -7; x < 1020; x += 17 )
+        {
+            TestPoint pointOfInterest;
+            pointOfInterest.push_back( x );
+            pointOfInterest.push_back( x % 101 );
+            pointOfInterest.push_back( 1 );
+
+            ASSERT_DOUBLE_EQ(
+                Utils::distance< int >(
+                    bruteForceClosest( treePoints, pointOfInterest ),
+                    pointOfInterest ),
+                Utils::distance< int >(
+                    treePoints[ sampledTree.nearestPointIndex(
+                                        pointOfInterest ) ],
+                    pointOfInterest ) );
+        }
+    }
+
+    // Sampling does not kick in at or below the threshold
+    options.splitPolicy          = KDTreeOptions::WIDEST_RANGE_MEDIAN;
+    options.splitSampleThreshold = treePoints.size();
+    ASSERT_EQ( serializedStructure( KDTree< int >( treePoints ) ),
+               serializedStructure( KDTree< int >( treePoints, options ) ) );
+}
+
+TEST( KDTree, CompactFormat )
+{
+    // Coordinates that decimal text does not represent exactly
+    Types::Points< double > treePoints;
+    for ( int i = 0; i < 400; ++i )
+    {
+        Types::Point< double > p;
+        p.push_back( ( i * 37 ) % 101 / 3.0 ); // x
+        p.push_back( ( i * 13 ) % 17 + 0.1 );  // y
+        p.push_back( 1.0 / 7.0 );              // z
+        treePoints.push_back( p );
+    }
+
+    KDTreeOptions textOptions;
+    textOptions.nodeLayout  = KDTreeOptions::VAN_EMDE_BOAS_LAYOUT;
+    textOptions.pointOrder  = KDTreeOptions::LEAF_ORDER;
+    textOptions.splitPolicy = KDTreeOptions::VARIANCE_MEDIAN;
+
+    const KDTreeOptions::PointCompression compressions[] = {
+        KDTreeOptions::RAW_POINTS,
+        KDTreeOptions::XOR_DELTA_POINTS,
+        KDTreeOptions::BYTE_SHUFFLE_POINTS
+    };
+
+    for ( size_t k = 0; k < 3; ++k )
+    {
+        KDTreeOptions options( textOptions );
+        options.fileFormat       = KDTreeOptions::COMPACT_FORMAT;
+        options.pointCompression = compressions[ k ];
+
+        KDTree< double > tree( treePoints, options );
+        ASSERT_TRUE( tree.serialize( testFile ) );
+
+        // Recognized by a default tree, coordinates exact
+        KDTree< double > deserialized;
+        ASSERT_TRUE( deserialized.deserialize( testFile ) );
+        ASSERT_EQ( options, deserialized.options() );
+        ASSERT_EQ( tree, deserialized );
+        ASSERT_EQ( treePoints, deserialized.points() );
+
+        for ( size_t i = 0; i < treePoints.size(); i += 7 )
+        {
+            Types::Point< double > pointOfInterest( treePoints[ i ] );
+            pointOfInterest[ 0 ] += 0.01;
+
+            ASSERT_EQ( tree.nearestPointIndex( pointOfInterest ),
+                       deserialized.nearestPointIndex( pointOfInterest ) );
+        }
+
+        // Truncated files are rejected
+        std::string contents;
+        {
+            std::ifstream in( testFile, std::ios::binary );
+            contents.assign( std::istreambuf_iterator< char >( in ),
+                             std::istreambuf_iterator< char >() );
+        }
+        {
+            std::ofstream out( testFile, std::ios::binary | std::ios::trunc );
+            out.write( contents.data(), contents.size() - 1u );
+        }
+        // Leaving the tree, its type and its split policy as they were
+        const KDTree< double > original( treePoints );
+        KDTree< double > truncated( original );
+        ASSERT_FALSE( truncated.deserialize( testFile ) );
+        ASSERT_EQ( original, truncated );
+        ASSERT_EQ( original.type(), truncated.type() );
+        ASSERT_EQ( original.options(), truncated.options() );
+        ASSERT_EQ( 0u, truncated.nearestPointIndex( treePoints[ 0 ] ) );
+    }
+
+    // Coordinates the rest of the file cannot hold are rejected before
+    // they are allocated
+    {
+        const std::string type = KDTree< double >().type();
+        std::ofstream out( testFile, std::ios::binary | std::ios::trunc );
+        out << Constants::KDTREE_COMPACT_MAGIC;
+        KDCodec::writeVarint( out, type.size() );
+        out << type;
+        KDCodec::writeVarint( out, 0u );                  // flags
+        KDCodec::writeVarint( out, KDTreeOptions::RAW_POINTS );
+        KDCodec::writeVarint( out, sizeof( double ) );
+        KDCodec::writeVarint( out, uint64_t( 1u ) << 40 ); // dimension
+        KDCodec::writeVarint( out, 2u );                  // points
+        out << std::string( 64u, '\0' );
+    }
+    KDTree< double > huge;
+    ASSERT_EQ( KDTree< double >::DESERIALIZE_MALFORMED_COMPACT,
+               huge.deserializeWithStatus( testFile ) );
+    ASSERT_TRUE( huge.points().empty() );
+
+    // Smaller than text
+    KDTreeOptions options;
+    options.fileFormat       = KDTreeOptions::COMPACT_FORMAT;
+    options.pointCompression = KDTreeOptions::XOR_DELTA_POINTS;
+
+    TestPoints intPoints;
+    for ( int i = 0; i < 400; ++i )
+    {
+        intPoints.push_back( TestPoint( 3, i ) );
+    }
+
+    const size_t textSize = serializedStructure( KDTree< int >( intPoints ) )
+                                    .size();
+    ASSERT_TRUE( KDTree< int >( intPoints, options ).serialize( testFile ) );
+    std::ifstream compactData( testFile, std::ios::binary | std::ios::ate );
+    ASSERT_GT( textSize / 4u, static_cast< size_t >( compactData.tellg() ) );
+    compactData.close();
+
+    // Empty tree, and a type mismatch
+    ASSERT_TRUE( KDTree< double >( options ).serialize( testFile ) );
+
+    KDTree< double > empty;
+    ASSERT_TRUE( empty.deserialize( testFile ) );
+    ASSERT_TRUE( empty.points().empty() );
+
+    OtherTypeKDTree otherType;
+    ASSERT_FALSE( otherType.deserialize( testFile ) );
+
+    KDTree< float > otherCoordinates;
+    ASSERT_FALSE( otherCoordinates.deserialize( testFile ) );
+
+    std::remove( testFile.c_str() );
+}
+
+TEST( KDTree, CompressedSize )
+{
+    TestFileGuard guard( testFile );
+
+    // Full precision coordinates, no constant columns
+    KDCsvPoints< double > csv;
+    ASSERT_TRUE( csv.load( "data/sample_data.csv" ) );
+
+    const KDTreeOptions::PointCompression compressions[] = {
+        KDTreeOptions::RAW_POINTS,
+        KDTreeOptions::XOR_DELTA_POINTS,
+        KDTreeOptions::BYTE_SHUFFLE_POINTS
+    };
+    const KDTreeOptions::FileFormat formats[] = {
+        KDTreeOptions::COMPACT_FORMAT,
+        KDTreeOptions::CHUNKED_FORMAT
+    };
+
+    for ( size_t f = 0; f < 2; ++f )
+    {
+        size_t sizes[ 3 ];
+        for ( size_t k = 0; k < 3; ++k )
+        {
+            KDTreeOptions options;
+            options.fileFormat       = formats[ f ];
+            options.pointCompression = compressions[ k ];
+            ASSERT_TRUE( KDTree< double >( csv.points(), options )
+                                 .serialize( testFile ) );
+
+            std::ifstream in( testFile, std::ios::binary | std::ios::ate );
+            sizes[ k ] = static_cast< size_t >( in.tellg() );
+            in.close();
+
+            KDTree< double > deserialized;
+            ASSERT_TRUE( deserialized.deserialize( testFile ) );
+            ASSERT_EQ( csv.points(), deserialized.points() );
+        }
+
+        // XOR along the leaves saves over 8% of the file, including the
+        // structure, and more than byte planes do
+        ASSERT_GT( sizes[ 0 ] * 92u, sizes[ 1 ] * 100u );
+        ASSERT_GT( sizes[ 2 ], sizes[ 1 ] );
+    }
+}
+
+TEST( KDTree, ChunkedFormat )
+{
+    TestFileGuard guard( testFile );
+    typedef KDTree< double > Tree;
+
+    // Enough points for more than one point chunk
+    Types::Points< double > treePoints;
+    for ( int i = 0; i < 70000; ++i )
+    {
+        Types::Point< double > p;
+        p.push_back( ( i * 37 ) % 1001 / 3.0 ); // x
+        p.push_back( ( i * 13 ) % 617 + 0.1 );  // y
+        treePoints.push_back( p );
+    }
+
+    KDTreeOptions options;
+    options.fileFormat       = KDTreeOptions::CHUNKED_FORMAT;
+    options.pointCompression = KDTreeOptions::XOR_DELTA_POINTS;
+    options.pointOrder       = KDTreeOptions::LEAF_ORDER;
+    const KDTree< double > tree( treePoints, options );
+
+    // Any chunk depth and number of threads, either node allocation
+    const size_t depths[]  = { 0u, 5u, 64u };
+    const size_t threads[] = { 1u, 3u, 0u };
+    for ( size_t k = 0; k < 3; ++k )
+    {
+        KDTreeOptions writeOptions( options );
+        writeOptions.chunkDepth = depths[ k ];
+        writeOptions.ioThreads  = threads[ k ];
+        const KDTree< double > written( treePoints, writeOptions );
+        ASSERT_TRUE( written.serialize( testFile ) );
+
+        KDTreeOptions readOptions;
+        readOptions.ioThreads      = threads[ 2u - k ];
+        readOptions.nodeAllocation = k % 2u ? KDTreeOptions::ARENA_NODES
+                                            : KDTreeOptions::SHARED_NODES;
+        KDTree< double > deserialized( readOptions );
+        ASSERT_EQ( Tree::DESERIALIZE_SUCCESS,
+                   deserialized.deserializeWithStatus( testFile ) );
+        ASSERT_EQ( tree, deserialized );
+        ASSERT_EQ( treePoints, deserialized.points() );
+        ASSERT_EQ( KDTreeOptions::CHUNKED_FORMAT,
+                   deserialized.options().fileFormat );
+        ASSERT_EQ( KDTreeOptions::LEAF_ORDER,
+                   deserialized.options().pointOrder );
+
+        for ( size_t i = 0; i < treePoints.size(); i += 997 )
+        {
+            Types::Point< double > pointOfInterest( treePoints[ i ] );
+            pointOfInterest[ 1 ] += 0.3;
+
+            ASSERT_EQ( tree.nearestPointIndex( pointOfInterest ),
+                       deserialized.nearestPointIndex( pointOfInterest ) );
+        }
+    }
+
+    // Truncated or corrupted files are rejected, leaving the tree as it was
+    std::string contents;
+    {
+        std::ifstream in( testFile, std::ios::binary );
+        contents.assign( std::istreambuf_iterator< char >( in ),
+                         std::istreambuf_iterator< char >() );
+    }
+
+    const size_t cuts[] = { 12u, contents.size() / 2u, contents.size() - 1u };
+    for ( size_t k = 0; k < 3; ++k )
+    {
+        {
+            std::ofstream out( testFile, std::ios::binary | std::ios::trunc );
+            out.write( contents.data(), cuts[ k ] );
+        }
+
+        KDTree< double > deserialized( tree );
+        ASSERT_EQ( Tree::DESERIALIZE_MALFORMED_CHUNKED,
+                   deserialized.deserializeWithStatus( testFile ) );
+        ASSERT_EQ( tree, deserialized );
+    }
+
+    {
+        std::string corrupted( contents );
+        corrupted[ corrupted.size() - 3u ] ^= 0x55;
+        std::ofstream out( testFile, std::ios::binary | std::ios::trunc );
+        out.write( corrupted.data(), corrupted.size() );
+    }
+    KDTree< double > corrupted;
+    ASSERT_NE( Tree::DESERIALIZE_SUCCESS,
+               corrupted.deserializeWithStatus( testFile ) );
+
+    // A point chunk too small for the dimension of the header is rejected
+    // before it is read
+    {
+        const std::string type = Tree().type();
+        std::ostringstream header;
+        KDCodec::writeVarint( header, type.size() );
+        header << type;
+        KDCodec::writeVarint( header, 0u );                  // flags
+        KDCodec::writeVarint( header, KDTreeOptions::RAW_POINTS );
+        KDCodec::writeVarint( header, sizeof( double ) );
+        KDCodec::writeVarint( header, uint64_t( 1u ) << 40 ); // dimension
+        KDCodec::writeVarint( header, 1u );                  // points
+        KDCodec::writeVarint( header, 1u );                  // chunk points
+        KDCodec::writeVarint( header, 1u );                  // subtrees
+
+        // A single leaf, as both the top and the only subtree
+        std::ostringstream leaf;
+        KDCodec::writeVarint( leaf, 1u );
+        KDCodec::writeBytes( leaf, std::vector< uint8_t >( 1u, 1u ) );
+        KDCodec::writeVarint( leaf, 0u );
+        header << leaf.str();
+        KDCodec::writeVarint( header, 16u );
+        KDCodec::writeVarint( header, leaf.str().size() );
+
+        const uint64_t headerSize = header.str().size();
+        std::ofstream out( testFile, std::ios::binary | std::ios::trunc );
+        out << Constants::KDTREE_CHUNKED_MAGIC;
+        out.write( reinterpret_cast< const char* >( &headerSize ),
+                   sizeof( headerSize ) );
+        out << header.str() << std::string( 16u, '\0' ) << leaf.str();
+    }
+    KDTree< double > huge( tree );
+    ASSERT_EQ( Tree::DESERIALIZE_MALFORMED_CHUNKED,
+               huge.deserializeWithStatus( testFile ) );
+    ASSERT_EQ( tree, huge );
+
+    // Empty and single point trees
+    ASSERT_TRUE( KDTree< double >( options ).serialize( testFile ) );
+    KDTree< double > empty;
+    ASSERT_TRUE( empty.deserialize( testFile ) );
+    ASSERT_TRUE( empty.points().empty() );
+
+    const Types::Points< double > single( 1u, treePoints[ 5 ] );
+    ASSERT_TRUE( KDTree< double >( single, options ).serialize( testFile ) );
+    KDTree< double > one;
+    ASSERT_TRUE( one.deserialize( testFile ) );
+    ASSERT_EQ( single, one.points() );
+    ASSERT_EQ( 0u, one.nearestPointIndex( treePoints[ 9 ] ) );
+
+    // A type mismatch
+    KDTree< float > otherCoordinates;
+    ASSERT_FALSE( otherCoordinates.deserialize( testFile ) );
+}
+
+TEST( KDTREE, DeserializeStatus )
+{
+    TestFileGuard guard( testFile );
+    typedef KDTree< double >          Tree;
+    typedef Types::Point< double >    Point;
+
+    KDTree< double > tree;
+    ASSERT_EQ( Tree::DESERIALIZE_OPEN_FAILED,
+               tree.deserializeWithStatus( testFile ) );
+
+    // A degenerate chain, split after every point
+    const size_t depth = 20000u;
+    {
+        std::ofstream out( testFile );
+        out << tree.type() << '\n' << depth << '\n';
+        for ( size_t i = 0; i < depth; ++i )
+        {
+            out << i << ",1\n";
+        }
+        for ( size_t i = 0; i + 1u < depth; ++i )
+        {
+            out << "HYPERPLANE\n0 " << i << ".5\nLEAF\n" << i << '\n';
+        }
+        out << "LEAF\n" << depth - 1u << "\r\n\n";
+    }
+
+    KDTreeOptions options;
+    options.nodeAllocation = KDTreeOptions::ARENA_NODES;
+    KDTree< double > chain( options );
+    ASSERT_EQ( Tree::DESERIALIZE_SUCCESS,
+               chain.deserializeWithStatus( testFile ) );
+    ASSERT_EQ( depth, chain.points().size() );
+    ASSERT_EQ( 0u,         chain.nearestPointIndex( Point( 2, -3.0 ) ) );
+    ASSERT_EQ( 7777u,      chain.nearestPointIndex( Point( 2, 7777.2 ) ) );
+    ASSERT_EQ( depth - 1u, chain.nearestPointIndex( Point( 2, 1e9 ) ) );
+
+    // Laid out without recursion as well
+    KDTreeOptions vebOptions;
+    vebOptions.nodeLayout = KDTreeOptions::VAN_EMDE_BOAS_LAYOUT;
+    KDTree< double > vebChain( vebOptions );
+    ASSERT_EQ( Tree::DESERIALIZE_SUCCESS,
+               vebChain.deserializeWithStatus( testFile ) );
+    ASSERT_EQ( chain, vebChain );
+    ASSERT_EQ( 7777u, vebChain.nearestPointIndex( Point( 2, 7777.2 ) ) );
+    ASSERT_EQ( vebChain.root().get() + 1, vebChain.root()->left().get() );
+    ASSERT_EQ( vebChain.root().get() + 2, vebChain.root()->right().get() );
+
+    KDTreeOptions leafOptions;
+    leafOptions.pointOrder = KDTreeOptions::LEAF_ORDER;
+    KDTree< double > leafChain( leafOptions );
+    ASSERT_EQ( Tree::DESERIALIZE_SUCCESS,
+               leafChain.deserializeWithStatus( testFile ) );
+    ASSERT_EQ( 7777u, leafChain.nearestPointIndex( Point( 2, 7777.2 ) ) );
+
+    // Malformed files are rejected and leave the tree untouched
+    Types::Points< double > points;
+    for ( int i = 0; i < 3; ++i )
+    {
+        points.push_back( Point( 2, i ) );
+    }
+    KDTree< double > sample( points );
+    const std::string type = sample.type();
+    const std::string structure = "HYPERPLANE\n0 0.5\nLEAF\n0\n"
+                                  "HYPERPLANE\n0 1.5\nLEAF\n1\nLEAF\n2\n";
+
+    const std::pair< std::string, Tree::DeserializeStatus > cases[] = {
+        { "Another KDTree\n3\n",
+          Tree::DESERIALIZE_TYPE_MISMATCH },
+        { type + "\n-3\n",
+          Tree::DESERIALIZE_MALFORMED_COUNT },
+        { type + "\n1000\n0,0\n",
+          Tree::DESERIALIZE_MALFORMED_COUNT },
+        { type + "\n3\n0,0\n1,1\n2\n" + structure,
+          Tree::DESERIALIZE_MALFORMED_POINTS },
+        { type + "\n3\n0,0\n1,x\n2,2\n" + structure,
+          Tree::DESERIALIZE_MALFORMED_POINTS },
+        { type + "\n3\n0,0\n1,1\n2,2\nHYPERPLANE\n2 0.5\n",
+          Tree::DESERIALIZE_MALFORMED_NODE },
+        { type + "\n3\n0,0\n1,1\n2,2\nLEAF\n3\n",
+          Tree::DESERIALIZE_MALFORMED_NODE },
+        { type + "\n3\n0,0\n1,1\n2,2\nBRANCH\n",
+          Tree::DESERIALIZE_MALFORMED_NODE },
+        { type + "\n3\n0,0\n1,1\n2,2\nHYPERPLANE\n0 0.5\nLEAF\n0\n",
+          Tree::DESERIALIZE_MALFORMED_STRUCTURE },
+        { type + "\n3\n0,0\n1,1\n2,2\nHYPERPLANE\n0 0.5\nLEAF\n0\nLEAF\n1\n",
+          Tree::DESERIALIZE_MALFORMED_STRUCTURE },
+        { type + "\n3\n0,0\n1,1\n2,2\nEMPTY TREE\n",
+          Tree::DESERIALIZE_MALFORMED_STRUCTURE },
+        { type + "\n3\n0,0\n1,1\n2,2\n" + structure + "LEAF\n0\n",
+          Tree::DESERIALIZE_MALFORMED_TRAILER },
+        { type + "\n3\n0,0\n1,1\n2,2\n" + structure,
+          Tree::DESERIALIZE_SUCCESS }
+    };
+
+    for ( size_t i = 0; i < sizeof( cases ) / sizeof( cases[ 0 ] ); ++i )
+    {
+        {
+            std::ofstream out( testFile, std::ios::trunc );
+            out << cases[ i ].first;
+        }
+
+        KDTree< double > loaded( sample );
+        ASSERT_EQ( cases[ i ].second, loaded.deserializeWithStatus( testFile ) )
+                << cases[ i ].first;
+        ASSERT_EQ( Tree::DESERIALIZE_SUCCESS == cases[ i ].second,
+                   loaded.deserialize( testFile ) );
+        if ( Tree::DESERIALIZE_SUCCESS != cases[ i ].second )
+        {
+            ASSERT_TRUE( sample == loaded );
+        }
+        else
+        {
+            ASSERT_EQ( points, loaded.points() );
+            ASSERT_EQ( 2u, loaded.nearestPointIndex( Point( 2, 1.8 ) ) );
+        }
+    }
+}
+
+TEST( KDTREE, SerializeEmptyTreeTest )
+{
+    TestFileGuard guard( testFile );
+    TestPoints treePoints;
+
+    TestKDTree sampleTree( treePoints );
+    std::cout << sampleTree << std::endl;
+
+    ASSERT_TRUE( sampleTree.serialize( testFile ) );
+
+    std::ifstream treeData( testFile );
+    ASSERT_TRUE( treeData.is_open() );
+
+    {
+        std::string serialized;
+        ASSERT_TRUE( getline( treeData, serialized ) );
+        ASSERT_EQ( Constants::KDTREE_SIMPLE_VARIETY, serialized );
+    }
+    {
+        const std::string expected1 = "0";
+        std::string serialized1;
+        ASSERT_TRUE( getline( treeData, serialized1 ) );
+        ASSERT_EQ( expected1, serialized1 );
+    }
+    {
+        std::string serialized2;
+        ASSERT_TRUE( getline( treeData, serialized2 ) );
+        ASSERT_EQ( Constants::KDTREE_EMPTY_MARKER, serialized2 );
+    }
+
+    {
+        std::string serialized;
+        ASSERT_FALSE( getline( treeData, serialized ) );
+    }
+}
+
+TEST( KDTREE, DeserializeEmptyTreeTest )
+{
+    TestFileGuard guard( testFile );
+    TestPoints treePoints;
+
+    TestKDTree sampleTree( treePoints );
+    std::cout << sampleTree << std::endl;
+
+    ASSERT_TRUE( sampleTree.serialize( testFile ) );
+
+    TestKDTree deserialized;
+    ASSERT_TRUE( deserialized.deserialize( testFile ) );
+
+    ASSERT_EQ( sampleTree, deserialized );
+}
+
+TEST( KDTREE, SerializeTreeOnOneNodeTest )
+{
+    TestFileGuard guard( testFile );
+    TestPoints treePoints;
+    {
+        TestPoint p;
+        p.push_back( 1 );
+        treePoints.push_back( p );
+    }
+
+    TestKDTree sampleTree( treePoints );
+    std::cout << sampleTree << std::endl;
+
+    ASSERT_TRUE( sampleTree.serialize( testFile ) );
+
+    std::ifstream treeData( testFile );
+    ASSERT_TRUE( treeData.is_open() );
+
+    {
+        std::string serialized;
+        ASSERT_TRUE( getline( treeData, serialized ) );
+        ASSERT_EQ( Constants::KDTREE_SIMPLE_VARIETY, serialized );
+    }
+    {
+        const std::string expected = "1";
+        std::string serialized;
+        ASSERT_TRUE( getline( treeData, serialized ) );
+        ASSERT_EQ( expected, serialized );
+    }
+    {
+        const std::string expected = "1";
+        std::string serialized;
+        ASSERT_TRUE( getline( treeData, serialized ) );
+        ASSERT_EQ( expected, serialized );
+    }
+
+    {
+        std::string serialized;
+        ASSERT_TRUE( getline( treeData, serialized ) );
+        ASSERT_EQ( Constants::KDTREE_LEAF_MARKER, serialized );
+    }
+    {
+        const std::string expected = "0";
+        std::string serialized;
+        ASSERT_TRUE( getline( treeData, serialized ) );
+        ASSERT_EQ( expected, serialized );
+    }
+
+
+
+    {
+        std::string serialized;
+        ASSERT_FALSE( getline( treeData, serialized ) );
+    }
+}
+
+TEST( KDTREE, DeserializeTreeOnOneNodesTest )
+{
+    TestFileGuard guard( testFile );
+    TestPoints treePoints;
+    {
+        TestPoint p;
+        p.push_back( 1 );
+        treePoints.push_back( p );
+    }
+
+    TestKDTree sampleTree( treePoints );
+    std::cout << sampleTree << std::endl;
+
+    ASSERT_TRUE( sampleTree.serialize( testFile ) );
+
+    TestKDTree deserialized;
+    ASSERT_TRUE( deserialized.deserialize( testFile ) );
+
+    ASSERT_EQ( sampleTree, deserialized );
+}
+
+TEST( KDTREE, SerializeTreeOnTwoNodesTest )
+{
+    TestFileGuard guard( testFile );
+    TestPoints treePoints;
+    {
+        TestPoint p;
+        p.push_back( 1 );
+        treePoints.push_back( p );
+    }
+    {
+        TestPoint p;
+        p.push_back( 2 );
+        treePoints.push_back( p );
+    }
+
+    TestKDTree sampleTree( treePoints );
+    std::cout << sampleTree << std::endl;
+
+    ASSERT_TRUE( sampleTree.serialize( testFile ) );
+
+    std::ifstream treeData( testFile );
+    ASSERT_TRUE( treeData.is_open() );
+
+    {
+        std::string serialized;
+        ASSERT_TRUE( getline( treeData, serialized ) );
+        ASSERT_EQ( Constants::KDTREE_SIMPLE_VARIETY, serialized );
+    }
+    {
+        const std::string expected = "2";
+        std::string serialized;
+        ASSERT_TRUE( getline( treeData, serialized ) );
+        ASSERT_EQ( expected, serialized );
+    }
+    {
+        const std::string expected = "1";
+        std::string serialized;
+        ASSERT_TRUE( getline( treeData, serialized ) );
+        ASSERT_EQ( expected, serialized );
+    }
+    {
+        const std::string expected = "2";
+        std::string serialized;
+        ASSERT_TRUE( getline( treeData, serialized ) );
+        ASSERT_EQ( expected, serialized );
+    }
+
+    {
+        std::string serialized;
+        ASSERT_TRUE( getline( treeData, serialized ) );
+        ASSERT_EQ( Constants::KDTREE_HYPERPLANE_MARKER, serialized );
+    }
+    {
+        const std::string expected = "0 2";
+        std::string serialized;
+        ASSERT_TRUE( getline( treeData, serialized ) );
+        ASSERT_EQ( expected, serialized );
+    }
+    {
+        std::string serialized;
+        ASSERT_TRUE( getline( treeData, serialized ) );
+        ASSERT_EQ( Constants::KDTREE_LEAF_MARKER, serialized );
+    }
+    {
+        const std::string expected = "0";
+        std::string serialized;
+        ASSERT_TRUE( getline( treeData, serialized ) );
+        ASSERT_EQ( expected, serialized );
+    }
+    {
+        std::string serialized;
+        ASSERT_TRUE( getline( treeData, serialized ) );
+        ASSERT_EQ( Constants::KDTREE_LEAF_MARKER, serialized );
+    }
+    {
+        const std::string expected = "1";
+        std::string serialized;
+        ASSERT_TRUE( getline( treeData, serialized ) );
+        ASSERT_EQ( expected, serialized );
+    }
+
+
+
+    {
+        std::string serialized;
+        ASSERT_FALSE( getline( treeData, serialized ) );
+    }
+}
+
+TEST( KDTREE, DeserializeTreeOnTwoNodesTest )
+{
+    TestFileGuard guard( testFile );
+    TestPoints treePoints;
+    {
+        TestPoint p;
+        p.push_back( 1 );
+        treePoints.push_back( p );
+    }
+    {
+        TestPoint p;
+        p.push_back( 2 );
+        treePoints.push_back( p );
+    }
+
+    TestKDTree sampleTree( treePoints );
+    std::cout << sampleTree << std::endl;
+
+    ASSERT_TRUE( sampleTree.serialize( testFile ) );
+
+    TestKDTree deserialized;
+    ASSERT_TRUE( deserialized.deserialize( testFile ) );
+    std::cout << deserialized << std::endl;
+
+    ASSERT_EQ( sampleTree.root()->isLeaf(),
+             deserialized.root()->isLeaf() );
+    ASSERT_EQ( sampleTree.root()->hyperplane(),
+             deserialized.root()->hyperplane() );
+
+    ASSERT_EQ( sampleTree.root()->left()->isLeaf(),
+             deserialized.root()->left()->isLeaf() );
+    ASSERT_EQ( sampleTree.root()->left()->leafPointIndex(),
+             deserialized.root()->left()->leafPointIndex() );
+
+    ASSERT_EQ( sampleTree.root()->right()->isLeaf(),
+             deserialized.root()->right()->isLeaf() );
+    ASSERT_EQ( sampleTree.root()->right()->leafPointIndex(),
+             deserialized.root()->right()->leafPointIndex() );
+
+    ASSERT_EQ( sampleTree, deserialized );
+}
+
+TEST( KDTREE, SerializeTreeOnThreeNodesTest )
+{
+    TestFileGuard guard( testFile );
+    TestPoints treePoints;
+    {
+        TestPoint p;
+        p.push_back( 1 );
+        treePoints.push_back( p );
+    }
+    {
+        TestPoint p;
+        p.push_back( 2 );
+        treePoints.push_back( p );
+    }
+    {
+        TestPoint p;
+        p.push_back( 3 );
+        treePoints.push_back( p );
+    }
+
+    TestKDTree sampleTree( treePoints );
+    std::cout << sampleTree << std::endl;
+
+    ASSERT_TRUE( sampleTree.serialize( testFile ) );
+
+    std::ifstream treeData( testFile );
+    ASSERT_TRUE( treeData.is_open() );
+
+    {
+        std::string serialized;
+        ASSERT_TRUE( getline( treeData, serialized ) );
+        ASSERT_EQ( Constants::KDTREE_SIMPLE_VARIETY, serialized );
+    }
+    {
+        const std::string expected = "3";
+        std::string serialized;
+        ASSERT_TRUE( getline( treeData, serialized ) );
+        ASSERT_EQ( expected, serialized );
+    }
+    {
+        const std::string expected = "1";
+        std::string serialized;
+        ASSERT_TRUE( getline( treeData, serialized ) );
+        ASSERT_EQ( expected, serialized );
+    }
+    {
+        const std::string expected = "2";
+        std::string serialized;
+        ASSERT_TRUE( getline( treeData, serialized ) );
+        ASSERT_EQ( expected, serialized );
+    }
+    {
+        const std::string expected = "3";
+        std::string serialized;
+        ASSERT_TRUE( getline( treeData, serialized ) );
+        ASSERT_EQ( expected, serialized );
+    }
+
+    {
+        std::string serialized;
+        ASSERT_TRUE( getline( treeData, serialized ) );
+        ASSERT_EQ( Constants::KDTREE_HYPERPLANE_MARKER, serialized );
+    }
+    {
+        const std::string expected = "0 2";
+        std::string serialized;
+        ASSERT_TRUE( getline( treeData, serialized ) );
+        ASSERT_EQ( expected, serialized );
+    }
+    {
+        std::string serialized;
+        ASSERT_TRUE( getline( treeData, serialized ) );
+        ASSERT_EQ( Constants::KDTREE_LEAF_MARKER, serialized );
+    }
+    {
+        const std::string expected = "0";
+        std::string serialized;
+        ASSERT_TRUE( getline( treeData, serialized ) );
+        ASSERT_EQ( expected, serialized );
+    }
+
+    {
+        std::string serialized;
+        ASSERT_TRUE( getline( treeData, serialized ) );
+        ASSERT_EQ( Constants::KDTREE_HYPERPLANE_MARKER, serialized );
+    }
+    {
+        const std::string expected = "0 3";
+        std::string serialized;
+        ASSERT_TRUE( getline( treeData, serialized ) );
+        ASSERT_EQ( expected, serialized );
+    }
+
+    {
+        std::string serialized;
+        ASSERT_TRUE( getline( treeData, serialized ) );
+        ASSERT_EQ( Constants::KDTREE_LEAF_MARKER, serialized );
+    }
+    {
+        const std::string expected = "1";
+        std::string serialized;
+        ASSERT_TRUE( getline( treeData, serialized ) );
+        ASSERT_EQ( expected, serialized );
+    }
+
+    {
+        std::string serialized;
+        ASSERT_TRUE( getline( treeData, serialized ) );
+        ASSERT_EQ( Constants::KDTREE_LEAF_MARKER, serialized );
+    }
+    {
+        const std::string expected = "2";
+        std::string serialized;
+        ASSERT_TRUE( getline( treeData, serialized ) );
+        ASSERT_EQ( expected, serialized );
+    }
+
+
+
+
+    {
+        std::string serialized;
+        ASSERT_FALSE( getline( treeData, serialized ) );
+    }
+}
+
+TEST( KDTREE, DeserializeTreeOnThreeNodesTest )
+{
+    //TestFileGuard guard( testFile );
+    TestPoints treePoints;
+    {
+        TestPoint p;
+        p.push_back( 1 );
+        treePoints.push_back( p );
+    }
+    {
+        TestPoint p;
+        p.push_back( 2 );
+        treePoints.push_back( p );
+    }
+    {
+        TestPoint p;
+        p.push_back( 3 );
+        treePoints.push_back( p );
+    }
+
+    TestKDTree sampleTree( treePoints );
+    std::cout << sampleTree << std::endl;
+
+    ASSERT_TRUE( sampleTree.serialize( testFile ) );
+
+    TestKDTree deserialized;
+    ASSERT_TRUE( deserialized.deserialize( testFile ) );
+
+    ASSERT_EQ( sampleTree.root()->isLeaf(),
+             deserialized.root()->isLeaf() );
+    ASSERT_EQ( sampleTree.root()->hyperplane(),
+             deserialized.root()->hyperplane() );
+
+    ASSERT_EQ( sampleTree.root()->left()->isLeaf(),
+             deserialized.root()->left()->isLeaf() );
+    ASSERT_EQ( sampleTree.root()->left()->leafPointIndex(),
+             deserialized.root()->left()->leafPointIndex() );
+
+    ASSERT_EQ( sampleTree.root()->right()->isLeaf(),
+             deserialized.root()->right()->isLeaf() );
+    ASSERT_EQ( sampleTree.root()->right()->hyperplane(),
+             deserialized.root()->right()->hyperplane() );
+
+    ASSERT_EQ( sampleTree.root()->right()->left()->isLeaf(),
+             deserialized.root()->right()->left()->isLeaf() );
+    ASSERT_EQ( sampleTree.root()->right()->left()->leafPointIndex(),
+             deserialized.root()->right()->left()->leafPointIndex() );
+
+    ASSERT_EQ( sampleTree.root()->right()->left()->isLeaf(),
+             deserialized.root()->right()->left()->isLeaf() );
+    ASSERT_EQ( sampleTree.root()->right()->left()->leafPointIndex(),
+             deserialized.root()->right()->left()->leafPointIndex() );
+
+    ASSERT_EQ( sampleTree, deserialized );
+}
+
+TEST( KDTREE, SerializeTreeOnFourNodesTest )
+{
+    TestFileGuard guard( testFile );
+    TestPoints treePoints;
+    {
+        TestPoint p;
+        p.push_back( -6 ); // x
+        p.push_back(  2 ); // x
+        treePoints.push_back( p );
+    }
+    {
+        TestPoint p;
+        p.push_back( -6 ); // x
+        p.push_back( -2 ); // x
+        treePoints.push_back( p );
+    }
+    {
+        TestPoint p;
+        p.push_back( 6 ); // x
+        p.push_back( 4 ); // x
+        treePoints.push_back( p );
+    }
+    {
+        TestPoint p;
+        p.push_back(  6 ); // x
+        p.push_back( -4 ); // x
+        treePoints.push_back( p );
+    }
+
+    TestKDTree sampleTree( treePoints );
+    std::cout << sampleTree << std::endl;
+
+    ASSERT_TRUE( sampleTree.serialize( testFile ) );
+
+    std::ifstream treeData( testFile );
+    ASSERT_TRUE( treeData.is_open() );
+
+    {
+        std::string serialized;
+        ASSERT_TRUE( getline( treeData, serialized ) );
+        ASSERT_EQ( Constants::KDTREE_SIMPLE_VARIETY, serialized );
+    }
+    {
+        const std::string expected = "4";
+        std::string serialized;
+        ASSERT_TRUE( getline( treeData, serialized ) );
+        ASSERT_EQ( expected, serialized );
+    }
+    {
+        const std::string expected = "-6,2";
+        std::string serialized;
+        ASSERT_TRUE( getline( treeData, serialized ) );
+        ASSERT_EQ( expected, serialized );
+    }
+    {
+        const std::string expected = "-6,-2";
+        std::string serialized;
+        ASSERT_TRUE( getline( treeData, serialized ) );
+        ASSERT_EQ( expected, serialized );
+    }
+    {
+        const std::string expected = "6,4";
+        std::string serialized;
+        ASSERT_TRUE( getline( treeData, serialized ) );
+        ASSERT_EQ( expected, serialized );
+    }
+    {
+        const std::string expected = "6,-4";
+        std::string serialized;
+        ASSERT_TRUE( getline( treeData, serialized ) );
+        ASSERT_EQ( expected, serialized );
+    }
+
+    {
+        std::string serialized;
+        ASSERT_TRUE( getline( treeData, serialized ) );
+        ASSERT_EQ( Constants::KDTREE_HYPERPLANE_MARKER, serialized );
+    }
+    {
+        const std::string expected = "0 6";
+        std::string serialized;
+        ASSERT_TRUE( getline( treeData, serialized ) );
+        ASSERT_EQ( expected, serialized );
+    }
+    {
+        std::string serialized;
+        ASSERT_TRUE( getline( treeData, serialized ) );
+        ASSERT_EQ( Constants::KDTREE_HYPERPLANE_MARKER, serialized );
+    }
+    {
+        const std::string expected = "1 2";
+        std::string serialized;
+        ASSERT_TRUE( getline( treeData, serialized ) );
+        ASSERT_EQ( expected, serialized );
+    }
+    {
+        std::string serialized;
+        ASSERT_TRUE( getline( treeData, serialized ) );
+        ASSERT_EQ( Constants::KDTREE_LEAF_MARKER, serialized );
+    }
+    {
+        const std::string expected = "1";
+        std::string serialized;
+        ASSERT_TRUE( getline( treeData, serialized ) );
+        ASSERT_EQ( expected, serialized );
+    }
+    {
+        std::string serialized;
+        ASSERT_TRUE( getline( treeData, serialized ) );
+        ASSERT_EQ( Constants::KDTREE_LEAF_MARKER, serialized );
+    }
+    {
+        const std::string expected = "0";
+        std::string serialized;
+        ASSERT_TRUE( getline( treeData, serialized ) );
+        ASSERT_EQ( expected, serialized );
+    }
+    {
+        std::string serialized;
+        ASSERT_TRUE( getline( treeData, serialized ) );
+        ASSERT_EQ( Constants::KDTREE_HYPERPLANE_MARKER, serialized );
+    }
+    {
+        const std::string expected = "1 4";
+        std::string serialized;
+        ASSERT_TRUE( getline( treeData, serialized ) );
+        ASSERT_EQ( expected, serialized );
+    }
+    {
+        std::string serialized;
+        ASSERT_TRUE( getline( treeData, serialized ) );
+        ASSERT_EQ( Constants::KDTREE_LEAF_MARKER, serialized );
+    }
+    {
+        const std::string expected = "3";
+        std::string serialized;
+        ASSERT_TRUE( getline( treeData, serialized ) );
+        ASSERT_EQ( expected, serialized );
+    }
+    {
+        std::string serialized;
+        ASSERT_TRUE( getline( treeData, serialized ) );
+        ASSERT_EQ( Constants::KDTREE_LEAF_MARKER, serialized );
+    }
+    {
+        const std::string expected = "2";
+        std::string serialized;
+        ASSERT_TRUE( getline( treeData, serialized ) );
+        ASSERT_EQ( expected, serialized );
+    }
+
+
+
+    {
+    std::string serialized;
+    ASSERT_FALSE( getline( treeData, serialized ) );
+    }
+}
+
+TEST( KDTREE, DeserializeTreeOnFourNodesTest )
+{
+    TestFileGuard guard( testFile );
+    TestPoints treePoints;
+    {
+        TestPoint p;
+        p.push_back( -6 ); // x
+        p.push_back(  2 ); // x
+        treePoints.push_back( p );
+    }
+    {
+        TestPoint p;
+        p.push_back( -6 ); // x
+        p.push_back( -2 ); // x
+        treePoints.push_back( p );
+    }
+    {
+        TestPoint p;
+        p.push_back( 6 ); // x
+        p.push_back( 4 ); // x
+        treePoints.push_back( p );
+    }
+    {
+        TestPoint p;
+        p.push_back(  6 ); // x
+        p.push_back( -4 ); // x
+        treePoints.push_back( p );
+    }
+
+    TestKDTree sampleTree( treePoints );
+    std::cout << sampleTree << std::endl;
+
+    ASSERT_TRUE( sampleTree.serialize( testFile ) );
+
+    TestKDTree deserialized;
+    ASSERT_TRUE( deserialized.deserialize( testFile ) );
+
+    ASSERT_EQ( sampleTree.root()->isLeaf(),
+             deserialized.root()->isLeaf() );
+    ASSERT_EQ( sampleTree.root()->hyperplane(),
+             deserialized.root()->hyperplane() );
+
+    ASSERT_EQ( sampleTree.root()->left()->isLeaf(),
+             deserialized.root()->left()->isLeaf() );
+    ASSERT_EQ( sampleTree.root()->left()->hyperplane(),
+             deserialized.root()->left()->hyperplane() );
+
+    ASSERT_EQ( sampleTree.root()->left()->left()->isLeaf(),
+             deserialized.root()->left()->left()->isLeaf() );
+    ASSERT_EQ( sampleTree.root()->left()->left()->leafPointIndex(),
+             deserialized.root()->left()->left()->leafPointIndex() );
+
+    ASSERT_EQ( sampleTree.root()->left()->right()->isLeaf(),
+             deserialized.root()->left()->right()->isLeaf() );
+    ASSERT_EQ( sampleTree.root()->left()->right()->leafPointIndex(),
+             deserialized.root()->left()->right()->leafPointIndex() );
+
+    ASSERT_EQ( sampleTree.root()->right()->isLeaf(),
+             deserialized.root()->right()->isLeaf() );
+    ASSERT_EQ( sampleTree.root()->right()->hyperplane(),
+             deserialized.root()->right()->hyperplane() );
+
+    ASSERT_EQ( sampleTree.root()->right()->left()->isLeaf(),
+             deserialized.root()->right()->left()->isLeaf() );
+    ASSERT_EQ( sampleTree.root()->right()->left()->leafPointIndex(),
+             deserialized.root()->right()->left()->leafPointIndex() );
+
+    ASSERT_EQ( sampleTree.root()->right()->right()->isLeaf(),
+             deserialized.root()->right()->right()->isLeaf() );
+    ASSERT_EQ( sampleTree.root()->right()->right()->leafPointIndex(),
+             deserialized.root()->right()->right()->leafPointIndex() );
+}
+
+TEST( KDTREE, CompleteSanity )
+{
+    TestFileGuard guard( testFile );
+
+    const std::string dataFilename = "data/sample_data.csv";
+    std::ifstream treeData( dataFilename );
+
+    ASSERT_TRUE( treeData.is_open() );
+
+    std::string line;
+    Types::Points< float > treePoints;
+
+    while ( getline ( treeData, line ) )
+    {
+        Types::Point< float > treePoint;
+
+        size_t pos = 0;
+
+        while ( true )
+        {
+            treePoint.push_back( static_cast< float >( stof( line, &pos ) ) );
+
+            if ( line[ pos ] == ',')
+            {
+                line = line.substr( pos + 1u );
+            }
+            else
+            {
+                break;
+            }
+        }
+
+        treePoints.push_back( treePoint );
+    }
+    treeData.close();
+
+    KDTree< float > serializedTree( treePoints );
+    std::cout << serializedTree << std::endl;
+
+    ASSERT_TRUE( serializedTree.serialize( testFile ) );
+
+    KDTree< float > deserializedTree;
+    ASSERT_TRUE( deserializedTree.deserialize( testFile ) );
+    std::cout << deserializedTree << std::endl;
+
+    const std::string queryFilename = "data/query_data.csv";
+    std::ifstream queryData( queryFilename );
+
+    ASSERT_TRUE( queryData.is_open() );
+
+    while ( getline ( queryData, line ) )
+    {
+        Types::Point< float > queryPoint;
+
+        size_t pos = 0;
+        while ( true )
+        {
+            queryPoint.push_back( stof( line, &pos ) );
+
+            if ( line[ pos ] == ',')
+            {
+                line = line.substr( pos + 1u );
+            }
+            else
+            {
+                break;
+            }
+        }
+
+        const size_t bruteIndex =
+                bruteForceClosestIndex( treePoints, queryPoint );
+        const size_t serializedTreeIndex =
+                serializedTree.nearestPointIndex( queryPoint ) ;
+        const size_t deserializedTreeIndex =
+                deserializedTree.nearestPointIndex( queryPoint ) ;
+
+        ASSERT_EQ( bruteIndex, serializedTreeIndex );
+        ASSERT_EQ( bruteIndex, deserializedTreeIndex );
+    }
+
+    queryData.close();
+}
+
 } // namespace
\ No newline at end of file
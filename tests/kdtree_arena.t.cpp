@@ -0,0 +1,127 @@
+#include "gtest/gtest.h"
+
+#include "kdtree_arena.h"
+#include "kdtree_options.h"
+
+using namespace datastructures;
+
+namespace {
+
+//////////////////////////////////////////////////////////////////////////////
+// LOCAL TYPES AND DEFINITIONS
+//////////////////////////////////////////////////////////////////////////////
+
+int liveNodes = 0;
+
+class CountedNode
+{
+public:
+    CountedNode( const int value )
+    : m_value( value )
+    {
+        ++liveNodes;
+    }
+
+    ~CountedNode()
+    {
+        --liveNodes;
+    }
+
+    int value() const
+    {
+        return m_value;
+    }
+
+private:
+    int m_value;
+};
+
+typedef KDNodeArena< CountedNode > TestArena;
+
+//////////////////////////////////////////////////////////////////////////////
+// HELPER FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////
+// TEST FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+TEST( KDNodeArena, TestZero )
+{
+    TestArena zero;
+
+    ASSERT_EQ( 0u, zero.size() );
+    ASSERT_EQ( 0u, zero.capacity() );
+    ASSERT_EQ( 0u, zero.numSlabs() );
+
+    zero.reserve( 0u );
+    ASSERT_EQ( 0u, zero.numSlabs() );
+}
+
+TEST( KDNodeArena, ReserveUsesSingleSlab )
+{
+    {
+        TestArena arena( 4u );
+        arena.reserve( 10u );
+        ASSERT_EQ( 1u, arena.numSlabs() );
+        ASSERT_EQ( 10u, arena.capacity() );
+
+        CountedNode* first = arena.create( 0 );
+        for ( int i = 1; i < 10; ++i )
+        {
+            CountedNode* node = arena.create( i );
+
+            // Nodes of a reserved block are contiguous
+            ASSERT_EQ( first + i, node );
+            ASSERT_EQ( i, node->value() );
+        }
+        ASSERT_EQ( 1u, arena.numSlabs() );
+        ASSERT_EQ( 10u, arena.size() );
+        ASSERT_EQ( 10, liveNodes );
+
+        // Running out of room falls back to default sized slabs
+        arena.create( 10 );
+        ASSERT_EQ( 2u, arena.numSlabs() );
+        ASSERT_EQ( 14u, arena.capacity() );
+        ASSERT_EQ( 11, liveNodes );
+    }
+
+    // All the nodes are destroyed together with the arena
+    ASSERT_EQ( 0, liveNodes );
+}
+
+TEST( KDNodeArena, Clear )
+{
+    TestArena arena( 2u );
+    for ( int i = 0; i < 5; ++i )
+    {
+        arena.create( i );
+    }
+    ASSERT_EQ( 3u, arena.numSlabs() );
+    ASSERT_EQ( 5, liveNodes );
+
+    arena.clear();
+    ASSERT_EQ( 0u, arena.size() );
+    ASSERT_EQ( 0u, arena.numSlabs() );
+    ASSERT_EQ( 0, liveNodes );
+
+    // Arena is reusable after clear()
+    ASSERT_EQ( 7, arena.create( 7 )->value() );
+    ASSERT_EQ( 1u, arena.size() );
+}
+
+TEST( KDTreeOptions, Equality )
+{
+    KDTreeOptions shared;
+    ASSERT_EQ( KDTreeOptions::SHARED_NODES, shared.nodeAllocation );
+
+    KDTreeOptions arena;
+    arena.nodeAllocation = KDTreeOptions::ARENA_NODES;
+
+    ASSERT_TRUE( shared == KDTreeOptions() );
+    ASSERT_TRUE( shared != arena );
+
+    std::cout << shared << " " << arena << std::endl;
+}
+
+} // namespace
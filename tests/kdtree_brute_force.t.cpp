@@ -0,0 +1,242 @@
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "kdtree_types.h"
+#include "kdtree_constants.h"
+#include "kdtree_utils.h"
+#include "kdtree_options.h"
+#include "kdtree.h"
+#include "kdtree_brute_force.h"
+
+using namespace datastructures;
+
+namespace {
+
+//////////////////////////////////////////////////////////////////////////////
+// LOCAL TYPES AND DEFINITIONS
+//////////////////////////////////////////////////////////////////////////////
+
+typedef Types::Point< float >       TestPoint;
+typedef Types::Points< float >      TestPoints;
+
+//////////////////////////////////////////////////////////////////////////////
+// HELPER FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+TestPoints randomPoints( const size_t count,
+                         const size_t dimension,
+                         const unsigned seed )
+{
+    std::mt19937 generator( seed );
+    std::uniform_int_distribution< int > coordinate( -50, 50 );
+
+    // Integral coordinates, so that ties are common
+    TestPoints points( count, TestPoint( dimension ) );
+    for ( size_t i = 0; i < count; ++i )
+    {
+        for ( size_t axis = 0; axis < dimension; ++axis )
+        {
+            points[ i ][ axis ] = coordinate( generator ) / 4.0f;
+        }
+    }
+
+    return points;
+}
+
+size_t firstClosestIndex( const TestPoints& points, const TestPoint& query )
+{
+    size_t closest = 0u;
+    for ( size_t i = 1; i < points.size(); ++i )
+    {
+        if ( Utils::distance< float >( points[ i ], query ) <
+             Utils::distance< float >( points[ closest ], query ) )
+        {
+            closest = i;
+        }
+    }
+
+    return closest;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// TEST FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+TEST( KDBruteForce, Empty )
+{
+    const KDBruteForce< float > bruteForce;
+    ASSERT_EQ( 0u, bruteForce.size() );
+    ASSERT_EQ( 0u, bruteForce.dimension() );
+    ASSERT_TRUE( bruteForce.points().empty() );
+
+    const TestPoint query( 2u, 1.0f );
+    ASSERT_EQ( Constants::KDTREE_ERROR_INDEX,
+               bruteForce.nearestPointIndex( query ) );
+    ASSERT_TRUE( bruteForce.nearestPoint( query ).empty() );
+    ASSERT_TRUE( bruteForce.pointAt( 0u ).empty() );
+
+    std::vector< size_t > indexes;
+    bruteForce.nearestPointIndexes( query.data(), 1u, 2u, indexes );
+    ASSERT_EQ( std::vector< size_t >( 1u, Constants::KDTREE_ERROR_INDEX ),
+               indexes );
+}
+
+TEST( KDBruteForce, MatchesTree )
+{
+    // Sizes around the block size, so that the last block is padded
+    const size_t sizes[] = { 1u, 2u, 15u, 16u, 17u, 33u, 500u };
+    for ( size_t s = 0; s < sizeof( sizes ) / sizeof( sizes[ 0 ] ); ++s )
+    {
+        for ( size_t dimension = 1u; dimension <= 5u; dimension += 2u )
+        {
+            const TestPoints points = randomPoints( sizes[ s ], dimension,
+                                                    static_cast< unsigned >(
+                                                    s * 10u + dimension ) );
+            const KDTree< float >       tree( points );
+            const KDBruteForce< float > bruteForce( points );
+            ASSERT_EQ( points.size(), bruteForce.size() );
+            ASSERT_EQ( dimension,     bruteForce.dimension() );
+
+            const TestPoints queries = randomPoints( 200u, dimension, 7u );
+            for ( size_t q = 0; q < queries.size(); ++q )
+            {
+                const size_t index = bruteForce.nearestPointIndex(
+                                             queries[ q ] );
+
+                // Closest point of the lowest index, at the distance the
+                // tree finds
+                ASSERT_EQ( firstClosestIndex( points, queries[ q ] ), index );
+                ASSERT_EQ( Utils::distance< float >(
+                                   tree.nearestPointView( queries[ q ] ),
+                                   KDPointView< float >( queries[ q ] ) ),
+                           Utils::distance< float >(
+                                   KDPointView< float >(
+                                           bruteForce.pointAt( index ) ),
+                                   KDPointView< float >( queries[ q ] ) ) );
+                ASSERT_EQ( points[ index ],
+                           bruteForce.nearestPoint( queries[ q ] ) );
+            }
+        }
+    }
+}
+
+TEST( KDBruteForce, Batches )
+{
+    const TestPoints points  = randomPoints( 1000u, 3u, 11u );
+    const TestPoints queries = randomPoints( 1003u, 3u, 12u );
+
+    std::vector< float > flat;
+    for ( size_t q = 0; q < queries.size(); ++q )
+    {
+        flat.insert( flat.end(), queries[ q ].begin(), queries[ q ].end() );
+    }
+
+    const size_t threads[] = { 1u, 3u, 0u };
+    for ( size_t t = 0; t < sizeof( threads ) / sizeof( threads[ 0 ] ); ++t )
+    {
+        const KDBruteForce< float > bruteForce( points, threads[ t ] );
+        ASSERT_EQ( threads[ t ], bruteForce.numThreads() );
+
+        // Counts that are not multiples of the tile or task sizes
+        const size_t counts[] = { 0u, 1u, 5u, 64u, 65u, queries.size() };
+        for ( size_t c = 0; c < sizeof( counts ) / sizeof( counts[ 0 ] ); ++c )
+        {
+            std::vector< size_t > indexes;
+            bruteForce.nearestPointIndexes( flat.data(), counts[ c ], 3u,
+                                            indexes );
+            ASSERT_EQ( counts[ c ], indexes.size() );
+            for ( size_t q = 0; q < counts[ c ]; ++q )
+            {
+                ASSERT_EQ( bruteForce.nearestPointIndex( queries[ q ] ),
+                           indexes[ q ] );
+            }
+        }
+    }
+}
+
+TEST( KDBruteForce, FlatBuffer )
+{
+    // Every point followed by a coordinate that is not part of it
+    const TestPoints points = randomPoints( 40u, 2u, 21u );
+    std::vector< float > buffer;
+    for ( size_t i = 0; i < points.size(); ++i )
+    {
+        buffer.insert( buffer.end(), points[ i ].begin(), points[ i ].end() );
+        buffer.push_back( 1000.0f );
+    }
+
+    const KDBruteForce< float > strided( buffer.data(), points.size(), 2u,
+                                         3u );
+    const KDBruteForce< float > copied( points );
+    ASSERT_EQ( points,          copied.points() );
+    ASSERT_EQ( copied.points(), strided.points() );
+
+    const TestPoints queries = randomPoints( 50u, 2u, 22u );
+    for ( size_t q = 0; q < queries.size(); ++q )
+    {
+        ASSERT_EQ( copied.nearestPointIndex( queries[ q ] ),
+                   strided.nearestPointIndex( queries[ q ].data(), 2u ) );
+    }
+
+    // Invalid buffers make empty engines
+    ASSERT_EQ( 0u, KDBruteForce< float >( nullptr, 3u, 2u, 2u ).size() );
+    ASSERT_EQ( 0u, KDBruteForce< float >( buffer.data(), 3u, 3u, 2u ).size() );
+}
+
+TEST( KDBruteForce, TreePointsView )
+{
+    // Points as the tree stores them, answers mapped back to input order
+    const TestPoints points  = randomPoints( 500u, 3u, 51u );
+    const TestPoints queries = randomPoints( 100u, 3u, 52u );
+
+    KDTreeOptions options;
+    options.pointOrder = KDTreeOptions::LEAF_ORDER;
+    const KDTree< float > tree( points, options );
+    const KDBruteForce< float > bruteForce( tree.pointsView(), 2u );
+    ASSERT_EQ( points.size(), bruteForce.size() );
+
+    for ( size_t q = 0; q < queries.size(); ++q )
+    {
+        const size_t storage = bruteForce.nearestPointIndex( queries[ q ] );
+        ASSERT_EQ( firstClosestIndex( points, queries[ q ] ),
+                   tree.inputIndex( storage ) );
+        ASSERT_EQ( points[ tree.inputIndex( storage ) ],
+                   bruteForce.pointAt( storage ) );
+    }
+}
+
+TEST( KDBruteForce, CardinalityMismatch )
+{
+    TestPoints points = randomPoints( 10u, 2u, 31u );
+    const KDBruteForce< float > bruteForce( points );
+
+    const TestPoint query( 3u, 0.0f );
+    ASSERT_EQ( Constants::KDTREE_ERROR_INDEX,
+               bruteForce.nearestPointIndex( query ) );
+    ASSERT_TRUE( bruteForce.nearestPoint( query ).empty() );
+
+    std::vector< size_t > indexes;
+    bruteForce.nearestPointIndexes( query.data(), 1u, 3u, indexes );
+    ASSERT_EQ( std::vector< size_t >( 1u, Constants::KDTREE_ERROR_INDEX ),
+               indexes );
+
+    // Points of different cardinality make an empty engine
+    points[ 5 ].push_back( 1.0f );
+    ASSERT_EQ( 0u, KDBruteForce< float >( points ).size() );
+}
+
+TEST( KDBruteForce, Print )
+{
+    const KDBruteForce< float > bruteForce( randomPoints( 3u, 2u, 41u ), 2u );
+
+    std::stringstream text;
+    text << bruteForce;
+    ASSERT_EQ( "KDBruteForce:[ size = 3, dimension = 2, threads = 2 ]",
+               text.str() );
+}
+
+} // namespace
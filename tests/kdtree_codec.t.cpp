@@ -0,0 +1,163 @@
+#include <cstdint>
+#include <limits>
+#include <sstream>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "kdtree_options.h"
+#include "kdtree_codec.h"
+
+using namespace datastructures;
+
+namespace {
+
+//////////////////////////////////////////////////////////////////////////////
+// HELPER FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+template< typename T >
+void roundTrip( const std::vector< T >& values, const size_t stride )
+{
+    const KDTreeOptions::PointCompression compressions[] = {
+        KDTreeOptions::RAW_POINTS,
+        KDTreeOptions::XOR_DELTA_POINTS,
+        KDTreeOptions::BYTE_SHUFFLE_POINTS
+    };
+
+    for ( size_t k = 0; k < 3; ++k )
+    {
+        std::stringstream stream;
+        KDCodec::encodeValues( stream, values, stride, compressions[ k ] );
+
+        std::vector< T > decoded;
+        ASSERT_TRUE( KDCodec::decodeValues( stream, values.size(), stride,
+                                            compressions[ k ], decoded ) );
+        ASSERT_EQ( values, decoded );
+
+        // Truncated streams are detected
+        if ( !values.empty() )
+        {
+            std::string encoded = stream.str();
+            encoded.resize( encoded.size() - 1u );
+
+            std::stringstream truncated( encoded );
+            ASSERT_FALSE( KDCodec::decodeValues( truncated, values.size(),
+                                                 stride, compressions[ k ],
+                                                 decoded ) );
+        }
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// TEST FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+TEST( KDCodec, Varint )
+{
+    const uint64_t values[] = {
+        0u, 1u, 127u, 128u, 300u, 16383u, 16384u,
+        std::numeric_limits< uint64_t >::max()
+    };
+
+    std::stringstream stream;
+    for ( size_t i = 0; i < 8; ++i )
+    {
+        KDCodec::writeVarint( stream, values[ i ] );
+    }
+    ASSERT_EQ( 1u + 1u + 1u + 2u + 2u + 2u + 3u + 10u, stream.str().size() );
+
+    for ( size_t i = 0; i < 8; ++i )
+    {
+        uint64_t value;
+        ASSERT_TRUE( KDCodec::readVarint( stream, value ) );
+        ASSERT_EQ( values[ i ], value );
+    }
+
+    uint64_t value;
+    ASSERT_FALSE( KDCodec::readVarint( stream, value ) );
+
+    // Zigzag keeps small magnitudes small
+    ASSERT_EQ( 0u, KDCodec::zigzag( 0 ) );
+    ASSERT_EQ( 1u, KDCodec::zigzag( -1 ) );
+    ASSERT_EQ( 2u, KDCodec::zigzag( 1 ) );
+    ASSERT_EQ( std::numeric_limits< int64_t >::min(),
+               KDCodec::unzigzag( KDCodec::zigzag(
+                       std::numeric_limits< int64_t >::min() ) ) );
+    ASSERT_EQ( -12345, KDCodec::unzigzag( KDCodec::zigzag( -12345 ) ) );
+}
+
+TEST( KDCodec, Bits )
+{
+    ASSERT_EQ( 0u,  KDCodec::bitsFor( 0u ) );
+    ASSERT_EQ( 1u,  KDCodec::bitsFor( 1u ) );
+    ASSERT_EQ( 2u,  KDCodec::bitsFor( 2u ) );
+    ASSERT_EQ( 2u,  KDCodec::bitsFor( 3u ) );
+    ASSERT_EQ( 64u, KDCodec::bitsFor( std::numeric_limits< uint64_t >::max() ) );
+
+    KDCodec::BitWriter writer;
+    writer.write( 1u, 1u );
+    writer.write( 5u, 3u );
+    writer.write( 0u, 0u );
+    writer.write( 0x1FFu, 9u );
+    ASSERT_EQ( 2u, writer.bytes().size() );
+
+    KDCodec::BitReader reader( writer.bytes() );
+    uint64_t value;
+    ASSERT_TRUE( reader.read( 1u, value ) );
+    ASSERT_EQ( 1u, value );
+    ASSERT_TRUE( reader.read( 3u, value ) );
+    ASSERT_EQ( 5u, value );
+    ASSERT_TRUE( reader.read( 9u, value ) );
+    ASSERT_EQ( 0x1FFu, value );
+    ASSERT_TRUE( reader.read( 3u, value ) );
+    ASSERT_EQ( 0u, value );
+    ASSERT_FALSE( reader.read( 1u, value ) );
+}
+
+TEST( KDCodec, Values )
+{
+    std::vector< double > doubles;
+    std::vector< int >    ints;
+    for ( int i = 0; i < 300; ++i )
+    {
+        doubles.push_back( 1000.0 + i * 0.1 );
+        doubles.push_back( -3.25 );
+        doubles.push_back( i % 2 ? 1e300 : -0.0 );
+
+        ints.push_back( i / 7 );
+        ints.push_back( -i );
+    }
+
+    roundTrip( doubles, 3u );
+    roundTrip( ints, 2u );
+    roundTrip( std::vector< float >(), 1u );
+
+    // Repetitive coordinates shrink
+    std::stringstream raw;
+    std::stringstream xorDelta;
+    std::stringstream shuffled;
+    KDCodec::encodeValues( raw,      doubles, 3u, KDTreeOptions::RAW_POINTS );
+    KDCodec::encodeValues( xorDelta, doubles, 3u,
+                           KDTreeOptions::XOR_DELTA_POINTS );
+    KDCodec::encodeValues( shuffled, doubles, 3u,
+                           KDTreeOptions::BYTE_SHUFFLE_POINTS );
+    ASSERT_EQ( doubles.size() * sizeof( double ), raw.str().size() );
+    ASSERT_GT( raw.str().size(), xorDelta.str().size() );
+    ASSERT_GT( raw.str().size(), shuffled.str().size() );
+
+    // Sign changes cost two control bits per value, not a whole varint
+    std::vector< double > alternating;
+    for ( int i = 0; i < 300; ++i )
+    {
+        alternating.push_back( ( i % 2 ? -1.0 : 1.0 ) * ( 1.0 + i * 0.37 ) );
+    }
+
+    std::stringstream alternatingXor;
+    KDCodec::encodeValues( alternatingXor, alternating, 1u,
+                           KDTreeOptions::XOR_DELTA_POINTS );
+    ASSERT_GE( alternating.size() * ( 8u * sizeof( double ) + 2u ) / 8u + 4u,
+               alternatingXor.str().size() );
+}
+
+} // namespace
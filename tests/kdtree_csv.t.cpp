@@ -0,0 +1,199 @@
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "kdtree_types.h"
+#include "kdtree_csv.h"
+
+using namespace datastructures;
+
+namespace {
+
+//////////////////////////////////////////////////////////////////////////////
+// LOCAL TYPES AND DEFINITIONS
+//////////////////////////////////////////////////////////////////////////////
+
+typedef Types::Point< double >      TestPoint;
+typedef Types::Points< double >     TestPoints;
+
+const std::string csvFile = "really_long_and_unique_csv_file_47.csv";
+
+class TestFileGuard
+{
+public:
+    TestFileGuard( const std::string& testFileName )
+    : m_testFileName( testFileName )
+    {
+        // nothing to do here
+    }
+
+    ~TestFileGuard()
+    {
+        std::remove( m_testFileName.c_str() );
+    }
+
+private:
+    std::string   m_testFileName;
+};
+
+//////////////////////////////////////////////////////////////////////////////
+// HELPER FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+void writeFile( const std::string& fileName, const std::string& contents )
+{
+    std::ofstream fileData( fileName, std::ios::binary | std::ios::trunc );
+    fileData << contents;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// TEST FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+TEST( KDCsvPoints, Parse )
+{
+    TestFileGuard guard( csvFile );
+    KDCsvPoints< double > loader;
+
+    ASSERT_FALSE( loader.load( csvFile ) );
+
+    // Blank lines, white space, Windows line breaks, no final line break
+    writeFile( csvFile, "1.5,2,-3e2\n\n 4 , 5.25,6\r\n7,8,9" );
+    ASSERT_TRUE( loader.load( csvFile ) );
+    ASSERT_FALSE( loader.fromCache() );
+    ASSERT_EQ( 3u, loader.size() );
+    ASSERT_EQ( 3u, loader.dimension() );
+
+    TestPoints expected;
+    expected.push_back( TestPoint( { 1.5, 2.0, -300.0 } ) );
+    expected.push_back( TestPoint( { 4.0, 5.25, 6.0 } ) );
+    expected.push_back( TestPoint( { 7.0, 8.0, 9.0 } ) );
+    ASSERT_EQ( expected, loader.points() );
+    ASSERT_EQ( 5.25, loader.data()[ 4 ] );
+
+    // Empty file
+    writeFile( csvFile, "" );
+    ASSERT_TRUE( loader.load( csvFile ) );
+    ASSERT_EQ( 0u, loader.size() );
+
+    // Malformed files
+    const std::string malformed[] = {
+        "1,2\n3,4,5\n",
+        "1,2\n3,x\n",
+        "1,,2\n",
+        "1,2,\n",
+        "1;2\n"
+    };
+    for ( size_t i = 0; i < sizeof( malformed ) / sizeof( malformed[ 0 ] );
+          ++i )
+    {
+        writeFile( csvFile, malformed[ i ] );
+        ASSERT_FALSE( loader.load( csvFile ) ) << malformed[ i ];
+        ASSERT_EQ( 0u, loader.size() );
+    }
+}
+
+TEST( KDCsvPoints, Cache )
+{
+    const std::string cacheFile = KDCsv::cacheName( csvFile );
+    TestFileGuard guard( csvFile );
+    TestFileGuard cacheGuard( cacheFile );
+
+    std::string contents;
+    for ( int i = 0; i < 1000; ++i )
+    {
+        contents += std::to_string( i / 7.0 ) + "," +
+                    std::to_string( i % 13 ) + "\n";
+    }
+    writeFile( csvFile, contents );
+
+    // Without the cache no sidecar is written
+    KDCsvPoints< double > parsed;
+    ASSERT_TRUE( parsed.load( csvFile ) );
+    ASSERT_FALSE( std::ifstream( cacheFile ).is_open() );
+
+    // The first parse writes the sidecar, later loads map it
+    KDCsvPoints< double > first;
+    ASSERT_TRUE( first.load( csvFile, true ) );
+    ASSERT_FALSE( first.fromCache() );
+    ASSERT_TRUE( std::ifstream( cacheFile ).is_open() );
+
+    KDCsvPoints< double > cached;
+    ASSERT_TRUE( cached.load( csvFile, true ) );
+    ASSERT_TRUE( cached.fromCache() );
+    ASSERT_EQ( 1000u, cached.size() );
+    ASSERT_EQ( 2u,    cached.dimension() );
+    ASSERT_EQ( parsed.points(), cached.points() );
+
+    // Another coordinate type parses again
+    KDCsvPoints< float > floats;
+    ASSERT_TRUE( floats.load( csvFile, true ) );
+    ASSERT_FALSE( floats.fromCache() );
+    ASSERT_TRUE( floats.load( csvFile, true ) );
+    ASSERT_TRUE( floats.fromCache() );
+    ASSERT_EQ( static_cast< float >( parsed.data()[ 7 ] ),
+               floats.data()[ 7 ] );
+
+    // A changed file of the same size parses again
+    contents[ 0 ] = '9';
+    writeFile( csvFile, contents );
+    KDCsvPoints< float > changed;
+    ASSERT_TRUE( changed.load( csvFile, true ) );
+    ASSERT_FALSE( changed.fromCache() );
+    ASSERT_EQ( 9.0f, changed.data()[ 0 ] );
+
+    // A truncated sidecar is ignored and replaced
+    writeFile( cacheFile, "KDCSVC01" );
+    ASSERT_TRUE( changed.load( csvFile, true ) );
+    ASSERT_FALSE( changed.fromCache() );
+    ASSERT_TRUE( changed.load( csvFile, true ) );
+    ASSERT_TRUE( changed.fromCache() );
+}
+
+TEST( KDCsvPoints, ConcurrentCache )
+{
+    const std::string cacheFile = KDCsv::cacheName( csvFile );
+    TestFileGuard guard( csvFile );
+    TestFileGuard cacheGuard( cacheFile );
+
+    std::string contents;
+    for ( int i = 0; i < 5000; ++i )
+    {
+        contents += std::to_string( i ) + "," + std::to_string( -i ) + "\n";
+    }
+    writeFile( csvFile, contents );
+
+    // Runs racing to write the sidecar each write their own temporary file
+    std::vector< std::thread > runs;
+    std::atomic< size_t > succeeded( 0u );
+    for ( size_t r = 0; r < 4u; ++r )
+    {
+        runs.push_back( std::thread( [ & ]()
+        {
+            KDCsvPoints< double > loader;
+            if ( loader.load( csvFile, true ) && ( 5000u == loader.size() ) &&
+                 ( -4999.0 == loader.data()[ 9999 ] ) )
+            {
+                ++succeeded;
+            }
+        } ) );
+    }
+    for ( size_t r = 0; r < runs.size(); ++r )
+    {
+        runs[ r ].join();
+    }
+    ASSERT_EQ( 4u, succeeded );
+
+    KDCsvPoints< double > cached;
+    ASSERT_TRUE( cached.load( csvFile, true ) );
+    ASSERT_TRUE( cached.fromCache() );
+    ASSERT_EQ( 5000u, cached.size() );
+    ASSERT_EQ( -4999.0, cached.data()[ 9999 ] );
+}
+
+} // namespace
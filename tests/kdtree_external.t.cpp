@@ -0,0 +1,269 @@
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "kdtree_types.h"
+#include "kdtree.h"
+#include "kdtree_utils.h"
+#include "kdtree_external.h"
+#include "kdtree_csv.h"
+
+using namespace datastructures;
+
+namespace {
+
+//////////////////////////////////////////////////////////////////////////////
+// LOCAL TYPES AND DEFINITIONS
+//////////////////////////////////////////////////////////////////////////////
+
+typedef Types::Point< double >      TestPoint;
+typedef Types::Points< double >     TestPoints;
+
+const std::string sampleFile   = "really_long_and_unique_sample_file_43.csv";
+const std::string treeFile     = "really_long_and_unique_tree_file_43.txt";
+const std::string expectedFile = "really_long_and_unique_tree_file_44.txt";
+
+class TestFileGuard
+{
+public:
+    TestFileGuard( const std::string& testFileName )
+    : m_testFileName( testFileName )
+    {
+        // nothing to do here
+    }
+
+    ~TestFileGuard()
+    {
+        std::remove( m_testFileName.c_str() );
+    }
+
+private:
+    std::string   m_testFileName;
+};
+
+//////////////////////////////////////////////////////////////////////////////
+// HELPER FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+void writeSample( const TestPoints& points )
+{
+    std::ofstream sampleData( sampleFile );
+    for ( size_t i = 0; i < points.size(); ++i )
+    {
+        sampleData << points[ i ][ 0 ];
+        for ( size_t j = 1; j < points[ i ].size(); ++j )
+        {
+            sampleData << ',' << points[ i ][ j ];
+        }
+        sampleData << '\n';
+    }
+}
+
+std::string contents( const std::string& fileName )
+{
+    std::ifstream fileData( fileName );
+    std::string result;
+    std::string line;
+    while ( getline( fileData, line ) )
+    {
+        result += line + '\n';
+    }
+
+    return result;
+}
+
+TestPoints makePoints( const size_t count )
+{
+    // Clusters, duplicates and a constant axis
+    TestPoints points;
+    for ( size_t i = 0; i < count; ++i )
+    {
+        TestPoint p;
+        p.push_back( static_cast< double >( ( i * 37 ) % 211 +
+                                            ( i % 5 ? 0 : 900 ) ) ); // x
+        p.push_back( static_cast< double >( ( i * 13 ) % 17 ) );     // y
+        p.push_back( 4.0 );                                          // z
+        points.push_back( p );
+    }
+
+    return points;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// TEST FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+TEST( KDExternalBuilder, FitsInMemory )
+{
+    TestFileGuard sampleGuard( sampleFile );
+    TestFileGuard treeGuard( treeFile );
+    TestFileGuard expectedGuard( expectedFile );
+
+    const TestPoints points = makePoints( 500u );
+    writeSample( points );
+
+    // A single partition is the plain KDTree
+    KDExternalBuilder< double > builder( 1u << 30 );
+    ASSERT_TRUE( builder.build( sampleFile, treeFile ) );
+    ASSERT_EQ( 500u, builder.numPoints() );
+    ASSERT_EQ( 1u,   builder.numPartitions() );
+    ASSERT_EQ( 500u, builder.largestPartition() );
+
+    ASSERT_TRUE( KDTree< double >( points ).serialize( expectedFile ) );
+    ASSERT_EQ( contents( expectedFile ), contents( treeFile ) );
+}
+
+TEST( KDExternalBuilder, SplitsOnDisk )
+{
+    TestFileGuard sampleGuard( sampleFile );
+    TestFileGuard treeGuard( treeFile );
+
+    TestPoints points = makePoints( 3000u );
+
+    // Enough duplicates of a single point to exceed the budget on their own
+    for ( size_t i = 0; i < 100u; ++i )
+    {
+        points.push_back( points[ 7 ] );
+    }
+    writeSample( points );
+
+    const size_t budget = 64u * KDExternalBuilder< double >::bytesPerPoint( 3u );
+    KDExternalBuilder< double > builder( budget );
+    ASSERT_TRUE( builder.build( sampleFile, treeFile ) );
+    ASSERT_EQ( points.size(), builder.numPoints() );
+    ASSERT_LT( 1u, builder.numPartitions() );
+    ASSERT_GE( 64u, builder.largestPartition() );
+
+    // No scratch files left behind
+    ASSERT_FALSE( std::ifstream( treeFile + ".scratch.0" ).is_open() );
+
+    KDTree< double > tree;
+    ASSERT_TRUE( tree.deserialize( treeFile ) );
+    ASSERT_EQ( points, tree.points() );
+
+    for ( double x = -5.0; x < 1120.0; x += 9.0 )
+    {
+        TestPoint pointOfInterest;
+        pointOfInterest.push_back( x );
+        pointOfInterest.push_back( static_cast< double >(
+                                           static_cast< int >( x ) % 19 ) );
+        pointOfInterest.push_back( 3.0 );
+
+        double best = Utils::distance( points[ 0 ], pointOfInterest );
+        for ( size_t i = 1; i < points.size(); ++i )
+        {
+            best = std::min( best,
+                             Utils::distance( points[ i ], pointOfInterest ) );
+        }
+
+        ASSERT_DOUBLE_EQ( best, Utils::distance(
+                points[ tree.nearestPointIndex( pointOfInterest ) ],
+                pointOfInterest ) );
+    }
+}
+
+TEST( KDExternalBuilder, DuplicatedAxis )
+{
+    TestFileGuard sampleGuard( sampleFile );
+    TestFileGuard treeGuard( treeFile );
+
+    // Most x values at the minimum, the widest axis: every median sample
+    // lands on the ties
+    TestPoints points;
+    for ( size_t i = 0; i < 4000u; ++i )
+    {
+        TestPoint p;
+        p.push_back( i % 10 < 7 ? 0.0 : static_cast< double >( i % 997 ) );
+        p.push_back( static_cast< double >( ( i * 13 ) % 101 ) );
+        points.push_back( p );
+    }
+    writeSample( points );
+
+    const size_t capacity = 64u;
+    const size_t budget   = capacity *
+                            KDExternalBuilder< double >::bytesPerPoint( 2u );
+    KDExternalBuilder< double > builder( budget );
+    ASSERT_TRUE( builder.build( sampleFile, treeFile ) );
+    ASSERT_GE( capacity, builder.largestPartition() );
+
+    // Splits keep halving the points instead of peeling the largest off
+    ASSERT_GE( 4u * points.size() / capacity, builder.numPartitions() );
+
+    KDTree< double > tree;
+    ASSERT_TRUE( tree.deserialize( treeFile ) );
+    ASSERT_EQ( points, tree.points() );
+
+    for ( size_t i = 0; i < points.size(); i += 41u )
+    {
+        ASSERT_EQ( points[ i ],
+                   points[ tree.nearestPointIndex( points[ i ] ) ] );
+    }
+}
+
+TEST( KDExternalBuilder, InvalidInput )
+{
+    TestFileGuard sampleGuard( sampleFile );
+    TestFileGuard treeGuard( treeFile );
+
+    KDExternalBuilder< double > builder( 1024u );
+    ASSERT_FALSE( builder.build( sampleFile, treeFile ) );
+
+    // Mixed cardinality
+    {
+        std::ofstream sampleData( sampleFile );
+        sampleData << "1,2\n3,4,5\n";
+    }
+    ASSERT_FALSE( builder.build( sampleFile, treeFile ) );
+
+    // Empty sample
+    {
+        std::ofstream sampleData( sampleFile );
+    }
+    ASSERT_TRUE( builder.build( sampleFile, treeFile ) );
+
+    KDTree< double > tree;
+    ASSERT_TRUE( tree.deserialize( treeFile ) );
+    ASSERT_TRUE( tree.points().empty() );
+}
+
+TEST( KDExternalBuilder, SameInputAsInCore )
+{
+    TestFileGuard sampleGuard( sampleFile );
+    TestFileGuard treeGuard( treeFile );
+
+    // Whatever the in-core loader accepts or rejects, so does the builder
+    const std::string samples[] = {
+        "1,2,3\n\n4,5,6\n",
+        "1,2,3\r\n4, 5 ,6\r\n\r\n7,8,9",
+        "\n\n",
+        "1,2,3 x\n4,5,6\n",
+        "1,2,\n",
+        "1,,2\n",
+        "1,2,3\n4,5\n"
+    };
+    for ( size_t i = 0; i < sizeof( samples ) / sizeof( samples[ 0 ] ); ++i )
+    {
+        {
+            std::ofstream sampleData( sampleFile, std::ios::binary );
+            sampleData << samples[ i ];
+        }
+
+        KDCsvPoints< double > csv;
+        const bool loaded = csv.load( sampleFile );
+
+        KDExternalBuilder< double > builder( 1024u );
+        ASSERT_EQ( loaded, builder.build( sampleFile, treeFile ) )
+                << samples[ i ];
+        if ( loaded )
+        {
+            KDTree< double > tree;
+            ASSERT_TRUE( tree.deserialize( treeFile ) );
+            ASSERT_EQ( csv.points(), tree.points() );
+        }
+    }
+}
+
+} // namespace
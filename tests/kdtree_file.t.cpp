@@ -0,0 +1,129 @@
+#include <atomic>
+#include <cstdio>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "kdtree_file.h"
+
+using namespace datastructures;
+
+namespace {
+
+//////////////////////////////////////////////////////////////////////////////
+// LOCAL TYPES AND DEFINITIONS
+//////////////////////////////////////////////////////////////////////////////
+
+const std::string testFile = "really_long_and_unique_file_name_46.bin";
+
+class TestFileGuard
+{
+public:
+    TestFileGuard( const std::string& testFileName )
+    : m_testFileName( testFileName )
+    {
+        // nothing to do here
+    }
+
+    ~TestFileGuard()
+    {
+        std::remove( m_testFileName.c_str() );
+    }
+
+private:
+    std::string   m_testFileName;
+};
+
+//////////////////////////////////////////////////////////////////////////////
+// TEST FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+TEST( KDFile, PositionedIO )
+{
+    TestFileGuard guard( testFile );
+
+    KDFile file;
+    ASSERT_FALSE( file.isOpen() );
+    ASSERT_FALSE( file.open( testFile, KDFile::READ ) );
+    ASSERT_TRUE( file.open( testFile, KDFile::WRITE ) );
+    ASSERT_TRUE( file.resize( 4000u ) );
+    ASSERT_EQ( 4000u, file.size() );
+
+    // Blocks written concurrently, out of order
+    ASSERT_TRUE( KDFile::forEach( 40u, 4u,
+                                  [ & ]( const size_t block )
+                                  {
+                                      const std::string bytes(
+                                              100u, 'a' + block % 26u );
+                                      return file.writeAt(
+                                              ( 39u - block ) * 100u,
+                                              bytes.data(), bytes.size() );
+                                  } ) );
+    file.close();
+    ASSERT_FALSE( file.isOpen() );
+
+    ASSERT_TRUE( file.open( testFile, KDFile::READ ) );
+    ASSERT_EQ( 4000u, file.size() );
+
+    std::string bytes( 150u, '\0' );
+    ASSERT_TRUE( file.readAt( 3850u, &bytes[ 0 ], bytes.size() ) );
+    ASSERT_EQ( std::string( 50u, 'b' ) + std::string( 100u, 'a' ), bytes );
+
+    // Past the end of the file
+    ASSERT_FALSE( file.readAt( 3900u, &bytes[ 0 ], bytes.size() ) );
+}
+
+TEST( KDFile, ForEach )
+{
+    // Every task runs exactly once, whatever the number of threads
+    for ( size_t threads = 0; threads < 6u; ++threads )
+    {
+        std::vector< std::atomic< int > > calls( 1000u );
+        for ( size_t i = 0; i < calls.size(); ++i )
+        {
+            calls[ i ] = 0;
+        }
+
+        ASSERT_TRUE( KDFile::forEach( calls.size(), threads,
+                                      [ & ]( const size_t task )
+                                      {
+                                          ++calls[ task ];
+                                          return true;
+                                      } ) );
+        for ( size_t i = 0; i < calls.size(); ++i )
+        {
+            ASSERT_EQ( 1, calls[ i ] );
+        }
+    }
+
+    ASSERT_TRUE( KDFile::forEach( 0u, 4u,
+                                  []( const size_t ) { return false; } ) );
+
+    // A failure skips the remaining tasks
+    std::atomic< size_t > done( 0u );
+    ASSERT_FALSE( KDFile::forEach( 1000u, 1u,
+                                   [ & ]( const size_t task )
+                                   {
+                                       ++done;
+                                       return task < 10u;
+                                   } ) );
+    ASSERT_EQ( 11u, done );
+
+    // So does a task that throws, on any thread
+    for ( size_t threads = 1u; threads < 4u; ++threads )
+    {
+        ASSERT_FALSE( KDFile::forEach( 100u, threads,
+                                       []( const size_t task )
+                                       {
+                                           if ( 42u == task )
+                                           {
+                                               throw std::bad_alloc();
+                                           }
+                                           return true;
+                                       } ) );
+    }
+}
+
+} // namespace
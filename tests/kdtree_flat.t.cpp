@@ -0,0 +1,237 @@
+#include <cstdint>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "kdtree_types.h"
+#include "kdtree_options.h"
+#include "kdtree_point_view.h"
+#include "kdtree.h"
+#include "kdtree_flat.h"
+
+using namespace datastructures;
+
+namespace {
+
+//////////////////////////////////////////////////////////////////////////////
+// LOCAL TYPES AND DEFINITIONS
+//////////////////////////////////////////////////////////////////////////////
+
+typedef Types::Point< double >      TestPoint;
+typedef Types::Points< double >     TestPoints;
+typedef KDFlatTree< double >        FlatTree;
+typedef KDFlatNode< double >        FlatNode;
+
+class VectorSource
+{
+public:
+    VectorSource( const KDTree< double >&        tree,
+                  const std::vector< FlatNode >& nodes )
+    : m_tree( tree )
+    , m_nodes( nodes )
+    , m_failAt( Constants::KDTREE_FLAT_LEAF )
+    , m_numReads( 0u )
+    {
+        // nothing to do here
+    }
+
+    bool node( const uint64_t id, FlatNode& result ) const
+    {
+        ++m_numReads;
+        if ( id == m_failAt )
+        {
+            return false;
+        }
+
+        result = m_nodes[ id ];
+        return true;
+    }
+
+    bool distance( const FlatNode&              leaf,
+                   const KDPointView< double >& pointOfInterest,
+                   double&                      result ) const
+    {
+        result = Utils::distance< double >( m_tree.pointAt( leaf.index ),
+                                            pointOfInterest );
+        return true;
+    }
+
+    void failAt( const uint64_t id )
+    {
+        m_failAt = id;
+    }
+
+    size_t numReads() const
+    {
+        return m_numReads;
+    }
+
+private:
+    const KDTree< double >&        m_tree;
+    const std::vector< FlatNode >& m_nodes;
+    uint64_t                       m_failAt;
+    mutable size_t                 m_numReads;
+};
+
+//////////////////////////////////////////////////////////////////////////////
+// HELPER FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+size_t nearestIndex( const VectorSource& source, const TestPoint& point )
+{
+    FlatNode best;
+    if ( !FlatTree::nearest( source, KDPointView< double >( point ), best ) )
+    {
+        return Constants::KDTREE_ERROR_INDEX;
+    }
+
+    return static_cast< size_t >( best.index );
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// TEST FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+TEST( KDFlatTree, Flatten )
+{
+    TestPoints points;
+    for ( int i = 0; i < 100; ++i )
+    {
+        TestPoint p;
+        p.push_back( ( i * 31 ) % 17 ); // x
+        p.push_back( ( i * 7 ) % 23 );  // y
+        points.push_back( p );
+    }
+
+    KDTreeOptions options;
+    options.pointOrder = KDTreeOptions::LEAF_ORDER;
+    const KDTree< double > tree( points, options );
+
+    std::vector< FlatNode > nodes;
+    ASSERT_TRUE( FlatTree::flatten( tree, nodes ) );
+    ASSERT_EQ( 2u * points.size() - 1u, nodes.size() );
+
+    // Preorder, leaves numbered left to right, every point once
+    std::vector< bool > seen( points.size(), false );
+    uint64_t nextSlot = 0u;
+    for ( uint64_t id = 0; id < nodes.size(); ++id )
+    {
+        const FlatNode& node = nodes[ id ];
+        ASSERT_TRUE( FlatTree::isValid( id, node, nodes.size(),
+                                        points.size(), 2u ) );
+        if ( Constants::KDTREE_FLAT_LEAF == node.axis )
+        {
+            ASSERT_EQ( nextSlot++, node.slot );
+            ASSERT_FALSE( seen[ node.index ] );
+            seen[ node.index ] = true;
+            continue;
+        }
+
+        ASSERT_EQ( id + 1u, node.left );
+    }
+    ASSERT_EQ( points.size(), nextSlot );
+
+    // The empty tree
+    ASSERT_TRUE( FlatTree::flatten( KDTree< double >(), nodes ) );
+    ASSERT_TRUE( nodes.empty() );
+}
+
+TEST( KDFlatTree, IsValid )
+{
+    FlatNode split;
+    split.axis  = 1u;
+    split.left  = 4u;
+    split.right = 7u;
+    split.slot  = 0u;
+    split.index = 0u;
+    split.value = 0.5;
+    ASSERT_TRUE( FlatTree::isValid( 3u, split, 8u, 5u, 2u ) );
+
+    // Axis out of range, a child out of range, before or on its parent,
+    // both children the same
+    ASSERT_FALSE( FlatTree::isValid( 3u, split, 8u, 5u, 1u ) );
+    ASSERT_FALSE( FlatTree::isValid( 3u, split, 7u, 5u, 2u ) );
+    ASSERT_FALSE( FlatTree::isValid( 4u, split, 8u, 5u, 2u ) );
+    split.right = split.left;
+    ASSERT_FALSE( FlatTree::isValid( 3u, split, 8u, 5u, 2u ) );
+
+    FlatNode leaf = split;
+    leaf.axis  = Constants::KDTREE_FLAT_LEAF;
+    leaf.slot  = 4u;
+    leaf.index = 2u;
+    ASSERT_TRUE( FlatTree::isValid( 3u, leaf, 8u, 5u, 2u ) );
+    ASSERT_FALSE( FlatTree::isValid( 3u, leaf, 8u, 4u, 2u ) );
+    leaf.index = 5u;
+    ASSERT_FALSE( FlatTree::isValid( 3u, leaf, 8u, 5u, 2u ) );
+}
+
+TEST( KDFlatTree, NearestMatchesKDTree )
+{
+    // A coarse grid, full of ties
+    TestPoints points;
+    for ( int i = 0; i < 600; ++i )
+    {
+        TestPoint p;
+        p.push_back( i % 20 );         // x
+        p.push_back( ( i / 20 ) % 6 ); // y
+        p.push_back( i % 3 );          // z
+        points.push_back( p );
+    }
+
+    const KDTree< double > tree( points );
+    std::vector< FlatNode > nodes;
+    ASSERT_TRUE( FlatTree::flatten( tree, nodes ) );
+
+    const VectorSource source( tree, nodes );
+    for ( double x = -2.0; x < 22.0; x += 0.5 )
+    {
+        for ( double y = -1.0; y < 7.0; y += 1.0 )
+        {
+            TestPoint pointOfInterest;
+            pointOfInterest.push_back( x );
+            pointOfInterest.push_back( y );
+            pointOfInterest.push_back( 1.0 );
+
+            ASSERT_EQ( tree.nearestPointIndex( pointOfInterest ),
+                       nearestIndex( source, pointOfInterest ) );
+        }
+    }
+}
+
+TEST( KDFlatTree, DeepTree )
+{
+    // Values far apart, so that every split peels a single point off
+    TestPoints points;
+    double x = 1.0;
+    for ( int i = 0; i < 60; ++i )
+    {
+        TestPoint p;
+        p.push_back( x );
+        points.push_back( p );
+        x *= 2.0;
+    }
+
+    KDTreeOptions options;
+    options.splitPolicy = KDTreeOptions::SLIDING_MIDPOINT;
+    const KDTree< double > tree( points, options );
+
+    std::vector< FlatNode > nodes;
+    ASSERT_TRUE( FlatTree::flatten( tree, nodes ) );
+    ASSERT_EQ( 2u * points.size() - 1u, nodes.size() );
+
+    VectorSource source( tree, nodes );
+    for ( size_t i = 0; i < points.size(); ++i )
+    {
+        ASSERT_EQ( tree.nearestPointIndex( points[ i ] ),
+                   nearestIndex( source, points[ i ] ) );
+    }
+
+    // A failing read fails the search
+    const size_t numReads = source.numReads();
+    source.failAt( nodes.size() - 1u );
+    ASSERT_EQ( Constants::KDTREE_ERROR_INDEX,
+               nearestIndex( source, points.back() ) );
+    ASSERT_LT( numReads, source.numReads() );
+}
+
+} // namespace
@@ -0,0 +1,132 @@
+#include <cstdint>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "kdtree_histogram.h"
+
+using namespace datastructures;
+
+namespace {
+
+//////////////////////////////////////////////////////////////////////////////
+// TEST FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+TEST( KDHistogram, Percentiles )
+{
+    KDHistogram histogram;
+    ASSERT_EQ( 0u,  histogram.count() );
+    ASSERT_EQ( 0u,  histogram.min() );
+    ASSERT_EQ( 0u,  histogram.max() );
+    ASSERT_EQ( 0.0, histogram.mean() );
+    ASSERT_EQ( 0u,  histogram.percentile( 50.0 ) );
+
+    // Small values are counted exactly
+    for ( uint64_t value = 1; value <= 100u; ++value )
+    {
+        histogram.record( value );
+    }
+    ASSERT_EQ( 100u,  histogram.count() );
+    ASSERT_EQ( 1u,    histogram.min() );
+    ASSERT_EQ( 100u,  histogram.max() );
+    ASSERT_EQ( 50.5,  histogram.mean() );
+    ASSERT_EQ( 1u,    histogram.percentile( 0.0 ) );
+    ASSERT_EQ( 50u,   histogram.percentile( 50.0 ) );
+    ASSERT_EQ( 90u,   histogram.percentile( 90.0 ) );
+    ASSERT_EQ( 99u,   histogram.percentile( 99.0 ) );
+    ASSERT_EQ( 100u,  histogram.percentile( 99.9 ) );
+    ASSERT_EQ( 100u,  histogram.percentile( 100.0 ) );
+
+    // Large values to within 1 / 64 of themselves, never above max()
+    const uint64_t values[] = {
+        1000u, 123456u, 987654321u, 1ull << 40, ( 1ull << 40 ) + 12345u,
+        std::numeric_limits< uint64_t >::max() / 3u,
+        std::numeric_limits< uint64_t >::max()
+    };
+    for ( size_t i = 0; i < sizeof( values ) / sizeof( values[ 0 ] ); ++i )
+    {
+        histogram.reset();
+        ASSERT_EQ( 0u, histogram.count() );
+
+        histogram.record( values[ i ] );
+        histogram.record( 1u );
+        const uint64_t reported = histogram.percentile( 100.0 );
+        ASSERT_EQ( values[ i ], reported );
+
+        histogram.record( values[ i ] / 2u );
+        const uint64_t median = histogram.percentile( 50.0 );
+        ASSERT_LE( values[ i ] / 2u, median );
+        ASSERT_GE( values[ i ] / 2u / 64u, median - values[ i ] / 2u );
+    }
+}
+
+TEST( KDHistogram, Merge )
+{
+    // Histograms of several threads merge into that of all the values
+    KDHistogram all;
+    std::vector< KDHistogram > perThread( 4u );
+    std::vector< std::thread > threads;
+    for ( size_t t = 0; t < perThread.size(); ++t )
+    {
+        threads.push_back( std::thread( [ &perThread, t ]()
+        {
+            for ( uint64_t value = t; value < 100000u; value += 4u )
+            {
+                perThread[ t ].record( value * 37u );
+            }
+        } ) );
+    }
+    for ( uint64_t value = 0; value < 100000u; ++value )
+    {
+        all.record( value * 37u );
+    }
+
+    KDHistogram merged;
+    for ( size_t t = 0; t < threads.size(); ++t )
+    {
+        threads[ t ].join();
+        merged.merge( perThread[ t ] );
+    }
+
+    ASSERT_EQ( all.count(), merged.count() );
+    ASSERT_EQ( all.min(),   merged.min() );
+    ASSERT_EQ( all.max(),   merged.max() );
+    ASSERT_EQ( all.mean(),  merged.mean() );
+
+    const double percents[] = { 0.0, 50.0, 90.0, 99.0, 99.9, 100.0 };
+    for ( size_t i = 0; i < sizeof( percents ) / sizeof( percents[ 0 ] );
+          ++i )
+    {
+        ASSERT_EQ( all.percentile( percents[ i ] ),
+                   merged.percentile( percents[ i ] ) );
+    }
+
+    // Merging an empty histogram changes nothing
+    merged.merge( KDHistogram() );
+    ASSERT_EQ( all.min(),   merged.min() );
+    ASSERT_EQ( all.count(), merged.count() );
+}
+
+TEST( KDHistogram, Print )
+{
+    KDHistogram histogram;
+    histogram.record( 7u );
+
+    std::stringstream text;
+    text << histogram;
+    ASSERT_EQ( "KDHistogram:[ count = 1, min = 7, mean = 7, p50 = 7, "
+               "p90 = 7, p99 = 7, p99.9 = 7, max = 7 ]", text.str() );
+
+    std::stringstream json;
+    histogram.printJson( json );
+    ASSERT_EQ( "{ \"count\": 1, \"min\": 7, \"mean\": 7, \"p50\": 7, "
+               "\"p90\": 7, \"p99\": 7, \"p99.9\": 7, \"max\": 7 }",
+               json.str() );
+}
+
+} // namespace
@@ -0,0 +1,168 @@
+#include <cstdint>
+
+#include "gtest/gtest.h"
+
+#include "kdtree_types.h"
+#include "kdtree_implicit.h"
+#include "kdtree.h"
+#include "kdtree_utils.h"
+
+using namespace datastructures;
+
+namespace {
+
+//////////////////////////////////////////////////////////////////////////////
+// LOCAL TYPES AND DEFINITIONS
+//////////////////////////////////////////////////////////////////////////////
+
+typedef Types::Point< int >         TestPoint;
+typedef Types::Points< int >        TestPoints;
+typedef KDImplicitTree< int >       TestImplicitTree;
+
+//////////////////////////////////////////////////////////////////////////////
+// HELPER FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+TestPoints makePoints( const int numPoints )
+{
+    TestPoints points;
+    for ( int i = 0; i < numPoints; ++i )
+    {
+        TestPoint p;
+        p.push_back( ( i * 37 ) % 101 ); // x
+        p.push_back( ( i * 11 ) % 23 );  // y
+        p.push_back( ( i * 5 ) % 7 );    // z
+        points.push_back( p );
+    }
+
+    return points;
+}
+
+double bruteForceDistance( const TestPoints& points, const TestPoint& p )
+{
+    double best = Constants::KDTREE_MAX_DISTANCE;
+    for ( TestPoints::const_iterator it = points.cbegin();
+          it != points.cend(); ++it )
+    {
+        best = std::min( best, Utils::distance< int >( *it, p ) );
+    }
+
+    return best;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// TEST FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+TEST( KDImplicitTree, TestZero )
+{
+    TestImplicitTree zero;
+
+    ASSERT_TRUE( zero.empty() );
+    ASSERT_EQ( 0u, zero.size() );
+    ASSERT_EQ( zero, TestImplicitTree( TestPoints() ) );
+    ASSERT_EQ( Constants::KDTREE_ERROR_INDEX,
+               zero.nearestPointIndex( TestPoint( 3, 0 ) ) );
+    ASSERT_TRUE( zero.nearestPointView( TestPoint( 3, 0 ) ).empty() );
+    ASSERT_TRUE( zero.pointAt( 0u ).empty() );
+
+    std::cout << zero << std::endl;
+}
+
+TEST( KDImplicitTree, MismatchedPoints )
+{
+    TestPoints points = makePoints( 4 );
+    points[ 2 ].push_back( 1 );
+
+    TestImplicitTree tree( points );
+    ASSERT_TRUE( tree.empty() );
+
+    TestImplicitTree sane( makePoints( 4 ) );
+    ASSERT_EQ( Constants::KDTREE_ERROR_INDEX,
+               sane.nearestPointIndex( TestPoint( 2, 0 ) ) );
+}
+
+TEST( KDImplicitTree, MatchesBruteForce )
+{
+    const TestPoints points = makePoints( 200 );
+
+    const TestImplicitTree varianceTree( points );
+    const TestImplicitTree cyclicTree( points, TestImplicitTree::CYCLIC_AXIS );
+    ASSERT_EQ( TestImplicitTree::VARIANCE_AXIS, varianceTree.splitAxis() );
+    ASSERT_EQ( TestImplicitTree::CYCLIC_AXIS, cyclicTree.splitAxis() );
+    ASSERT_EQ( varianceTree, cyclicTree );
+
+    for ( size_t i = 0; i < points.size(); ++i )
+    {
+        ASSERT_EQ( points[ i ], varianceTree.pointAt( i ).toPoint() );
+    }
+
+    for ( int x = -3; x < 104; x += 3 )
+    {
+        for ( int y = -2; y < 25; y += 4 )
+        {
+            TestPoint pointOfInterest;
+            pointOfInterest.push_back( x );
+            pointOfInterest.push_back( y );
+            pointOfInterest.push_back( ( x + y ) % 9 );
+
+            const double expected = bruteForceDistance( points,
+                                                        pointOfInterest );
+
+            const size_t varianceIndex =
+                    varianceTree.nearestPointIndex( pointOfInterest );
+            ASSERT_DOUBLE_EQ( expected,
+                              Utils::distance< int >( points[ varianceIndex ],
+                                                      pointOfInterest ) );
+
+            const size_t cyclicIndex =
+                    cyclicTree.nearestPointIndex( pointOfInterest );
+            ASSERT_DOUBLE_EQ( expected,
+                              Utils::distance< int >( points[ cyclicIndex ],
+                                                      pointOfInterest ) );
+
+            ASSERT_EQ( points[ varianceIndex ],
+                       varianceTree.nearestPointView( pointOfInterest )
+                                   .toPoint() );
+        }
+    }
+
+    // Exact matches are found
+    for ( size_t i = 0; i < points.size(); i += 7 )
+    {
+        ASSERT_EQ( points[ i ],
+                   points[ cyclicTree.nearestPointIndex( points[ i ] ) ] );
+    }
+}
+
+TEST( KDImplicitTree, SmallerThanKDTree )
+{
+    const TestPoints points = makePoints( 1000 );
+
+    KDImplicitTree< int, uint32_t > varianceTree( points );
+    KDImplicitTree< int, uint32_t > cyclicTree(
+            points,
+            KDImplicitTree< int, uint32_t >::CYCLIC_AXIS );
+
+    // Coordinates, two narrow index arrays and at most one byte per node
+    const size_t payload = points.size() * 3u * sizeof( int ) +
+                           points.size() * 2u * sizeof( uint32_t );
+    ASSERT_EQ( payload + points.size(), varianceTree.memoryFootprint() );
+    ASSERT_EQ( payload, cyclicTree.memoryFootprint() );
+
+    KDTree< int > explicitTree( points );
+    for ( size_t i = 0; i < points.size(); i += 13 )
+    {
+        ASSERT_DOUBLE_EQ(
+            Utils::distance< int >(
+                    points[ explicitTree.nearestPointIndex( points[ i ] ) ],
+                    points[ i ] ),
+            Utils::distance< int >(
+                    points[ varianceTree.nearestPointIndex( points[ i ] ) ],
+                    points[ i ] ) );
+    }
+
+    std::cout << varianceTree << std::endl;
+}
+
+} // namespace
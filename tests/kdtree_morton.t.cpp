@@ -0,0 +1,134 @@
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "kdtree_types.h"
+#include "kdtree_point_view.h"
+#include "kdtree_morton.h"
+
+using namespace datastructures;
+
+namespace {
+
+//////////////////////////////////////////////////////////////////////////////
+// LOCAL TYPES AND DEFINITIONS
+//////////////////////////////////////////////////////////////////////////////
+
+typedef Types::Point< double >      TestPoint;
+typedef Types::Points< double >     TestPoints;
+typedef KDPointsView< double >      TestPointsView;
+
+//////////////////////////////////////////////////////////////////////////////
+// HELPER FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+TestPoint makePoint( const double x, const double y )
+{
+    TestPoint p;
+    p.push_back( x );
+    p.push_back( y );
+
+    return p;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// TEST FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+TEST( Morton, Bits )
+{
+    ASSERT_EQ( 0u,  Morton::bitsPerAxis( 0u ) );
+    ASSERT_EQ( 32u, Morton::bitsPerAxis( 1u ) );
+    ASSERT_EQ( 32u, Morton::bitsPerAxis( 2u ) );
+    ASSERT_EQ( 21u, Morton::bitsPerAxis( 3u ) );
+    ASSERT_EQ( 1u,  Morton::bitsPerAxis( 64u ) );
+    ASSERT_EQ( 0u,  Morton::bitsPerAxis( 65u ) );
+
+    // Axis 0 holds the most significant bit of every group
+    ASSERT_EQ( 2u, Morton::axisOfBit( 0u, 3u ) );
+    ASSERT_EQ( 0u, Morton::axisOfBit( 2u, 3u ) );
+    ASSERT_EQ( 0u, Morton::axisOfBit( 62u, 3u ) );
+    ASSERT_EQ( 0u, Morton::axisOfBit( 63u, 2u ) );
+    ASSERT_EQ( 1u, Morton::axisOfBit( 62u, 2u ) );
+
+    ASSERT_EQ( 0u,  Morton::highestBit( 1u ) );
+    ASSERT_EQ( 5u,  Morton::highestBit( 0x3Fu ) );
+    ASSERT_EQ( 63u, Morton::highestBit( ~Morton::Code( 0u ) ) );
+
+    ASSERT_EQ( 1u, Morton::numThreads( 8u, 10u ) );
+    ASSERT_EQ( 2u, Morton::numThreads(
+                           2u, 100u * Constants::KDTREE_PARALLEL_BUILD_GRAIN ) );
+}
+
+TEST( Morton, Encode )
+{
+    // Corners of the bounding box, in Z-order
+    TestPoints points;
+    points.push_back( makePoint( 1.0,  1.0 ) );
+    points.push_back( makePoint( 0.0,  0.0 ) );
+    points.push_back( makePoint( 1.0,  0.0 ) );
+    points.push_back( makePoint( 0.0,  1.0 ) );
+
+    std::vector< Morton::Code > codes;
+    Morton::encode( TestPointsView( points ), codes, 2u );
+    ASSERT_EQ( 4u, codes.size() );
+
+    ASSERT_EQ( 0u, codes[ 1 ] );
+    ASSERT_EQ( ~Morton::Code( 0u ), codes[ 0 ] );
+    ASSERT_TRUE( codes[ 1 ] < codes[ 3 ] );
+    ASSERT_TRUE( codes[ 3 ] < codes[ 2 ] );
+    ASSERT_TRUE( codes[ 2 ] < codes[ 0 ] );
+
+    // Highest bit separates the points on axis 0
+    ASSERT_EQ( 0u, Morton::axisOfBit( Morton::highestBit( codes[ 2 ] ^
+                                                          codes[ 3 ] ), 2u ) );
+
+    // No points
+    Morton::encode( TestPointsView(), codes, 1u );
+    ASSERT_TRUE( codes.empty() );
+}
+
+TEST( Morton, RadixSort )
+{
+    const size_t threads[] = { 1u, 3u, 8u };
+    for ( size_t k = 0; k < 3; ++k )
+    {
+        std::vector< Morton::Code > codes;
+        std::vector< uint32_t >     values;
+
+        Morton::Code state = 42u;
+        for ( uint32_t i = 0; i < 1000u; ++i )
+        {
+            state = state * 6364136223846793005ull + 1442695040888963407ull;
+            codes.push_back( state >> 24 );
+            values.push_back( i );
+        }
+
+        // Duplicates check stability
+        codes[ 10 ] = codes[ 500 ];
+        codes[ 999 ] = codes[ 500 ];
+
+        std::vector< std::pair< Morton::Code, uint32_t > > expected;
+        for ( size_t i = 0; i < codes.size(); ++i )
+        {
+            expected.push_back( std::make_pair( codes[ i ], values[ i ] ) );
+        }
+        std::stable_sort( expected.begin(), expected.end(),
+                          []( const std::pair< Morton::Code, uint32_t >& l,
+                              const std::pair< Morton::Code, uint32_t >& r )
+                          {
+                              return l.first < r.first;
+                          } );
+
+        Morton::radixSort( codes, values, 40u, threads[ k ] );
+        for ( size_t i = 0; i < codes.size(); ++i )
+        {
+            ASSERT_EQ( expected[ i ].first,  codes[ i ] );
+            ASSERT_EQ( expected[ i ].second, values[ i ] );
+        }
+    }
+}
+
+} // namespace
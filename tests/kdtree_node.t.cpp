@@ -1,147 +1,239 @@
-#include "gtest/gtest.h"
-
-#include "kdtree_types.h"
-#include "kdtree_constants.h"
-#include "kdtree_node.h"
-
-using namespace datastructures;
-
-namespace {
-
-//////////////////////////////////////////////////////////////////////////////
-// LOCAL TYPES AND DEFINITIONS
-//////////////////////////////////////////////////////////////////////////////
-
-typedef KDHyperplane< int >   TestHyperplane;
-typedef KDNode< int >         TestNode;
-
-//////////////////////////////////////////////////////////////////////////////
-// HELPER FUNCTIONS
-//////////////////////////////////////////////////////////////////////////////
-
-//////////////////////////////////////////////////////////////////////////////
-// TEST FUNCTIONS
-//////////////////////////////////////////////////////////////////////////////
-
-TEST( KDNode, TestZero )
-{
-    // initial object
-    TestNode zero;
-
-    ASSERT_TRUE( zero == zero );
-    ASSERT_TRUE( !( zero != zero ) );
-    ASSERT_TRUE( zero.equals( zero ) );
-
-    // Empty configs must be equivalent
-    TestNode zero2;
-
-    ASSERT_TRUE( zero == zero2 );
-    ASSERT_TRUE( !( zero != zero2 ) );
-    ASSERT_TRUE( zero.equals( zero2 ) );
-
-    // copy of initial object
-    TestNode zeroCopy( zero );
-    ASSERT_TRUE( zero == zeroCopy );
-    ASSERT_TRUE( !( zero != zeroCopy ) );
-    ASSERT_TRUE( zero.equals( zeroCopy ) );
-
-    // assign of initial object
-    TestNode zeroAssign;
-    zeroAssign = zero;
-    ASSERT_TRUE( zero == zeroAssign );
-    ASSERT_TRUE( !( zero != zeroAssign ) );
-    ASSERT_TRUE( zero.equals( zeroAssign ) );
-}
-
-TEST( KDNode, TestUninitializedState )
-{
-    TestNode        dummyNode;
-    TestHyperplane  dummyHyperplane;
-
-    std::cout << dummyNode << std::endl;
-
-    ASSERT_EQ( dummyNode.hyperplane(),     dummyHyperplane );
-    ASSERT_EQ( dummyNode.left(),           nullptr );
-    ASSERT_EQ( dummyNode.left(),           nullptr );
-    ASSERT_EQ( dummyNode.leafPointIndex(), Constants::KDTREE_ERROR_INDEX );
-}
-
-TEST( KDNode, SanityNonLeaf )
-{
-    TestHyperplane                    hyperplane( 1u, 2 );
-    const std::shared_ptr< TestNode>  left( new KDNode< int >() );
-    const std::shared_ptr< TestNode>  right( new KDNode< int >() );
-
-    TestNode dummyNode( hyperplane, left, right );
-
-    ASSERT_EQ( dummyNode.hyperplane()    , hyperplane );
-    ASSERT_EQ( dummyNode.left()          , left );
-    ASSERT_EQ( dummyNode.right()         , right );
-    ASSERT_EQ( dummyNode.isLeaf()        , false );
-    ASSERT_EQ( dummyNode.leafPointIndex(), Constants::KDTREE_ERROR_INDEX );
-
-    std::cout << dummyNode << std::endl;
-
-    TestNode dummyNode2 = dummyNode;
-
-    ASSERT_EQ( dummyNode2.hyperplane()    , hyperplane );
-    ASSERT_EQ( dummyNode2.left()          , left );
-    ASSERT_EQ( dummyNode2.right()         , right );
-    ASSERT_EQ( dummyNode2.isLeaf()        , false );
-    ASSERT_EQ( dummyNode2.leafPointIndex(), Constants::KDTREE_ERROR_INDEX );
-
-    std::cout << dummyNode2 << std::endl;
-
-    TestNode dummyNode3( dummyNode );
-
-    ASSERT_EQ( dummyNode3.hyperplane()    , hyperplane );
-    ASSERT_EQ( dummyNode3.left()          , left );
-    ASSERT_EQ( dummyNode3.right()         , right );
-    ASSERT_EQ( dummyNode3.isLeaf()        , false );
-    ASSERT_EQ( dummyNode3.leafPointIndex(), Constants::KDTREE_ERROR_INDEX );
-
-    std::cout << dummyNode2 << std::endl;
-
-    ASSERT_EQ( dummyNode,  dummyNode2 );
-    ASSERT_EQ( dummyNode,  dummyNode3 );
-    ASSERT_EQ( dummyNode2, dummyNode3 );
-}
-
-TEST( KDNode, SanityLeaf )
-{
-    const size_t   leafPointIndex = 1u;
-    TestNode dummyLeafNode( leafPointIndex );
-    TestHyperplane emptyHyperplane;
-
-    ASSERT_EQ( dummyLeafNode.hyperplane()    , emptyHyperplane );
-    ASSERT_EQ( dummyLeafNode.left()          , nullptr );
-    ASSERT_EQ( dummyLeafNode.right()         , nullptr );
-    ASSERT_EQ( dummyLeafNode.isLeaf()        , true );
-    ASSERT_EQ( dummyLeafNode.leafPointIndex(), leafPointIndex );
-
-    std::cout << dummyLeafNode << std::endl;
-
-    TestNode dummyLeafNode2 = dummyLeafNode;
-    ASSERT_EQ( dummyLeafNode2.hyperplane()    , emptyHyperplane );
-    ASSERT_EQ( dummyLeafNode2.left()          , nullptr );
-    ASSERT_EQ( dummyLeafNode2.right()         , nullptr );
-    ASSERT_EQ( dummyLeafNode2.isLeaf()        , true );
-    ASSERT_EQ( dummyLeafNode2.leafPointIndex(), leafPointIndex );
-
-    std::cout << dummyLeafNode2 << std::endl;
-
-    TestNode dummyLeafNode3( dummyLeafNode );
-    ASSERT_EQ( dummyLeafNode3.hyperplane()    , emptyHyperplane );
-    ASSERT_EQ( dummyLeafNode3.left()          , nullptr );
-    ASSERT_EQ( dummyLeafNode3.right()         , nullptr );
-    ASSERT_EQ( dummyLeafNode3.isLeaf()        , true );
-    ASSERT_EQ( dummyLeafNode3.leafPointIndex(), leafPointIndex );
-
-    std::cout << dummyLeafNode3 << std::endl;
-
-    ASSERT_EQ( dummyLeafNode,  dummyLeafNode2 );
-    ASSERT_EQ( dummyLeafNode,  dummyLeafNode3 );
-    ASSERT_EQ( dummyLeafNode2, dummyLeafNode3 );
-}
-
+#include <cstdint>
+#include <memory>
+
+#include "gtest/gtest.h"
+
+#include "kdtree_types.h"
+#include "kdtree_constants.h"
+#include "kdtree_node.h"
+
+using namespace datastructures;
+
+namespace {
+
+//////////////////////////////////////////////////////////////////////////////
+// LOCAL TYPES AND DEFINITIONS
+//////////////////////////////////////////////////////////////////////////////
+
+typedef KDHyperplane< int >   TestHyperplane;
+typedef KDNode< int >         TestNode;
+typedef KDNode< int, uint32_t > NarrowTestNode;
+
+size_t countingAllocations = 0u;
+
+template< typename T >
+class CountingAllocator : public std::allocator< T >
+{
+public:
+    typedef T value_type;
+
+    template< typename U >
+    struct rebind
+    {
+        typedef CountingAllocator< U > other;
+    };
+
+    CountingAllocator()
+    {
+        // nothing to do here
+    }
+
+    template< typename U >
+    CountingAllocator( const CountingAllocator< U >& )
+    {
+        // nothing to do here
+    }
+
+    T* allocate( const size_t n )
+    {
+        ++countingAllocations;
+        return std::allocator< T >::allocate( n );
+    }
+};
+
+//////////////////////////////////////////////////////////////////////////////
+// HELPER FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////
+// TEST FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+TEST( KDNode, TestZero )
+{
+    // initial object
+    TestNode zero;
+
+    ASSERT_TRUE( zero == zero );
+    ASSERT_TRUE( !( zero != zero ) );
+    ASSERT_TRUE( zero.equals( zero ) );
+
+    // Empty configs must be equivalent
+    TestNode zero2;
+
+    ASSERT_TRUE( zero == zero2 );
+    ASSERT_TRUE( !( zero != zero2 ) );
+    ASSERT_TRUE( zero.equals( zero2 ) );
+
+    // copy of initial object
+    TestNode zeroCopy( zero );
+    ASSERT_TRUE( zero == zeroCopy );
+    ASSERT_TRUE( !( zero != zeroCopy ) );
+    ASSERT_TRUE( zero.equals( zeroCopy ) );
+
+    // assign of initial object
+    TestNode zeroAssign;
+    zeroAssign = zero;
+    ASSERT_TRUE( zero == zeroAssign );
+    ASSERT_TRUE( !( zero != zeroAssign ) );
+    ASSERT_TRUE( zero.equals( zeroAssign ) );
+}
+
+TEST( KDNode, TestUninitializedState )
+{
+    TestNode        dummyNode;
+    TestHyperplane  dummyHyperplane;
+
+    std::cout << dummyNode << std::endl;
+
+    ASSERT_EQ( dummyNode.hyperplane(),     dummyHyperplane );
+    ASSERT_EQ( dummyNode.left(),           nullptr );
+    ASSERT_EQ( dummyNode.left(),           nullptr );
+    ASSERT_EQ( dummyNode.leafPointIndex(), Constants::KDTREE_ERROR_INDEX );
+}
+
+TEST( KDNode, SanityNonLeaf )
+{
+    TestHyperplane                    hyperplane( 1u, 2 );
+    const std::shared_ptr< TestNode>  left( new KDNode< int >() );
+    const std::shared_ptr< TestNode>  right( new KDNode< int >() );
+
+    TestNode dummyNode( hyperplane, left, right );
+
+    ASSERT_EQ( dummyNode.hyperplane()    , hyperplane );
+    ASSERT_EQ( dummyNode.left()          , left );
+    ASSERT_EQ( dummyNode.right()         , right );
+    ASSERT_EQ( dummyNode.isLeaf()        , false );
+    ASSERT_EQ( dummyNode.leafPointIndex(), Constants::KDTREE_ERROR_INDEX );
+
+    std::cout << dummyNode << std::endl;
+
+    TestNode dummyNode2 = dummyNode;
+
+    ASSERT_EQ( dummyNode2.hyperplane()    , hyperplane );
+    ASSERT_EQ( dummyNode2.left()          , left );
+    ASSERT_EQ( dummyNode2.right()         , right );
+    ASSERT_EQ( dummyNode2.isLeaf()        , false );
+    ASSERT_EQ( dummyNode2.leafPointIndex(), Constants::KDTREE_ERROR_INDEX );
+
+    std::cout << dummyNode2 << std::endl;
+
+    TestNode dummyNode3( dummyNode );
+
+    ASSERT_EQ( dummyNode3.hyperplane()    , hyperplane );
+    ASSERT_EQ( dummyNode3.left()          , left );
+    ASSERT_EQ( dummyNode3.right()         , right );
+    ASSERT_EQ( dummyNode3.isLeaf()        , false );
+    ASSERT_EQ( dummyNode3.leafPointIndex(), Constants::KDTREE_ERROR_INDEX );
+
+    std::cout << dummyNode2 << std::endl;
+
+    ASSERT_EQ( dummyNode,  dummyNode2 );
+    ASSERT_EQ( dummyNode,  dummyNode3 );
+    ASSERT_EQ( dummyNode2, dummyNode3 );
+}
+
+TEST( KDNode, SanityLeaf )
+{
+    const size_t   leafPointIndex = 1u;
+    TestNode dummyLeafNode( leafPointIndex );
+    TestHyperplane emptyHyperplane;
+
+    ASSERT_EQ( dummyLeafNode.hyperplane()    , emptyHyperplane );
+    ASSERT_EQ( dummyLeafNode.left()          , nullptr );
+    ASSERT_EQ( dummyLeafNode.right()         , nullptr );
+    ASSERT_EQ( dummyLeafNode.isLeaf()        , true );
+    ASSERT_EQ( dummyLeafNode.leafPointIndex(), leafPointIndex );
+
+    std::cout << dummyLeafNode << std::endl;
+
+    TestNode dummyLeafNode2 = dummyLeafNode;
+    ASSERT_EQ( dummyLeafNode2.hyperplane()    , emptyHyperplane );
+    ASSERT_EQ( dummyLeafNode2.left()          , nullptr );
+    ASSERT_EQ( dummyLeafNode2.right()         , nullptr );
+    ASSERT_EQ( dummyLeafNode2.isLeaf()        , true );
+    ASSERT_EQ( dummyLeafNode2.leafPointIndex(), leafPointIndex );
+
+    std::cout << dummyLeafNode2 << std::endl;
+
+    TestNode dummyLeafNode3( dummyLeafNode );
+    ASSERT_EQ( dummyLeafNode3.hyperplane()    , emptyHyperplane );
+    ASSERT_EQ( dummyLeafNode3.left()          , nullptr );
+    ASSERT_EQ( dummyLeafNode3.right()         , nullptr );
+    ASSERT_EQ( dummyLeafNode3.isLeaf()        , true );
+    ASSERT_EQ( dummyLeafNode3.leafPointIndex(), leafPointIndex );
+
+    std::cout << dummyLeafNode3 << std::endl;
+
+    ASSERT_EQ( dummyLeafNode,  dummyLeafNode2 );
+    ASSERT_EQ( dummyLeafNode,  dummyLeafNode3 );
+    ASSERT_EQ( dummyLeafNode2, dummyLeafNode3 );
+}
+
+TEST( KDNode, NarrowIndex )
+{
+    // Narrow nodes speak size_t and KDTREE_ERROR_INDEX just like wide ones
+    NarrowTestNode nonLeaf;
+    ASSERT_FALSE( nonLeaf.isLeaf() );
+    ASSERT_EQ( Constants::KDTREE_ERROR_INDEX, nonLeaf.leafPointIndex() );
+
+    NarrowTestNode errorLeaf( Constants::KDTREE_ERROR_INDEX );
+    ASSERT_FALSE( errorLeaf.isLeaf() );
+    ASSERT_EQ( nonLeaf, errorLeaf );
+
+    const size_t leafPointIndex = 4000000000u;
+    NarrowTestNode leaf( leafPointIndex );
+    ASSERT_TRUE( leaf.isLeaf() );
+    ASSERT_EQ( leafPointIndex, leaf.leafPointIndex() );
+
+    NarrowTestNode leafCopy( leaf );
+    ASSERT_EQ( leaf, leafCopy );
+    ASSERT_NE( leaf, nonLeaf );
+
+    std::cout << leaf << std::endl;
+
+    // Split axes are narrowed too, the uninitialized one included
+    const TestHyperplane hyperplane( 3u, 7 );
+    NarrowTestNode split( hyperplane, NarrowTestNode::NodePtr(),
+                          NarrowTestNode::NodePtr() );
+    ASSERT_EQ( hyperplane, split.hyperplane() );
+
+    const TestHyperplane emptyHyperplane;
+    NarrowTestNode uninitialized( emptyHyperplane, NarrowTestNode::NodePtr(),
+                                  NarrowTestNode::NodePtr() );
+    ASSERT_EQ( emptyHyperplane, uninitialized.hyperplane() );
+    ASSERT_FALSE( uninitialized.isLeaf() );
+
+    // Two child pointers, the split value and the index
+    ASSERT_GE( 2u * sizeof( std::shared_ptr< KDNode< double, uint32_t > > ) +
+               2u * sizeof( double ),
+               sizeof( KDNode< double, uint32_t > ) );
+}
+
+TEST( KDNode, Allocator )
+{
+    typedef KDNode< int, uint32_t, CountingAllocator< int > > CountedNode;
+
+    countingAllocations = 0u;
+    CountedNode::NodePtr left  = CountedNode::create( 0u );
+    CountedNode::NodePtr right = CountedNode::create( 1u );
+    CountedNode::NodePtr root  = CountedNode::create( TestHyperplane( 0u, 1 ),
+                                                      left, right );
+
+    // One allocation per node, its reference count included
+    ASSERT_EQ( 3u, countingAllocations );
+    ASSERT_EQ( left, root->left() );
+    ASSERT_EQ( 1u, root->right()->leafPointIndex() );
+}
+
 } // namespace
\ No newline at end of file
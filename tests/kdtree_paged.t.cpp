@@ -0,0 +1,287 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "kdtree_types.h"
+#include "kdtree.h"
+#include "kdtree_paged.h"
+#include "kdtree_report.h"
+
+using namespace datastructures;
+
+namespace {
+
+//////////////////////////////////////////////////////////////////////////////
+// LOCAL TYPES AND DEFINITIONS
+//////////////////////////////////////////////////////////////////////////////
+
+typedef Types::Point< double >      TestPoint;
+typedef Types::Points< double >     TestPoints;
+
+const std::string treeFile  = "really_long_and_unique_tree_file_45.txt";
+const std::string pagedFile = "really_long_and_unique_paged_file_45.bin";
+
+class TestFileGuard
+{
+public:
+    TestFileGuard( const std::string& testFileName )
+    : m_testFileName( testFileName )
+    {
+        // nothing to do here
+    }
+
+    ~TestFileGuard()
+    {
+        std::remove( m_testFileName.c_str() );
+    }
+
+private:
+    std::string   m_testFileName;
+};
+
+//////////////////////////////////////////////////////////////////////////////
+// HELPER FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+TestPoints crowdedPoints()
+{
+    // Points crowding towards the origin along the diagonal, each half as
+    // far from it as the one before, which sliding midpoint splits peel off
+    // one per level, beside a grid. Queries near the origin then walk a
+    // path hundreds of nodes long, spread over far more pages than the
+    // cache holds.
+    TestPoints points;
+    double x = 400.0;
+    for ( int i = 0; i < 500; ++i )
+    {
+        points.push_back( TestPoint( 3u, x ) );
+        x *= 0.5;
+    }
+
+    for ( int i = 0; i < 1500; ++i )
+    {
+        TestPoint p;
+        p.push_back( ( i % 50 ) * 8 + 4 ); // x
+        p.push_back( ( i / 50 ) * 2 );     // y
+        p.push_back( i % 2 );              // z
+        points.push_back( p );
+    }
+
+    return points;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// TEST FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+TEST( KDPagedTree, MatchesKDTree )
+{
+    TestFileGuard treeGuard( treeFile );
+    TestFileGuard pagedGuard( pagedFile );
+
+    KDTreeOptions options;
+    options.splitPolicy = KDTreeOptions::SLIDING_MIDPOINT;
+    ASSERT_TRUE( KDTree< double >( crowdedPoints(), options ).serialize(
+                         treeFile ) );
+
+    KDTree< double > tree;
+    ASSERT_TRUE( tree.deserialize( treeFile ) );
+    ASSERT_LT( 500u, KDTreeReport< double >( tree ).maxDepth() );
+
+    // Small pages and cache, so that most of the file stays on disk
+    ASSERT_TRUE( KDPagedTree< double >::write( treeFile, pagedFile, 512u ) );
+
+    KDPagedTree< double > paged;
+    ASSERT_TRUE( paged.open( pagedFile, 8u ) );
+    ASSERT_TRUE( paged.isOpen() );
+    ASSERT_EQ( 2000u, paged.size() );
+    ASSERT_EQ( 3u,    paged.dimension() );
+    ASSERT_EQ( 512u,  paged.pageSize() );
+    ASSERT_LT( 20u,   paged.numPages() );
+
+    for ( double x = -3.0; x < 420.0; x += 1.5 )
+    {
+        TestPoint pointOfInterest;
+        pointOfInterest.push_back( x );
+        pointOfInterest.push_back( static_cast< int >( x * 7 ) % 60 );
+        pointOfInterest.push_back( 0.25 );
+
+        const size_t index = paged.nearestPointIndex( pointOfInterest );
+        ASSERT_EQ( tree.nearestPointIndex( pointOfInterest ), index );
+        ASSERT_EQ( tree.pointAt( index ).toPoint(),
+                   paged.nearestPoint( pointOfInterest ) );
+        ASSERT_GE( 9u, paged.residentPages() );
+    }
+
+    // Down the crowd, a path through hundreds of fragments
+    for ( double x = 1e-140; x < 1.0; x *= 7.0 )
+    {
+        const TestPoint pointOfInterest( 3u, x );
+        ASSERT_EQ( tree.nearestPointIndex( pointOfInterest ),
+                   paged.nearestPointIndex( pointOfInterest ) );
+        ASSERT_GE( 9u, paged.residentPages() );
+    }
+
+    ASSERT_LT( 0u,  paged.cacheHits() );
+    ASSERT_LT( 0u,  paged.cacheMisses() );
+    ASSERT_LT( 0.0, paged.hitRate() );
+    ASSERT_GT( 1.0, paged.hitRate() );
+
+    paged.resetStatistics();
+    ASSERT_EQ( 0u,  paged.cacheHits() );
+    ASSERT_EQ( 0.0, paged.hitRate() );
+
+    // Cardinality mismatch
+    ASSERT_EQ( Constants::KDTREE_ERROR_INDEX,
+               paged.nearestPointIndex( TestPoint( 2, 1.0 ) ) );
+
+    paged.close();
+    ASSERT_FALSE( paged.isOpen() );
+    ASSERT_EQ( 0u, paged.residentPages() );
+}
+
+TEST( KDPagedTree, EmptyAndInvalidFiles )
+{
+    TestFileGuard treeGuard( treeFile );
+    TestFileGuard pagedGuard( pagedFile );
+
+    ASSERT_TRUE( KDTree< double >().serialize( treeFile ) );
+    ASSERT_TRUE( KDPagedTree< double >::write( treeFile, pagedFile ) );
+
+    KDPagedTree< double > paged;
+    ASSERT_TRUE( paged.open( pagedFile ) );
+    ASSERT_EQ( 0u, paged.size() );
+    ASSERT_EQ( Constants::KDTREE_ERROR_INDEX,
+               paged.nearestPointIndex( TestPoint( 2, 1.0 ) ) );
+
+    // Page too small for the header
+    ASSERT_FALSE( KDPagedTree< double >::write( treeFile, pagedFile, 16u ) );
+
+    // Not a paged file, or of another coordinate type
+    ASSERT_FALSE( paged.open( treeFile ) );
+    ASSERT_TRUE( KDPagedTree< double >::write( treeFile, pagedFile ) );
+
+    KDPagedTree< float > otherType;
+    ASSERT_FALSE( otherType.open( pagedFile ) );
+    ASSERT_FALSE( otherType.isOpen() );
+}
+
+TEST( KDPagedTree, FileFormats )
+{
+    TestFileGuard treeGuard( treeFile );
+    TestFileGuard pagedGuard( pagedFile );
+
+    // Coordinates that decimal text does not represent exactly
+    TestPoints points;
+    for ( int i = 0; i < 500; ++i )
+    {
+        TestPoint p;
+        p.push_back( ( i * 37 ) % 101 / 3.0 ); // x
+        p.push_back( ( i * 13 ) % 17 + 0.1 );  // y
+        points.push_back( p );
+    }
+
+    const KDTreeOptions::FileFormat formats[] = {
+        KDTreeOptions::TEXT_FORMAT,
+        KDTreeOptions::COMPACT_FORMAT,
+        KDTreeOptions::CHUNKED_FORMAT
+    };
+    for ( size_t f = 0; f < sizeof( formats ) / sizeof( formats[ 0 ] ); ++f )
+    {
+        KDTreeOptions options;
+        options.fileFormat = formats[ f ];
+        options.pointOrder = KDTreeOptions::LEAF_ORDER;
+        ASSERT_TRUE( KDTree< double >( points, options ).serialize( treeFile ) );
+
+        KDTree< double > tree;
+        ASSERT_TRUE( tree.deserialize( treeFile ) );
+        ASSERT_TRUE( KDPagedTree< double >::write( treeFile, pagedFile,
+                                                   256u ) );
+
+        KDPagedTree< double > paged;
+        ASSERT_TRUE( paged.open( pagedFile, 4u ) );
+        for ( size_t i = 0; i < points.size(); i += 3 )
+        {
+            TestPoint pointOfInterest( points[ i ] );
+            pointOfInterest[ 0 ] += 0.01;
+
+            // Same point, same coordinates
+            const size_t index = paged.nearestPointIndex( pointOfInterest );
+            ASSERT_EQ( tree.nearestPointIndex( pointOfInterest ), index );
+            ASSERT_EQ( tree.pointAt( index ).toPoint(),
+                       paged.nearestPoint( pointOfInterest ) );
+        }
+    }
+}
+
+TEST( KDPagedTree, MalformedFiles )
+{
+    TestFileGuard treeGuard( treeFile );
+    TestFileGuard pagedGuard( pagedFile );
+
+    TestPoints points;
+    for ( int i = 0; i < 300; ++i )
+    {
+        points.push_back( TestPoint( 2, i ) );
+    }
+    ASSERT_TRUE( KDTree< double >( points ).serialize( treeFile ) );
+    ASSERT_TRUE( KDPagedTree< double >::write( treeFile, pagedFile, 256u ) );
+
+    std::string contents;
+    {
+        std::ifstream in( pagedFile, std::ios::binary );
+        contents.assign( std::istreambuf_iterator< char >( in ),
+                         std::istreambuf_iterator< char >() );
+    }
+    ASSERT_EQ( 0u, contents.size() % 256u );
+
+    // Truncated to whole pages or not
+    const size_t cuts[] = { 3u * 256u, contents.size() - 256u,
+                            contents.size() - 1u };
+    for ( size_t k = 0; k < sizeof( cuts ) / sizeof( cuts[ 0 ] ); ++k )
+    {
+        {
+            std::ofstream out( pagedFile, std::ios::binary | std::ios::trunc );
+            out.write( contents.data(), cuts[ k ] );
+        }
+
+        KDPagedTree< double > paged;
+        ASSERT_FALSE( paged.open( pagedFile ) );
+    }
+
+    // Points without coordinates
+    {
+        std::string corrupted( contents );
+        const uint64_t dimension = 0u;
+        std::memcpy( &corrupted[ Constants::KDTREE_PAGED_MAGIC.size() +
+                                 sizeof( uint64_t ) ],
+                     &dimension, sizeof( dimension ) );
+        std::ofstream out( pagedFile, std::ios::binary | std::ios::trunc );
+        out.write( corrupted.data(), corrupted.size() );
+    }
+    KDPagedTree< double > dimensionless;
+    ASSERT_FALSE( dimensionless.open( pagedFile ) );
+
+    // A split linking back to the root fails the query, not the process
+    {
+        std::string corrupted( contents );
+        const uint64_t root = 0u;
+        std::memcpy( &corrupted[ 256u + sizeof( uint64_t ) ],
+                     &root, sizeof( root ) );
+        std::ofstream out( pagedFile, std::ios::binary | std::ios::trunc );
+        out.write( corrupted.data(), corrupted.size() );
+    }
+    KDPagedTree< double > looping;
+    ASSERT_TRUE( looping.open( pagedFile ) );
+    ASSERT_EQ( Constants::KDTREE_ERROR_INDEX,
+               looping.nearestPointIndex( TestPoint( 2, -5.0 ) ) );
+    ASSERT_TRUE( looping.nearestPoint( TestPoint( 2, -5.0 ) ).empty() );
+}
+
+} // namespace
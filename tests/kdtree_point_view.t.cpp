@@ -0,0 +1,126 @@
+#include "gtest/gtest.h"
+
+#include "kdtree_types.h"
+#include "kdtree_point_view.h"
+
+using namespace datastructures;
+
+namespace {
+
+//////////////////////////////////////////////////////////////////////////////
+// LOCAL TYPES AND DEFINITIONS
+//////////////////////////////////////////////////////////////////////////////
+
+typedef Types::Point< int >     TestPoint;
+typedef Types::Points< int >    TestPoints;
+typedef KDPointView< int >      TestPointView;
+typedef KDPointsView< int >     TestPointsView;
+
+//////////////////////////////////////////////////////////////////////////////
+// HELPER FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////
+// TEST FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+TEST( KDPointView, TestZero )
+{
+    TestPointView zero;
+
+    ASSERT_TRUE( zero.empty() );
+    ASSERT_EQ( 0u, zero.size() );
+    ASSERT_EQ( nullptr, zero.data() );
+    ASSERT_TRUE( zero == zero );
+    ASSERT_TRUE( zero == TestPointView() );
+    ASSERT_EQ( TestPoint(), zero.toPoint() );
+
+    std::cout << zero << std::endl;
+}
+
+TEST( KDPointView, ViewsWithoutCopying )
+{
+    TestPoint p1;
+    p1.push_back( 1 );
+    p1.push_back( 2 );
+    p1.push_back( 3 );
+
+    TestPointView view( p1 );
+    ASSERT_EQ( p1.data(), view.data() );
+    ASSERT_EQ( 3u, view.size() );
+    ASSERT_EQ( 2, view[ 1 ] );
+    ASSERT_EQ( p1, view.toPoint() );
+
+    // Raw buffer view
+    const int raw[] = { 1, 2, 3, 4 };
+    TestPointView rawView( raw, 3u );
+    ASSERT_TRUE( view == rawView );
+    ASSERT_TRUE( view != TestPointView( raw + 1, 3u ) );
+    ASSERT_TRUE( view != TestPointView( raw, 4u ) );
+
+    int sum = 0;
+    for ( TestPointView::const_iterator it = view.begin();
+          it != view.end(); ++it )
+    {
+        sum += ( *it );
+    }
+    ASSERT_EQ( 6, sum );
+
+    std::cout << view << std::endl;
+}
+
+TEST( KDPointsView, ViewsWithoutCopying )
+{
+    TestPointsView zero;
+    ASSERT_TRUE( zero.empty() );
+    ASSERT_EQ( 0u, zero.size() );
+
+    TestPoints points;
+    for ( int i = 0; i < 3; ++i )
+    {
+        TestPoint p;
+        p.push_back( i );
+        p.push_back( -i );
+        points.push_back( p );
+    }
+
+    TestPointsView view( points );
+    ASSERT_EQ( 3u, view.size() );
+    ASSERT_EQ( points[ 2 ].data(), view[ 2 ].data() );
+    ASSERT_EQ( points, view.toPoints() );
+
+    TestPoints same( points );
+    ASSERT_TRUE( view == TestPointsView( same ) );
+
+    same[ 1 ][ 1 ] = 42;
+    ASSERT_TRUE( view != TestPointsView( same ) );
+    ASSERT_TRUE( view != zero );
+}
+
+TEST( KDPointsView, StridedBuffer )
+{
+    const int raw[] = { 1, 2, 0,
+                        3, 4, 0,
+                        5, 6, 0 };
+
+    TestPointsView view( raw, 3u, 2u, 3u );
+    ASSERT_TRUE( view.isStrided() );
+    ASSERT_FALSE( TestPointsView().isStrided() );
+    ASSERT_EQ( 3u, view.size() );
+    ASSERT_EQ( raw + 6, view[ 2 ].data() );
+    ASSERT_EQ( 2u, view[ 2 ].size() );
+
+    TestPoints points;
+    for ( int i = 0; i < 3; ++i )
+    {
+        TestPoint p;
+        p.push_back( 2 * i + 1 );
+        p.push_back( 2 * i + 2 );
+        points.push_back( p );
+    }
+
+    ASSERT_EQ( points, view.toPoints() );
+    ASSERT_TRUE( view == TestPointsView( points ) );
+}
+
+} // namespace
@@ -0,0 +1,175 @@
+#include <cstdint>
+#include <cstdio>
+#include <sstream>
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "kdtree_types.h"
+#include "kdtree_options.h"
+#include "kdtree_profile.h"
+#include "kdtree.h"
+
+using namespace datastructures;
+
+namespace {
+
+//////////////////////////////////////////////////////////////////////////////
+// LOCAL TYPES AND DEFINITIONS
+//////////////////////////////////////////////////////////////////////////////
+
+typedef Types::Point< double >      TestPoint;
+typedef Types::Points< double >     TestPoints;
+
+const std::string profileFile = "really_long_and_unique_profile_file_50.txt";
+
+class TestFileGuard
+{
+public:
+    TestFileGuard( const std::string& testFileName )
+    : m_testFileName( testFileName )
+    {
+        // nothing to do here
+    }
+
+    ~TestFileGuard()
+    {
+        std::remove( m_testFileName.c_str() );
+    }
+
+private:
+    std::string   m_testFileName;
+};
+
+//////////////////////////////////////////////////////////////////////////////
+// HELPER FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+TestPoints scatteredPoints()
+{
+    // Distinct points all over the unit cube, so that every phase of every
+    // builder has real work to time
+    TestPoints points;
+    uint32_t state = 12345u;
+    for ( int i = 0; i < 3000; ++i )
+    {
+        TestPoint p;
+        for ( int axis = 0; axis < 3; ++axis )
+        {
+            state = state * 1664525u + 1013904223u;
+            p.push_back( ( state >> 8 ) / 16777216.0 );
+        }
+        points.push_back( p );
+    }
+
+    return points;
+}
+
+uint64_t sumOfPhases( const KDBuildProfile& profile )
+{
+    return profile.sortNanoseconds + profile.splitNanoseconds +
+           profile.partitionNanoseconds + profile.allocationNanoseconds +
+           profile.finishNanoseconds;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// TEST FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+TEST( KDBuildProfile, Print )
+{
+    KDBuildProfile profile;
+    ASSERT_TRUE( profile.empty() );
+    ASSERT_EQ( 0u, sumOfPhases( profile ) );
+
+    profile.sortNanoseconds       = 1000000000u;
+    profile.splitNanoseconds      = 250000000u;
+    profile.partitionNanoseconds  = 500000000u;
+    profile.allocationNanoseconds = 125000000u;
+    profile.finishNanoseconds     = 62500000u;
+    profile.totalNanoseconds      = 2000000000u;
+    ASSERT_FALSE( profile.empty() );
+
+    std::stringstream text;
+    text << profile;
+    ASSERT_EQ( "KDBuildProfile:[ sort = 1s, split = 0.25s, partition = 0.5s, "
+               "allocation = 0.125s, finish = 0.0625s, total = 2s ]",
+               text.str() );
+
+    std::stringstream json;
+    profile.printJson( json );
+    ASSERT_EQ( "{ \"sort\": 1, \"split\": 0.25, \"partition\": 0.5, "
+               "\"allocation\": 0.125, \"finish\": 0.0625, \"total\": 2 }",
+               json.str() );
+}
+
+TEST( KDBuildProfile, Now )
+{
+    const uint64_t before = KDBuildProfile::now();
+    const uint64_t after  = KDBuildProfile::now();
+    ASSERT_LE( before, after );
+}
+
+TEST( KDBuildProfile, Builders )
+{
+    const TestPoints points = scatteredPoints();
+
+    // Off by default
+    const KDTree< double > plain( points );
+    ASSERT_TRUE( plain.buildProfile().empty() );
+
+    const KDTreeOptions::TreeBuilder builders[] = {
+        KDTreeOptions::MEDIAN_BUILDER,
+        KDTreeOptions::PRESORTED_BUILDER,
+        KDTreeOptions::MORTON_BUILDER
+    };
+    for ( size_t i = 0; i < sizeof( builders ) / sizeof( builders[ 0 ] ); ++i )
+    {
+        KDTreeOptions options;
+        options.builder      = builders[ i ];
+        options.profileBuild = true;
+
+        const KDTree< double > tree( points, options );
+        const KDBuildProfile&  profile = tree.buildProfile();
+        ASSERT_FALSE( profile.empty() );
+        ASSERT_LT( 0u, profile.splitNanoseconds );
+        ASSERT_LT( 0u, profile.allocationNanoseconds );
+        ASSERT_LE( sumOfPhases( profile ), profile.totalNanoseconds );
+        if ( KDTreeOptions::MEDIAN_BUILDER == builders[ i ] )
+        {
+            ASSERT_EQ( 0u, profile.sortNanoseconds );
+            ASSERT_LT( 0u, profile.partitionNanoseconds );
+        }
+        else
+        {
+            ASSERT_LT( 0u, profile.sortNanoseconds );
+        }
+
+        // Copies keep the profile of the structure they share
+        const KDTree< double > copy( tree );
+        ASSERT_EQ( profile.totalNanoseconds,
+                   copy.buildProfile().totalNanoseconds );
+    }
+}
+
+TEST( KDBuildProfile, Deserialized )
+{
+    KDTreeOptions options;
+    options.profileBuild = true;
+
+    KDTree< double > tree( scatteredPoints(), options );
+    ASSERT_FALSE( tree.buildProfile().empty() );
+
+    // Moving leaves nothing behind
+    KDTree< double > moved( std::move( tree ) );
+    ASSERT_FALSE( moved.buildProfile().empty() );
+    ASSERT_TRUE( tree.buildProfile().empty() );
+
+    // A loaded structure was not built
+    TestFileGuard guard( profileFile );
+    ASSERT_TRUE( moved.serialize( profileFile ) );
+    ASSERT_TRUE( moved.deserialize( profileFile ) );
+    ASSERT_TRUE( moved.buildProfile().empty() );
+}
+
+} // namespace
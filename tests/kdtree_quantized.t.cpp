@@ -0,0 +1,136 @@
+#include <cstdint>
+
+#include "gtest/gtest.h"
+
+#include "kdtree_types.h"
+#include "kdtree_point_view.h"
+#include "kdtree_options.h"
+#include "kdtree_quantized.h"
+#include "kdtree_utils.h"
+
+using namespace datastructures;
+
+namespace {
+
+//////////////////////////////////////////////////////////////////////////////
+// LOCAL TYPES AND DEFINITIONS
+//////////////////////////////////////////////////////////////////////////////
+
+typedef Types::Point< float >       TestPoint;
+typedef Types::Points< float >      TestPoints;
+typedef KDPointsView< float >       TestPointsView;
+typedef KDQuantizedPoints< float >  TestQuantizedPoints;
+
+//////////////////////////////////////////////////////////////////////////////
+// HELPER FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+TestPoints makePoints( const size_t numPoints, const size_t dimension )
+{
+    // Deterministic pseudo random coordinates in [-50, 50)
+    uint32_t state = 12345u;
+
+    TestPoints points;
+    for ( size_t i = 0; i < numPoints; ++i )
+    {
+        TestPoint p;
+        for ( size_t j = 0; j < dimension; ++j )
+        {
+            state = state * 1664525u + 1013904223u;
+            p.push_back( static_cast< float >( state >> 8 ) /
+                         static_cast< float >( 1u << 24 ) * 100.0f - 50.0f );
+        }
+        points.push_back( p );
+    }
+
+    return points;
+}
+
+void checkBounds( const TestPoints&          points,
+                  const TestQuantizedPoints& quantized )
+{
+    ASSERT_EQ( points.size(), quantized.size() );
+
+    const TestPoints queries = makePoints( 20, points[ 0 ].size() );
+    for ( size_t i = 0; i < points.size(); ++i )
+    {
+        // Decoded copies are within the error bound
+        const Types::Point< double > decoded = quantized.decode( i );
+        double error2 = 0.0;
+        for ( size_t j = 0; j < decoded.size(); ++j )
+        {
+            error2 += ( decoded[ j ] - points[ i ][ j ] ) *
+                      ( decoded[ j ] - points[ i ][ j ] );
+        }
+        ASSERT_LE( std::sqrt( error2 ), quantized.errorBound( i ) );
+
+        // Lower bounds never exceed exact distances
+        for ( size_t q = 0; q < queries.size(); ++q )
+        {
+            ASSERT_LE( quantized.lowerBound( i, queries[ q ] ),
+                       Utils::distance< float >( points[ i ],
+                                                 queries[ q ] ) );
+        }
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// TEST FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+TEST( KDQuantizedPoints, TestZero )
+{
+    TestQuantizedPoints zero;
+    ASSERT_TRUE( zero.empty() );
+    ASSERT_EQ( 0u, zero.memoryFootprint() );
+
+    const TestPoints points = makePoints( 10, 4 );
+    TestQuantizedPoints full( TestPointsView( points ),
+                              KDTreeOptions::FULL_PRECISION );
+    ASSERT_TRUE( full.empty() );
+
+    std::cout << zero << std::endl;
+}
+
+TEST( KDQuantizedPoints, Bfloat16 )
+{
+    const TestPoints points = makePoints( 100, 16 );
+    TestQuantizedPoints quantized( TestPointsView( points ),
+                                   KDTreeOptions::BFLOAT16_PRECISION );
+    ASSERT_EQ( KDTreeOptions::BFLOAT16_PRECISION, quantized.precision() );
+    ASSERT_EQ( 16u, quantized.dimension() );
+
+    checkBounds( points, quantized );
+
+    // Half of the float storage plus a bound per point
+    ASSERT_EQ( points.size() * 16u * sizeof( uint16_t ) +
+               points.size() * sizeof( float ),
+               quantized.memoryFootprint() );
+}
+
+TEST( KDQuantizedPoints, Scalar8 )
+{
+    TestPoints points = makePoints( 100, 16 );
+
+    // Constant axis
+    for ( size_t i = 0; i < points.size(); ++i )
+    {
+        points[ i ][ 3 ] = 7.0f;
+    }
+
+    TestQuantizedPoints quantized( TestPointsView( points ),
+                                   KDTreeOptions::SCALAR_8_PRECISION );
+    ASSERT_EQ( KDTreeOptions::SCALAR_8_PRECISION, quantized.precision() );
+
+    checkBounds( points, quantized );
+    ASSERT_DOUBLE_EQ( 7.0, quantized.decode( 42 )[ 3 ] );
+
+    // Error is at most half a step per axis
+    for ( size_t i = 0; i < points.size(); ++i )
+    {
+        ASSERT_LE( quantized.errorBound( i ),
+                   std::sqrt( 16.0 ) * 100.0 / 255.0 / 2.0 * 1.01 );
+    }
+}
+
+} // namespace
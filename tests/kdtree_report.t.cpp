@@ -0,0 +1,221 @@
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "kdtree_types.h"
+#include "kdtree_options.h"
+#include "kdtree.h"
+#include "kdtree_report.h"
+
+using namespace datastructures;
+
+namespace {
+
+//////////////////////////////////////////////////////////////////////////////
+// LOCAL TYPES AND DEFINITIONS
+//////////////////////////////////////////////////////////////////////////////
+
+typedef Types::Point< double >      TestPoint;
+typedef Types::Points< double >     TestPoints;
+
+//////////////////////////////////////////////////////////////////////////////
+// HELPER FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+TestPoints stripPoints()
+{
+    // A long thin strip of points stacked in pairs, so that cells come out
+    // elongated and splitting a pair leaves a flat cell behind
+    TestPoints points;
+    for ( int i = 0; i < 2000; ++i )
+    {
+        const int k = i / 2;
+
+        TestPoint p;
+        p.push_back( ( k * 37 ) % 997 ); // x
+        p.push_back( ( k % 4 ) * 0.25 ); // y
+        p.push_back( k % 3 );            // z
+        points.push_back( p );
+    }
+
+    return points;
+}
+
+TestPoints gridPoints()
+{
+    // 4 x 4 distinct points, a perfectly balanced tree
+    TestPoints points;
+    for ( int i = 0; i < 16; ++i )
+    {
+        TestPoint p;
+        p.push_back( i % 4 );
+        p.push_back( i / 4 );
+        points.push_back( p );
+    }
+
+    return points;
+}
+
+size_t sum( const std::vector< size_t >& counts )
+{
+    return std::accumulate( counts.begin(), counts.end(), size_t( 0u ) );
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// TEST FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+TEST( KDTreeReport, Empty )
+{
+    const KDTreeReport< double > report( ( KDTree< double >() ) );
+    ASSERT_EQ( 0u,  report.numPoints() );
+    ASSERT_EQ( 0u,  report.dimension() );
+    ASSERT_EQ( 0u,  report.numNodes() );
+    ASSERT_EQ( 0u,  report.numLeaves() );
+    ASSERT_EQ( 0u,  report.maxDepth() );
+    ASSERT_EQ( 0u,  report.optimalDepth() );
+    ASSERT_EQ( 0.0, report.meanLeafDepth() );
+    ASSERT_EQ( 1.0, report.minBalance() );
+    ASSERT_EQ( 1.0, report.meanBalance() );
+    ASSERT_TRUE( report.axisSplits().empty() );
+    ASSERT_EQ( 0u,  report.numDegenerateCells() );
+    ASSERT_TRUE( report.profile().empty() );
+}
+
+TEST( KDTreeReport, Balanced )
+{
+    const KDTree< double >       tree( gridPoints() );
+    const KDTreeReport< double > report( tree );
+
+    ASSERT_EQ( 16u, report.numPoints() );
+    ASSERT_EQ( 2u,  report.dimension() );
+    ASSERT_EQ( 31u, report.numNodes() );
+    ASSERT_EQ( 16u, report.numLeaves() );
+
+    // Every leaf at depth 4
+    const size_t depths[] = { 0u, 0u, 0u, 0u, 16u };
+    ASSERT_EQ( std::vector< size_t >( depths, depths + 5 ),
+               report.leafDepths() );
+    ASSERT_EQ( 4u,  report.maxDepth() );
+    ASSERT_EQ( 4u,  report.optimalDepth() );
+    ASSERT_EQ( 4.0, report.meanLeafDepth() );
+    ASSERT_EQ( 1.0, report.minBalance() );
+    ASSERT_EQ( 1.0, report.meanBalance() );
+    ASSERT_EQ( 15u, sum( report.axisSplits() ) );
+    ASSERT_LT( 0u,  report.axisSplits()[ 0 ] );
+    ASSERT_LT( 0u,  report.axisSplits()[ 1 ] );
+
+    // The root cell is a square
+    ASSERT_EQ( 1.0, report.minAspectRatio() );
+    ASSERT_LE( report.minAspectRatio(),  report.meanAspectRatio() );
+    ASSERT_LE( report.meanAspectRatio(), report.maxAspectRatio() );
+    ASSERT_TRUE( report.profile().empty() );
+}
+
+TEST( KDTreeReport, Cells )
+{
+    // The root cell is 4 by 1 and split on x at 4, leaving the right leaf
+    // with a flat cell
+    TestPoints points( 2u, TestPoint( 2u, 0.0 ) );
+    points[ 1 ][ 0 ] = 4.0;
+    points[ 1 ][ 1 ] = 1.0;
+
+    const KDTreeReport< double > report( ( KDTree< double >( points ) ) );
+    ASSERT_EQ( 3u,  report.numNodes() );
+    ASSERT_EQ( 1u,  report.maxDepth() );
+    ASSERT_EQ( 1u,  report.axisSplits()[ 0 ] );
+    ASSERT_EQ( 0u,  report.axisSplits()[ 1 ] );
+    ASSERT_EQ( 1u,  report.numDegenerateCells() );
+    ASSERT_EQ( 4.0, report.minAspectRatio() );
+    ASSERT_EQ( 4.0, report.meanAspectRatio() );
+    ASSERT_EQ( 4.0, report.maxAspectRatio() );
+}
+
+TEST( KDTreeReport, Policies )
+{
+    const TestPoints points = stripPoints();
+
+    const KDTreeOptions::SplitPolicy policies[] = {
+        KDTreeOptions::WIDEST_RANGE_MEDIAN,
+        KDTreeOptions::VARIANCE_MEDIAN,
+        KDTreeOptions::SLIDING_MIDPOINT,
+        KDTreeOptions::COST_MODEL,
+        KDTreeOptions::CYCLIC_MEDIAN
+    };
+    for ( size_t i = 0; i < sizeof( policies ) / sizeof( policies[ 0 ] ); ++i )
+    {
+        KDTreeOptions options;
+        options.splitPolicy = policies[ i ];
+
+        const KDTree< double >       tree( points, options );
+        const KDTreeReport< double > report( tree );
+
+        ASSERT_EQ( points.size(),           report.numPoints() );
+        ASSERT_EQ( 2u * points.size() - 1u, report.numNodes() );
+        ASSERT_EQ( points.size(),           report.numLeaves() );
+        ASSERT_EQ( points.size(),           sum( report.leafDepths() ) );
+        ASSERT_EQ( points.size() - 1u,      sum( report.axisSplits() ) );
+        ASSERT_EQ( 11u, report.optimalDepth() );
+        ASSERT_LE( report.optimalDepth(),  report.maxDepth() );
+        ASSERT_LT( 0.0, report.minBalance() );
+        ASSERT_LE( report.minBalance(),    report.meanBalance() );
+        ASSERT_GE( 1.0, report.meanBalance() );
+        ASSERT_LE( 1.0, report.minAspectRatio() );
+        ASSERT_LE( report.meanAspectRatio(), report.maxAspectRatio() );
+        ASSERT_LT( 10.0, report.maxAspectRatio() );
+        ASSERT_LT( 0u, report.numDegenerateCells() );
+        ASSERT_GT( report.numNodes(), report.numDegenerateCells() );
+
+        // Cyclic splits take turns on the axes
+        if ( KDTreeOptions::CYCLIC_MEDIAN == policies[ i ] )
+        {
+            ASSERT_LT( 0u, report.axisSplits()[ 2 ] );
+        }
+
+        // Profiling leaves the shape alone
+        options.profileBuild = true;
+        const KDTree< double >       profiled( points, options );
+        const KDTreeReport< double > profiledReport( profiled );
+        ASSERT_EQ( report.leafDepths(), profiledReport.leafDepths() );
+        ASSERT_EQ( report.axisSplits(), profiledReport.axisSplits() );
+        ASSERT_EQ( report.meanBalance(), profiledReport.meanBalance() );
+        ASSERT_FALSE( profiledReport.profile().empty() );
+    }
+}
+
+TEST( KDTreeReport, Print )
+{
+    TestPoints points( 2u, TestPoint( 2u, 0.0 ) );
+    points[ 1 ][ 0 ] = 4.0;
+    points[ 1 ][ 1 ] = 1.0;
+    const KDTreeReport< double > report( ( KDTree< double >( points ) ) );
+
+    std::stringstream text;
+    text << report;
+    ASSERT_EQ( "KDTreeReport:[ points = 2, dimension = 2, nodes = 3, "
+               "leaves = 2, max depth = 1, optimal depth = 1, "
+               "mean leaf depth = 1, min balance = 1, mean balance = 1, "
+               "axis splits = [ 1, 0 ], "
+               "aspect ratio = [ min = 4, mean = 4, max = 4 ], "
+               "degenerate cells = 1, "
+               "KDBuildProfile:[ sort = 0s, split = 0s, partition = 0s, "
+               "allocation = 0s, finish = 0s, total = 0s ] ]", text.str() );
+
+    std::stringstream json;
+    report.printJson( json );
+    ASSERT_EQ( "{ \"points\": 2, \"dimension\": 2, \"nodes\": 3, "
+               "\"leaves\": 2, \"depth\": { \"max\": 1, \"optimal\": 1, "
+               "\"mean\": 1, \"leaves_per_depth\": [ 0, 2 ] }, "
+               "\"balance\": { \"min\": 1, \"mean\": 1 }, "
+               "\"axis_splits\": [ 1, 0 ], "
+               "\"aspect_ratio\": { \"min\": 4, \"mean\": 4, \"max\": 4, "
+               "\"degenerate_cells\": 1 }, "
+               "\"build_seconds\": { \"sort\": 0, \"split\": 0, "
+               "\"partition\": 0, \"allocation\": 0, \"finish\": 0, "
+               "\"total\": 0 } }", json.str() );
+}
+
+} // namespace
@@ -0,0 +1,359 @@
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include "gtest/gtest.h"
+
+#include "kdtree_types.h"
+#include "kdtree_point_view.h"
+#include "kdtree_utils.h"
+#include "kdtree.h"
+#include "kdtree_server.h"
+
+using namespace datastructures;
+
+namespace {
+
+//////////////////////////////////////////////////////////////////////////////
+// LOCAL TYPES AND DEFINITIONS
+//////////////////////////////////////////////////////////////////////////////
+
+typedef Types::Point< float >       TestPoint;
+typedef Types::Points< float >      TestPoints;
+
+const std::string socketFile = "really_long_and_unique_socket_48.sock";
+
+//////////////////////////////////////////////////////////////////////////////
+// HELPER FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+TestPoints gridPoints()
+{
+    // A grid with rows two apart, so that a query on an odd row is as far
+    // from the row above as from the one below. The server must break such
+    // ties exactly as the tree does.
+    TestPoints points;
+    for ( int i = 0; i < 3000; ++i )
+    {
+        TestPoint p;
+        p.push_back( ( i % 100 ) * 4.5f - 10.0f ); // x
+        p.push_back( ( i / 100 ) * 2.0f );         // y
+        points.push_back( p );
+    }
+
+    return points;
+}
+
+std::vector< float > queryPoints( const size_t count )
+{
+    std::vector< float > queries;
+    for ( size_t i = 0; i < count; ++i )
+    {
+        queries.push_back( static_cast< float >( i % 431 ) - 10.25f );
+        queries.push_back( static_cast< float >( ( i * 7 ) % 60 ) );
+    }
+
+    return queries;
+}
+
+void verifyAnswers( const KDTree< float >&         tree,
+                    const std::vector< float >&    queries,
+                    const std::vector< uint64_t >& indexes,
+                    const std::vector< double >&   distances )
+{
+    ASSERT_EQ( queries.size() / 2u, indexes.size() );
+    ASSERT_EQ( indexes.size(),      distances.size() );
+
+    for ( size_t i = 0; i < indexes.size(); ++i )
+    {
+        const KDPointView< float > query( &queries[ i * 2u ], 2u );
+        ASSERT_EQ( tree.nearestPointIndex( &queries[ i * 2u ], 2u ),
+                   indexes[ i ] );
+        ASSERT_EQ( Utils::distance( query, tree.pointAt( indexes[ i ] ) ),
+                   distances[ i ] );
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// TEST FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+TEST( KDWorkerPool, Parallel )
+{
+    // Every task runs exactly once, whatever the number of workers and
+    // callers
+    for ( size_t workers = 0; workers < 4u; ++workers )
+    {
+        KDWorkerPool pool( workers );
+        ASSERT_EQ( workers, pool.numWorkers() );
+
+        std::vector< std::atomic< int > > calls( 3000u );
+        for ( size_t i = 0; i < calls.size(); ++i )
+        {
+            calls[ i ] = 0;
+        }
+
+        std::vector< std::thread > callers;
+        for ( size_t caller = 0; caller < 3u; ++caller )
+        {
+            callers.push_back( std::thread( [ &, caller ]()
+            {
+                pool.parallel( 1000u, [ & ]( const size_t task )
+                {
+                    ++calls[ caller * 1000u + task ];
+                } );
+            } ) );
+        }
+
+        for ( size_t caller = 0; caller < callers.size(); ++caller )
+        {
+            callers[ caller ].join();
+        }
+
+        for ( size_t i = 0; i < calls.size(); ++i )
+        {
+            ASSERT_EQ( 1, calls[ i ] );
+        }
+
+        pool.parallel( 0u, []( const size_t ) { FAIL(); } );
+    }
+}
+
+TEST( KDQueryServer, Pipes )
+{
+    const KDTree< float > tree( gridPoints() );
+    KDQueryServer< float > server( tree, 3u );
+    ASSERT_EQ( 3u, server.numWorkers() );
+
+    int requests[ 2 ];
+    int responses[ 2 ];
+    ASSERT_EQ( 0, ::pipe( requests ) );
+    ASSERT_EQ( 0, ::pipe( responses ) );
+
+    bool served = false;
+    std::thread serving( [ & ]()
+    {
+        served = server.serve( requests[ 0 ], responses[ 1 ] );
+    } );
+
+    KDQueryClient< float > client;
+    client.attach( responses[ 0 ], requests[ 1 ] );
+
+    // Batches of several sizes over a single connection
+    const size_t counts[] = { 1u, 255u, 257u, 5000u, 0u };
+    for ( size_t i = 0; i < sizeof( counts ) / sizeof( counts[ 0 ] ); ++i )
+    {
+        const std::vector< float > queries = queryPoints( counts[ i ] );
+        std::vector< uint64_t > indexes;
+        std::vector< double >   distances;
+        ASSERT_EQ( KDQueryProtocol::OK,
+                   client.query( queries.data(), counts[ i ], 2u,
+                                 indexes, &distances ) );
+        verifyAnswers( tree, queries, indexes, distances );
+
+        // Without distances only indexes come back
+        std::vector< uint64_t > plain;
+        ASSERT_EQ( KDQueryProtocol::OK,
+                   client.query( queries.data(), counts[ i ], 2u, plain ) );
+        ASSERT_EQ( indexes, plain );
+    }
+
+    ASSERT_EQ( 10u,    server.numBatches() );
+    ASSERT_EQ( 11026u, server.numQueries() );
+
+    // The end of input between requests ends serving normally
+    ::close( requests[ 1 ] );
+    serving.join();
+    ASSERT_TRUE( served );
+
+    ::close( requests[ 0 ] );
+    ::close( responses[ 0 ] );
+    ::close( responses[ 1 ] );
+}
+
+TEST( KDQueryServer, UnixSocket )
+{
+    const KDTree< float > tree( gridPoints() );
+    KDQueryServer< float > server( tree );
+    ASSERT_TRUE( server.listen( socketFile ) );
+    ASSERT_FALSE( server.listen( socketFile ) );
+
+    std::thread running( [ & ]() { server.run(); } );
+
+    // Concurrent connections
+    std::vector< std::thread > clients;
+    std::atomic< size_t > succeeded( 0u );
+    for ( size_t c = 0; c < 4u; ++c )
+    {
+        clients.push_back( std::thread( [ & ]()
+        {
+            KDQueryClient< float > client;
+            if ( !client.connect( socketFile ) )
+            {
+                return;
+            }
+
+            const std::vector< float > queries = queryPoints( 2000u );
+            std::vector< uint64_t > indexes;
+            std::vector< double >   distances;
+            for ( int batch = 0; batch < 5; ++batch )
+            {
+                if ( KDQueryProtocol::OK !=
+                     client.query( queries.data(), 2000u, 2u,
+                                   indexes, &distances ) )
+                {
+                    return;
+                }
+            }
+            verifyAnswers( tree, queries, indexes, distances );
+            ++succeeded;
+        } ) );
+    }
+
+    for ( size_t c = 0; c < clients.size(); ++c )
+    {
+        clients[ c ].join();
+    }
+    ASSERT_EQ( 4u, succeeded );
+    ASSERT_EQ( 20u, server.numBatches() );
+
+    // A request the server cannot answer closes the connection
+    KDQueryClient< float > client;
+    ASSERT_TRUE( client.connect( socketFile ) );
+
+    const std::vector< float > queries = queryPoints( 10u );
+    std::vector< uint64_t > indexes;
+    ASSERT_EQ( KDQueryProtocol::DIMENSION_MISMATCH,
+               client.query( queries.data(), 5u, 4u, indexes ) );
+    ASSERT_TRUE( indexes.empty() );
+    ASSERT_EQ( KDQueryProtocol::BATCH_TOO_LARGE,
+               client.query( queries.data(), 10u, 2u, indexes ) );
+
+    KDQueryClient< double > doubles;
+    ASSERT_TRUE( doubles.connect( socketFile ) );
+    const std::vector< double > wide( 4u, 1.0 );
+    ASSERT_EQ( KDQueryProtocol::VALUE_SIZE_MISMATCH,
+               doubles.query( wide.data(), 2u, 2u, indexes ) );
+
+    // Stopping closes the connections still open and the socket
+    KDQueryClient< float > idle;
+    ASSERT_TRUE( idle.connect( socketFile ) );
+    server.stop();
+    running.join();
+    ASSERT_FALSE( KDQueryClient< float >().connect( socketFile ) );
+    ASSERT_EQ( KDQueryProtocol::BATCH_TOO_LARGE,
+               idle.query( queries.data(), 10u, 2u, indexes ) );
+}
+
+TEST( KDQueryServer, EmptyTree )
+{
+    const KDTree< float > tree;
+    KDQueryServer< float > server( tree, 1u );
+
+    int requests[ 2 ];
+    int responses[ 2 ];
+    ASSERT_EQ( 0, ::pipe( requests ) );
+    ASSERT_EQ( 0, ::pipe( responses ) );
+    std::thread serving( [ & ]()
+    {
+        server.serve( requests[ 0 ], responses[ 1 ] );
+    } );
+
+    KDQueryClient< float > client;
+    client.attach( responses[ 0 ], requests[ 1 ] );
+
+    // Only empty requests have a dimension an empty tree accepts
+    std::vector< uint64_t > indexes;
+    ASSERT_EQ( KDQueryProtocol::OK,
+               client.query( nullptr, 0u, 0u, indexes ) );
+    ASSERT_TRUE( indexes.empty() );
+
+    const std::vector< float > queries = queryPoints( 3u );
+    ASSERT_EQ( KDQueryProtocol::DIMENSION_MISMATCH,
+               client.query( queries.data(), 3u, 2u, indexes ) );
+
+    ::close( requests[ 1 ] );
+    serving.join();
+    ::close( requests[ 0 ] );
+    ::close( responses[ 0 ] );
+    ::close( responses[ 1 ] );
+}
+
+TEST( KDQueryServer, Limits )
+{
+    const KDTree< float > tree( gridPoints() );
+    KDQueryServer< float > server( tree, 1u );
+
+    int requests[ 2 ];
+    int responses[ 2 ];
+    ASSERT_EQ( 0, ::pipe( requests ) );
+    ASSERT_EQ( 0, ::pipe( responses ) );
+    std::thread serving( [ & ]()
+    {
+        server.serve( requests[ 0 ], responses[ 1 ] );
+    } );
+
+    // Rejected before anything is allocated for its points
+    KDQueryProtocol::RequestHeader request;
+    request.magic     = Constants::KDTREE_QUERY_MAGIC;
+    request.flags     = 0u;
+    request.valueSize = sizeof( float );
+    request.dimension = 0xFFFFFFFFu;
+    request.count     = Constants::KDTREE_QUERY_MAX_BATCH;
+    ASSERT_TRUE( KDQueryProtocol::writeFully( requests[ 1 ], &request,
+                                              sizeof( request ) ) );
+
+    KDQueryProtocol::ResponseHeader response;
+    ASSERT_TRUE( KDQueryProtocol::readFully( responses[ 0 ], &response,
+                                             sizeof( response ) ) );
+    ASSERT_EQ( KDQueryProtocol::BATCH_TOO_LARGE, response.status );
+    ASSERT_EQ( 0u, response.count );
+
+    serving.join();
+    ::close( requests[ 0 ] );
+    ::close( requests[ 1 ] );
+    ::close( responses[ 0 ] );
+    ::close( responses[ 1 ] );
+}
+
+TEST( KDQueryServer, SocketPath )
+{
+    const KDTree< float > tree( gridPoints() );
+
+    // Other files are left alone
+    {
+        std::ofstream file( socketFile.c_str() );
+        file << "1,2\n";
+    }
+    KDQueryServer< float > server( tree, 1u );
+    ASSERT_FALSE( server.listen( socketFile ) );
+    std::ifstream kept( socketFile.c_str() );
+    std::string line;
+    ASSERT_TRUE( std::getline( kept, line ) );
+    ASSERT_EQ( "1,2", line );
+    std::remove( socketFile.c_str() );
+
+    // A live server keeps its socket
+    ASSERT_TRUE( server.listen( socketFile ) );
+    KDQueryServer< float > second( tree, 1u );
+    ASSERT_FALSE( second.listen( socketFile ) );
+    KDQueryClient< float > client;
+    ASSERT_TRUE( client.connect( socketFile ) );
+    server.stop();
+
+    // A socket nobody listens on any more is replaced
+    const int stale = KDQueryProtocol::listen( socketFile );
+    ASSERT_LE( 0, stale );
+    KDQueryProtocol::close( stale );
+    ASSERT_EQ( 0, ::access( socketFile.c_str(), F_OK ) );
+    ASSERT_TRUE( second.listen( socketFile ) );
+    second.stop();
+    ASSERT_NE( 0, ::access( socketFile.c_str(), F_OK ) );
+}
+
+} // namespace
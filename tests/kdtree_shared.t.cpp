@@ -0,0 +1,280 @@
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "gtest/gtest.h"
+
+#include "kdtree_types.h"
+#include "kdtree_options.h"
+#include "kdtree.h"
+#include "kdtree_shared.h"
+#include "kdtree_report.h"
+
+using namespace datastructures;
+
+namespace {
+
+//////////////////////////////////////////////////////////////////////////////
+// LOCAL TYPES AND DEFINITIONS
+//////////////////////////////////////////////////////////////////////////////
+
+typedef Types::Point< double >      TestPoint;
+typedef Types::Points< double >     TestPoints;
+
+const std::string sharedFile = "really_long_and_unique_shared_file_49.bin";
+
+class TestFileGuard
+{
+public:
+    TestFileGuard( const std::string& testFileName )
+    : m_testFileName( testFileName )
+    {
+        // nothing to do here
+    }
+
+    ~TestFileGuard()
+    {
+        std::remove( m_testFileName.c_str() );
+    }
+
+private:
+    std::string   m_testFileName;
+};
+
+//////////////////////////////////////////////////////////////////////////////
+// HELPER FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+TestPoints deepPoints()
+{
+    // A chain of points, each twice as far out on x as the one before,
+    // which sliding midpoint splits peel off one per level, next to a cloud
+    // of points stacked in pairs. The segment must hold a tree hundreds of
+    // levels deep as well as duplicates.
+    TestPoints points;
+    double x = 1.0;
+    for ( int i = 0; i < 500; ++i )
+    {
+        TestPoint p;
+        p.push_back( x );   // x
+        p.push_back( 0.0 ); // y
+        p.push_back( 0.0 ); // z
+        points.push_back( p );
+        x *= 2.0;
+    }
+
+    for ( int i = 0; i < 1500; ++i )
+    {
+        const int k = i / 2;
+
+        TestPoint p;
+        p.push_back( ( k * 37 ) % 409 ); // x
+        p.push_back( ( k * 13 ) % 53 );  // y
+        p.push_back( k % 2 );            // z
+        points.push_back( p );
+    }
+
+    return points;
+}
+
+bool matches( const KDTree< double >&       tree,
+              const KDSharedTree< double >& shared )
+{
+    for ( double x = -3.0; x < 420.0; x += 1.5 )
+    {
+        TestPoint pointOfInterest;
+        pointOfInterest.push_back( x );
+        pointOfInterest.push_back( static_cast< int >( x * 7 ) % 60 );
+        pointOfInterest.push_back( 0.25 );
+
+        const size_t index = shared.nearestPointIndex( pointOfInterest );
+        if ( ( tree.nearestPointIndex( pointOfInterest ) != index ) ||
+             ( tree.pointAt( index ) != shared.pointAt( index ) ) ||
+             ( tree.pointAt( index ) !=
+               shared.nearestPointView( pointOfInterest.data(), 3u ) ) )
+        {
+            return false;
+        }
+    }
+
+    // Down the chain
+    for ( double x = 1.0; x < 1e150; x *= 3.0 )
+    {
+        TestPoint pointOfInterest( 3u, 0.5 );
+        pointOfInterest[ 0 ] = x;
+
+        if ( tree.nearestPointIndex( pointOfInterest ) !=
+             shared.nearestPointIndex( pointOfInterest ) )
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// TEST FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+TEST( KDSharedTree, MatchesKDTree )
+{
+    TestFileGuard guard( sharedFile );
+
+    KDTreeOptions leafOrder;
+    leafOrder.pointOrder = KDTreeOptions::LEAF_ORDER;
+
+    KDTreeOptions slidingMidpoint;
+    slidingMidpoint.splitPolicy = KDTreeOptions::SLIDING_MIDPOINT;
+    slidingMidpoint.nodeAllocation = KDTreeOptions::ARENA_NODES;
+
+    const KDTreeOptions options[] = {
+        KDTreeOptions(), leafOrder, slidingMidpoint
+    };
+    for ( size_t i = 0; i < sizeof( options ) / sizeof( options[ 0 ] ); ++i )
+    {
+        const KDTree< double > tree( deepPoints(), options[ i ] );
+        ASSERT_TRUE( KDSharedTree< double >::write(
+                             tree, sharedFile,
+                             KDSharedSegment::REGULAR_FILE ) );
+
+        KDSharedTree< double > shared;
+        ASSERT_FALSE( shared.isOpen() );
+        ASSERT_TRUE( shared.open( sharedFile,
+                                  KDSharedSegment::REGULAR_FILE ) );
+        ASSERT_TRUE( shared.isOpen() );
+        ASSERT_EQ( 2000u, shared.size() );
+        ASSERT_EQ( 3u,    shared.dimension() );
+        ASSERT_EQ( 3999u, shared.numNodes() );
+        ASSERT_TRUE( matches( tree, shared ) );
+
+        // Sliding midpoint builds the chain
+        if ( KDTreeOptions::SLIDING_MIDPOINT == options[ i ].splitPolicy )
+        {
+            ASSERT_LT( 500u, KDTreeReport< double >( tree ).maxDepth() );
+        }
+
+        for ( size_t index = 0; index < 2000u; index += 97u )
+        {
+            ASSERT_EQ( tree.pointAt( index ), shared.pointAt( index ) );
+        }
+        ASSERT_EQ( 0u, shared.pointAt( 2000u ).size() );
+
+        // Cardinality mismatch
+        ASSERT_EQ( Constants::KDTREE_ERROR_INDEX,
+                   shared.nearestPointIndex( TestPoint( 2, 1.0 ) ) );
+
+        shared.close();
+        ASSERT_FALSE( shared.isOpen() );
+        ASSERT_EQ( 0u, shared.size() );
+    }
+}
+
+TEST( KDSharedTree, SharedMemory )
+{
+    const std::string segment = "/kdtree_unit_test_" +
+                                std::to_string( ::getpid() );
+
+    const KDTree< double > tree( deepPoints() );
+    ASSERT_TRUE( KDSharedTree< double >::write( tree, segment ) );
+
+    // Every process maps the same segment
+    std::vector< pid_t > children;
+    for ( int child = 0; child < 3; ++child )
+    {
+        const pid_t pid = ::fork();
+        ASSERT_LE( 0, pid );
+        if ( !pid )
+        {
+            KDSharedTree< double > shared;
+            ::_exit( shared.open( segment ) && matches( tree, shared ) ?
+                     0 : 1 );
+        }
+        children.push_back( pid );
+    }
+
+    for ( size_t child = 0; child < children.size(); ++child )
+    {
+        int status = 0;
+        ASSERT_EQ( children[ child ], ::waitpid( children[ child ],
+                                                 &status, 0 ) );
+        ASSERT_TRUE( WIFEXITED( status ) );
+        ASSERT_EQ( 0, WEXITSTATUS( status ) );
+    }
+
+    // Replacing the segment leaves mappings of the old one intact
+    KDSharedTree< double > shared;
+    ASSERT_TRUE( shared.open( segment ) );
+
+    TestPoints fewer;
+    fewer.push_back( TestPoint( 3, 1.0 ) );
+    fewer.push_back( TestPoint( 3, 2.0 ) );
+    ASSERT_TRUE( KDSharedTree< double >::write(
+                         KDTree< double >( fewer ), segment ) );
+    ASSERT_TRUE( matches( tree, shared ) );
+
+    KDSharedTree< double > replaced;
+    ASSERT_TRUE( replaced.open( segment ) );
+    ASSERT_EQ( 2u, replaced.size() );
+    ASSERT_EQ( 1u, replaced.nearestPointIndex( TestPoint( 3, 1.75 ) ) );
+
+    ASSERT_TRUE( KDSharedTree< double >::remove( segment ) );
+    ASSERT_FALSE( KDSharedTree< double >().open( segment ) );
+    ASSERT_TRUE( matches( tree, shared ) );
+}
+
+TEST( KDSharedTree, EmptyAndInvalidSegments )
+{
+    TestFileGuard guard( sharedFile );
+    KDSharedTree< double > shared;
+
+    ASSERT_FALSE( shared.open( sharedFile, KDSharedSegment::REGULAR_FILE ) );
+
+    // Empty tree
+    ASSERT_TRUE( KDSharedTree< double >::write(
+                         KDTree< double >(), sharedFile,
+                         KDSharedSegment::REGULAR_FILE ) );
+    ASSERT_TRUE( shared.open( sharedFile, KDSharedSegment::REGULAR_FILE ) );
+    ASSERT_EQ( 0u, shared.size() );
+    ASSERT_EQ( Constants::KDTREE_ERROR_INDEX,
+               shared.nearestPointIndex( TestPoint( 3, 1.0 ) ) );
+    ASSERT_EQ( 0u, shared.nearestPointView( nullptr, 0u ).size() );
+
+    // Another coordinate type
+    ASSERT_TRUE( KDSharedTree< double >::write(
+                         KDTree< double >( deepPoints() ), sharedFile,
+                         KDSharedSegment::REGULAR_FILE ) );
+    ASSERT_FALSE( KDSharedTree< float >().open(
+                          sharedFile, KDSharedSegment::REGULAR_FILE ) );
+
+    // Truncated
+    std::string bytes;
+    {
+        std::ifstream sharedData( sharedFile, std::ios::binary );
+        bytes.assign( std::istreambuf_iterator< char >( sharedData ),
+                      std::istreambuf_iterator< char >() );
+    }
+    {
+        std::ofstream sharedData( sharedFile,
+                                  std::ios::binary | std::ios::trunc );
+        sharedData.write( bytes.data(), bytes.size() - 8u );
+    }
+    ASSERT_FALSE( shared.open( sharedFile, KDSharedSegment::REGULAR_FILE ) );
+    ASSERT_FALSE( shared.isOpen() );
+
+    // A link pointing backwards would loop forever
+    std::fill( bytes.begin() + 136u, bytes.begin() + 144u, '\0' );
+    {
+        std::ofstream sharedData( sharedFile,
+                                  std::ios::binary | std::ios::trunc );
+        sharedData.write( bytes.data(), bytes.size() );
+    }
+    ASSERT_FALSE( shared.open( sharedFile, KDSharedSegment::REGULAR_FILE ) );
+}
+
+} // namespace
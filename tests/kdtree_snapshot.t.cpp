@@ -0,0 +1,213 @@
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "kdtree_types.h"
+#include "kdtree.h"
+#include "kdtree_snapshot.h"
+
+using namespace datastructures;
+
+namespace {
+
+//////////////////////////////////////////////////////////////////////////////
+// LOCAL TYPES AND DEFINITIONS
+//////////////////////////////////////////////////////////////////////////////
+
+typedef Types::Point< int >     TestPoint;
+typedef Types::Points< int >    TestPoints;
+typedef KDTreeSnapshot< int >   TestSnapshot;
+
+//////////////////////////////////////////////////////////////////////////////
+// HELPER FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+TestPoints linePoints( const int size, const int offset )
+{
+    TestPoints points;
+    for ( int i = 0; i < size; ++i )
+    {
+        TestPoint p;
+        p.push_back( i + offset ); // x
+        p.push_back( 0 );          // y
+        points.push_back( p );
+    }
+
+    return points;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// TEST FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+TEST( KDTreeSnapshot, TestZero )
+{
+    TestSnapshot snapshot;
+
+    ASSERT_TRUE( nullptr != snapshot.acquire() );
+    ASSERT_EQ( KDTree< int >(), *snapshot.acquire() );
+    ASSERT_EQ( 0u, snapshot.generation() );
+
+    TestPoint pointOfInterest;
+    pointOfInterest.push_back( 0 );
+    pointOfInterest.push_back( 0 );
+    ASSERT_EQ( Constants::KDTREE_ERROR_INDEX,
+               snapshot.nearestPointIndex( pointOfInterest ) );
+
+    // Null trees are never published
+    snapshot.publish( TestSnapshot::TreePtr() );
+    ASSERT_TRUE( nullptr != snapshot.acquire() );
+    ASSERT_EQ( 1u, snapshot.generation() );
+}
+
+TEST( KDTreeSnapshot, PublishKeepsReadersSnapshot )
+{
+    TestSnapshot snapshot;
+    snapshot.rebuild( linePoints( 4, 0 ) );
+
+    TestSnapshot::TreePtr reader = snapshot.acquire();
+    std::weak_ptr< const KDTree< int > > watcher( reader );
+
+    TestSnapshot::TreePtr previous = snapshot.rebuild( linePoints( 4, 100 ) );
+    ASSERT_EQ( reader, previous );
+    previous.reset();
+
+    // Reader still holds the old tree and sees old data
+    TestPoint pointOfInterest;
+    pointOfInterest.push_back( 2 );
+    pointOfInterest.push_back( 0 );
+    ASSERT_EQ( linePoints( 4, 0 )[ 2 ], reader->nearestPoint( pointOfInterest ) );
+    ASSERT_EQ( linePoints( 4, 100 )[ 0 ],
+               snapshot.acquire()->nearestPoint( pointOfInterest ) );
+
+    // Old tree is reclaimed once the last reader is gone
+    ASSERT_FALSE( watcher.expired() );
+    reader.reset();
+    ASSERT_TRUE( watcher.expired() );
+}
+
+TEST( KDTreeSnapshot, ReloadFailureKeepsCurrentTree )
+{
+    TestSnapshot snapshot;
+    snapshot.rebuild( linePoints( 3, 0 ) );
+
+    TestSnapshot::TreePtr before = snapshot.acquire();
+    ASSERT_FALSE( snapshot.reload( "no_such_file_for_kdtree_snapshot.txt" ) );
+    ASSERT_EQ( before, snapshot.acquire() );
+    ASSERT_EQ( 1u, snapshot.generation() );
+}
+
+TEST( KDTreeSnapshot, ConcurrentReadersDuringRebuild )
+{
+    const int numPoints  = 64;
+    const int numReaders = 4;
+    const int numRebuilds = 20;
+
+    TestSnapshot snapshot;
+    snapshot.rebuild( linePoints( numPoints, 0 ) );
+
+    std::atomic< bool > done( false );
+    std::atomic< int >  failures( 0 );
+    std::vector< std::thread > readers;
+
+    for ( int r = 0; r < numReaders; ++r )
+    {
+        readers.push_back( std::thread( [ & ]() {
+            while ( !done.load() )
+            {
+                TestSnapshot::TreePtr tree = snapshot.acquire();
+
+                TestPoint pointOfInterest;
+                pointOfInterest.push_back( numPoints / 2 );
+                pointOfInterest.push_back( 0 );
+
+                // Every published tree holds exactly numPoints points
+                if ( tree->nearestPointIndex( pointOfInterest ) >=
+                        static_cast< size_t >( numPoints ) )
+                {
+                    ++failures;
+                }
+            }
+        } ) );
+    }
+
+    for ( int i = 0; i < numRebuilds; ++i )
+    {
+        snapshot.rebuild( linePoints( numPoints, i ) );
+    }
+
+    done = true;
+    for ( size_t r = 0; r < readers.size(); ++r )
+    {
+        readers[ r ].join();
+    }
+
+    ASSERT_EQ( 0, failures.load() );
+    ASSERT_EQ( static_cast< size_t >( numRebuilds + 1 ), snapshot.generation() );
+}
+
+TEST( KDTreeSnapshot, ReadersProgressDuringPublish )
+{
+    const int numPoints   = 32;
+    const int numReaders  = 4;
+    const int numAcquires = 5000;
+
+    TestSnapshot snapshot;
+    snapshot.rebuild( linePoints( numPoints, 0 ) );
+    std::weak_ptr< const KDTree< int > > watcher( snapshot.acquire() );
+
+    const TestSnapshot::TreePtr trees[ 2 ] = {
+        std::make_shared< const KDTree< int > >( linePoints( numPoints, 1 ) ),
+        std::make_shared< const KDTree< int > >( linePoints( numPoints, 2 ) )
+    };
+
+    // The writer publishes back to back for as long as the readers run
+    std::atomic< bool > done( false );
+    size_t numPublished = 0u;
+    std::thread writer( [ & ]() {
+        while ( !done.load() )
+        {
+            snapshot.publish( trees[ numPublished++ % 2u ] );
+        }
+    } );
+
+    std::atomic< int > failures( 0 );
+    std::vector< std::thread > readers;
+    for ( int r = 0; r < numReaders; ++r )
+    {
+        readers.push_back( std::thread( [ & ]() {
+            TestPoint pointOfInterest;
+            pointOfInterest.push_back( 0 );
+            pointOfInterest.push_back( 0 );
+
+            for ( int i = 0; i < numAcquires; ++i )
+            {
+                TestSnapshot::TreePtr tree = snapshot.acquire();
+                if ( ( nullptr == tree ) ||
+                     ( tree->nearestPointIndex( pointOfInterest ) != 0u ) )
+                {
+                    ++failures;
+                }
+            }
+        } ) );
+    }
+
+    // Every reader completes while publish() keeps running
+    for ( size_t r = 0; r < readers.size(); ++r )
+    {
+        readers[ r ].join();
+    }
+    done = true;
+    writer.join();
+
+    ASSERT_EQ( 0, failures.load() );
+    ASSERT_EQ( numPublished + 1u, snapshot.generation() );
+
+    // With no reader left, the next publish() reclaims every retired tree
+    snapshot.publish( trees[ 0 ] );
+    ASSERT_TRUE( watcher.expired() );
+}
+
+} // namespace